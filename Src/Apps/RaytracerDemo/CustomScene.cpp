@@ -301,8 +301,9 @@ bool LoadCustomScene(Scene& scene, Camera& camera)
     /*
     // heterogeneous absorption medium
     {
-        auto densityBitmap = helpers::LoadBitmapObject(gOptions.dataPath, "TEXTURES/Volume/Clouds/wdas_cloud_half.vdb");
-        //auto densityBitmap = helpers::LoadBitmapObject(gOptions.dataPath, "TEXTURES/Volume/sphere.vdb");
+        auto densityBitmap = MakeSharedPtr<SparseBitmap3D>("wdas_cloud_half");
+        densityBitmap->LoadVDB((gOptions.dataPath + "TEXTURES/Volume/Clouds/wdas_cloud_half.vdb").Str());
+        //densityBitmap->LoadVDB((gOptions.dataPath + "TEXTURES/Volume/sphere.vdb").Str());
 
         const float density = 20.0f;
         const Vec4f scattering = Vec4f(1.0f, 1.0f, 1.0f) * density;
@@ -449,7 +449,7 @@ bool DemoWindow::Loop()
 
         mDeltaTime = displayTimer.Restart();
 
-        UpdateCamera();
+        bool cameraMoved = UpdateCamera();
 
         bool resetFrame = false;
 
@@ -457,7 +457,7 @@ bool DemoWindow::Loop()
         {
             mPreviewRenderingParams = mRenderingParams;
             mPreviewRenderingParams.antiAliasingSpread = 0.0f;
-            resetFrame |= true;
+            cameraMoved = true;
         }
 
         mSpectrumPicking = false;
@@ -472,6 +472,12 @@ bool DemoWindow::Loop()
         {
             ResetFrame();
         }
+        else if (cameraMoved)
+        {
+            // reuse accumulated samples if enabled, otherwise just reset the frame
+            mViewport->Reproject(*mScene, mCamera);
+            ResetCounters();
+        }
 
         //// render
         localTimer.Start();
@@ -519,7 +525,7 @@ bool DemoWindow::IsPreview() const
     return IsMouseButtonDown(MouseButton::Right);
 }
 
-void DemoWindow::UpdateCamera()
+bool DemoWindow::UpdateCamera()
 {
     uint32 width, height;
     GetSize(width, height);
@@ -549,9 +555,9 @@ void DemoWindow::UpdateCamera()
     // TODO
     //mCamera.mLinearVelocity = mCameraSetup.linearVelocity;
 
-    if (movement.Length3() > NFE_MATH_EPSILON)
+    const bool cameraMoved = movement.Length3() > NFE_MATH_EPSILON;
+    if (cameraMoved)
     {
-        ResetFrame();
 
         movement.Normalize3();
         movement *= mCameraSpeed;
@@ -586,6 +592,8 @@ void DemoWindow::UpdateCamera()
     {
         mCamera.SetAngularVelocity(Quaternion::FromEulerAngles(mCameraSetup.angularVelocity));
     }
+
+    return cameraMoved;
 }
 
 } // namespace NFE
@@ -19,9 +19,21 @@ struct Options
     Common::String dataPath;
 
     bool enablePacketTracing = false;
+    bool compressTextures = false;
+    bool compressMeshes = false;
+    bool optimizeBvh = false;
+    bool useLargePages = false;
     Common::String rendererName{ "Path Tracer" };
 
     Common::String sceneName;
+
+    // headless multi-process rendering (see TileFarmMode.h)
+    bool tileFarmCoordinator = false;
+    Common::String tileFarmWorkerHost;      // run as a worker connected to this host
+    uint32 tileFarmPort = 5050;
+    uint32 tileFarmWorkers = 1;
+    uint32 tileFarmPasses = 64;
+    Common::String tileFarmOutput{ "tilefarm.bmp" };
 };
 
 struct CameraSetup
@@ -121,7 +133,9 @@ private:
 
     bool IsPreview() const;
     void ResetCounters();
-    void UpdateCamera();
+
+    // returns true if the camera was moved
+    bool UpdateCamera();
 };
 
 extern Options gOptions;
@@ -6,8 +6,10 @@
 #include "Engine/Raytracer/Scene/Object/SceneObject.h"
 #include "Engine/Raytracer/Scene/Light/BackgroundLight.h"
 #include "Engine/Raytracer/Renderers/Renderer.h"
+#include "Engine/Raytracer/Utils/ExrWriter.h"
 #include "Engine/Raytracer/Utils/Profiler.h"
 
+#include "Engine/Common/Logger/Logger.hpp"
 #include "Engine/Common/Reflection/Types/ReflectionUniquePtrType.hpp"
 #include "Engine/Common/Reflection/Types/ReflectionClassType.hpp"
 
@@ -81,6 +83,12 @@ void DemoWindow::RenderUI_Stats()
         ImGui::Text("Shadow rays (hit)"); ImGui::NextColumn();
         ImGui::Text("%.3fM", (float)counters.numShadowRaysHit / 1.0e+6f); ImGui::NextColumn();
 
+        ImGui::Text("Occluder cache (tests)"); ImGui::NextColumn();
+        ImGui::Text("%.3fM", (float)counters.numOccluderCacheTests / 1.0e+6f); ImGui::NextColumn();
+
+        ImGui::Text("Occluder cache (hits)"); ImGui::NextColumn();
+        ImGui::Text("%.3fM", (float)counters.numOccluderCacheHits / 1.0e+6f); ImGui::NextColumn();
+
         ImGui::Text("Ray-box tests (total)"); ImGui::NextColumn();
         ImGui::Text("%.3fM", (float)counters.numRayBoxTests / 1.0e+6f); ImGui::NextColumn();
 
@@ -402,7 +410,19 @@ bool DemoWindow::RenderUI_Settings()
         {
             // TODO this is incorrect
             const float colorScale = 1.0f / (float)mViewport->GetProgress().passesFinished;
-            mViewport->GetSumBuffer().SaveEXR("screenshot.exr", colorScale);
+
+            // chunks are compressed in parallel, which is much faster than Bitmap::SaveEXR for big images
+            ExrWriter::PartDesc part;
+            part.source = &mViewport->GetSumBuffer();
+            part.pixelType = ExrWriter::PixelType::Float;
+            part.compression = ExrWriter::Compression::ZIP;
+            part.scale = colorScale;
+
+            ExrWriter writer;
+            if (!writer.Open("screenshot.exr", ArrayView<const ExrWriter::PartDesc>(&part, 1)) || !writer.Close())
+            {
+                NFE_LOG_ERROR("Failed to save HDR screenshot");
+            }
         }
     }
 
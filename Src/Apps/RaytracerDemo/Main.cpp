@@ -1,8 +1,10 @@
 #include "PCH.h"
 #include "Demo.h"
+#include "TileFarmMode.h"
 
 #include "Engine/Common/Logger/Logger.hpp"
 #include "Engine/Common/FileSystem/FileSystem.hpp"
+#include "Engine/Raytracer/Utils/Memory.h"
 
 #include <cxxopts.hpp>
 
@@ -21,6 +23,16 @@ bool ParseOptions(int argc, char** argv, Options& outOptions)
         ("renderer", "Renderer name", cxxopts::value<std::string>())
         ("p,packet-tracing", "Use ray packet tracing by default", cxxopts::value<bool>())
         ("data", "Data path", cxxopts::value<std::string>())
+        ("compress-textures", "Block compress 8-bit textures on load (cached on disk)", cxxopts::value<bool>())
+        ("compress-meshes", "Quantize mesh normals, tangents and texture coordinates, use 16-bit indices for small meshes", cxxopts::value<bool>())
+        ("optimize-bvh", "Restructure mesh BVHs after build (slower loading, faster rendering)", cxxopts::value<bool>())
+        ("large-pages", "Allocate big buffers (BVHs, meshes, textures) using large pages", cxxopts::value<bool>())
+        ("coordinator", "Render without window, distributing the work to tile farm workers", cxxopts::value<bool>())
+        ("worker", "Render without window, as a tile farm worker connected to given coordinator host", cxxopts::value<std::string>())
+        ("port", "Tile farm coordinator port", cxxopts::value<uint32>())
+        ("workers", "Number of tile farm workers to wait for", cxxopts::value<uint32>())
+        ("passes", "Number of sampling passes rendered by tile farm", cxxopts::value<uint32>())
+        ("output", "Image file saved by tile farm coordinator", cxxopts::value<std::string>())
         ;
 
     try
@@ -43,6 +55,27 @@ bool ParseOptions(int argc, char** argv, Options& outOptions)
             outOptions.rendererName = result["renderer"].as<std::string>().c_str();
 
         outOptions.enablePacketTracing = result["p"].count() > 0;
+        outOptions.compressTextures = result["compress-textures"].count() > 0;
+        outOptions.compressMeshes = result["compress-meshes"].count() > 0;
+        outOptions.optimizeBvh = result["optimize-bvh"].count() > 0;
+        outOptions.useLargePages = result["large-pages"].count() > 0;
+
+        outOptions.tileFarmCoordinator = result["coordinator"].count() > 0;
+
+        if (result.count("worker"))
+            outOptions.tileFarmWorkerHost = result["worker"].as<std::string>().c_str();
+
+        if (result.count("port"))
+            outOptions.tileFarmPort = result["port"].as<uint32>();
+
+        if (result.count("workers"))
+            outOptions.tileFarmWorkers = result["workers"].as<uint32>();
+
+        if (result.count("passes"))
+            outOptions.tileFarmPasses = result["passes"].as<uint32>();
+
+        if (result.count("output"))
+            outOptions.tileFarmOutput = result["output"].as<std::string>().c_str();
     }
     catch (cxxopts::OptionParseException& e)
     {
@@ -78,6 +111,19 @@ int main(int argc, char* argv[])
         return 1;
     }
 
+    RT::MemoryInitOptions memoryOptions;
+    memoryOptions.useLargePages = gOptions.useLargePages;
+    RT::InitMemory(memoryOptions);
+
+    if (gOptions.tileFarmCoordinator || !gOptions.tileFarmWorkerHost.Empty())
+    {
+        const bool result = gOptions.tileFarmCoordinator ? helpers::RunTileFarmCoordinator() : helpers::RunTileFarmWorker();
+
+        NFE::Common::ShutdownSubsystems();
+
+        return result ? 0 : 4;
+    }
+
     {
         DemoWindow demo;
 
@@ -1,5 +1,6 @@
 #include "PCH.h"
 #include "MeshLoader.h"
+#include "Demo.h"
 
 #include "Engine/Raytracer/Utils/Bitmap.h"
 #include "Engine/Raytracer/Textures/BitmapTexture.h"
@@ -8,6 +9,8 @@
 #include "Engine/Common/Math/Geometry.hpp"
 #include "Engine/Common/Math/HdrColor.hpp"
 #include "Engine/Common/FileSystem/FileSystem.hpp"
+#include "Engine/Common/System/Mutex.hpp"
+#include "Engine/Common/Utils/ScopedLock.hpp"
 
 #include <tinyobjloader/tiny_obj_loader.h>
 
@@ -35,6 +38,15 @@ struct TriangleIndicesHash
     }
 };
 
+struct BitmapCacheEntry
+{
+    Mutex lock;
+    BitmapPtr bitmap;
+    bool loaded = false;
+};
+
+using BitmapCacheEntryPtr = SharedPtr<BitmapCacheEntry>;
+
 BitmapPtr LoadBitmapObject(const StringView& baseDir, const StringView& path)
 {
     if (path.Empty())
@@ -49,19 +61,39 @@ BitmapPtr LoadBitmapObject(const StringView& baseDir, const StringView& path)
     }
 
     // cache bitmaps so they are loaded only once
-    static HashMap<String, BitmapPtr> bitmapsList;
-    BitmapPtr& bitmapPtr = bitmapsList.Insert(fullPath, BitmapPtr()).iterator->second;
+    // NOTE: bitmaps can be requested from multiple threads at once (see LoadScene)
+    static Mutex bitmapsListLock;
+    static HashMap<String, BitmapCacheEntryPtr> bitmapsList;
 
-    if (!bitmapPtr)
+    BitmapCacheEntryPtr entry;
     {
-        bitmapPtr = MakeSharedPtr<Bitmap>(fullPath.Str());
-        if (!bitmapPtr->Load(fullPath.Str()))
+        ScopedExclusiveLock<Mutex> lock(bitmapsListLock);
+        BitmapCacheEntryPtr& entryRef = bitmapsList.Insert(fullPath, BitmapCacheEntryPtr()).iterator->second;
+        if (!entryRef)
         {
-            return nullptr;
+            entryRef = MakeSharedPtr<BitmapCacheEntry>();
+        }
+        entry = entryRef;
+    }
+
+    // other threads requesting the same bitmap wait here until it's loaded
+    ScopedExclusiveLock<Mutex> lock(entry->lock);
+
+    if (!entry->loaded)
+    {
+        entry->loaded = true;
+
+        Bitmap::LoadParams loadParams;
+        loadParams.blockCompress = gOptions.compressTextures;
+
+        BitmapPtr bitmap = MakeSharedPtr<Bitmap>(fullPath.Str());
+        if (bitmap->Load(fullPath.Str(), loadParams))
+        {
+            entry->bitmap = std::move(bitmap);
         }
     }
 
-    return bitmapPtr;
+    return entry->bitmap;
 }
 
 TexturePtr LoadTexture(const StringView& baseDir, const StringView& path)
@@ -381,6 +413,11 @@ public:
         }
     }
 
+    NFE_FORCE_INLINE uint32 GetNumTriangles() const
+    {
+        return mVertexIndices.Size() / 3;
+    }
+
     MeshShapePtr BuildMesh()
     {
         MeshDesc meshDesc;
@@ -395,6 +432,9 @@ public:
         meshDesc.vertexBufferDesc.normals = mVertexNormals.Data();
         meshDesc.vertexBufferDesc.tangents = mVertexTangents.Data();
         meshDesc.vertexBufferDesc.texCoords = mVertexTexCoords.Data();
+        meshDesc.vertexBufferDesc.packShadingData = gOptions.compressMeshes;
+        meshDesc.vertexBufferDesc.compactIndices = gOptions.compressMeshes;
+        meshDesc.bvhParams.optimizationTimeBudget = gOptions.optimizeBvh ? 1.0f : 0.0f;
 
         MeshShapePtr mesh = MakeSharedPtr<MeshShape>();
         bool result = mesh->Initialize(meshDesc);
@@ -430,5 +470,31 @@ RT::MeshShapePtr LoadMesh(const String& filePath, MaterialsMap& outMaterials, co
     return loader.BuildMesh();
 }
 
+void MeshLoaderDeleter::Delete(MeshLoader* loader)
+{
+    DefaultDeleter<MeshLoader>::Delete(loader);
+}
+
+ParsedMeshPtr ParseMesh(const String& filePath, MaterialsMap& outMaterials, const float scale)
+{
+    ParsedMeshPtr loader = MakeUniquePtr<MeshLoader, MeshLoaderDeleter>();
+    if (!loader->LoadMesh(filePath, outMaterials, scale))
+    {
+        return nullptr;
+    }
+
+    return loader;
+}
+
+uint32 GetNumTriangles(const MeshLoader& parsedMesh)
+{
+    return parsedMesh.GetNumTriangles();
+}
+
+MeshShapePtr BuildMesh(MeshLoader& parsedMesh)
+{
+    return parsedMesh.BuildMesh();
+}
+
 } // namespace helpers
 } // namespace NFE
\ No newline at end of file
@@ -4,15 +4,36 @@
 #include "Engine/Raytracer/Material/Material.h"
 #include "Engine/Raytracer/Utils/Bitmap.h"
 #include "Engine/Common/Containers/HashMap.hpp"
+#include "Engine/Common/Containers/UniquePtr.hpp"
 
 namespace NFE {
 namespace helpers {
 
 using MaterialsMap = Common::HashMap<Common::String, RT::MaterialPtr>;
 
+// NOTE: bitmaps are cached, loading functions can be called from multiple threads concurrently
 RT::BitmapPtr LoadBitmapObject(const Common::StringView& baseDir, const Common::StringView& path);
 RT::TexturePtr LoadTexture(const Common::StringView& baseDir, const Common::StringView& path);
 RT::MeshShapePtr LoadMesh(const Common::String& filePath, MaterialsMap& outMaterials, const float scale = 1.0f);
+
+class MeshLoader;
+
+struct MeshLoaderDeleter
+{
+    static void Delete(MeshLoader* loader);
+};
+
+// mesh file that was parsed, but the mesh shape was not created yet
+using ParsedMeshPtr = Common::UniquePtr<MeshLoader, MeshLoaderDeleter>;
+
+// Parse mesh file (can be called from any thread), the mesh shape is created later with BuildMesh()
+// NOTE: this way mesh files can be parsed in parallel, while BVH of big meshes is still built using all the threads
+ParsedMeshPtr ParseMesh(const Common::String& filePath, MaterialsMap& outMaterials, const float scale = 1.0f);
+uint32 GetNumTriangles(const MeshLoader& parsedMesh);
+
+// Create mesh shape (including BVH) from parsed mesh file
+// NOTE: BVH is built in parallel only when called from the main thread
+RT::MeshShapePtr BuildMesh(MeshLoader& parsedMesh);
 RT::MaterialPtr CreateDefaultMaterial(MaterialsMap& outMaterials);
 
 } // namespace helpers
@@ -20,8 +20,13 @@
 #include "Engine/Raytracer/Textures/NoiseTexture.h"
 #include "Engine/Raytracer/Textures/MixTexture.h"
 #include "Engine/Raytracer/Medium/Medium.h"
+#include "Engine/Raytracer/Utils/TextureCache.h"
 
 #include "Engine/Common/Logger/Logger.hpp"
+#include "Engine/Common/Containers/HashSet.hpp"
+#include "Engine/Common/System/Timer.hpp"
+#include "Engine/Common/Utils/TaskBuilder.hpp"
+#include "Engine/Common/Utils/Waitable.hpp"
 
 #include "rapidjson/document.h"
 #include "rapidjson/reader.h"
@@ -35,6 +40,36 @@ using namespace Math;
 using namespace Common;
 
 using TexturesMap = HashMap<String, TexturePtr>;
+using MeshesMap = HashMap<String, MeshShapePtr>;
+
+// meshes with more triangles are parsed in background, but created on the main thread, so the BVH is built in parallel
+static constexpr uint32 ParallelBvhBuildThreshold = 64 * 1024;
+
+// mesh file loaded in background, before the scene objects are created
+struct MeshLoadRequest
+{
+    String key;
+    String path;
+    float scale = 1.0f;
+    MeshShapePtr mesh;
+    ParsedMeshPtr parsedMesh;   // big mesh waiting to be built on the main thread
+    MaterialsMap materials;     // materials defined in the mesh file
+};
+
+// bitmaps and meshes referenced by the scene description
+// each asset is listed once, even if it's used by multiple textures, materials or objects
+struct SceneAssets
+{
+    DynArray<String> bitmapPaths;
+    HashSet<String> bitmapPathsSet;
+    DynArray<MeshLoadRequest> meshes;
+    HashSet<String> meshKeys;
+};
+
+static String GetMeshKey(const String& path, float scale)
+{
+    return String::Printf("%s@%f", path.Str(), scale);
+}
 
 static bool ParseVector2(const rapidjson::Value& value, Vec4f& outVector)
 {
@@ -233,7 +268,7 @@ static bool TryParseHdrColorRGB(const rapidjson::Value& value, const char* name,
     return ParseHdrColorRGB(value[name], outColor);
 }
 
-static bool TryParseTransform(const rapidjson::Value& parentValue, const char* name, Transform& outValue)
+static bool TryParseTransform(const rapidjson::Value& parentValue, const char* name, Transform& outValue, Vec4f* outScale = nullptr)
 {
     if (!parentValue.HasMember(name))
     {
@@ -257,11 +292,38 @@ static bool TryParseTransform(const rapidjson::Value& parentValue, const char* n
 
     orientation *= (NFE_MATH_PI / 180.0f);
 
+    if (outScale)
+    {
+        if (!TryParseVector3(value, "scale", true, *outScale))
+            return false;
+    }
+
     outValue = Transform(translation, Quaternion::FromEulerAngles(orientation.ToVec3f()));
 
     return true;
 }
 
+// parse object's transform and (optional) transform at the end of the frame
+static bool TryParseObjectTransform(const rapidjson::Value& value, ISceneObject& sceneObject)
+{
+    Transform transform;
+    Vec4f scale(1.0f);
+    if (!TryParseTransform(value, "transform", transform, &scale))
+        return false;
+    sceneObject.SetTransform(transform, scale);
+
+    if (value.HasMember("endTransform"))
+    {
+        Transform endTransform;
+        Vec4f endScale(1.0f);
+        if (!TryParseTransform(value, "endTransform", endTransform, &endScale))
+            return false;
+        sceneObject.SetEndTransform(endTransform, endScale);
+    }
+
+    return true;
+}
+
 static bool TryParseTextureName(const rapidjson::Value& value, const char* name, const TexturesMap& textures, TexturePtr& outValue)
 {
     if (!value.HasMember(name))
@@ -362,6 +424,25 @@ static TexturePtr ParseTexture(const rapidjson::Value& value, const TexturesMap&
             return nullptr;
         }
 
+        bool streamed = false;
+        if (!TryParseBool(value, "streamed", true, streamed))
+        {
+            return nullptr;
+        }
+
+        if (streamed)
+        {
+            // texels will be loaded on demand through the texture cache
+            const String fullPath = gOptions.dataPath.ToView() + path.ToView();
+            TiledBitmapPtr tiledBitmap = MakeSharedPtr<TiledBitmap>(fullPath.Str());
+            if (!tiledBitmap->Open(fullPath.Str()))
+            {
+                return nullptr;
+            }
+
+            return MakeSharedPtr<BitmapTexture>(tiledBitmap);
+        }
+
         BitmapPtr bitmap = LoadBitmapObject(gOptions.dataPath, path);
         if (!bitmap || bitmap->GetWidth() == 0 || bitmap->GetHeight() == 0)
         {
@@ -505,7 +586,7 @@ static MaterialPtr ParseMaterial(const rapidjson::Value& value, const TexturesMa
     return material;
 }
 
-static ShapePtr ParseShape(const rapidjson::Value& value, MaterialsMap& materials)
+static ShapePtr ParseShape(const rapidjson::Value& value, MaterialsMap& materials, const MeshesMap& meshes)
 {
     ShapePtr shape;
 
@@ -594,7 +675,17 @@ static ShapePtr ParseShape(const rapidjson::Value& value, MaterialsMap& material
         }
 
         const String path = gOptions.dataPath + value["path"].GetString();
-        shape = helpers::LoadMesh(path, materials, scale);
+
+        // meshes are usually loaded up front (see LoadScene)
+        const auto iter = meshes.Find(GetMeshKey(path, scale));
+        if (iter != meshes.End())
+        {
+            shape = iter->second;
+        }
+        else
+        {
+            shape = helpers::LoadMesh(path, materials, scale);
+        }
     }
     else
     {
@@ -604,7 +695,7 @@ static ShapePtr ParseShape(const rapidjson::Value& value, MaterialsMap& material
     return shape;
 }
 
-static bool ParseLight(const rapidjson::Value& value, Scene& scene, const TexturesMap& textures)
+static bool ParseLight(const rapidjson::Value& value, Scene& scene, const TexturesMap& textures, const MeshesMap& meshes)
 {
     if (!value.IsObject())
     {
@@ -637,7 +728,7 @@ static bool ParseLight(const rapidjson::Value& value, Scene& scene, const Textur
         }
 
         MaterialsMap materials;
-        ShapePtr shape = ParseShape(value["shape"], materials);
+        ShapePtr shape = ParseShape(value["shape"], materials, meshes);
         auto areaLight = MakeUniquePtr<AreaLight>(std::move(shape), lightColor);
 
         if (!TryParseTextureName(value, "texture", textures, areaLight->mTexture))
@@ -713,13 +804,9 @@ static bool ParseLight(const rapidjson::Value& value, Scene& scene, const Textur
 
     auto lightObject = MakeUniquePtr<LightSceneObject>(std::move(light));
 
+    if (!TryParseObjectTransform(value, *lightObject))
     {
-        Transform transform;
-        if (!TryParseTransform(value, "transform", transform))
-        {
-            return false;
-        }
-        lightObject->SetTransform(transform.ToMatrix());
+        return false;
     }
 
     scene.AddObject(std::move(lightObject));
@@ -727,7 +814,7 @@ static bool ParseLight(const rapidjson::Value& value, Scene& scene, const Textur
     return true;
 }
 
-static bool ParseObject(const rapidjson::Value& value, Scene& scene, MaterialsMap& materials)
+static bool ParseObject(const rapidjson::Value& value, Scene& scene, MaterialsMap& materials, const MeshesMap& meshes)
 {
     if (!value.IsObject())
     {
@@ -735,7 +822,7 @@ static bool ParseObject(const rapidjson::Value& value, Scene& scene, MaterialsMa
         return false;
     }
 
-    ShapePtr shape = ParseShape(value, materials);
+    ShapePtr shape = ParseShape(value, materials, meshes);
     if (!shape)
     {
         return false;
@@ -743,17 +830,13 @@ static bool ParseObject(const rapidjson::Value& value, Scene& scene, MaterialsMa
 
     ShapeSceneObjectPtr sceneObject = MakeUniquePtr<ShapeSceneObject>(std::move(shape));
 
-    // TODO velocity
-
     MaterialPtr material;
     if (!TryParseMaterialName(materials, value, "material", material))
         return false;
     sceneObject->BindMaterial(material);
 
-    Transform transform;
-    if (!TryParseTransform(value, "transform", transform))
+    if (!TryParseObjectTransform(value, *sceneObject))
         return false;
-    sceneObject->SetTransform(transform.ToMatrix());
 
     scene.AddObject(std::move(sceneObject));
     return true;
@@ -799,6 +882,151 @@ static bool ParseCamera(const rapidjson::Value& value, const TexturesMap& textur
     return true;
 }
 
+static void CollectBitmap(const rapidjson::Value& value, const char* name, const HashSet<String>& textureNames, SceneAssets& assets)
+{
+    if (!value.IsObject() || !value.HasMember(name) || !value[name].IsString())
+    {
+        return;
+    }
+
+    // texture references which are not texture names are bitmap paths (see TryParseTextureName)
+    const String path{ value[name].GetString() };
+    if (path.Empty() || textureNames.Exists(path) || assets.bitmapPathsSet.Exists(path))
+    {
+        return;
+    }
+
+    assets.bitmapPathsSet.Insert(path);
+    assets.bitmapPaths.PushBack(path);
+}
+
+static void CollectMesh(const rapidjson::Value& value, SceneAssets& assets)
+{
+    if (!value.IsObject() || !value.HasMember("type") || !value["type"].IsString() || !value.HasMember("path") || !value["path"].IsString())
+    {
+        return;
+    }
+
+    const String type{ value["type"].GetString() };
+    if (type != "mesh")
+    {
+        return;
+    }
+
+    float scale = 1.0f;
+    if (value.HasMember("scale") && value["scale"].IsDouble())
+    {
+        scale = static_cast<float>(value["scale"].GetDouble());
+    }
+
+    MeshLoadRequest request;
+    request.path = gOptions.dataPath + value["path"].GetString();
+    request.scale = scale;
+    request.key = GetMeshKey(request.path, scale);
+
+    if (!assets.meshKeys.Exists(request.key))
+    {
+        assets.meshKeys.Insert(request.key);
+        assets.meshes.PushBack(std::move(request));
+    }
+}
+
+// gather all the bitmaps and meshes used by the scene
+// NOTE: errors are not reported here, the description is validated when the scene is being built
+static void CollectSceneAssets(const rapidjson::Document& d, SceneAssets& assets)
+{
+    HashSet<String> textureNames;
+
+    if (d.HasMember("textures") && d["textures"].IsArray())
+    {
+        const rapidjson::Value& texturesArray = d["textures"];
+        for (rapidjson::SizeType i = 0; i < texturesArray.Size(); i++)
+        {
+            const rapidjson::Value& value = texturesArray[i];
+            if (value.IsObject() && value.HasMember("name") && value["name"].IsString())
+            {
+                textureNames.Insert(String(value["name"].GetString()));
+            }
+        }
+
+        for (rapidjson::SizeType i = 0; i < texturesArray.Size(); i++)
+        {
+            const rapidjson::Value& value = texturesArray[i];
+            if (!value.IsObject() || !value.HasMember("type") || !value["type"].IsString())
+            {
+                continue;
+            }
+
+            const String type{ value["type"].GetString() };
+            if (type == "bitmap")
+            {
+                // streamed bitmaps are loaded on demand
+                const bool streamed = value.HasMember("streamed") && value["streamed"].IsBool() && value["streamed"].GetBool();
+                if (!streamed)
+                {
+                    CollectBitmap(value, "path", HashSet<String>(), assets);
+                }
+            }
+            else if (type == "mix")
+            {
+                CollectBitmap(value, "textureA", textureNames, assets);
+                CollectBitmap(value, "textureB", textureNames, assets);
+                CollectBitmap(value, "weight", textureNames, assets);
+            }
+        }
+    }
+
+    if (d.HasMember("materials") && d["materials"].IsArray())
+    {
+        const rapidjson::Value& materialsArray = d["materials"];
+        for (rapidjson::SizeType i = 0; i < materialsArray.Size(); i++)
+        {
+            const rapidjson::Value& value = materialsArray[i];
+            CollectBitmap(value, "baseColorTexture", textureNames, assets);
+            CollectBitmap(value, "emissionTexture", textureNames, assets);
+            CollectBitmap(value, "roughnessTexture", textureNames, assets);
+            CollectBitmap(value, "metalnessTexture", textureNames, assets);
+            CollectBitmap(value, "normalMap", textureNames, assets);
+            CollectBitmap(value, "maskMap", textureNames, assets);
+        }
+    }
+
+    if (d.HasMember("objects") && d["objects"].IsArray())
+    {
+        const rapidjson::Value& objectsArray = d["objects"];
+        for (rapidjson::SizeType i = 0; i < objectsArray.Size(); i++)
+        {
+            CollectMesh(objectsArray[i], assets);
+        }
+    }
+
+    if (d.HasMember("lights") && d["lights"].IsArray())
+    {
+        const rapidjson::Value& lightsArray = d["lights"];
+        for (rapidjson::SizeType i = 0; i < lightsArray.Size(); i++)
+        {
+            const rapidjson::Value& value = lightsArray[i];
+            CollectBitmap(value, "texture", textureNames, assets);
+            if (value.IsObject() && value.HasMember("shape"))
+            {
+                CollectMesh(value["shape"], assets);
+            }
+        }
+    }
+
+    if (d.HasMember("camera"))
+    {
+        CollectBitmap(d["camera"], "bokehTexture", textureNames, assets);
+    }
+}
+
+// loading options baked into the scene archive, the archive is recreated when they change
+static String GetSceneArchiveOptions()
+{
+    return String::Printf("compressTextures=%d compressMeshes=%d optimizeBvh=%d",
+        gOptions.compressTextures ? 1 : 0, gOptions.compressMeshes ? 1 : 0, gOptions.optimizeBvh ? 1 : 0);
+}
+
 bool LoadScene(const String& path, Scene& scene, RT::Camera& camera)
 {
     FILE* fp = fopen(path.Str(), "rb");
@@ -820,8 +1048,60 @@ bool LoadScene(const String& path, Scene& scene, RT::Camera& camera)
         return false;
     }
 
+    // scene objects are loaded from the binary archive (if present), only camera setup is read from the description
+    const String archivePath = path + ".rtarchive";
+    const String archiveOptions = GetSceneArchiveOptions();
+    if (Scene::IsArchiveUpToDate(archivePath, archiveOptions))
+    {
+        Bitmap::LoadParams loadParams;
+        loadParams.blockCompress = gOptions.compressTextures;
+
+        if (scene.LoadArchive(archivePath, loadParams))
+        {
+            if (d.HasMember("camera"))
+            {
+                return ParseCamera(d["camera"], TexturesMap(), camera);
+            }
+            return true;
+        }
+
+        NFE_LOG_WARNING("Failed to load scene archive '%s', falling back to scene description", archivePath.Str());
+    }
+
+    Timer timer;
+
+    SceneAssets assets;
+    CollectSceneAssets(d, assets);
+
+    // Bitmaps and meshes (including mesh BVHs) are loaded in parallel, in background of textures and materials parsing.
+    // Bitmaps that are not loaded yet when needed are waited for in LoadBitmapObject.
+    // NOTE: the waitable is declared after the assets, so on early return it's destroyed (waited for) first
+    Waitable assetsWaitable;
+    {
+        TaskBuilder taskBuilder(assetsWaitable);
+
+        taskBuilder.ParallelFor("LoadScene/Bitmaps", assets.bitmapPaths.Size(), [&assets](const TaskContext&, uint32 index)
+        {
+            LoadBitmapObject(gOptions.dataPath, assets.bitmapPaths[index]);
+        });
+
+        taskBuilder.ParallelFor("LoadScene/Meshes", assets.meshes.Size(), [&assets](const TaskContext&, uint32 index)
+        {
+            MeshLoadRequest& request = assets.meshes[index];
+            request.parsedMesh = ParseMesh(request.path, request.materials, request.scale);
+
+            // BVH built on a worker thread is single-threaded, which is fine for small meshes only
+            if (request.parsedMesh && GetNumTriangles(*request.parsedMesh) < ParallelBvhBuildThreshold)
+            {
+                request.mesh = BuildMesh(*request.parsedMesh);
+                request.parsedMesh.Reset();
+            }
+        });
+    }
+
     MaterialsMap materialsMap;
     TexturesMap texturesMap;
+    MeshesMap meshesMap;
 
     if (d.HasMember("textures"))
     {
@@ -880,6 +1160,29 @@ bool LoadScene(const String& path, Scene& scene, RT::Camera& camera)
         }
     }
 
+    assetsWaitable.Wait();
+
+    for (MeshLoadRequest& request : assets.meshes)
+    {
+        if (request.parsedMesh)
+        {
+            request.mesh = BuildMesh(*request.parsedMesh);
+            request.parsedMesh.Reset();
+        }
+    }
+
+    NFE_LOG_INFO("Scene assets loaded in %.3f seconds (%u bitmaps, %u meshes)", timer.Stop(), assets.bitmapPaths.Size(), assets.meshes.Size());
+
+    for (const MeshLoadRequest& request : assets.meshes)
+    {
+        for (const auto& iter : request.materials)
+        {
+            materialsMap.Insert(iter.first, iter.second);
+        }
+
+        meshesMap.Insert(request.key, request.mesh);
+    }
+
     if (d.HasMember("objects"))
     {
         const rapidjson::Value& objectsArray = d["objects"];
@@ -887,7 +1190,7 @@ bool LoadScene(const String& path, Scene& scene, RT::Camera& camera)
         {
             for (rapidjson::SizeType i = 0; i < objectsArray.Size(); i++)
             {
-                if (!ParseObject(objectsArray[i], scene, materialsMap))
+                if (!ParseObject(objectsArray[i], scene, materialsMap, meshesMap))
                     return false;
             }
         }
@@ -905,7 +1208,7 @@ bool LoadScene(const String& path, Scene& scene, RT::Camera& camera)
         {
             for (rapidjson::SizeType i = 0; i < lightsArray.Size(); i++)
             {
-                if (!ParseLight(lightsArray[i], scene, texturesMap))
+                if (!ParseLight(lightsArray[i], scene, texturesMap, meshesMap))
                     return false;
             }
         }
@@ -925,6 +1228,21 @@ bool LoadScene(const String& path, Scene& scene, RT::Camera& camera)
         }
     }
 
+    // NOTE: bitmaps are not listed, as they are not stored in the archive
+    SceneArchiveSources archiveSources;
+    archiveSources.options = archiveOptions;
+    archiveSources.files.PushBack(path);
+    for (const MeshLoadRequest& request : assets.meshes)
+    {
+        archiveSources.files.PushBack(request.path);
+    }
+
+    // failure is not fatal, the scene will be loaded from the description again next time
+    if (!scene.SaveArchive(archivePath, archiveSources))
+    {
+        NFE_LOG_WARNING("Failed to save scene archive '%s'", archivePath.Str());
+    }
+
     return true;
 }
 
@@ -0,0 +1,153 @@
+#include "PCH.h"
+#include "TileFarmMode.h"
+#include "Demo.h"
+#include "SceneLoader.h"
+
+#include "Engine/Raytracer/Rendering/TileFarm.h"
+#include "Engine/Raytracer/Renderers/Renderer.h"
+#include "Engine/Raytracer/Textures/Texture.h"
+
+#include "Engine/Common/System/Socket.hpp"
+#include "Engine/Common/System/Thread.hpp"
+#include "Engine/Common/Logger/Logger.hpp"
+#include "Engine/Common/Utils/Stream/SocketInputStream.hpp"
+#include "Engine/Common/Utils/Stream/SocketOutputStream.hpp"
+
+namespace NFE {
+namespace helpers {
+
+using namespace RT;
+using namespace Math;
+using namespace Common;
+
+extern bool LoadCustomScene(Scene& scene, Camera& camera);
+
+bool RunTileFarmCoordinator()
+{
+    // coordinator only merges the samples, no scene is needed
+    UniquePtr<Viewport> viewport = MakeUniquePtr<Viewport>();
+    if (!viewport->Resize(gOptions.windowWidth, gOptions.windowHeight))
+    {
+        return false;
+    }
+
+    TileFarmCoordinator::Settings settings;
+    settings.totalPasses = gOptions.tileFarmPasses;
+
+    TileFarmCoordinator coordinator;
+    if (!coordinator.Init(*viewport, settings))
+    {
+        return false;
+    }
+
+    Socket listener;
+    if (!listener.Listen(static_cast<uint16>(gOptions.tileFarmPort)))
+    {
+        return false;
+    }
+
+    NFE_LOG_INFO("TileFarm: Waiting for %u workers on port %u...", gOptions.tileFarmWorkers, gOptions.tileFarmPort);
+
+    // each worker connection is served on a separate thread
+    DynArray<Socket> connections;
+    DynArray<Thread> threads;
+    connections.Resize(gOptions.tileFarmWorkers);
+    threads.Resize(gOptions.tileFarmWorkers);
+
+    for (uint32 i = 0; i < gOptions.tileFarmWorkers; ++i)
+    {
+        if (!listener.Accept(connections[i]))
+        {
+            break;
+        }
+
+        NFE_LOG_INFO("TileFarm: Worker %u connected", i);
+
+        Socket& connection = connections[i];
+        threads[i].Run([&coordinator, &connection]()
+        {
+            SocketInputStream input(connection);
+            SocketOutputStream output(connection);
+            coordinator.ServeWorker(input, output);
+            connection.Close();
+        });
+    }
+
+    for (Thread& thread : threads)
+    {
+        thread.Wait();
+    }
+
+    if (!coordinator.IsFinished())
+    {
+        NFE_LOG_ERROR("TileFarm: Only %u out of %u jobs were rendered", coordinator.GetNumMergedJobs(), coordinator.GetNumJobs());
+        return false;
+    }
+
+    coordinator.PostProcess();
+
+    if (!viewport->GetFrontBuffer().SaveBMP(gOptions.tileFarmOutput.Str(), true))
+    {
+        return false;
+    }
+
+    NFE_LOG_INFO("TileFarm: Image saved to '%s'", gOptions.tileFarmOutput.Str());
+    return true;
+}
+
+bool RunTileFarmWorker()
+{
+    Scene scene;
+    Camera camera;
+    camera.mDOF.aperture = 0.0f;
+
+    if (gOptions.sceneName.Empty())
+    {
+        LoadCustomScene(scene, camera);
+    }
+    else if (!LoadScene(gOptions.sceneName, scene, camera))
+    {
+        return false;
+    }
+
+    if (!scene.BuildBVH())
+    {
+        return false;
+    }
+
+    const float aspectRatio = static_cast<float>(gOptions.windowWidth) / static_cast<float>(gOptions.windowHeight);
+    camera.SetPerspective(aspectRatio, camera.mFieldOfView);
+
+    const RendererPtr renderer = CreateRenderer(gOptions.rendererName, scene);
+    if (!renderer)
+    {
+        return false;
+    }
+
+    RenderingParams params;
+    params.traversalMode = gOptions.enablePacketTracing ? TraversalMode::Packet : TraversalMode::Single;
+    params.numPreviewPasses = 0; // nothing to preview without a window
+
+    UniquePtr<Viewport> viewport = MakeUniquePtr<Viewport>();
+    if (!viewport->SetRenderingParams(params) ||
+        !viewport->SetRenderer(renderer.Get()) ||
+        !viewport->Resize(gOptions.windowWidth, gOptions.windowHeight))
+    {
+        return false;
+    }
+
+    Socket connection;
+    if (!connection.Connect(gOptions.tileFarmWorkerHost, static_cast<uint16>(gOptions.tileFarmPort)))
+    {
+        return false;
+    }
+
+    NFE_LOG_INFO("TileFarm: Connected to coordinator %s:%u", gOptions.tileFarmWorkerHost.Str(), gOptions.tileFarmPort);
+
+    SocketInputStream input(connection);
+    SocketOutputStream output(connection);
+    return TileFarmWorker::Run(*viewport, scene, camera, input, output);
+}
+
+} // namespace helpers
+} // namespace NFE
@@ -0,0 +1,16 @@
+#pragma once
+
+namespace NFE {
+namespace helpers {
+
+// Headless multi-process rendering (see RT::TileFarmCoordinator).
+// Coordinator and workers must be started with the same scene, resolution and renderer options.
+
+// wait for workers, distribute the rendering jobs and save the merged image
+bool RunTileFarmCoordinator();
+
+// connect to a coordinator and render the jobs it sends
+bool RunTileFarmWorker();
+
+} // namespace helpers
+} // namespace NFE
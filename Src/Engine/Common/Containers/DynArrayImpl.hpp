@@ -552,8 +552,8 @@ bool DynArray<ElementType>::Resize_SkipConstructor(uint32 size)
 template<typename ElementType>
 void DynArray<ElementType>::Swap(DynArray& other)
 {
-    std::swap(this->mElements, other->mElements);
-    std::swap(this->mSize, other->mSize);
+    std::swap(this->mElements, other.mElements);
+    std::swap(this->mSize, other.mSize);
     std::swap(mAllocSize, other.mAllocSize);
 }
 
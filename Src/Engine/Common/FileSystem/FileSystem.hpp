@@ -68,6 +68,12 @@ public:
      */
     static PathType GetPathType(const StringView& path);
 
+    /**
+     * Get time of the last modification of a file.
+     * @note The time is platform-specific, it's only meaningful when compared with other modification times.
+     */
+    static bool GetModificationTime(const StringView& path, uint64& outTime);
+
     /**
      * Create a directory.
      */
@@ -145,6 +145,20 @@ PathType FileSystem::GetPathType(const StringView& path)
     return PathType::Invalid;
 }
 
+bool FileSystem::GetModificationTime(const StringView& path, uint64& outTime)
+{
+    const StringViewToCStringHelper pathString(path);
+
+    struct stat stat;
+    if (::stat(pathString, &stat) != 0)
+    {
+        return false;
+    }
+
+    outTime = static_cast<uint64>(stat.st_mtim.tv_sec) * 1000000000ull + static_cast<uint64>(stat.st_mtim.tv_nsec);
+    return true;
+}
+
 bool FileSystem::CreateDir(const StringView& path)
 {
     const StringViewToCStringHelper pathString(path);
@@ -0,0 +1,126 @@
+/**
+ * @file
+ * @brief  Linux implementation of MemoryMappedFile class.
+ */
+
+#include "PCH.hpp"
+#include "../MemoryMappedFile.hpp"
+#include "Logger/Logger.hpp"
+#include "Containers/String.hpp"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace NFE {
+namespace Common {
+
+#define INVALID_FD -1
+
+MemoryMappedFile::MemoryMappedFile()
+    : mFD(INVALID_FD)
+    , mData(nullptr)
+    , mSize(0)
+{
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    Close();
+}
+
+bool MemoryMappedFile::Open(const StringView& path, size_t size)
+{
+    Close();
+
+    const StringViewToCStringHelper pathString(path);
+    mFD = ::open(pathString, O_RDWR | O_CREAT, 0644);
+    if (mFD == INVALID_FD)
+    {
+        NFE_LOG_ERROR("Failed to open file '%s': %s", pathString.Str(), strerror(errno));
+        return false;
+    }
+
+    struct stat fileStat;
+    if (::fstat(mFD, &fileStat) != 0)
+    {
+        NFE_LOG_ERROR("Failed to get size of file '%s': %s", pathString.Str(), strerror(errno));
+        Close();
+        return false;
+    }
+
+    if (size == 0)
+    {
+        size = static_cast<size_t>(fileStat.st_size);
+    }
+    else if (static_cast<size_t>(fileStat.st_size) != size)
+    {
+        if (::ftruncate(mFD, static_cast<off_t>(size)) != 0)
+        {
+            NFE_LOG_ERROR("Failed to resize file '%s': %s", pathString.Str(), strerror(errno));
+            Close();
+            return false;
+        }
+    }
+
+    if (size == 0)
+    {
+        NFE_LOG_ERROR("Cannot map empty file '%s'", pathString.Str());
+        Close();
+        return false;
+    }
+
+    void* data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, mFD, 0);
+    if (data == MAP_FAILED)
+    {
+        NFE_LOG_ERROR("Failed to map file '%s': %s", pathString.Str(), strerror(errno));
+        Close();
+        return false;
+    }
+
+    mData = data;
+    mSize = size;
+    return true;
+}
+
+void MemoryMappedFile::Close()
+{
+    if (mData)
+    {
+        ::munmap(mData, mSize);
+        mData = nullptr;
+        mSize = 0;
+    }
+
+    if (mFD != INVALID_FD)
+    {
+        ::close(mFD);
+        mFD = INVALID_FD;
+    }
+}
+
+bool MemoryMappedFile::Flush(size_t offset, size_t size, bool wait)
+{
+    if (!mData || offset >= mSize)
+    {
+        return false;
+    }
+
+    size = std::min(size, mSize - offset);
+
+    // msync requires page-aligned address
+    const size_t pageSize = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    const size_t alignedOffset = offset - offset % pageSize;
+
+    if (::msync(static_cast<uint8*>(mData) + alignedOffset, size + (offset - alignedOffset), wait ? MS_SYNC : MS_ASYNC) != 0)
+    {
+        NFE_LOG_ERROR("Failed to flush mapped file: %s", strerror(errno));
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace Common
+} // namespace NFE
@@ -0,0 +1,75 @@
+/**
+ * @file
+ * @brief  MemoryMappedFile class declaration.
+ */
+
+#pragma once
+
+#include "../nfCommon.hpp"
+#include "../Containers/StringView.hpp"
+
+#if defined(WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#endif
+
+namespace NFE {
+namespace Common {
+
+/**
+ * Read-write file mapped into process memory.
+ * Modifications of the mapped memory are written back to the file by the OS, even if the process gets killed.
+ */
+class NFCOMMON_API MemoryMappedFile final
+{
+    NFE_MAKE_NONCOPYABLE(MemoryMappedFile)
+    NFE_MAKE_NONMOVEABLE(MemoryMappedFile)
+
+public:
+    MemoryMappedFile();
+    ~MemoryMappedFile();
+
+    /**
+     * Open (or create) a file and map it into memory.
+     * @param path  File path.
+     * @param size  Required file size in bytes. The file is resized if needed.
+     *              If zero, the whole existing file is mapped.
+     */
+    bool Open(const StringView& path, size_t size = 0);
+
+    /**
+     * Unmap and close the file.
+     */
+    void Close();
+
+    /**
+     * Write modified pages in the given range back to the disk.
+     * @param offset,size   Range to be flushed (will be extended to page boundaries).
+     * @param wait          If true, the function waits until the data is written (survives OS crash).
+     *                      Otherwise the write is only scheduled.
+     */
+    bool Flush(size_t offset, size_t size, bool wait = true);
+
+    NFE_FORCE_INLINE bool Flush(bool wait = true) { return Flush(0, mSize, wait); }
+
+    NFE_FORCE_INLINE bool IsOpened() const { return mData != nullptr; }
+    NFE_FORCE_INLINE void* GetData() const { return mData; }
+    NFE_FORCE_INLINE size_t GetSize() const { return mSize; }
+
+private:
+#if defined(WIN32)
+    HANDLE mFile;
+    HANDLE mMapping;
+#elif defined(__LINUX__) | defined(__linux__)
+    int mFD;
+#else
+#error "Target system not supported!"
+#endif
+
+    void* mData;
+    size_t mSize;
+};
+
+} // namespace Common
+} // namespace NFE
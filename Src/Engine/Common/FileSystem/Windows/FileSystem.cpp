@@ -210,6 +210,20 @@ PathType FileSystem::GetPathType(const StringView& path)
     return PathType::File;
 }
 
+bool FileSystem::GetModificationTime(const StringView& path, uint64& outTime)
+{
+    Utf16String widePath;
+    if (!UTF8ToUTF16(path, widePath))
+        return false;
+
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    if (::GetFileAttributesEx(widePath.c_str(), GetFileExInfoStandard, &attributes) == 0)
+        return false;
+
+    outTime = (static_cast<uint64>(attributes.ftLastWriteTime.dwHighDateTime) << 32) | attributes.ftLastWriteTime.dwLowDateTime;
+    return true;
+}
+
 bool FileSystem::CreateDir(const StringView& path)
 {
     Utf16String widePath;
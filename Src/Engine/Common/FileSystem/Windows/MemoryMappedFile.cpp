@@ -0,0 +1,152 @@
+/**
+ * @file
+ * @brief  Windows implementation of MemoryMappedFile class.
+ */
+
+#include "PCH.hpp"
+#include "../MemoryMappedFile.hpp"
+#include "Logger/Logger.hpp"
+#include "Containers/String.hpp"
+#include "System/Windows/Common.hpp"
+
+
+namespace NFE {
+namespace Common {
+
+MemoryMappedFile::MemoryMappedFile()
+    : mFile(INVALID_HANDLE_VALUE)
+    , mMapping(NULL)
+    , mData(nullptr)
+    , mSize(0)
+{
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    Close();
+}
+
+bool MemoryMappedFile::Open(const StringView& path, size_t size)
+{
+    Close();
+
+    const StringViewToCStringHelper pathString(path);
+
+    Utf16String widePath;
+    if (!UTF8ToUTF16(path, widePath))
+    {
+        return false;
+    }
+
+    mFile = ::CreateFile(widePath.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL,
+                         OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (mFile == INVALID_HANDLE_VALUE)
+    {
+        NFE_LOG_ERROR("Failed to open file '%s': %s", pathString.Str(), GetLastErrorString().Str());
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!::GetFileSizeEx(mFile, &fileSize))
+    {
+        NFE_LOG_ERROR("Failed to get size of file '%s': %s", pathString.Str(), GetLastErrorString().Str());
+        Close();
+        return false;
+    }
+
+    if (size == 0)
+    {
+        size = static_cast<size_t>(fileSize.QuadPart);
+    }
+
+    if (size == 0)
+    {
+        NFE_LOG_ERROR("Cannot map empty file '%s'", pathString.Str());
+        Close();
+        return false;
+    }
+
+    // NOTE: mapping object extends the file if needed, but never shrinks it
+    if (static_cast<size_t>(fileSize.QuadPart) > size)
+    {
+        LARGE_INTEGER newSize;
+        newSize.QuadPart = static_cast<LONGLONG>(size);
+        if (!::SetFilePointerEx(mFile, newSize, NULL, FILE_BEGIN) || !::SetEndOfFile(mFile))
+        {
+            NFE_LOG_ERROR("Failed to resize file '%s': %s", pathString.Str(), GetLastErrorString().Str());
+            Close();
+            return false;
+        }
+    }
+
+    const uint64 mappingSize = static_cast<uint64>(size);
+    mMapping = ::CreateFileMapping(mFile, NULL, PAGE_READWRITE,
+                                   static_cast<DWORD>(mappingSize >> 32), static_cast<DWORD>(mappingSize & 0xFFFFFFFF), NULL);
+    if (mMapping == NULL)
+    {
+        NFE_LOG_ERROR("Failed to create mapping of file '%s': %s", pathString.Str(), GetLastErrorString().Str());
+        Close();
+        return false;
+    }
+
+    mData = ::MapViewOfFile(mMapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (mData == nullptr)
+    {
+        NFE_LOG_ERROR("Failed to map file '%s': %s", pathString.Str(), GetLastErrorString().Str());
+        Close();
+        return false;
+    }
+
+    mSize = size;
+    return true;
+}
+
+void MemoryMappedFile::Close()
+{
+    if (mData)
+    {
+        ::UnmapViewOfFile(mData);
+        mData = nullptr;
+        mSize = 0;
+    }
+
+    if (mMapping != NULL)
+    {
+        ::CloseHandle(mMapping);
+        mMapping = NULL;
+    }
+
+    if (mFile != INVALID_HANDLE_VALUE)
+    {
+        ::CloseHandle(mFile);
+        mFile = INVALID_HANDLE_VALUE;
+    }
+}
+
+bool MemoryMappedFile::Flush(size_t offset, size_t size, bool wait)
+{
+    if (!mData || offset >= mSize)
+    {
+        return false;
+    }
+
+    size = std::min(size, mSize - offset);
+
+    if (!::FlushViewOfFile(static_cast<uint8*>(mData) + offset, size))
+    {
+        NFE_LOG_ERROR("Failed to flush mapped file: %s", GetLastErrorString().Str());
+        return false;
+    }
+
+    // FlushViewOfFile only schedules the write of the pages
+    if (wait && !::FlushFileBuffers(mFile))
+    {
+        NFE_LOG_ERROR("Failed to flush file buffers: %s", GetLastErrorString().Str());
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace Common
+} // namespace NFE
@@ -137,6 +137,7 @@ template<typename T> class SimdTriangle;
 template<typename T> class SimdRay;
 template<typename T> class SimdBox;
 class Distribution;
+class Distribution2D;
 union Half;
 struct Half2;
 struct Half3;
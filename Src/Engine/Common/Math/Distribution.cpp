@@ -3,6 +3,7 @@
 #include "Math.hpp"
 #include "Memory/DefaultAllocator.hpp"
 #include "Logger/Logger.hpp"
+#include "Containers/DynArray.hpp"
 
 
 namespace NFE {
@@ -11,14 +12,17 @@ namespace Math {
 Distribution::Distribution()
     : mPDF(nullptr)
     , mCDF(nullptr)
+    , mAliasTable(nullptr)
     , mSize(0)
 {}
 
 Distribution::~Distribution()
 {
+    NFE_FREE(mAliasTable);
     NFE_FREE(mCDF);
     NFE_FREE(mPDF);
 
+    mAliasTable = nullptr;
     mCDF = nullptr;
     mPDF = nullptr;
 }
@@ -57,6 +61,13 @@ bool Distribution::Initialize(const float* pdfValues, uint32 numValues)
         return false;
     }
 
+    mAliasTable = (AliasEntry*)NFE_MALLOC(sizeof(AliasEntry) * (size_t)numValues, NFE_CACHE_LINE_SIZE);
+    if (!mAliasTable)
+    {
+        NFE_LOG_ERROR("Failed to allocate memory for alias table");
+        return false;
+    }
+
     // compute cumulated distribution function
     double accumulated = 0.0;
     mCDF[0] = 0.0f;
@@ -83,10 +94,71 @@ bool Distribution::Initialize(const float* pdfValues, uint32 numValues)
 
     // TODO Cumulative distribution function should be stored as unsigned integers, as it's only in 0-1 range
 
+    BuildAliasTable(mPDF, numValues, mAliasTable);
+
     mSize = numValues;
     return true;
 }
 
+void Distribution::BuildAliasTable(const float* normalizedPdf, uint32 numValues, AliasEntry* outTable)
+{
+    // Vose's algorithm
+    // each bucket with probability below average is paired with a bucket with probability above average,
+    // which donates the missing part
+
+    Common::DynArray<double> scaledPdf;
+    scaledPdf.Resize(numValues);
+
+    Common::DynArray<uint32> small;
+    Common::DynArray<uint32> large;
+    small.Reserve(numValues);
+    large.Reserve(numValues);
+
+    for (uint32 i = 0; i < numValues; ++i)
+    {
+        scaledPdf[i] = normalizedPdf[i];
+
+        outTable[i].threshold = 1.0f;
+        outTable[i].alias = i;
+        outTable[i].pdf = normalizedPdf[i];
+        outTable[i].aliasPdf = normalizedPdf[i];
+
+        if (scaledPdf[i] < 1.0)
+        {
+            small.PushBack(i);
+        }
+        else
+        {
+            large.PushBack(i);
+        }
+    }
+
+    while (!small.Empty() && !large.Empty())
+    {
+        const uint32 smallIndex = small.Back();
+        const uint32 largeIndex = large.Back();
+        small.PopBack();
+        large.PopBack();
+
+        outTable[smallIndex].threshold = static_cast<float>(scaledPdf[smallIndex]);
+        outTable[smallIndex].alias = largeIndex;
+        outTable[smallIndex].aliasPdf = normalizedPdf[largeIndex];
+
+        scaledPdf[largeIndex] = (scaledPdf[largeIndex] + scaledPdf[smallIndex]) - 1.0;
+
+        if (scaledPdf[largeIndex] < 1.0)
+        {
+            small.PushBack(largeIndex);
+        }
+        else
+        {
+            large.PushBack(largeIndex);
+        }
+    }
+
+    // remaining buckets are (up to rounding errors) full, so they keep threshold equal to one
+}
+
 uint32 Distribution::SampleDiscrete(const float u, float& outPdf) const
 {
     uint32 low = 0u;
@@ -114,5 +186,95 @@ uint32 Distribution::SampleDiscrete(const float u, float& outPdf) const
     return offset;
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+Distribution2D::Distribution2D()
+    : mConditionals(nullptr)
+    , mWidth(0)
+    , mHeight(0)
+{}
+
+Distribution2D::~Distribution2D()
+{
+    Release();
+}
+
+void Distribution2D::Release()
+{
+    NFE_FREE(mConditionals);
+    mConditionals = nullptr;
+    mWidth = 0;
+    mHeight = 0;
+}
+
+bool Distribution2D::Initialize(const float* pdfValues, uint32 width, uint32 height)
+{
+    Release();
+
+    if (width == 0 || height == 0)
+    {
+        NFE_LOG_ERROR("Empty distribution");
+        return false;
+    }
+
+    if (!pdfValues)
+    {
+        NFE_LOG_ERROR("Invalid distribution pdf");
+        return false;
+    }
+
+    mConditionals = (Distribution::AliasEntry*)NFE_MALLOC(sizeof(Distribution::AliasEntry) * (size_t)width * (size_t)height, NFE_CACHE_LINE_SIZE);
+    if (!mConditionals)
+    {
+        NFE_LOG_ERROR("Failed to allocate memory for conditional distributions");
+        return false;
+    }
+
+    Common::DynArray<float> rowPdf;
+    Common::DynArray<float> marginalPdf;
+    rowPdf.Resize(width);
+    marginalPdf.Resize(height);
+
+    for (uint32 y = 0; y < height; ++y)
+    {
+        const float* rowValues = pdfValues + (size_t)width * (size_t)y;
+
+        double rowSum = 0.0;
+        for (uint32 x = 0; x < width; ++x)
+        {
+            NFE_ASSERT(IsValid(rowValues[x]), "Corrupted pdf");
+            NFE_ASSERT(rowValues[x] >= 0.0f, "Pdf must be non-negative. Value (%u,%u) is %f", x, y, rowValues[x]);
+            rowSum += rowValues[x];
+        }
+
+        marginalPdf[y] = static_cast<float>(rowSum);
+
+        // rows with zero probability are never sampled, but they need valid (uniform) alias table anyway
+        const float normFactor = rowSum > 0.0 ? static_cast<float>((double)width / rowSum) : 0.0f;
+        for (uint32 x = 0; x < width; ++x)
+        {
+            rowPdf[x] = rowSum > 0.0 ? rowValues[x] * normFactor : 1.0f;
+        }
+
+        Distribution::BuildAliasTable(rowPdf.Data(), width, mConditionals + (size_t)width * (size_t)y);
+    }
+
+    if (!mMarginal.Initialize(marginalPdf.Data(), height))
+    {
+        Release();
+        return false;
+    }
+
+    mWidth = width;
+    mHeight = height;
+    return true;
+}
+
+float Distribution2D::Pdf(uint32 x, uint32 y) const
+{
+    NFE_ASSERT(x < mWidth && y < mHeight, "Index out of bounds");
+    return mMarginal.Pdf(y) * mConditionals[mWidth * y + x].pdf;
+}
+
 } // namespace Math
 } // namespace NFE
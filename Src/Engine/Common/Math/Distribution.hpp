@@ -1,6 +1,8 @@
 #pragma once
 
 #include "../nfCommon.hpp"
+#include "Math.hpp"
+#include "Vec2f.hpp"
 
 namespace NFE {
 namespace Math {
@@ -13,23 +15,114 @@ class NFCOMMON_API Distribution
     NFE_MAKE_NONMOVEABLE(Distribution)
 
 public:
+    // alias method (Walker/Vose) table entry
+    struct AliasEntry
+    {
+        float threshold;    // probability of keeping the bucket's own value
+        uint32 alias;       // value used otherwise
+        float pdf;          // PDF of the bucket's own value
+        float aliasPdf;     // PDF of the alias value
+    };
+
     Distribution();
     ~Distribution();
 
     // initialize with 1D pdf function
+    // NOTE: both CDF and alias table are built
     bool Initialize(const float* pdfValues, uint32 numValues);
 
-    // sample discrete
+    NFE_FORCE_INLINE uint32 GetSize() const { return mSize; }
+
+    // sample discrete (binary search in CDF)
     uint32 SampleDiscrete(const float u, float& outPdf) const;
 
+    // sample discrete in constant time (alias method)
+    // optionally returns remapped uniform variable that can be reused for further sampling
+    NFE_FORCE_INLINE uint32 SampleDiscreteAlias(const float u, float& outPdf, float* outRemappedU = nullptr) const
+    {
+        return SampleAliasTable(mAliasTable, mSize, u, outPdf, outRemappedU);
+    }
+
     // get PDF of given value
     float Pdf(uint32 valueIndex) const;
 
+    // build alias table for normalized PDF (average value equal to one)
+    static void BuildAliasTable(const float* normalizedPdf, uint32 numValues, AliasEntry* outTable);
+
+    NFE_FORCE_INLINE static uint32 SampleAliasTable(const AliasEntry* table, uint32 numValues, const float u, float& outPdf, float* outRemappedU)
+    {
+        NFE_ASSERT(u >= 0.0f && u < 1.0f, "Invalid random variable: %f", u);
+
+        const float scaledU = u * static_cast<float>(numValues);
+        const uint32 index = Min(static_cast<uint32>(scaledU), numValues - 1u);
+        const float fraction = scaledU - static_cast<float>(index);
+
+        const AliasEntry& entry = table[index];
+
+        if (fraction < entry.threshold)
+        {
+            outPdf = entry.pdf;
+            if (outRemappedU)
+            {
+                *outRemappedU = Min(0.999999940395f, fraction / entry.threshold);
+            }
+            return index;
+        }
+
+        outPdf = entry.aliasPdf;
+        if (outRemappedU)
+        {
+            *outRemappedU = Min(0.999999940395f, (fraction - entry.threshold) / (1.0f - entry.threshold));
+        }
+        return entry.alias;
+    }
+
 private:
     float* mPDF;
     float* mCDF; // Cumulative distribution function
+    AliasEntry* mAliasTable;
     uint32 mSize;
 };
 
+// Utility class for fast sampling 2D probability distribution function (e.g. image importance map)
+// Rows are selected with marginal distribution and then a column with per-row conditional distribution.
+// Sampling is performed in constant time (alias method).
+class NFCOMMON_API Distribution2D
+{
+    NFE_MAKE_NONCOPYABLE(Distribution2D)
+    NFE_MAKE_NONMOVEABLE(Distribution2D)
+
+public:
+    Distribution2D();
+    ~Distribution2D();
+
+    // initialize with 2D pdf function (row-major order)
+    bool Initialize(const float* pdfValues, uint32 width, uint32 height);
+
+    NFE_FORCE_INLINE uint32 GetWidth() const { return mWidth; }
+    NFE_FORCE_INLINE uint32 GetHeight() const { return mHeight; }
+
+    // sample discrete
+    // optionally returns remapped uniform variables that can be reused for further sampling
+    NFE_FORCE_INLINE void SampleDiscrete(const Vec2f& u, uint32& outX, uint32& outY, float& outPdf, Vec2f* outRemappedU = nullptr) const
+    {
+        float rowPdf, columnPdf;
+        outY = mMarginal.SampleDiscreteAlias(u.x, rowPdf, outRemappedU ? &outRemappedU->y : nullptr);
+        outX = Distribution::SampleAliasTable(mConditionals + mWidth * outY, mWidth, u.y, columnPdf, outRemappedU ? &outRemappedU->x : nullptr);
+        outPdf = rowPdf * columnPdf;
+    }
+
+    // get PDF of given value
+    float Pdf(uint32 x, uint32 y) const;
+
+private:
+    void Release();
+
+    Distribution mMarginal;
+    Distribution::AliasEntry* mConditionals; // per-row alias tables
+    uint32 mWidth;
+    uint32 mHeight;
+};
+
 } // namespace Math
 } // namespace NFE
@@ -34,7 +34,7 @@ NFE_FORCE_INLINE const Vec4f Vec4f_Load_Half2(const Half2& src)
 #ifdef NFE_USE_FP16C
     uint32 value;
     memcpy(&value, &src, sizeof(Half2));
-    return _mm_cvtph_ps(_mm_set1_epi32(value));
+    return _mm_cvtph_ps(_mm_cvtsi32_si128(value));
 #else // NFE_USE_FP16C
     return Vec4f(src.x.ToFloat(), src.y.ToFloat(), 0.0f, 0.0f);
 #endif // NFE_USE_FP16C
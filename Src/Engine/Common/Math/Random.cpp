@@ -10,11 +10,25 @@ static NFE_FORCE_INLINE uint64 Rotl64(const uint64 x, const int k)
     return (x << k) | (x >> (64 - k));
 }
 
+static NFE_FORCE_INLINE uint64 SplitMix64(uint64& state)
+{
+    // http://xoshiro.di.unimi.it/splitmix64.c
+    uint64 z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
 Random::Random()
 {
     Reset();
 }
 
+Random::Random(uint64 seed)
+{
+    Reset(seed);
+}
+
 void Random::Reset()
 {
     Common::Entropy entropy;
@@ -29,6 +43,20 @@ void Random::Reset()
     }
 }
 
+void Random::Reset(uint64 seed)
+{
+    const auto getInt = [&seed]() { return static_cast<int32>(SplitMix64(seed)); };
+
+    for (uint32 i = 0; i < 2; ++i)
+    {
+        mSeed[i] = SplitMix64(seed);
+        mSeedSimd4[i] = Vec4i(getInt(), getInt(), getInt(), getInt());
+#ifdef NFE_USE_AVX2
+        mSeedSimd8[i] = Vec8i(getInt(), getInt(), getInt(), getInt(), getInt(), getInt(), getInt(), getInt());
+#endif // NFE_USE_AVX2
+    }
+}
+
 uint64 Random::GetLong()
 {
     // xoroshiro128+ algorithm
@@ -17,10 +17,14 @@ class NFE_ALIGN(32) NFCOMMON_API Random
 {
 public:
     Random();
+    explicit Random(uint64 seed);
 
     // initialize seeds with new values, very slow
     void Reset();
 
+    // initialize seeds deterministically from a single value
+    void Reset(uint64 seed);
+
     template<typename T>
     const T Get();
 
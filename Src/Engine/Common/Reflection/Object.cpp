@@ -22,4 +22,8 @@ bool IObject::OnPropertyChanged(const Common::StringView propertyName)
     return true;
 }
 
+void IObject::OnDeserialized()
+{
+}
+
 } // namespace NFE
@@ -22,6 +22,9 @@ public:
 
     // Called when a property gets changed (e.g. by the editor)
     virtual bool OnPropertyChanged(const Common::StringView propertyName);
+
+    // Called once after the object was deserialized (all the members are read), so derived state can be rebuilt
+    virtual void OnDeserialized();
 };
 
 using ObjectPtr = Common::SharedPtr<IObject>;
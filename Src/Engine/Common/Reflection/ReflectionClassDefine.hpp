@@ -73,6 +73,7 @@ NFE_FORCE_INLINE constexpr size_t OffsetOf(Member Class::*member)
         {                                                                                                       \
             typeInfo.isAbstract = std::is_abstract_v<T>;                                                        \
             typeInfo.name = #T;                                                                                 \
+            typeInfo.objectCast = [](void* object) -> NFE::IObject* { return static_cast<T*>(object); };        \
             T::_InitType(typeInfo);                                                                             \
         }                                                                                                       \
     } } /* namespace NFE::RTTI */                                                                               \
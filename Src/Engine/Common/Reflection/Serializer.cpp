@@ -20,7 +20,7 @@ bool Serialize(const ObjectPtr& rootObject, OutputStream& outputStream)
     return Serialize(rootObjects, outputStream);
 }
 
-bool Serialize(const ArrayView<const ObjectPtr> rootObjects, OutputStream& outputStream)
+bool Serialize(const ArrayView<const ObjectPtr> rootObjects, OutputStream& outputStream, DynArray<ObjectPtr>* outAllObjects)
 {
     NFE_ASSERT(!rootObjects.Empty(), "What's point in serializing zero objects?");
 
@@ -129,6 +129,18 @@ bool Serialize(const ArrayView<const ObjectPtr> rootObjects, OutputStream& outpu
                 return false;
             }
         }
+
+        if (outAllObjects)
+        {
+            outAllObjects->Clear();
+            for (const ObjectPtr& objectPtr : objectTable)
+            {
+                if (objectPtr)
+                {
+                    outAllObjects->PushBack(objectPtr);
+                }
+            }
+        }
     }
 
     // Write root object indices
@@ -152,7 +164,7 @@ bool Serialize(const ArrayView<const ObjectPtr> rootObjects, OutputStream& outpu
     return true;
 }
 
-bool Deserialize(DynArray<ObjectPtr>& outRootObjects, InputStream& inputStream)
+bool Deserialize(DynArray<ObjectPtr>& outRootObjects, InputStream& inputStream, DynArray<ObjectPtr>* outAllObjects)
 {
     TypeRegistry& typeRegistry = TypeRegistry::GetInstance();
 
@@ -210,6 +222,11 @@ bool Deserialize(DynArray<ObjectPtr>& outRootObjects, InputStream& inputStream)
         }
     }
 
+    if (outAllObjects)
+    {
+        outAllObjects->Clear();
+    }
+
     // deserialize objects
     {
         serializationContext.InitStage(SerializationContext::Stage::Deserialization);
@@ -274,6 +291,11 @@ bool Deserialize(DynArray<ObjectPtr>& outRootObjects, InputStream& inputStream)
                 NFE_LOG_ERROR("Deserialize: Failed to deserialize object %u", objIndex);
                 return false;
             }
+
+            if (outAllObjects)
+            {
+                outAllObjects->PushBack(outObject);
+            }
         }
     }
 
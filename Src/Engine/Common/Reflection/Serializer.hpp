@@ -13,10 +13,14 @@ namespace RTTI {
 NFCOMMON_API bool Serialize(const ObjectPtr& rootObject, Common::OutputStream& outputStream);
 
 // serialize multiple objects into binary data stream
-NFCOMMON_API bool Serialize(const Common::ArrayView<const ObjectPtr> rootObjects, Common::OutputStream& outputStream);
+// optionally returns all the serialized objects (including the ones referenced by root objects), in the order of serialization
+NFCOMMON_API bool Serialize(const Common::ArrayView<const ObjectPtr> rootObjects, Common::OutputStream& outputStream,
+                            Common::DynArray<ObjectPtr>* outAllObjects = nullptr);
 
 // deserialize multiple objects from a binary data stream
-NFCOMMON_API bool Deserialize(Common::DynArray<ObjectPtr>& outRootObjects, Common::InputStream& inputStream);
+// optionally returns all the deserialized objects (including the ones referenced by root objects), in the order of serialization
+NFCOMMON_API bool Deserialize(Common::DynArray<ObjectPtr>& outRootObjects, Common::InputStream& inputStream,
+                              Common::DynArray<ObjectPtr>* outAllObjects = nullptr);
 
 } // namespace RTTI
 } // namespace NFE
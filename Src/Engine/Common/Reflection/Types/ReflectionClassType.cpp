@@ -11,6 +11,7 @@
 #include "../ReflectionUnitTestHelper.hpp"
 #include "../ReflectionTypeRegistry.hpp"
 #include "../ReflectionVariant.hpp"
+#include "../Object.hpp"
 #include "../../Config/ConfigInterface.hpp"
 #include "../../Utils/Stream/OutputStream.hpp"
 #include "../../Utils/Stream/InputStream.hpp"
@@ -28,6 +29,7 @@ using MemberPayloadSizeType = uint16;
 ClassType::ClassType()
     : mParent(nullptr)
     , mIsAbstract(false)
+    , mObjectCast(nullptr)
 {}
 
 void ClassType::OnInitialize(const TypeInfo& info)
@@ -36,6 +38,7 @@ void ClassType::OnInitialize(const TypeInfo& info)
 
     mParent = classTypeInfo.parent;
     mIsAbstract = classTypeInfo.isAbstract;
+    mObjectCast = classTypeInfo.objectCast;
 
     mMembers.Reserve(classTypeInfo.members.Size());
     for (const Member& member : classTypeInfo.members)
@@ -589,6 +592,12 @@ bool ClassType::DeserializeBinary(void* outObject, InputStream& stream, Serializ
         }
     }
 
+    // let the object update its internal state
+    if (IObject* object = CastToObject(outObject))
+    {
+        object->OnDeserialized();
+    }
+
     return true;
 }
 
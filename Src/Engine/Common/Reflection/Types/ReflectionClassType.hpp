@@ -18,6 +18,9 @@ namespace RTTI {
 
 struct ClassTypeInfo;
 
+// converts pointer to an object of polymorphic class to its IObject base
+using ObjectCastFunction = IObject*(*)(void*);
+
 /**
  * Simple, polymorphic or abstract class type.
  */
@@ -43,6 +46,9 @@ public:
     // Check if the class is abstract (cannot create object of it)
     NFE_FORCE_INLINE bool IsAbstract() const { return mIsAbstract; }
 
+    // Get IObject base of an object of this type (will return nullptr for non-polymorphic classes)
+    NFE_FORCE_INLINE IObject* CastToObject(void* object) const { return mObjectCast ? mObjectCast(object) : nullptr; }
+
     /**
      * Enumerate all subtypes of this type (including self).
      */
@@ -93,6 +99,8 @@ private:
 
     bool mIsAbstract;
 
+    ObjectCastFunction mObjectCast;
+
     // serialize directly to an existing ConfigObject structure
     bool SerializeDirectly(const void* object, Common::IConfig& config, Common::ConfigObject& outObject, SerializationContext& context) const;
 
@@ -108,6 +116,7 @@ struct ClassTypeInfo : public TypeInfo
 {
     bool isAbstract = false;
     const ClassType* parent = nullptr;
+    ObjectCastFunction objectCast = nullptr;
     ClassType::Children childTypes;
     Common::DynArray<Member> members;
 };
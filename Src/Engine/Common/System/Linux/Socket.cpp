@@ -0,0 +1,242 @@
+/**
+ * @file
+ * @brief  Linux implementation of Socket class.
+ */
+
+#include "PCH.hpp"
+#include "../Socket.hpp"
+#include "Logger/Logger.hpp"
+#include "Containers/String.hpp"
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+
+namespace NFE {
+namespace Common {
+
+#define INVALID_SOCKET -1
+
+namespace {
+
+void DisableNagle(int socket)
+{
+    // messages are small and request-response based, don't wait for more data
+    int value = 1;
+    ::setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &value, sizeof(value));
+}
+
+} // namespace
+
+Socket::Socket()
+    : mSocket(INVALID_SOCKET)
+{
+}
+
+Socket::~Socket()
+{
+    Close();
+}
+
+Socket::Socket(Socket&& other)
+    : mSocket(other.mSocket)
+{
+    other.mSocket = INVALID_SOCKET;
+}
+
+Socket& Socket::operator = (Socket&& other)
+{
+    if (this != &other)
+    {
+        Close();
+        mSocket = other.mSocket;
+        other.mSocket = INVALID_SOCKET;
+    }
+    return *this;
+}
+
+bool Socket::Listen(uint16 port, bool localOnly)
+{
+    Close();
+
+    mSocket = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (mSocket == INVALID_SOCKET)
+    {
+        NFE_LOG_ERROR("Failed to create socket: %s", strerror(errno));
+        return false;
+    }
+
+    int reuseAddress = 1;
+    ::setsockopt(mSocket, SOL_SOCKET, SO_REUSEADDR, &reuseAddress, sizeof(reuseAddress));
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(localOnly ? INADDR_LOOPBACK : INADDR_ANY);
+
+    if (::bind(mSocket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+    {
+        NFE_LOG_ERROR("Failed to bind socket to port %u: %s", static_cast<uint32>(port), strerror(errno));
+        Close();
+        return false;
+    }
+
+    if (::listen(mSocket, SOMAXCONN) != 0)
+    {
+        NFE_LOG_ERROR("Failed to listen on port %u: %s", static_cast<uint32>(port), strerror(errno));
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+bool Socket::Accept(Socket& outConnection)
+{
+    outConnection.Close();
+
+    const int connection = ::accept(mSocket, nullptr, nullptr);
+    if (connection == INVALID_SOCKET)
+    {
+        NFE_LOG_ERROR("Failed to accept connection: %s", strerror(errno));
+        return false;
+    }
+
+    DisableNagle(connection);
+    outConnection.mSocket = connection;
+    return true;
+}
+
+bool Socket::Connect(const StringView& host, uint16 port)
+{
+    Close();
+
+    const StringViewToCStringHelper hostString(host);
+    const String portString = String::Printf("%u", static_cast<uint32>(port));
+
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    addrinfo* addresses = nullptr;
+    const int result = ::getaddrinfo(hostString, portString.Str(), &hints, &addresses);
+    if (result != 0)
+    {
+        NFE_LOG_ERROR("Failed to resolve host '%s': %s", hostString.Str(), gai_strerror(result));
+        return false;
+    }
+
+    for (const addrinfo* address = addresses; address; address = address->ai_next)
+    {
+        mSocket = ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (mSocket == INVALID_SOCKET)
+        {
+            continue;
+        }
+
+        if (::connect(mSocket, address->ai_addr, address->ai_addrlen) == 0)
+        {
+            break;
+        }
+
+        ::close(mSocket);
+        mSocket = INVALID_SOCKET;
+    }
+
+    ::freeaddrinfo(addresses);
+
+    if (mSocket == INVALID_SOCKET)
+    {
+        NFE_LOG_ERROR("Failed to connect to %s:%u: %s", hostString.Str(), static_cast<uint32>(port), strerror(errno));
+        return false;
+    }
+
+    DisableNagle(mSocket);
+    return true;
+}
+
+void Socket::Close()
+{
+    if (mSocket != INVALID_SOCKET)
+    {
+        ::close(mSocket);
+        mSocket = INVALID_SOCKET;
+    }
+}
+
+size_t Socket::Send(const void* data, size_t size)
+{
+    const uint8* bytes = static_cast<const uint8*>(data);
+
+    size_t bytesSent = 0;
+    while (bytesSent < size)
+    {
+        // don't raise SIGPIPE if the other side disconnected
+        const ssize_t result = ::send(mSocket, bytes + bytesSent, size - bytesSent, MSG_NOSIGNAL);
+        if (result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (result <= 0)
+        {
+            NFE_LOG_ERROR("Failed to send data: %s", strerror(errno));
+            break;
+        }
+        bytesSent += static_cast<size_t>(result);
+    }
+
+    return bytesSent;
+}
+
+size_t Socket::Receive(void* data, size_t size)
+{
+    uint8* bytes = static_cast<uint8*>(data);
+
+    size_t bytesReceived = 0;
+    while (bytesReceived < size)
+    {
+        const ssize_t result = ::recv(mSocket, bytes + bytesReceived, size - bytesReceived, 0);
+        if (result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (result < 0)
+        {
+            NFE_LOG_ERROR("Failed to receive data: %s", strerror(errno));
+            break;
+        }
+        if (result == 0)
+        {
+            // connection closed
+            break;
+        }
+        bytesReceived += static_cast<size_t>(result);
+    }
+
+    return bytesReceived;
+}
+
+uint16 Socket::GetPort() const
+{
+    sockaddr_in address = {};
+    socklen_t addressLength = sizeof(address);
+    if (::getsockname(mSocket, reinterpret_cast<sockaddr*>(&address), &addressLength) != 0)
+    {
+        return 0;
+    }
+
+    return ntohs(address.sin_port);
+}
+
+bool Socket::IsOpened() const
+{
+    return mSocket != INVALID_SOCKET;
+}
+
+} // namespace Common
+} // namespace NFE
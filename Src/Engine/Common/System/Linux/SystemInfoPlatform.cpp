@@ -50,6 +50,58 @@ bool ReadFileToString(const String& path, String& outString)
     return true;
 }
 
+// read single line from a sysfs file (sysfs files report invalid size, so File can't be used)
+bool ReadSysFsLine(const char* path, char* buffer, int bufferSize)
+{
+    FILE* file = fopen(path, "r");
+    if (!file)
+    {
+        return false;
+    }
+
+    const bool result = fgets(buffer, bufferSize, file) != nullptr;
+    fclose(file);
+    return result;
+}
+
+// parse list of ranges, e.g. "0-3,8,10-11"
+bool ParseRangeList(const char* str, DynArray<uint32>& outValues)
+{
+    while (*str && *str != '\n')
+    {
+        char* end = nullptr;
+        const unsigned long first = strtoul(str, &end, 10);
+        if (end == str)
+        {
+            return false;
+        }
+
+        unsigned long last = first;
+        str = end;
+        if (*str == '-')
+        {
+            last = strtoul(str + 1, &end, 10);
+            if (end == str + 1 || last < first)
+            {
+                return false;
+            }
+            str = end;
+        }
+
+        for (unsigned long i = first; i <= last; ++i)
+        {
+            outValues.PushBack(static_cast<uint32>(i));
+        }
+
+        if (*str == ',')
+        {
+            str++;
+        }
+    }
+
+    return true;
+}
+
 } // namespace
 
 void SystemInfo::InitCPUInfoPlatform()
@@ -60,6 +112,37 @@ void SystemInfo::InitCPUInfoPlatform()
     mPageSize = sysconf(_SC_PAGESIZE); // may be 'PAGE_SIZE' on some systems
 }
 
+void SystemInfo::InitNumaInfoPlatform()
+{
+    char buffer[4096];
+
+    DynArray<uint32> nodeIds;
+    if (!ReadSysFsLine("/sys/devices/system/node/online", buffer, sizeof(buffer)) || !ParseRangeList(buffer, nodeIds))
+    {
+        return;
+    }
+
+    for (const uint32 nodeId : nodeIds)
+    {
+        char path[128];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%u/cpulist", nodeId);
+
+        DynArray<uint32> cpus;
+        if (!ReadSysFsLine(path, buffer, sizeof(buffer)) || !ParseRangeList(buffer, cpus))
+        {
+            NFE_LOG_WARNING("Failed to read CPU list of NUMA node %u", nodeId);
+            mNumaNodeCpus.Clear();
+            return;
+        }
+
+        // skip memory-only nodes
+        if (!cpus.Empty())
+        {
+            mNumaNodeCpus.PushBack(std::move(cpus));
+        }
+    }
+}
+
 void SystemInfo::InitOSVersion()
 {
     static const DynArray<const char*> osFiles = { "/etc/redhat-release", "/etc/issue" };
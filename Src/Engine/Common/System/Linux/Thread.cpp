@@ -148,6 +148,35 @@ bool Thread::SetCurrentThreadPriority(ThreadPriority priority)
     return false;
 }
 
+bool Thread::SetAffinity(const ArrayView<const uint32> cpus)
+{
+    if (!mThreadData || !mThreadData->callback || cpus.Empty())
+    {
+        return false;
+    }
+
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (const uint32 cpu : cpus)
+    {
+        if (cpu >= CPU_SETSIZE)
+        {
+            NFE_LOG_ERROR("Invalid CPU index for thread affinity: %u", cpu);
+            return false;
+        }
+        CPU_SET(cpu, &cpuSet);
+    }
+
+    const int retVal = pthread_setaffinity_np(mThreadData->id, sizeof(cpuSet), &cpuSet);
+    if (retVal != 0)
+    {
+        NFE_LOG_ERROR("Error while setting thread affinity: %s", strerror(retVal));
+        return false;
+    }
+
+    return true;
+}
+
 bool Thread::SetName(const char* name)
 {
     if (!mThreadData || !mThreadData->callback)
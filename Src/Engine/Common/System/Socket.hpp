@@ -0,0 +1,81 @@
+/**
+ * @file
+ * @brief  Socket class declaration.
+ */
+
+#pragma once
+
+#include "../nfCommon.hpp"
+#include "../Containers/StringView.hpp"
+
+
+namespace NFE {
+namespace Common {
+
+/**
+ * Blocking TCP socket.
+ * Used for communication between processes, either on the same machine (via loopback interface) or over the network.
+ */
+class NFCOMMON_API Socket final
+{
+    NFE_MAKE_NONCOPYABLE(Socket)
+
+public:
+    Socket();
+    ~Socket();
+    Socket(Socket&& other);
+    Socket& operator = (Socket&& other);
+
+    /**
+     * Start listening for incoming connections.
+     * @param port      Port number. If zero, any free port is used (see GetPort).
+     * @param localOnly Accept connections from the local machine only.
+     */
+    bool Listen(uint16 port, bool localOnly = false);
+
+    /**
+     * Wait for an incoming connection.
+     * @note The socket must be listening.
+     */
+    bool Accept(Socket& outConnection);
+
+    /**
+     * Connect to a listening socket.
+     * @param host  Host name or address.
+     */
+    bool Connect(const StringView& host, uint16 port);
+
+    /**
+     * Close the connection (or stop listening).
+     */
+    void Close();
+
+    /**
+     * Send data. Blocks until all the data is sent.
+     * @return Number of bytes sent. Smaller than requested if the connection was closed.
+     */
+    size_t Send(const void* data, size_t size);
+
+    /**
+     * Receive data. Blocks until all the requested data is received.
+     * @return Number of bytes received. Smaller than requested if the connection was closed.
+     */
+    size_t Receive(void* data, size_t size);
+
+    // get local port number
+    uint16 GetPort() const;
+
+    bool IsOpened() const;
+
+private:
+#if defined(WIN32)
+    uintptr_t mSocket;  // SOCKET
+#elif defined(__LINUX__) | defined(__linux__)
+    int mSocket;
+#else
+#error "Target system not supported!"
+#endif
+};
+
+} // namespace Common
+} // namespace NFE
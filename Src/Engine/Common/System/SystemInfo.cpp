@@ -8,6 +8,7 @@
 #include "SystemInfo.hpp"
 #include "SystemInfoConstants.hpp"
 #include "../Utils/StringUtils.hpp"
+#include "../Math/Math.hpp"
 
 
 namespace NFE {
@@ -20,6 +21,8 @@ SystemInfo::SystemInfo()
     InitOSVersion();
     InitCompilerInfo();
     InitMemoryInfo();
+    InitNumaInfoPlatform();
+    InitNumaInfoCommon();
     InitMap();
 }
 
@@ -162,6 +165,38 @@ void SystemInfo::InitMap()
     mCpuidFeatureMap.Insert("EM64T", CpuidFeature(4, 1<<29)); // Support for 64bit OS
 }
 
+void SystemInfo::InitNumaInfoCommon()
+{
+    // fallback for non-NUMA systems or when the topology could not be determined
+    if (mNumaNodeCpus.Empty())
+    {
+        DynArray<uint32> cpus;
+        for (uint32 i = 0; i < static_cast<uint32>(mCPUCoreNo); ++i)
+        {
+            cpus.PushBack(i);
+        }
+        mNumaNodeCpus.PushBack(std::move(cpus));
+    }
+
+    uint32 maxCpuIndex = 0;
+    for (const DynArray<uint32>& cpus : mNumaNodeCpus)
+    {
+        for (const uint32 cpu : cpus)
+        {
+            maxCpuIndex = Math::Max(maxCpuIndex, cpu);
+        }
+    }
+
+    mCpuNumaNodes.Resize(maxCpuIndex + 1, 0u);
+    for (uint32 node = 0; node < mNumaNodeCpus.Size(); ++node)
+    {
+        for (const uint32 cpu : mNumaNodeCpus[node])
+        {
+            mCpuNumaNodes[cpu] = node;
+        }
+    }
+}
+
 String SystemInfo::ConstructAllInfoString()
 {
     // Building output string
@@ -175,6 +210,7 @@ String SystemInfo::ConstructAllInfoString()
     outputStr += "CPU cores no.:   " + ToString(mCPUCoreNo) + '\n';
     outputStr += "Page size:       " + ToString(mPageSize) + " bytes\n";
     outputStr += "Cache line size: " + ToString(mCacheLineSize) + "bytes\n";
+    outputStr += "NUMA nodes no.:  " + ToString(GetNumNumaNodes()) + '\n';
 
     outputStr += "\n..::MEMORY::..\n";
     outputStr += "Free (total):         " + ToString(GetFreeMemoryKb()) + " kB\n";
@@ -254,5 +290,21 @@ uint64 SystemInfo::GetMemTotalSwapKb() const
     return mMemTotalSwapKb;
 }
 
+uint32 SystemInfo::GetNumNumaNodes() const
+{
+    return mNumaNodeCpus.Size();
+}
+
+uint32 SystemInfo::GetCpuNumaNode(uint32 cpuIndex) const
+{
+    return cpuIndex < mCpuNumaNodes.Size() ? mCpuNumaNodes[cpuIndex] : 0;
+}
+
+const DynArray<uint32>& SystemInfo::GetNumaNodeCpus(uint32 nodeIndex) const
+{
+    NFE_ASSERT(nodeIndex < mNumaNodeCpus.Size(), "Invalid NUMA node index");
+    return mNumaNodeCpus[nodeIndex];
+}
+
 } // namespace Common
 } // namespace NFE
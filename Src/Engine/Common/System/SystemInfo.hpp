@@ -8,6 +8,7 @@
 
 #include "../nfCommon.hpp"
 #include "../Containers/HashMap.hpp"
+#include "../Containers/DynArray.hpp"
 #include "../Containers/String.hpp"
 #include "../Containers/StringView.hpp"
 
@@ -54,6 +55,8 @@ private:
     uint64 mMemTotalVirtKb;
     uint64 mMemFreeVirtKb;
     uint64 mCpuidFeatures[5];
+    DynArray<DynArray<uint32>> mNumaNodeCpus;   // logical CPUs of each NUMA node
+    DynArray<uint32> mCpuNumaNodes;             // NUMA node of each logical CPU
 
     void Cpuid(int cpuInfo[4], int function_id);
     uint64 Rdtsc();
@@ -64,6 +67,8 @@ private:
     void InitMap();
     void InitCPUInfoPlatform();
     void InitMemoryInfo();
+    void InitNumaInfoPlatform();
+    void InitNumaInfoCommon();
 
     bool CheckFeature(CpuidFeature feature) const;
 
@@ -118,6 +123,22 @@ public:
     uint64 GetMemTotalPhysKb() const;
     uint64 GetMemTotalVirtKb() const;
     uint64 GetMemTotalSwapKb() const;
+
+    /**
+     * Get number of NUMA nodes.
+     * @note Non-NUMA systems are reported as a single node containing all the logical CPUs.
+     */
+    uint32 GetNumNumaNodes() const;
+
+    /**
+     * Get NUMA node index (in range [0, GetNumNumaNodes())) of a logical CPU.
+     */
+    uint32 GetCpuNumaNode(uint32 cpuIndex) const;
+
+    /**
+     * Get list of logical CPUs belonging to a NUMA node.
+     */
+    const DynArray<uint32>& GetNumaNodeCpus(uint32 nodeIndex) const;
 };
 
 /**
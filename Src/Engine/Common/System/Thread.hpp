@@ -7,6 +7,7 @@
 #pragma once
 #include "../nfCommon.hpp"
 #include "../Containers/UniquePtr.hpp"
+#include "../Containers/ArrayView.hpp"
 
 #if defined(WIN32)
 #define WIN32_LEAN_AND_MEAN
@@ -81,6 +82,9 @@ public:
     // Name can be MAX_THREAD_NAME_LENGTH characters long at max (including '\0')
     bool SetName(const char* name);
 
+    // Restrict thread to run only on given logical CPUs
+    bool SetAffinity(const ArrayView<const uint32> cpus);
+
     // Get thread's ID
     uint32 GetID() const;
 
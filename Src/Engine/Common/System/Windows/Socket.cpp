@@ -0,0 +1,260 @@
+/**
+ * @file
+ * @brief  Windows implementation of Socket class.
+ */
+
+#include "PCH.hpp"
+#include "../Socket.hpp"
+#include "Logger/Logger.hpp"
+#include "Containers/String.hpp"
+
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+
+namespace NFE {
+namespace Common {
+
+namespace {
+
+// Winsock must be initialized before any socket is created
+class WinsockInitializer
+{
+public:
+    WinsockInitializer()
+    {
+        WSADATA data;
+        mInitialized = ::WSAStartup(MAKEWORD(2, 2), &data) == 0;
+        if (!mInitialized)
+        {
+            NFE_LOG_ERROR("Failed to initialize Winsock");
+        }
+    }
+
+    ~WinsockInitializer()
+    {
+        if (mInitialized)
+        {
+            ::WSACleanup();
+        }
+    }
+
+private:
+    bool mInitialized;
+};
+
+void InitializeWinsock()
+{
+    static WinsockInitializer initializer;
+}
+
+void DisableNagle(SOCKET socket)
+{
+    // messages are small and request-response based, don't wait for more data
+    BOOL value = TRUE;
+    ::setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+} // namespace
+
+Socket::Socket()
+    : mSocket(INVALID_SOCKET)
+{
+}
+
+Socket::~Socket()
+{
+    Close();
+}
+
+Socket::Socket(Socket&& other)
+    : mSocket(other.mSocket)
+{
+    other.mSocket = INVALID_SOCKET;
+}
+
+Socket& Socket::operator = (Socket&& other)
+{
+    if (this != &other)
+    {
+        Close();
+        mSocket = other.mSocket;
+        other.mSocket = INVALID_SOCKET;
+    }
+    return *this;
+}
+
+bool Socket::Listen(uint16 port, bool localOnly)
+{
+    Close();
+    InitializeWinsock();
+
+    const SOCKET listenSocket = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listenSocket == INVALID_SOCKET)
+    {
+        NFE_LOG_ERROR("Failed to create socket, error code: %d", ::WSAGetLastError());
+        return false;
+    }
+    mSocket = listenSocket;
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(localOnly ? INADDR_LOOPBACK : INADDR_ANY);
+
+    if (::bind(listenSocket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == SOCKET_ERROR)
+    {
+        NFE_LOG_ERROR("Failed to bind socket to port %u, error code: %d", static_cast<uint32>(port), ::WSAGetLastError());
+        Close();
+        return false;
+    }
+
+    if (::listen(listenSocket, SOMAXCONN) == SOCKET_ERROR)
+    {
+        NFE_LOG_ERROR("Failed to listen on port %u, error code: %d", static_cast<uint32>(port), ::WSAGetLastError());
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+bool Socket::Accept(Socket& outConnection)
+{
+    outConnection.Close();
+
+    const SOCKET connection = ::accept(static_cast<SOCKET>(mSocket), nullptr, nullptr);
+    if (connection == INVALID_SOCKET)
+    {
+        NFE_LOG_ERROR("Failed to accept connection, error code: %d", ::WSAGetLastError());
+        return false;
+    }
+
+    DisableNagle(connection);
+    outConnection.mSocket = connection;
+    return true;
+}
+
+bool Socket::Connect(const StringView& host, uint16 port)
+{
+    Close();
+    InitializeWinsock();
+
+    const StringViewToCStringHelper hostString(host);
+    const String portString = String::Printf("%u", static_cast<uint32>(port));
+
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+
+    addrinfo* addresses = nullptr;
+    const int result = ::getaddrinfo(hostString, portString.Str(), &hints, &addresses);
+    if (result != 0)
+    {
+        NFE_LOG_ERROR("Failed to resolve host '%s', error code: %d", hostString.Str(), result);
+        return false;
+    }
+
+    for (const addrinfo* address = addresses; address; address = address->ai_next)
+    {
+        const SOCKET connection = ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (connection == INVALID_SOCKET)
+        {
+            continue;
+        }
+
+        if (::connect(connection, address->ai_addr, static_cast<int>(address->ai_addrlen)) != SOCKET_ERROR)
+        {
+            mSocket = connection;
+            break;
+        }
+
+        ::closesocket(connection);
+    }
+
+    ::freeaddrinfo(addresses);
+
+    if (mSocket == INVALID_SOCKET)
+    {
+        NFE_LOG_ERROR("Failed to connect to %s:%u, error code: %d", hostString.Str(), static_cast<uint32>(port), ::WSAGetLastError());
+        return false;
+    }
+
+    DisableNagle(static_cast<SOCKET>(mSocket));
+    return true;
+}
+
+void Socket::Close()
+{
+    if (mSocket != INVALID_SOCKET)
+    {
+        ::closesocket(static_cast<SOCKET>(mSocket));
+        mSocket = INVALID_SOCKET;
+    }
+}
+
+size_t Socket::Send(const void* data, size_t size)
+{
+    const char* bytes = static_cast<const char*>(data);
+
+    size_t bytesSent = 0;
+    while (bytesSent < size)
+    {
+        const int chunkSize = static_cast<int>(size - bytesSent > INT32_MAX ? INT32_MAX : size - bytesSent);
+        const int result = ::send(static_cast<SOCKET>(mSocket), bytes + bytesSent, chunkSize, 0);
+        if (result == SOCKET_ERROR || result == 0)
+        {
+            NFE_LOG_ERROR("Failed to send data, error code: %d", ::WSAGetLastError());
+            break;
+        }
+        bytesSent += static_cast<size_t>(result);
+    }
+
+    return bytesSent;
+}
+
+size_t Socket::Receive(void* data, size_t size)
+{
+    char* bytes = static_cast<char*>(data);
+
+    size_t bytesReceived = 0;
+    while (bytesReceived < size)
+    {
+        const int chunkSize = static_cast<int>(size - bytesReceived > INT32_MAX ? INT32_MAX : size - bytesReceived);
+        const int result = ::recv(static_cast<SOCKET>(mSocket), bytes + bytesReceived, chunkSize, 0);
+        if (result == SOCKET_ERROR)
+        {
+            NFE_LOG_ERROR("Failed to receive data, error code: %d", ::WSAGetLastError());
+            break;
+        }
+        if (result == 0)
+        {
+            // connection closed
+            break;
+        }
+        bytesReceived += static_cast<size_t>(result);
+    }
+
+    return bytesReceived;
+}
+
+uint16 Socket::GetPort() const
+{
+    sockaddr_in address = {};
+    int addressLength = sizeof(address);
+    if (::getsockname(static_cast<SOCKET>(mSocket), reinterpret_cast<sockaddr*>(&address), &addressLength) == SOCKET_ERROR)
+    {
+        return 0;
+    }
+
+    return ntohs(address.sin_port);
+}
+
+bool Socket::IsOpened() const
+{
+    return mSocket != INVALID_SOCKET;
+}
+
+} // namespace Common
+} // namespace NFE
@@ -9,6 +9,7 @@
 #include "../Library.hpp"
 #include "Common.hpp"
 #include "../../Utils/StringUtils.hpp"
+#include "../../Math/Math.hpp"
 
 #include <intrin.h>
 
@@ -73,6 +74,37 @@ void SystemInfo::InitCPUInfoPlatform()
     mPageSize = sysInfo.dwPageSize;
 }
 
+void SystemInfo::InitNumaInfoPlatform()
+{
+    ULONG highestNodeNumber = 0;
+    if (!::GetNumaHighestNodeNumber(&highestNodeNumber))
+    {
+        return;
+    }
+
+    // NOTE: only the first processor group is considered
+    DynArray<DynArray<uint32>> nodeCpus;
+    nodeCpus.Resize(highestNodeNumber + 1);
+    for (uint32 cpu = 0; cpu < Math::Min<uint32>(static_cast<uint32>(mCPUCoreNo), 64u); ++cpu)
+    {
+        UCHAR nodeNumber = 0;
+        if (!::GetNumaProcessorNode(static_cast<UCHAR>(cpu), &nodeNumber) || nodeNumber > highestNodeNumber)
+        {
+            return;
+        }
+        nodeCpus[nodeNumber].PushBack(cpu);
+    }
+
+    // skip memory-only nodes
+    for (DynArray<uint32>& cpus : nodeCpus)
+    {
+        if (!cpus.Empty())
+        {
+            mNumaNodeCpus.PushBack(std::move(cpus));
+        }
+    }
+}
+
 void SystemInfo::InitOSVersion()
 {
     OSVERSIONINFOEX os;
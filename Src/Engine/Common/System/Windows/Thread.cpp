@@ -171,6 +171,34 @@ bool Thread::SetCurrentThreadPriority(ThreadPriority priority)
     return false;
 }
 
+bool Thread::SetAffinity(const ArrayView<const uint32> cpus)
+{
+    if (!mThreadData || mThreadData->handle == INVALID_HANDLE_VALUE || cpus.Empty())
+    {
+        return false;
+    }
+
+    // NOTE: only the first processor group is supported
+    DWORD_PTR mask = 0;
+    for (const uint32 cpu : cpus)
+    {
+        if (cpu >= 64)
+        {
+            NFE_LOG_ERROR("Invalid CPU index for thread affinity: %u", cpu);
+            return false;
+        }
+        mask |= static_cast<DWORD_PTR>(1) << cpu;
+    }
+
+    if (0 == ::SetThreadAffinityMask(mThreadData->handle, mask))
+    {
+        NFE_LOG_ERROR("Failed to change thread %0X affinity. Error code: %u", mThreadData->id, ::GetLastError());
+        return false;
+    }
+
+    return true;
+}
+
 bool Thread::SetName(const char* name)
 {
     if (!mThreadData || mThreadData->id == 0)
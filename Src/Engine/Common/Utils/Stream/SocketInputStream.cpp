@@ -0,0 +1,31 @@
+#include "PCH.hpp"
+#include "SocketInputStream.hpp"
+#include "System/Socket.hpp"
+
+
+namespace NFE {
+namespace Common {
+
+SocketInputStream::SocketInputStream(Socket& socket)
+    : mSocket(socket)
+{ }
+
+uint64 SocketInputStream::GetSize()
+{
+    return std::numeric_limits<uint64>::max();
+}
+
+bool SocketInputStream::Seek(int64 offset, SeekMode mode)
+{
+    NFE_UNUSED(offset);
+    NFE_UNUSED(mode);
+    return false;
+}
+
+size_t SocketInputStream::Read(void* buffer, size_t num)
+{
+    return mSocket.Receive(buffer, num);
+}
+
+} // namespace Common
+} // namespace NFE
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "InputStream.hpp"
+
+
+namespace NFE {
+namespace Common {
+
+class Socket;
+
+/**
+ * Implementation of InputStream - socket reader.
+ * @note The stream has no known size and can't be seeked.
+ */
+class NFCOMMON_API SocketInputStream : public InputStream
+{
+    NFE_MAKE_NONCOPYABLE(SocketInputStream)
+    NFE_MAKE_NONMOVEABLE(SocketInputStream)
+
+private:
+    Socket& mSocket;
+
+public:
+    SocketInputStream(Socket& socket);
+
+    uint64 GetSize() override;
+    bool Seek(int64 offset, SeekMode mode) override;
+    size_t Read(void* buffer, size_t num) override;
+};
+
+} // namespace Common
+} // namespace NFE
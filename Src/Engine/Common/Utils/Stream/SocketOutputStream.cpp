@@ -0,0 +1,34 @@
+#include "PCH.hpp"
+#include "SocketOutputStream.hpp"
+#include "System/Socket.hpp"
+
+
+namespace NFE {
+namespace Common {
+
+SocketOutputStream::SocketOutputStream(Socket& socket)
+    : mSocket(socket)
+    , mBytesWritten(0)
+{ }
+
+size_t SocketOutputStream::Write(const void* buffer, size_t num)
+{
+    const size_t bytesSent = mSocket.Send(buffer, num);
+    mBytesWritten += bytesSent;
+    return bytesSent;
+}
+
+uint64 SocketOutputStream::GetPosition() const
+{
+    return mBytesWritten;
+}
+
+bool SocketOutputStream::Seek(int64 offset, SeekMode mode)
+{
+    NFE_UNUSED(offset);
+    NFE_UNUSED(mode);
+    return false;
+}
+
+} // namespace Common
+} // namespace NFE
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "OutputStream.hpp"
+
+
+namespace NFE {
+namespace Common {
+
+class Socket;
+
+/**
+ * Implementation of OutputStream - socket writer.
+ * @note The stream can't be seeked.
+ */
+class NFCOMMON_API SocketOutputStream : public OutputStream
+{
+    NFE_MAKE_NONCOPYABLE(SocketOutputStream)
+    NFE_MAKE_NONMOVEABLE(SocketOutputStream)
+
+private:
+    Socket& mSocket;
+    uint64 mBytesWritten;
+
+public:
+    SocketOutputStream(Socket& socket);
+
+    virtual size_t Write(const void* buffer, size_t num) override;
+    virtual bool Seek(int64 offset, SeekMode mode) override;
+    virtual uint64 GetPosition() const override;
+};
+
+} // namespace Common
+} // namespace NFE
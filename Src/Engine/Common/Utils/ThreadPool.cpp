@@ -7,12 +7,14 @@
 #include "PCH.hpp"
 #include "ThreadPool.hpp"
 #include "Waitable.hpp"
+#include "../System/SystemInfo.hpp"
 
 namespace NFE {
 namespace Common {
 
-WorkerThread::WorkerThread(ThreadPool* pool, uint32 id)
+WorkerThread::WorkerThread(ThreadPool* pool, uint32 id, uint32 numaNode)
     : mId(id)
+    , mNumaNode(numaNode)
     , mStarted(true)
 {
     mThread.Run(&ThreadPool::SchedulerCallback, pool, this);
@@ -20,6 +22,12 @@ WorkerThread::WorkerThread(ThreadPool* pool, uint32 id)
     char threadName[64];
     snprintf(threadName, sizeof(threadName), "NFE::Common::ThreadPool worker #%u", id);
     mThread.SetName(threadName);
+
+    // keep the thread on a single node, so it accesses node-local memory
+    if (pool->GetNumNumaNodes() > 1)
+    {
+        mThread.SetAffinity(SystemInfo::Instance().GetNumaNodeCpus(numaNode));
+    }
 }
 
 WorkerThread::~WorkerThread()
@@ -36,7 +44,8 @@ ThreadPool& ThreadPool::GetInstance()
 }
 
 ThreadPool::ThreadPool()
-    : mFirstFreeTask(InvalidTaskID)
+    : mNumNumaNodes(1)
+    , mFirstFreeTask(InvalidTaskID)
 {
     // TODO make it configurable
     InitTasksTable(TasksCapacity);
@@ -105,9 +114,16 @@ bool ThreadPool::InitTasksTable(uint32 newSize)
 
 void ThreadPool::SpawnWorkerThreads(uint32 num)
 {
-    for (uint32 i = 0; i < num; ++i)
+    const SystemInfo& systemInfo = SystemInfo::Instance();
+    mNumNumaNodes = systemInfo.GetNumNumaNodes();
+
+    const uint32 firstThread = mThreads.Size();
+    for (uint32 i = firstThread; i < firstThread + num; ++i)
     {
-        mThreads.PushBack(MakeUniquePtr<WorkerThread>(this, i));
+        // workers are distributed between nodes round-robin, so they are balanced for any number of workers
+        // (logical CPU indices are usually numbered node by node, so they would fill the first node first)
+        const uint32 numaNode = i % mNumNumaNodes;
+        mThreads.PushBack(MakeUniquePtr<WorkerThread>(this, i, numaNode));
     }
 }
 
@@ -59,10 +59,11 @@ class WorkerThread
 
     Thread mThread;
     uint32 mId;                     // thread number
+    uint32 mNumaNode;               // NUMA node the thread is pinned to
     std::atomic<bool> mStarted;     // if set to false, exit the thread
 
 public:
-    WorkerThread(ThreadPool* pool, uint32 id);
+    WorkerThread(ThreadPool* pool, uint32 id, uint32 numaNode);
     ~WorkerThread();
 };
 
@@ -93,6 +94,13 @@ public:
     // Get number of worker threads in the pool.
     NFE_FORCE_INLINE uint32 GetNumThreads() const { return mThreads.Size(); }
 
+    // Get number of NUMA nodes the worker threads are distributed between.
+    // On NUMA systems each worker thread is pinned to CPUs of a single node.
+    NFE_FORCE_INLINE uint32 GetNumNumaNodes() const { return mNumNumaNodes; }
+
+    // Get NUMA node of a worker thread (see TaskContext::threadId).
+    NFE_FORCE_INLINE uint32 GetThreadNumaNode(uint32 threadId) const { return mThreads[threadId]->mNumaNode; }
+
     // Create a new task.
     // The task will not be queued immidiately - it has to be queued manually via DispatchTask call
     // NOTE This function is thread-safe.
@@ -124,6 +132,7 @@ private:
 
     // Worker threads variables:
     DynArray<WorkerThreadPtr> mThreads;
+    uint32 mNumNumaNodes;
 
     // queues for tasks with "Queued" state
     Deque<TaskID> mTasksQueues[NumPriorities];
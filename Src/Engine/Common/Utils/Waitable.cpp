@@ -18,24 +18,23 @@ void Waitable::Wait()
 {
     NFE_ASSERT(Thread::IsMainThread(), "Nothing should wait on non-main thread as it may cause deadlock");
 
-    if (!mFinished)
+    // NOTE: the lock must be taken even if already finished, otherwise the waitable could be destroyed
+    // while OnFinished() is still signaling the condition variable
+    ScopedExclusiveLock<Mutex> lock(mMutex);
+    while (!mFinished)
     {
-        ScopedExclusiveLock<Mutex> lock(mMutex);
-        while (!mFinished)
-        {
-            mConditionVariable.Wait(lock);
-        }
+        mConditionVariable.Wait(lock);
     }
 }
 
 void Waitable::OnFinished()
 {
+    ScopedExclusiveLock<Mutex> lock(mMutex);
+
     const bool oldState = mFinished.exchange(true);
     NFE_ASSERT(!oldState, "OnFinished can be called only once on waitable object");
 
-    ScopedExclusiveLock<Mutex> lock(mMutex);
     mConditionVariable.SignalAll();
-
 }
 
 } // namespace Common
@@ -1,5 +1,7 @@
 #include "PCH.h"
 #include "BVH.h"
+#include "../Common/Utils/Stream/InputStream.hpp"
+#include "../Common/Utils/Stream/OutputStream.hpp"
 
 
 namespace NFE {
@@ -24,11 +26,57 @@ BVH::BVH()
 
 bool BVH::AllocateNodes(uint32 numNodes)
 {
-    mNodes.Resize(numNodes);
+    mNumNodes = 0;
+    mEndBoxes.Clear();
+
+    if (!mNodes.Resize(numNodes))
+    {
+        NFE_LOG_ERROR("BVH: Failed to allocate %u nodes", numNodes);
+        return false;
+    }
+
     mNumNodes = numNodes;
     return true;
 }
 
+void BVH::SetMotionBounds(const Math::Box* leafStartBoxes, const Math::Box* leafEndBoxes)
+{
+    mEndBoxes.Resize(mNumNodes);
+
+    // child nodes are always placed after the parent, so the nodes can be updated bottom-up in reversed order
+    // NOTE: union of interpolated boxes is contained by interpolation of the boxes unions,
+    // so the bounds stay conservative at any point in time
+    for (uint32 i = mNumNodes; i-- > 0; )
+    {
+        Node& node = mNodes[i];
+
+        Math::Box startBox = Math::Box::Empty();
+        Math::Box endBox = Math::Box::Empty();
+
+        if (node.IsLeaf())
+        {
+            for (uint32 j = 0; j < node.numLeaves; ++j)
+            {
+                startBox = Math::Box(startBox, leafStartBoxes[node.childIndex + j]);
+                endBox = Math::Box(endBox, leafEndBoxes[node.childIndex + j]);
+            }
+        }
+        else
+        {
+            NFE_ASSERT(node.childIndex > i, "Child node must be placed after the parent");
+
+            const Node& childA = mNodes[node.childIndex];
+            const Node& childB = mNodes[node.childIndex + 1];
+            startBox = Math::Box(childA.GetBox(), childB.GetBox());
+            endBox = Math::Box(mEndBoxes[node.childIndex], mEndBoxes[node.childIndex + 1]);
+        }
+
+        node.min = startBox.min.ToVec3f();
+        node.max = startBox.max.ToVec3f();
+        mEndBoxes[i] = endBox;
+    }
+}
+
 bool BVH::SaveToFile(const std::string& filePath) const
 {
     FILE* file = fopen(filePath.c_str(), "wb");
@@ -109,6 +157,65 @@ bool BVH::LoadFromFile(const std::string& filePath)
     return true;
 }
 
+bool BVH::Write(Common::OutputStream& stream) const
+{
+    BVHFileHeader header;
+    header.magic = BvhMagic;
+    header.version = BvhFileVersion;
+    header.numNodes = mNumNodes;
+
+    if (!stream.Write(header))
+    {
+        NFE_LOG_ERROR("Failed to write BVH header");
+        return false;
+    }
+
+    const size_t nodesSize = sizeof(Node) * mNumNodes;
+    if (stream.Write(mNodes.Data(), nodesSize) != nodesSize)
+    {
+        NFE_LOG_ERROR("Failed to write BVH nodes");
+        return false;
+    }
+
+    return true;
+}
+
+bool BVH::Read(Common::InputStream& stream)
+{
+    BVHFileHeader header;
+    if (!stream.Read(header))
+    {
+        NFE_LOG_ERROR("Failed to read BVH header");
+        return false;
+    }
+
+    if (header.magic != BvhMagic)
+    {
+        NFE_LOG_ERROR("Corrupted BVH data (invalid magic value)");
+        return false;
+    }
+
+    if (header.version != BvhFileVersion)
+    {
+        NFE_LOG_ERROR("Unsupported BVH data version %u (expected %u)", header.version, BvhFileVersion);
+        return false;
+    }
+
+    if (!AllocateNodes(header.numNodes))
+    {
+        return false;
+    }
+
+    const size_t nodesSize = sizeof(Node) * header.numNodes;
+    if (stream.Read(mNodes.Data(), nodesSize) != nodesSize)
+    {
+        NFE_LOG_ERROR("Failed to read BVH nodes");
+        return false;
+    }
+
+    return true;
+}
+
 void BVH::CalculateStats(Stats& outStats) const
 {
     if (mNumNodes == 0)
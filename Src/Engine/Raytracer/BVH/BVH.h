@@ -12,7 +12,7 @@ namespace NFE {
 namespace RT {
 
 // binary Bounding Volume Hierarchy
-class BVH
+class NFE_RAYTRACER_API BVH
 {
 public:
     static constexpr uint32 MaxDepth = 128;
@@ -81,19 +81,64 @@ public:
     bool SaveToFile(const std::string& filePath) const;
     bool LoadFromFile(const std::string& filePath);
 
+    // store/restore BVH nodes in a binary stream (same format as BVH file)
+    bool Write(Common::OutputStream& stream) const;
+    bool Read(Common::InputStream& stream);
+
+    // Compute time-dependent node bounds for moving leaves.
+    // Nodes' own bounds are replaced with bounds at time=0.0, bounds at time=1.0 are stored separately.
+    // Leaf boxes must be in BVH order.
+    void SetMotionBounds(const Math::Box* leafStartBoxes, const Math::Box* leafEndBoxes);
+
     NFE_FORCE_INLINE const Node* GetNodes() const { return mNodes.Data(); }
     NFE_FORCE_INLINE uint32 GetNumNodes() const { return mNumNodes; }
 
+    NFE_FORCE_INLINE bool HasMotion() const { return !mEndBoxes.Empty(); }
+    NFE_FORCE_INLINE const Math::Box* GetEndBoxes() const { return mEndBoxes.Data(); }
+
 private:
     void CalculateStatsForNode(uint32 node, Stats& outStats, uint32 depth) const;
     bool AllocateNodes(uint32 numNodes);
 
-    Common::DynArray<Node> mNodes;
+    LargeArray<Node> mNodes;
+    Common::DynArray<Math::Box> mEndBoxes; // node bounds at time=1.0 (empty for static BVH)
     uint32 mNumNodes;
 
     friend class BVHBuilder;
+    friend class BVHOptimizer;
+};
+
+// node bounds provider for traversal of static BVH
+struct StaticNodeBoxes
+{
+    NFE_FORCE_INLINE const Math::Box operator()(const BVH::Node& node) const
+    {
+        return node.GetBox();
+    }
 };
 
+// node bounds provider for traversal of BVH with motion bounds (linearly interpolated in time)
+class MotionNodeBoxes
+{
+public:
+    NFE_FORCE_INLINE MotionNodeBoxes(const BVH& bvh, const float time)
+        : mNodes(bvh.GetNodes())
+        , mEndBoxes(bvh.GetEndBoxes())
+        , mTime(time)
+    { }
+
+    NFE_FORCE_INLINE const Math::Box operator()(const BVH::Node& node) const
+    {
+        const Math::Box startBox = node.GetBox();
+        const Math::Box& endBox = mEndBoxes[&node - mNodes];
+        return { Math::Vec4f::Lerp(startBox.min, endBox.min, mTime), Math::Vec4f::Lerp(startBox.max, endBox.max, mTime) };
+    }
+
+private:
+    const BVH::Node* mNodes;
+    const Math::Box* mEndBoxes;
+    const float mTime;
+};
 
 } // namespace RT
 } // namespace NFE
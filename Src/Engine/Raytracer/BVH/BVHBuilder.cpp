@@ -1,6 +1,8 @@
 #include "PCH.h"
 #include "BVHBuilder.h"
+#include "BVHOptimizer.h"
 #include "../Common/System/Timer.hpp"
+#include "../Common/System/Thread.hpp"
 #include "../Common/Utils/TaskBuilder.hpp"
 #include "../Common/Utils/Waitable.hpp"
 #include "../Common/Utils/ThreadPool.hpp"
@@ -40,7 +42,10 @@ bool BVHBuilder::Build(const Box* data, const uint32 numLeaves,
     mLeafBoxes = data;
     mNumLeaves = numLeaves;
     mParams = params;
-    mTarget.AllocateNodes(2 * mNumLeaves);
+    if (!mTarget.AllocateNodes(2 * mNumLeaves))
+    {
+        return false;
+    }
 
     mNumGeneratedNodes = 0;
     mNumGeneratedLeaves = 0;
@@ -77,26 +82,37 @@ bool BVHBuilder::Build(const Box* data, const uint32 numLeaves,
     Timer timer;
     timer.Start();
 
-    uint32 numThreads = ThreadPool::GetInstance().GetNumThreads();
+    // When called from a worker thread (e.g. many meshes are loaded in parallel) the BVH is built on the calling thread,
+    // as waiting for the subtasks there could deadlock the thread pool.
+    const bool isMainThread = Thread::IsMainThread();
+
+    uint32 numThreads = isMainThread ? ThreadPool::GetInstance().GetNumThreads() : 1u;
     mThreadData.Resize(numThreads);
     for (uint32 i = 0; i < numThreads; ++i)
     {
         mThreadData[i].Init(mNumLeaves);
     }
 
-    Waitable waitable;
-    {
-        BVH::Node& rootNode = mTarget.mNodes.Front();
-        mNumGeneratedNodes += 2;
+    BVH::Node& rootNode = mTarget.mNodes.Front();
+    mNumGeneratedNodes += 2;
 
-        TaskBuilder taskBuilder(waitable);
-        taskBuilder.Task("BVHBuilder::Build", [this, rootWorkSet, &rootNode] (const TaskContext& taskContext)
+    if (isMainThread)
+    {
+        Waitable waitable;
         {
-            TaskBuilder childTaskBuilder(taskContext.taskId);
-            BuildNode_Threaded(rootWorkSet, rootNode, taskContext, childTaskBuilder);
-        });
+            TaskBuilder taskBuilder(waitable);
+            taskBuilder.Task("BVHBuilder::Build", [this, rootWorkSet, &rootNode] (const TaskContext& taskContext)
+            {
+                TaskBuilder childTaskBuilder(taskContext.taskId);
+                BuildNode_Threaded(rootWorkSet, rootNode, taskContext, childTaskBuilder);
+            });
+        }
+        waitable.Wait();
+    }
+    else
+    {
+        BuildNode(mThreadData.Front(), *rootWorkSet, rootNode);
     }
-    waitable.Wait();
 
     NFE_ASSERT(mNumGeneratedLeaves == mNumLeaves, ""); // Number of generated leaves is invalid
     NFE_ASSERT(mNumGeneratedNodes <= 2 * mNumLeaves, ""); // Number of generated nodes is invalid
@@ -104,11 +120,25 @@ bool BVHBuilder::Build(const Box* data, const uint32 numLeaves,
     // shrink BVH nodes array
     mTarget.mNumNodes = mNumGeneratedNodes;
     mTarget.mNodes.Resize(mNumGeneratedNodes);
-    // mTarget.mNodes.shrink_to_fit(); // TODO
+    mTarget.mNodes.ShrinkToFit();
 
     const float millisecondsElapsed = (float)(1000.0 * timer.Stop());
     NFE_LOG_INFO("Finished BVH generation in %.9g ms (num nodes = %u)", millisecondsElapsed, mNumGeneratedNodes.load());
 
+    {
+        BVHOptimizer optimizer(mTarget);
+
+        if (mParams.optimizationTimeBudget > 0.0f && mParams.heuristics == BvhBuildingParams::Heuristics::SurfaceArea)
+        {
+            optimizer.Restructure(mParams.optimizationTimeBudget, mParams.maxOptimizationPasses);
+        }
+
+        if (mParams.reorderNodes)
+        {
+            optimizer.ReorderNodes();
+        }
+    }
+
     outLeavesOrder = mLeavesOrder;
     return true;
 }
@@ -1,6 +1,6 @@
 #pragma once
 
-#include "Raytracer.h"
+#include "../Raytracer.h"
 #include "BVH.h"
 #include "../../Common/Containers/SharedPtr.hpp"
 
@@ -17,10 +17,18 @@ struct BvhBuildingParams
 
     uint32 maxLeafNodeSize = 2; // max number of objects in leaf nodes
     Heuristics heuristics = Heuristics::SurfaceArea;
+
+    // time limit (in seconds) for treelet restructuring after build, zero disables it
+    // NOTE: applies only to surface area heuristics
+    float optimizationTimeBudget = 0.0f;
+    uint32 maxOptimizationPasses = 3;
+
+    // store child pairs of sibling nodes next to each other, so grand-children of a node are prefetched together
+    bool reorderNodes = true;
 };
 
 // helper class for constructing BVH using SAH algorithm
-class BVHBuilder
+class NFE_RAYTRACER_API BVHBuilder
 {
 public:
 
@@ -32,6 +40,7 @@ public:
     void SetLeafData();
 
     // construct the BVH and return new leaves order
+    // NOTE: the build is multithreaded only when called from the main thread
     bool Build(const Math::Box* data, const uint32 numLeaves, const BvhBuildingParams& params, Indices& outLeavesOrder);
 
 private:
@@ -0,0 +1,478 @@
+#include "PCH.h"
+#include "BVHOptimizer.h"
+#include "../Common/System/Thread.hpp"
+#include "../Common/Utils/TaskBuilder.hpp"
+#include "../Common/Utils/Waitable.hpp"
+#include "../Common/Utils/ThreadPool.hpp"
+#include "../Common/Math/Box.hpp"
+#include "../Common/Utils/BitUtils.hpp"
+
+
+namespace NFE {
+namespace RT {
+
+using namespace Common;
+using namespace Math;
+
+namespace {
+
+// SAH cost constants (relative cost of ray-box test and ray-object test)
+static constexpr float NodeCost = 1.2f;
+static constexpr float LeafCost = 1.0f;
+
+// subtrees smaller than this are not split between tasks
+static constexpr uint32 MinSubtreeSizeForSplit = 1000;
+
+// stop optimizing if a pass improves SAH cost by less than this fraction
+static constexpr float MinPassImprovement = 0.001f;
+
+} // namespace
+
+BVHOptimizer::BVHOptimizer(BVH& targetBVH)
+    : mTarget(targetBVH)
+    , mTimeBudget(0.0)
+    , mTimeBudgetExceeded(false)
+    , mNumRestructuredTreelets(0)
+{
+}
+
+void BVHOptimizer::InitNodeInfo(uint32 nodeIndex)
+{
+    const BVH::Node& node = mTarget.mNodes[nodeIndex];
+    if (!node.IsLeaf())
+    {
+        InitNodeInfo(node.childIndex);
+        InitNodeInfo(node.childIndex + 1);
+    }
+
+    UpdateNodeInfo(nodeIndex);
+}
+
+void BVHOptimizer::UpdateNodeInfo(uint32 nodeIndex)
+{
+    const BVH::Node& node = mTarget.mNodes[nodeIndex];
+    const float area = node.GetBox().SurfaceArea();
+
+    NodeInfo& info = mNodeInfos[nodeIndex];
+    if (node.IsLeaf())
+    {
+        info.cost = LeafCost * area * static_cast<float>(node.numLeaves);
+        info.height = 1;
+        info.numLeaves = node.numLeaves;
+    }
+    else
+    {
+        const NodeInfo& infoA = mNodeInfos[node.childIndex];
+        const NodeInfo& infoB = mNodeInfos[node.childIndex + 1];
+        info.cost = NodeCost * area + infoA.cost + infoB.cost;
+        info.height = 1 + Max(infoA.height, infoB.height);
+        info.numLeaves = infoA.numLeaves + infoB.numLeaves;
+    }
+}
+
+bool BVHOptimizer::IsTimeBudgetExceeded()
+{
+    if (mTimeBudgetExceeded.load(std::memory_order_relaxed))
+    {
+        return true;
+    }
+
+    if (mTimer.Stop() > mTimeBudget)
+    {
+        mTimeBudgetExceeded = true;
+        return true;
+    }
+
+    return false;
+}
+
+void BVHOptimizer::Restructure(float timeBudget, uint32 maxPasses)
+{
+    const uint32 numNodes = mTarget.mNumNodes;
+    if (numNodes < 3 || maxPasses == 0 || timeBudget <= 0.0f)
+    {
+        return;
+    }
+
+    mTimer.Start();
+    mTimeBudget = timeBudget;
+    mTimeBudgetExceeded = false;
+    mNumRestructuredTreelets = 0;
+
+    mNodeInfos.Clear();
+    mNodeInfos.Resize(numNodes);
+    InitNodeInfo(0);
+
+    const float initialCost = mNodeInfos.Front().cost;
+
+    uint32 numPasses = 0;
+    while (numPasses < maxPasses && !mTimeBudgetExceeded)
+    {
+        const float passStartCost = mNodeInfos.Front().cost;
+
+        RestructurePass();
+        numPasses++;
+
+        if (mNodeInfos.Front().cost > passStartCost * (1.0f - MinPassImprovement))
+        {
+            break;
+        }
+    }
+
+    // node infos may be stale if the time budget was exceeded in the middle of a pass
+    InitNodeInfo(0);
+
+    NFE_LOG_INFO("BVH restructuring: SAH cost %.6g -> %.6g (%u treelets restructured, %u passes, %.3f ms%s)",
+        initialCost, mNodeInfos.Front().cost, mNumRestructuredTreelets.load(), numPasses, mTimer.Stop() * 1000.0,
+        mTimeBudgetExceeded ? ", time budget exceeded" : "");
+
+    mNodeInfos.Clear();
+}
+
+void BVHOptimizer::RestructurePass()
+{
+    // When called from a worker thread the BVH is processed on the calling thread (see BVHBuilder::Build)
+    if (!Thread::IsMainThread())
+    {
+        RestructureSubtree(0, 0);
+        return;
+    }
+
+    const BVH::Node* nodes = mTarget.mNodes.Data();
+    const uint32 targetNumSubtrees = 8 * ThreadPool::GetInstance().GetNumThreads();
+
+    // split the tree into independent subtrees (processed in parallel) and the top part
+    DynArray<SubtreeRoot> subtrees;
+    DynArray<SubtreeRoot> topNodes;
+    subtrees.PushBack({ 0, 0 });
+    while (subtrees.Size() < targetNumSubtrees)
+    {
+        // split the biggest subtree
+        uint32 subtreeToSplit = UINT32_MAX;
+        uint32 maxNumLeaves = MinSubtreeSizeForSplit;
+        for (uint32 i = 0; i < subtrees.Size(); ++i)
+        {
+            const uint32 numLeaves = mNodeInfos[subtrees[i].node].numLeaves;
+            if (!nodes[subtrees[i].node].IsLeaf() && numLeaves > maxNumLeaves)
+            {
+                subtreeToSplit = i;
+                maxNumLeaves = numLeaves;
+            }
+        }
+
+        if (subtreeToSplit == UINT32_MAX)
+        {
+            break;
+        }
+
+        const SubtreeRoot subtree = subtrees[subtreeToSplit];
+        const uint32 childIndex = nodes[subtree.node].childIndex;
+        topNodes.PushBack(subtree);
+        subtrees[subtreeToSplit] = { childIndex, subtree.depth + 1 };
+        subtrees.PushBack({ childIndex + 1, subtree.depth + 1 });
+    }
+
+    Waitable waitable;
+    {
+        TaskBuilder taskBuilder(waitable);
+        taskBuilder.ParallelFor("BVHOptimizer::Restructure", subtrees.Size(), [this, &subtrees] (const TaskContext&, uint32 index)
+        {
+            RestructureSubtree(subtrees[index].node, subtrees[index].depth);
+        });
+    }
+    waitable.Wait();
+
+    // a node was split only after its parent, so the reversed order is bottom-up
+    for (uint32 i = topNodes.Size(); i-- > 0; )
+    {
+        if (IsTimeBudgetExceeded())
+        {
+            break;
+        }
+
+        UpdateNodeInfo(topNodes[i].node);
+        RestructureTreelet(topNodes[i].node, topNodes[i].depth);
+    }
+}
+
+bool BVHOptimizer::RestructureSubtree(uint32 nodeIndex, uint32 depth)
+{
+    const BVH::Node& node = mTarget.mNodes[nodeIndex];
+    if (node.IsLeaf())
+    {
+        return true;
+    }
+
+    const uint32 childIndex = node.childIndex;
+    if (!RestructureSubtree(childIndex, depth + 1) || !RestructureSubtree(childIndex + 1, depth + 1))
+    {
+        return false;
+    }
+
+    if (IsTimeBudgetExceeded())
+    {
+        return false;
+    }
+
+    UpdateNodeInfo(nodeIndex);
+    RestructureTreelet(nodeIndex, depth);
+    return true;
+}
+
+bool BVHOptimizer::RestructureTreelet(uint32 rootIndex, uint32 depth)
+{
+    BVH::Node* nodes = mTarget.mNodes.Data();
+    BVH::Node& root = nodes[rootIndex];
+    NFE_ASSERT(!root.IsLeaf(), "Treelet root must be an inner node");
+
+    // treelet leaves are nodes, not necessarily BVH leaves
+    uint32 leafIndices[MaxTreeletLeaves];
+    uint32 numLeaves = 2;
+    leafIndices[0] = root.childIndex;
+    leafIndices[1] = root.childIndex + 1;
+
+    // child pairs owned by treelet inner nodes, reused when the treelet is rebuilt
+    uint32 pairIndices[MaxTreeletLeaves - 1];
+    uint32 numPairs = 1;
+    pairIndices[0] = root.childIndex;
+
+    // grow the treelet by expanding the leaf with the largest surface area
+    while (numLeaves < MaxTreeletLeaves)
+    {
+        uint32 leafToExpand = UINT32_MAX;
+        float maxArea = -1.0f;
+        for (uint32 i = 0; i < numLeaves; ++i)
+        {
+            const BVH::Node& node = nodes[leafIndices[i]];
+            if (!node.IsLeaf())
+            {
+                const float area = node.GetBox().SurfaceArea();
+                if (area > maxArea)
+                {
+                    leafToExpand = i;
+                    maxArea = area;
+                }
+            }
+        }
+
+        if (leafToExpand == UINT32_MAX)
+        {
+            break;
+        }
+
+        const uint32 childIndex = nodes[leafIndices[leafToExpand]].childIndex;
+        pairIndices[numPairs++] = childIndex;
+        leafIndices[leafToExpand] = childIndex;
+        leafIndices[numLeaves++] = childIndex + 1;
+    }
+
+    if (numLeaves < 3)
+    {
+        return false;
+    }
+
+    BVH::Node leafNodes[MaxTreeletLeaves];
+    NodeInfo leafInfos[MaxTreeletLeaves];
+    for (uint32 i = 0; i < numLeaves; ++i)
+    {
+        leafNodes[i] = nodes[leafIndices[i]];
+        leafInfos[i] = mNodeInfos[leafIndices[i]];
+    }
+
+    // find optimal partitioning of each subset of treelet leaves (dynamic programming)
+    // NOTE: proper subsets of a set have lower bit masks, so they are processed first
+    constexpr uint32 MaxSubsets = 1u << MaxTreeletLeaves;
+    Box subsetBoxes[MaxSubsets];
+    NodeInfo subsetInfos[MaxSubsets];
+    uint8 subsetPartitions[MaxSubsets];
+
+    const uint32 numSubsets = 1u << numLeaves;
+    for (uint32 subset = 1; subset < numSubsets; ++subset)
+    {
+        const uint32 lowestBit = subset & (0u - subset);
+        const uint32 rest = subset ^ lowestBit;
+        const uint32 lowestLeaf = BitUtils<uint32>::CountTrailingZeros(lowestBit);
+
+        if (rest == 0)
+        {
+            subsetBoxes[subset] = leafNodes[lowestLeaf].GetBox();
+            subsetInfos[subset] = leafInfos[lowestLeaf];
+            subsetPartitions[subset] = 0;
+            continue;
+        }
+
+        subsetBoxes[subset] = Box(subsetBoxes[rest], subsetBoxes[lowestBit]);
+
+        // check all the partitions (the lowest leaf is always on the left side to skip symmetric ones)
+        float bestCost = FLT_MAX;
+        uint32 bestLeft = 0;
+        for (uint32 restPart = (rest - 1) & rest; ; restPart = (restPart - 1) & rest)
+        {
+            const uint32 left = restPart | lowestBit;
+            const uint32 right = subset ^ left;
+            const float cost = subsetInfos[left].cost + subsetInfos[right].cost;
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestLeft = left;
+            }
+
+            if (restPart == 0)
+            {
+                break;
+            }
+        }
+
+        const uint32 bestRight = subset ^ bestLeft;
+        NodeInfo& info = subsetInfos[subset];
+        info.cost = NodeCost * subsetBoxes[subset].SurfaceArea() + bestCost;
+        info.height = 1 + Max(subsetInfos[bestLeft].height, subsetInfos[bestRight].height);
+        info.numLeaves = subsetInfos[bestLeft].numLeaves + subsetInfos[bestRight].numLeaves;
+        subsetPartitions[subset] = static_cast<uint8>(bestLeft);
+    }
+
+    const uint32 fullSet = numSubsets - 1;
+    if (subsetInfos[fullSet].cost >= mNodeInfos[rootIndex].cost * 0.9999f)
+    {
+        return false;
+    }
+
+    // traversal stack size is limited
+    if (depth + subsetInfos[fullSet].height > BVH::MaxDepth)
+    {
+        return false;
+    }
+
+    // rebuild the treelet
+    struct StackEntry
+    {
+        uint32 subset;
+        uint32 nodeIndex;
+    };
+
+    StackEntry stack[2 * MaxTreeletLeaves];
+    uint32 stackSize = 0;
+    uint32 numUsedPairs = 0;
+    stack[stackSize++] = { fullSet, rootIndex };
+
+    while (stackSize > 0)
+    {
+        const StackEntry entry = stack[--stackSize];
+        const uint32 subset = entry.subset;
+
+        if ((subset & (subset - 1)) == 0)
+        {
+            const uint32 leaf = BitUtils<uint32>::CountTrailingZeros(subset);
+            nodes[entry.nodeIndex] = leafNodes[leaf];
+            mNodeInfos[entry.nodeIndex] = leafInfos[leaf];
+            continue;
+        }
+
+        uint32 left = subsetPartitions[subset];
+        uint32 right = subset ^ left;
+
+        // traversal expects the first child to be on the lower side of the split axis
+        const Vec4f centerDiff = (subsetBoxes[right].min + subsetBoxes[right].max) - (subsetBoxes[left].min + subsetBoxes[left].max);
+        const Vec4f centerDist = Vec4f::Abs(centerDiff);
+        uint32 splitAxis = centerDist.x > centerDist.y ? 0 : 1;
+        splitAxis = centerDist.z > centerDist[splitAxis] ? 2 : splitAxis;
+        if (centerDiff[splitAxis] < 0.0f)
+        {
+            std::swap(left, right);
+        }
+
+        NFE_ASSERT(numUsedPairs < numPairs, "Treelet inner nodes count mismatch");
+        const uint32 pairIndex = pairIndices[numUsedPairs++];
+
+        BVH::Node& node = nodes[entry.nodeIndex];
+        node.min = subsetBoxes[subset].min.ToVec3f();
+        node.max = subsetBoxes[subset].max.ToVec3f();
+        node.childIndex = pairIndex;
+        node.numLeaves = 0;
+        node.splitAxis = splitAxis;
+        mNodeInfos[entry.nodeIndex] = subsetInfos[subset];
+
+        stack[stackSize++] = { left, pairIndex };
+        stack[stackSize++] = { right, pairIndex + 1 };
+    }
+
+    NFE_ASSERT(numUsedPairs == numPairs, "Treelet inner nodes count mismatch");
+
+    mNumRestructuredTreelets++;
+    return true;
+}
+
+bool BVHOptimizer::ReorderNodes()
+{
+    NFE_ASSERT(!mTarget.HasMotion(), "Nodes must be reordered before computing motion bounds");
+
+    const uint32 numNodes = mTarget.mNumNodes;
+    if (numNodes < 3)
+    {
+        return true;
+    }
+
+    LargeArray<BVH::Node> newNodes;
+    if (!newNodes.Resize(numNodes))
+    {
+        NFE_LOG_WARNING("Failed to allocate memory for BVH nodes reordering");
+        return false;
+    }
+
+    const BVH::Node* nodes = mTarget.mNodes.Data();
+
+    // root is followed by an unused node, so child pairs are aligned to cache lines
+    newNodes[0] = nodes[0];
+    newNodes[1] = nodes[1];
+    newNodes[0].childIndex = 2;
+    uint32 numNewNodes = 4;
+
+    // sibling pair (old and new index of the first node)
+    struct StackEntry
+    {
+        uint32 oldIndex;
+        uint32 newIndex;
+    };
+
+    DynArray<StackEntry> stack;
+    stack.PushBack({ nodes[0].childIndex, 2 });
+
+    // Child pairs of both siblings are placed next to each other, so all four grand-children of a node
+    // (prefetched together during traversal) occupy two adjacent cache lines.
+    // The pairs are visited in depth-first order, so a subtree is stored in a contiguous block of memory.
+    while (!stack.Empty())
+    {
+        const StackEntry entry = stack.Back();
+        stack.PopBack();
+
+        StackEntry childPairs[2];
+        uint32 numChildPairs = 0;
+
+        for (uint32 i = 0; i < 2; ++i)
+        {
+            BVH::Node& node = newNodes[entry.newIndex + i];
+            node = nodes[entry.oldIndex + i];
+
+            if (!node.IsLeaf())
+            {
+                childPairs[numChildPairs++] = { node.childIndex, numNewNodes };
+                node.childIndex = numNewNodes;
+                numNewNodes += 2;
+            }
+        }
+
+        // visit the first sibling's subtree first
+        while (numChildPairs > 0)
+        {
+            stack.PushBack(childPairs[--numChildPairs]);
+        }
+    }
+
+    NFE_ASSERT(numNewNodes == numNodes, "Some BVH nodes are not reachable");
+
+    mTarget.mNodes = std::move(newNodes);
+    return true;
+}
+
+} // namespace RT
+} // namespace NFE
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "../Raytracer.h"
+#include "BVH.h"
+#include "../../Common/System/Timer.hpp"
+#include "../../Common/Containers/DynArray.hpp"
+
+namespace NFE {
+namespace RT {
+
+// Post-build BVH optimizations:
+// - treelet restructuring, based on "Fast Parallel Construction of High-Quality Bounding Volume Hierarchies" (Karras, Aila):
+//   small treelets are replaced with the topology minimizing SAH cost
+// - node reordering, so all grand-children of a node are stored in two adjacent cache lines
+class NFE_RAYTRACER_API BVHOptimizer
+{
+public:
+    explicit BVHOptimizer(BVH& targetBVH);
+
+    // restructure treelets until there is no improvement, max number of passes is reached or time budget (in seconds) is exceeded
+    void Restructure(float timeBudget, uint32 maxPasses);
+
+    // reorder nodes, so child pairs of sibling nodes are stored next to each other
+    bool ReorderNodes();
+
+private:
+    static constexpr uint32 MaxTreeletLeaves = 7;
+
+    struct NodeInfo
+    {
+        float cost = 0.0f;      // SAH cost of the subtree
+        uint32 height = 0;      // number of levels in the subtree
+        uint32 numLeaves = 0;   // number of objects in the subtree
+    };
+
+    struct SubtreeRoot
+    {
+        uint32 node;
+        uint32 depth;
+    };
+
+    void InitNodeInfo(uint32 nodeIndex);
+    void UpdateNodeInfo(uint32 nodeIndex);
+
+    bool IsTimeBudgetExceeded();
+
+    // restructure a subtree bottom-up, returns false if the time budget was exceeded
+    bool RestructureSubtree(uint32 nodeIndex, uint32 depth);
+
+    // find optimal topology of a treelet rooted in given node, returns true if the treelet was changed
+    bool RestructureTreelet(uint32 rootIndex, uint32 depth);
+
+    void RestructurePass();
+
+    BVH& mTarget;
+    Common::DynArray<NodeInfo> mNodeInfos;
+
+    Common::Timer mTimer;
+    double mTimeBudget;
+    std::atomic<bool> mTimeBudgetExceeded;
+    std::atomic<uint32> mNumRestructuredTreelets;
+};
+
+} // namespace RT
+} // namespace NFE
@@ -26,17 +26,17 @@ struct RayColor
 
     NFE_FORCE_INLINE static const RayColor One()
     {
-#ifdef NFE_ENABLE_SPECTRAL_RENDERING
-        return RayColor{ Math::VECTOR8_ONE };
-#else
-        return RayColor{ Math::VECTOR_ONE };
-#endif
+        return RayColor{ Wavelength::ValueType(1.0f) };
     }
 
     NFE_FORCE_INLINE static const RayColor SingleWavelengthFallback()
     {
 #ifdef NFE_ENABLE_SPECTRAL_RENDERING
+#ifdef NFE_USE_AVX
         return RayColor{ Wavelength::ValueType((float)Wavelength::NumComponents, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f) };
+#else
+        return RayColor{ Wavelength::ValueType((float)Wavelength::NumComponents, 0.0f, 0.0f, 0.0f) };
+#endif // NFE_USE_AVX
 #else
         return RayColor{ Math::VECTOR_ONE };
 #endif
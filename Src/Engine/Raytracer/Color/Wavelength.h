@@ -12,6 +12,7 @@ namespace NFE {
 namespace RT {
 
 // Represents ray wavelength(s), randomized for primary rays
+// In spectral mode every path carries a "hero" wavelength and a few more wavelengths evenly spread across the visible range
 struct Wavelength
 {
     static constexpr float Lower = 0.380e-6f;
@@ -27,6 +28,19 @@ struct Wavelength
     using ValueType = Math::Vec4f;
 #endif // NFE_USE_AVX
 
+    // basis spectra used for RGB to spectrum conversion
+    enum RGBBasis : uint32
+    {
+        RGBBasis_White,
+        RGBBasis_Cyan,
+        RGBBasis_Magenta,
+        RGBBasis_Yellow,
+        RGBBasis_Red,
+        RGBBasis_Green,
+        RGBBasis_Blue,
+        RGBBasis_Count
+    };
+
     // sample tabularized data and return ray color
     const ValueType SampleSpectrum(const float* data, const uint32 numValues) const;
 
@@ -40,6 +54,11 @@ struct Wavelength
     ValueType value;
 
 #ifdef NFE_ENABLE_SPECTRAL_RENDERING
+    // spectra sampled at current wavelengths, cached once per path
+    // NOTE: this way RGB to spectrum conversion and tristimulus resolve cost just a few multiply-adds
+    ValueType rgbBasis[RGBBasis_Count];
+    ValueType xyzWeights[3];
+
     bool isSingle = false;
 #endif
 
@@ -51,10 +70,15 @@ struct Wavelength
         return value[0];
     }
 
-    NFE_FORCE_NOINLINE const ValueType GetInMeters() const
+    NFE_FORCE_INLINE const ValueType GetInMeters() const
     {
-        return ValueType(Lower) + value * (Higher - Lower);
+        return ValueType::MulAndAdd(value, Higher - Lower, ValueType(Lower));
     }
+
+private:
+#ifdef NFE_ENABLE_SPECTRAL_RENDERING
+    void UpdateCachedSpectra();
+#endif // NFE_ENABLE_SPECTRAL_RENDERING
 };
 
 
@@ -10,6 +10,6 @@
 
 #endif // NFE_CONFIGURATION_FINAL
 
-// enables spectral rendering via Monte Carlo wavelength sampling
-// NOTE: this slows down everything significantly
+// enables spectral rendering via hero wavelength sampling
+// NOTE: each path carries 8 (AVX) or 4 (SSE) wavelengths, spectra needed for RGB conversion are cached per path
 // #define NFE_ENABLE_SPECTRAL_RENDERING
@@ -49,6 +49,21 @@ public:
         ReversePdf,
     };
 
+    // concrete BSDF type, used for dispatching calls without going through virtual table (see BSDFDispatch.h)
+    enum class Type : uint8
+    {
+        Unknown,
+        Null,
+        Diffuse,
+        RoughDiffuse,
+        Metal,
+        RoughMetal,
+        Dielectric,
+        RoughDielectric,
+        Plastic,
+        RoughPlastic,
+    };
+
     // If incoming/outgoing direction is at extremely grazing angle, the BSDF will early-return zero value
     // in order to avoid potential divisions by zero.
     static constexpr float CosEpsilon = 1.0e-5f;
@@ -57,8 +72,11 @@ public:
     // If we didn't do this, we would end up with an extremely high values of sampling PDF.
     static constexpr float SpecularEventRoughnessTreshold = 0.005f;
 
+    NFE_FORCE_INLINE explicit BSDF(Type type = Type::Unknown) : mType(type) { }
     virtual ~BSDF() = default;
 
+    NFE_FORCE_INLINE Type GetType() const { return mType; }
+
     struct SamplingContext
     {
         // inputs
@@ -104,6 +122,9 @@ public:
 
     // Compute probability of scaterring event
     virtual float Pdf(const EvaluationContext& ctx, PdfDirection dir = ForwardPdf) const = 0;
+
+private:
+    Type mType;
 };
 
 } // namespace RT
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "NullBSDF.h"
+#include "DiffuseBSDF.h"
+#include "RoughDiffuseBSDF.h"
+#include "MetalBSDF.h"
+#include "RoughMetalBSDF.h"
+#include "DielectricBSDF.h"
+#include "RoughDielectricBSDF.h"
+#include "PlasticBSDF.h"
+#include "RoughPlasticBSDF.h"
+
+namespace NFE {
+namespace RT {
+
+// Call a functor with the BSDF cast to its concrete type.
+// All the built-in BSDF classes are final, so calls made by the functor are bound statically
+// instead of going through virtual table. This avoids indirect branch mispredictions on mixed-material scenes.
+// Unknown BSDF types (e.g. defined outside of the raytracer) fall back to virtual calls.
+template<typename FuncType>
+NFE_FORCE_INLINE auto DispatchBSDF(const BSDF& bsdf, const FuncType& func)
+{
+    switch (bsdf.GetType())
+    {
+    case BSDF::Type::Null:              return func(static_cast<const NullBSDF&>(bsdf));
+    case BSDF::Type::Diffuse:           return func(static_cast<const DiffuseBSDF&>(bsdf));
+    case BSDF::Type::RoughDiffuse:      return func(static_cast<const RoughDiffuseBSDF&>(bsdf));
+    case BSDF::Type::Metal:             return func(static_cast<const MetalBSDF&>(bsdf));
+    case BSDF::Type::RoughMetal:        return func(static_cast<const RoughMetalBSDF&>(bsdf));
+    case BSDF::Type::Dielectric:        return func(static_cast<const DielectricBSDF&>(bsdf));
+    case BSDF::Type::RoughDielectric:   return func(static_cast<const RoughDielectricBSDF&>(bsdf));
+    case BSDF::Type::Plastic:           return func(static_cast<const PlasticBSDF&>(bsdf));
+    case BSDF::Type::RoughPlastic:      return func(static_cast<const RoughPlasticBSDF&>(bsdf));
+    default:                            break;
+    }
+
+    return func(bsdf);
+}
+
+} // namespace RT
+} // namespace NFE
@@ -24,23 +24,15 @@ bool DielectricBSDF::Sample(SamplingContext& ctx) const
 
     float ior = ctx.materialParam.IoR;
 
-    bool fallbackToSingleWavelength = false;
-
     // handle dispersion
+    // NOTE: the hero wavelength drives sampling
 #ifdef NFE_ENABLE_SPECTRAL_RENDERING
-    if (ctx.material.dispersion.enable)
+    const bool isDispersive = ctx.material.dispersion.enable;
+    Wavelength::ValueType dispersiveIoR;
+    if (isDispersive)
     {
-        const float lambda = 1.0e+6f * (Wavelength::Lower + ctx.wavelength.GetBase() * (Wavelength::Higher - Wavelength::Lower));
-        // Cauchy's equation for light dispersion
-        const float lambda2 = lambda * lambda;
-        const float lambda4 = lambda2 * lambda2;
-        ior += ctx.material.dispersion.C / lambda2;
-        ior += ctx.material.dispersion.D / lambda4;
-        if (!ctx.wavelength.isSingle)
-        {
-            fallbackToSingleWavelength = true;
-            ctx.wavelength.isSingle = true;
-        }
+        dispersiveIoR = ctx.material.dispersion.Evaluate(ctx.wavelength, ior);
+        ior = dispersiveIoR[0];
     }
 #endif // NFE_ENABLE_SPECTRAL_RENDERING
 
@@ -84,6 +76,18 @@ bool DielectricBSDF::Sample(SamplingContext& ctx) const
         {
             ctx.outColor *= F / reflectionProbability;
         }
+
+#ifdef NFE_ENABLE_SPECTRAL_RENDERING
+        if (isDispersive && !ctx.wavelength.isSingle)
+        {
+            // reflection direction does not depend on wavelength, so all the wavelengths survive
+            // with their own Fresnel term
+            for (uint32 i = 0; i < Wavelength::NumComponents; ++i)
+            {
+                ctx.outColor.value[i] = FresnelDielectric(NdotV, dispersiveIoR[i]) / reflectionProbability;
+            }
+        }
+#endif // NFE_ENABLE_SPECTRAL_RENDERING
     }
     else
     {
@@ -94,12 +98,15 @@ bool DielectricBSDF::Sample(SamplingContext& ctx) const
         {
             ctx.outColor *= (1.0f - F) / refractionProbability;
         }
-    }
 
-    if (fallbackToSingleWavelength)
-    {
-        // in case of wavelength-dependent event, switch to single wavelength per ray
-        ctx.outColor *= RayColor::SingleWavelengthFallback();
+#ifdef NFE_ENABLE_SPECTRAL_RENDERING
+        if (isDispersive && !ctx.wavelength.isSingle)
+        {
+            // refraction direction is valid only for the hero wavelength, switch to single wavelength per ray
+            ctx.wavelength.isSingle = true;
+            ctx.outColor *= RayColor::SingleWavelengthFallback();
+        }
+#endif // NFE_ENABLE_SPECTRAL_RENDERING
     }
 
     return true;
@@ -6,11 +6,13 @@ namespace NFE {
 namespace RT {
 
 // Smooth transparent dielectic BSDF (e.g. polished glass or surface of water).
-class DielectricBSDF : public BSDF
+class DielectricBSDF final : public BSDF
 {
     NFE_DECLARE_POLYMORPHIC_CLASS(DielectricBSDF)
 
 public:
+    NFE_FORCE_INLINE DielectricBSDF() : BSDF(Type::Dielectric) { }
+
     virtual const char* GetShortName() const override { return "dielectric"; }
     virtual bool IsDelta() const override { return true; }
     virtual bool Sample(SamplingContext& ctx) const override;
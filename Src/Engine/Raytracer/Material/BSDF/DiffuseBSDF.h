@@ -6,11 +6,13 @@ namespace NFE {
 namespace RT {
 
 // simplest Lambertian diffuse
-class DiffuseBSDF : public BSDF
+class DiffuseBSDF final : public BSDF
 {
     NFE_DECLARE_POLYMORPHIC_CLASS(DiffuseBSDF)
 
 public:
+    NFE_FORCE_INLINE DiffuseBSDF() : BSDF(Type::Diffuse) { }
+
     virtual const char* GetShortName() const override { return "diffuse"; }
     virtual bool IsDelta() const override { return false; }
     virtual bool Sample(SamplingContext& ctx) const override;
@@ -6,11 +6,13 @@ namespace NFE {
 namespace RT {
 
 // Smooth metal (conductor) BRDF.
-class MetalBSDF : public BSDF
+class MetalBSDF final : public BSDF
 {
     NFE_DECLARE_POLYMORPHIC_CLASS(MetalBSDF)
 
 public:
+    NFE_FORCE_INLINE MetalBSDF() : BSDF(Type::Metal) { }
+
     virtual const char* GetShortName() const override { return "metal"; }
     virtual bool IsDelta() const override { return true; }
     virtual bool Sample(SamplingContext& ctx) const override;
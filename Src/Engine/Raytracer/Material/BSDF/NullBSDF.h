@@ -6,11 +6,13 @@ namespace NFE {
 namespace RT {
 
 // BSDF that absorbs all the light
-class NullBSDF : public BSDF
+class NullBSDF final : public BSDF
 {
     NFE_DECLARE_POLYMORPHIC_CLASS(NullBSDF)
 
 public:
+    NFE_FORCE_INLINE NullBSDF() : BSDF(Type::Null) { }
+
     virtual const char* GetShortName() const override { return "null"; }
     virtual bool IsDelta() const override { return false; }
     virtual bool Sample(SamplingContext& ctx) const override;
@@ -6,11 +6,13 @@ namespace NFE {
 namespace RT {
 
 // Smooth plastic-like BSDF
-class PlasticBSDF : public BSDF
+class PlasticBSDF final : public BSDF
 {
     NFE_DECLARE_POLYMORPHIC_CLASS(PlasticBSDF)
 
 public:
+    NFE_FORCE_INLINE PlasticBSDF() : BSDF(Type::Plastic) { }
+
     virtual const char* GetShortName() const override { return "plastic"; }
     virtual bool IsDelta() const override { return false; }
     virtual bool Sample(SamplingContext& ctx) const override;
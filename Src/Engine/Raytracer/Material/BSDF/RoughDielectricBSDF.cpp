@@ -24,27 +24,6 @@ bool RoughDielectricBSDF::Sample(SamplingContext& ctx) const
         return false;
     }
 
-    float ior = ctx.materialParam.IoR;
-    bool fallbackToSingleWavelength = false;
-
-    // handle dispersion
-#ifdef NFE_ENABLE_SPECTRAL_RENDERING
-    if (ctx.material.dispersion.enable)
-    {
-        const float lambda = 1.0e+6f * (Wavelength::Lower + ctx.wavelength.GetBase() * (Wavelength::Higher - Wavelength::Lower));
-        // Cauchy's equation for light dispersion
-        const float lambda2 = lambda * lambda;
-        const float lambda4 = lambda2 * lambda2;
-        ior += ctx.material.dispersion.C / lambda2;
-        ior += ctx.material.dispersion.D / lambda4;
-        if (!ctx.wavelength.isSingle)
-        {
-            fallbackToSingleWavelength = true;
-            ctx.wavelength.isSingle = true;
-        }
-    }
-#endif // NFE_ENABLE_SPECTRAL_RENDERING
-
     const float roughness = ctx.materialParam.roughness;
 
     // fallback to specular event
@@ -53,6 +32,20 @@ bool RoughDielectricBSDF::Sample(SamplingContext& ctx) const
         return DielectricBSDF().Sample(ctx);
     }
 
+    float ior = ctx.materialParam.IoR;
+
+    // handle dispersion
+    // NOTE: the hero wavelength drives sampling
+#ifdef NFE_ENABLE_SPECTRAL_RENDERING
+    const bool isDispersive = ctx.material.dispersion.enable;
+    Wavelength::ValueType dispersiveIoR;
+    if (isDispersive)
+    {
+        dispersiveIoR = ctx.material.dispersion.Evaluate(ctx.wavelength, ior);
+        ior = dispersiveIoR[0];
+    }
+#endif // NFE_ENABLE_SPECTRAL_RENDERING
+
     const Vec3f u = ctx.sampler.GetVec3f();
 
     // microfacet normal (aka. half vector)
@@ -94,6 +87,20 @@ bool RoughDielectricBSDF::Sample(SamplingContext& ctx) const
     {
         ctx.outPdf = F * microfacetPdf / (4.0f * Abs(VdotH));
         // Note: reflection is white for dielectrics
+
+#ifdef NFE_ENABLE_SPECTRAL_RENDERING
+        if (isDispersive && !ctx.wavelength.isSingle)
+        {
+            // reflection direction does not depend on wavelength, so all the wavelengths survive
+            // reweighted by their own Fresnel term (the event was chosen according to the hero's one)
+            RayColor fresnel;
+            for (uint32 i = 0; i < Wavelength::NumComponents; ++i)
+            {
+                fresnel.value[i] = FresnelDielectric(VdotH, dispersiveIoR[i]);
+            }
+            ctx.outColor *= fresnel / F;
+        }
+#endif // NFE_ENABLE_SPECTRAL_RENDERING
     }
     else
     {
@@ -106,12 +113,15 @@ bool RoughDielectricBSDF::Sample(SamplingContext& ctx) const
         //{
         //    ctx.outColor *= Sqr(eta);
         //}
-    }
 
-    if (fallbackToSingleWavelength)
-    {
-        // in case of wavelength-dependent event, switch to single wavelength per ray
-        ctx.outColor *= RayColor::SingleWavelengthFallback();
+#ifdef NFE_ENABLE_SPECTRAL_RENDERING
+        if (isDispersive && !ctx.wavelength.isSingle)
+        {
+            // refraction direction is valid only for the hero wavelength, switch to single wavelength per ray
+            ctx.wavelength.isSingle = true;
+            ctx.outColor *= RayColor::SingleWavelengthFallback();
+        }
+#endif // NFE_ENABLE_SPECTRAL_RENDERING
     }
 
     return true;
@@ -6,11 +6,13 @@ namespace NFE {
 namespace RT {
 
 // Rough transparent dielectic BSDF (e.g. ground glass).
-class RoughDielectricBSDF : public BSDF
+class RoughDielectricBSDF final : public BSDF
 {
     NFE_DECLARE_POLYMORPHIC_CLASS(RoughDielectricBSDF)
 
 public:
+    NFE_FORCE_INLINE RoughDielectricBSDF() : BSDF(Type::RoughDielectric) { }
+
     virtual const char* GetShortName() const override { return "roughDielectric"; }
     virtual bool IsDelta() const override { return false; } // TODO depends on material
     virtual bool Sample(SamplingContext& ctx) const override;
@@ -5,11 +5,13 @@
 namespace NFE {
 namespace RT {
 
-class RoughDiffuseBSDF : public BSDF
+class RoughDiffuseBSDF final : public BSDF
 {
     NFE_DECLARE_POLYMORPHIC_CLASS(RoughDiffuseBSDF)
 
 public:
+    NFE_FORCE_INLINE RoughDiffuseBSDF() : BSDF(Type::RoughDiffuse) { }
+
     virtual const char* GetShortName() const override { return "roughDiffuse"; }
     virtual bool IsDelta() const override { return false; }
     virtual bool Sample(SamplingContext& ctx) const override;
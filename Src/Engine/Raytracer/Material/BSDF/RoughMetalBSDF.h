@@ -6,11 +6,13 @@ namespace NFE {
 namespace RT {
 
 // Rough metal (conductor) BRDF.
-class RoughMetalBSDF : public BSDF
+class RoughMetalBSDF final : public BSDF
 {
     NFE_DECLARE_POLYMORPHIC_CLASS(RoughMetalBSDF)
 
 public:
+    NFE_FORCE_INLINE RoughMetalBSDF() : BSDF(Type::RoughMetal) { }
+
     virtual const char* GetShortName() const override { return "roughMetal"; }
     virtual bool IsDelta() const override { return false; } // TODO depends on material
     virtual bool Sample(SamplingContext& ctx) const override;
@@ -6,11 +6,13 @@ namespace NFE {
 namespace RT {
 
 // Rough plastic-like BSDF
-class RoughPlasticBSDF : public BSDF
+class RoughPlasticBSDF final : public BSDF
 {
     NFE_DECLARE_POLYMORPHIC_CLASS(RoughPlasticBSDF)
 
 public:
+    NFE_FORCE_INLINE RoughPlasticBSDF() : BSDF(Type::RoughPlastic) { }
+
     virtual const char* GetShortName() const override { return "roughPlastic"; }
     virtual bool IsDelta() const override { return false; }
     virtual bool Sample(SamplingContext& ctx) const override;
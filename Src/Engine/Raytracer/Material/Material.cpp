@@ -1,8 +1,11 @@
 #include "PCH.h"
 #include "Material.h"
+#include "BSDF/BSDFDispatch.h"
 #include "../Common/Math/HdrColor.hpp"
 #include "../Common/Math/Utils.hpp"
 #include "../Common/Reflection/ReflectionClassDefine.hpp"
+#include "../Common/Reflection/Types/ReflectionSharedPtrType.hpp"
+#include "../Common/Reflection/Types/ReflectionStringType.hpp"
 
 
 NFE_DEFINE_CLASS(NFE::RT::DispersionParams)
@@ -13,8 +16,9 @@ NFE_DEFINE_CLASS(NFE::RT::DispersionParams)
 }
 NFE_END_DEFINE_CLASS()
 
-NFE_DEFINE_CLASS(NFE::RT::Material)
+NFE_DEFINE_POLYMORPHIC_CLASS(NFE::RT::Material)
 {
+    NFE_CLASS_MEMBER(debugName);
     NFE_CLASS_MEMBER(mBSDF).Name("BSDF").NonNull();
     NFE_CLASS_MEMBER(emission);
     NFE_CLASS_MEMBER(baseColor);
@@ -25,6 +29,8 @@ NFE_DEFINE_CLASS(NFE::RT::Material)
     NFE_CLASS_MEMBER(K).Name("Extinction coefficient").Min(0.01f).Max(10.0f);
     NFE_CLASS_MEMBER(normalMapStrength).Min(0.0f).Max(5.0f);
     NFE_CLASS_MEMBER(dispersion);
+    NFE_CLASS_MEMBER(maskMap);
+    NFE_CLASS_MEMBER(normalMap);
 }
 NFE_END_DEFINE_CLASS()
 
@@ -44,6 +50,35 @@ DispersionParams::DispersionParams()
     D = 0.0f;
 }
 
+#ifdef NFE_ENABLE_SPECTRAL_RENDERING
+
+const Wavelength::ValueType DispersionParams::Evaluate(const Wavelength& wavelength, float baseIoR) const
+{
+    const Wavelength::ValueType lambda = wavelength.GetInMeters() * 1.0e+6f;
+    const Wavelength::ValueType invLambda2 = Wavelength::ValueType(1.0f) / (lambda * lambda);
+
+    // ior = baseIoR + C / lambda^2 + D / lambda^4
+    const Wavelength::ValueType dispersion = Wavelength::ValueType::MulAndAdd(invLambda2, D, Wavelength::ValueType(C));
+    return Wavelength::ValueType::MulAndAdd(invLambda2, dispersion, Wavelength::ValueType(baseIoR));
+}
+
+// vectorized version of FresnelMetal
+static NFE_FORCE_INLINE const Wavelength::ValueType EvaluateFresnelMetal(const float NdV, const Wavelength::ValueType& eta, const Wavelength::ValueType& k)
+{
+    using ValueType = Wavelength::ValueType;
+
+    const ValueType NdV2(NdV * NdV);
+    const ValueType one(1.0f);
+    const ValueType a = ValueType::MulAndAdd(eta, eta, k * k);
+    const ValueType b = a * NdV2;
+    const ValueType twoEtaNdV = eta * (2.0f * NdV);
+    const ValueType rs = (b - twoEtaNdV + one) / (b + twoEtaNdV + one);
+    const ValueType rp = (a - twoEtaNdV + NdV2) / (a + twoEtaNdV + NdV2);
+    return (rs + rp) * 0.5f;
+}
+
+#endif // NFE_ENABLE_SPECTRAL_RENDERING
+
 Material::Material(const char* debugName)
     : debugName(debugName)
     , baseColor(Math::HdrColorRGB(0.7f, 0.7f, 0.7f))
@@ -145,6 +180,16 @@ void Material::SetBsdf(const StringView& bsdfName)
         */
 
         mIorLookupTable.Init(ArrayView<const float>(wavelengths, lutSize), ArrayView<const Vec2f>(ior, lutSize));
+
+#ifdef NFE_ENABLE_SPECTRAL_RENDERING
+        for (uint32 i = 0; i < NumIorSpectrumSamples; ++i)
+        {
+            const float u = static_cast<float>(i) / static_cast<float>(NumIorSpectrumSamples - 1);
+            const Vec2f value = mIorLookupTable.Sample(1.0e+6f * (Wavelength::Lower + u * (Wavelength::Higher - Wavelength::Lower)));
+            mIorSpectrumEta[i] = value.x;
+            mIorSpectrumK[i] = value.y;
+        }
+#endif // NFE_ENABLE_SPECTRAL_RENDERING
     }
 
     DynArray<const RTTI::ClassType*> types;
@@ -231,16 +276,9 @@ const RayColor Material::EvaluateMetalFresnel(float NdotV, const Wavelength& wav
 {
 #ifdef NFE_ENABLE_SPECTRAL_RENDERING
 
-    RayColor F = RayColor::Zero();
-    const auto wavelengthInMeters = wavelength.GetInMeters();
-
-    for (uint32 i = 0; i < Wavelength::NumComponents; ++i)
-    {
-        const Vec2f ior = mIorLookupTable.Sample(wavelengthInMeters[i] * 1.0e+6f);
-        F.value[i] = FresnelMetal(NdotV, ior.x, ior.y);
-    }
-
-    return F;
+    const Wavelength::ValueType eta = wavelength.SampleSpectrum(mIorSpectrumEta, NumIorSpectrumSamples);
+    const Wavelength::ValueType k = wavelength.SampleSpectrum(mIorSpectrumK, NumIorSpectrumSamples);
+    return RayColor(EvaluateFresnelMetal(NdotV, eta, k));
 
 #else // !NFE_ENABLE_SPECTRAL_RENDERING
 
@@ -265,6 +303,46 @@ void Material::EvaluateShadingData(const Wavelength& wavelength, ShadingData& sh
     shadingData.materialParams.IoR = IoR;
 }
 
+void Material::EvaluateShadingData(const Wavelength& wavelength, ShadingData* shadingData, uint32 count) const
+{
+    constexpr uint32 BatchSize = 8;
+
+    RayColor baseColors[BatchSize];
+    RayColor emissionColors[BatchSize];
+
+    for (uint32 first = 0; first < count; first += BatchSize)
+    {
+        ShadingData* batch = shadingData + first;
+        const uint32 batchSize = Min(BatchSize, count - first);
+
+        // unused lanes replicate the last point
+        Vec4f texCoords[BatchSize];
+        for (uint32 i = 0; i < BatchSize; ++i)
+        {
+            texCoords[i] = batch[Min(i, batchSize - 1)].intersection.texCoord;
+        }
+
+        const Vec2x8f uv(texCoords[0], texCoords[1], texCoords[2], texCoords[3], texCoords[4], texCoords[5], texCoords[6], texCoords[7]);
+
+        baseColor.Evaluate(uv, wavelength, baseColors);
+        emission.Evaluate(uv, wavelength, emissionColors);
+        const Vec8f roughnessValues = roughness.Evaluate(uv);
+        const Vec8f roughnessAnisotropyValues = roughnessAnisotropy.Evaluate(uv);
+        const Vec8f metalnessValues = metalness.Evaluate(uv);
+
+        for (uint32 i = 0; i < batchSize; ++i)
+        {
+            SampledMaterialParameters& params = batch[i].materialParams;
+            params.baseColor = baseColors[i];
+            params.emissionColor = emissionColors[i];
+            params.roughness = roughnessValues[i];
+            params.roughnessAnisotropy = roughnessAnisotropyValues[i];
+            params.metalness = metalnessValues[i];
+            params.IoR = IoR;
+        }
+    }
+}
+
 const RayColor Material::Evaluate(
     ISampler& sampler,
     const Wavelength& wavelength,
@@ -290,7 +368,10 @@ const RayColor Material::Evaluate(
         incomingDirLocalSpace
     };
 
-    return mBSDF->Evaluate(evalContext, outPdfW, outReversePdfW);
+    return DispatchBSDF(*mBSDF, [&](const auto& bsdf)
+    {
+        return bsdf.Evaluate(evalContext, outPdfW, outReversePdfW);
+    });
 }
 
 const RayColor Material::Sample(
@@ -312,7 +393,12 @@ const RayColor Material::Sample(
 
     // BSDF sampling (in local space)
     // TODO don't compute PDF if not requested
-    if (!mBSDF || !mBSDF->Sample(samplingContext))
+    const bool sampled = mBSDF && DispatchBSDF(*mBSDF, [&](const auto& bsdf)
+    {
+        return bsdf.Sample(samplingContext);
+    });
+
+    if (!sampled)
     {
         if (outSampledEvent)
         {
@@ -11,6 +11,7 @@
 #include "../../Common/Containers/SharedPtr.hpp"
 #include "../../Common/Memory/Aligned.hpp"
 #include "../../Common/Reflection/ReflectionClassDeclare.hpp"
+#include "../../Common/Reflection/Object.hpp"
 #include "../../Common/Reflection/Types/ReflectionUniquePtrType.hpp"
 
 namespace NFE {
@@ -27,14 +28,19 @@ public:
     float D;
 
     DispersionParams();
+
+#ifdef NFE_ENABLE_SPECTRAL_RENDERING
+    // compute index of refraction for all the ray's wavelengths (Cauchy's equation)
+    const Wavelength::ValueType Evaluate(const Wavelength& wavelength, float baseIoR) const;
+#endif // NFE_ENABLE_SPECTRAL_RENDERING
 };
 
 using MaterialPtr = Common::SharedPtr<Material>;
 
 // simple PBR material
-class NFE_ALIGN(16) Material
+class NFE_ALIGN(16) Material : public IObject
 {
-    NFE_DECLARE_CLASS(Material)
+    NFE_DECLARE_POLYMORPHIC_CLASS(Material)
 
 public:
     NFE_ALIGNED_CLASS(16)
@@ -106,6 +112,10 @@ public:
 
     void EvaluateShadingData(const Wavelength& wavelength, ShadingData& shadingData) const;
 
+    // batched variant of EvaluateShadingData() for multiple shading points using this material
+    // NOTE: parameter textures are evaluated for 8 points at a time
+    void EvaluateShadingData(const Wavelength& wavelength, ShadingData* shadingData, uint32 count) const;
+
     // sample material's BSDFs
     const RayColor Sample(
         Wavelength& wavelength,
@@ -129,6 +139,13 @@ private:
     Material& operator = (const Material&) = delete;
 
     Common::UniquePtr<BSDF> mBSDF;
+
+#ifdef NFE_ENABLE_SPECTRAL_RENDERING
+    // IoR lookup table resampled uniformly over the visible range, so it can be sampled for all wavelengths at once
+    static constexpr uint32 NumIorSpectrumSamples = 32;
+    float mIorSpectrumEta[NumIorSpectrumSamples] = {};
+    float mIorSpectrumK[NumIorSpectrumSamples] = {};
+#endif // NFE_ENABLE_SPECTRAL_RENDERING
 };
 
 } // namespace RT
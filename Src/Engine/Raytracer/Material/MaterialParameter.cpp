@@ -8,7 +8,7 @@
 NFE_DEFINE_CLASS(NFE::RT::MaterialParameter)
 {
     NFE_CLASS_MEMBER(baseValue).Min(0.0f).Max(1.0f);
-    // TODO texture
+    NFE_CLASS_MEMBER(texture);
 }
 NFE_END_DEFINE_CLASS()
 
@@ -68,5 +68,27 @@ const RayColor ColorMaterialParameter::Evaluate(const Vec4f& uv, const Wavelengt
     return color;
 }
 
+void ColorMaterialParameter::Evaluate(const Vec2x8f& uv, const Wavelength& wavelength, RayColor* outColors) const
+{
+    const RayColor color = mBaseValue->Resolve(wavelength);
+
+    if (!mTexture)
+    {
+        for (uint32 i = 0; i < 8u; ++i)
+        {
+            outColors[i] = color;
+        }
+        return;
+    }
+
+    Vec4f textureColors[8];
+    mTexture->Evaluate(uv).Unpack(textureColors);
+
+    for (uint32 i = 0; i < 8u; ++i)
+    {
+        outColors[i] = color * RayColor::ResolveRGB(wavelength, Vec4f::Max(Vec4f::Zero(), textureColors[i]));
+    }
+}
+
 } // namespace RT
 } // namespace NFE
@@ -33,6 +33,17 @@ public:
 
         return value;
     };
+
+    // evaluate for 8 points at once
+    NFE_FORCE_INLINE const Math::Vec8f Evaluate(const Math::Vec2x8f& uv) const
+    {
+        if (texture)
+        {
+            return texture->Evaluate(uv).x * baseValue;
+        }
+
+        return Math::Vec8f(baseValue);
+    }
 };
 
 class ColorMaterialParameter
@@ -50,8 +61,13 @@ public:
     NFE_RAYTRACER_API void SetBaseValue(const ColorPtr& baseValueColor);
     NFE_RAYTRACER_API void SetTexture(const TexturePtr& texture);
 
+    NFE_FORCE_INLINE const ITexture* GetTexture() const { return mTexture.Get(); }
+
     const RayColor Evaluate(const Math::Vec4f& uv, const Wavelength& wavelength) const;
 
+    // evaluate for 8 points at once
+    void Evaluate(const Math::Vec2x8f& uv, const Wavelength& wavelength, RayColor* outColors) const;
+
 private:
 
     ColorPtr mBaseValue;
@@ -4,6 +4,7 @@
 #include "../Rendering/RenderingContext.h"
 #include "../Textures/Texture.h"
 #include "../Textures/ConstTexture.h"
+#include "../Utils/MajorantGrid.h"
 #include "../Common/Math/Transcendental.hpp"
 #include "../Common/Reflection/ReflectionClassDefine.hpp"
 #include "../Common/Reflection/Types/ReflectionUniquePtrType.hpp"
@@ -196,6 +197,24 @@ HeterogeneousAbsorptiveMedium::HeterogeneousAbsorptiveMedium(const TexturePtr& d
     mInvMaxExctinction = 1.0f / Max(mExctinctionCoeff.r, mExctinctionCoeff.g, mExctinctionCoeff.b);
 }
 
+bool HeterogeneousAbsorptiveMedium::OnPropertyChanged(const Common::StringView propertyName)
+{
+    if (propertyName == "mExctinctionCoeff")
+    {
+        mInvMaxExctinction = 1.0f / Max(mExctinctionCoeff.r, mExctinctionCoeff.g, mExctinctionCoeff.b);
+        return true;
+    }
+
+    return IMedium::OnPropertyChanged(propertyName);
+}
+
+void HeterogeneousAbsorptiveMedium::OnDeserialized()
+{
+    IMedium::OnDeserialized();
+
+    mInvMaxExctinction = 1.0f / Max(mExctinctionCoeff.r, mExctinctionCoeff.g, mExctinctionCoeff.b);
+}
+
 const RayColor HeterogeneousAbsorptiveMedium::Sample(const Ray& ray, float minDistance, float maxDistance, MediumScatteringEvent& outScatteringEvent, RenderingContext& ctx) const
 {
     if (maxDistance > FLT_MAX)
@@ -223,23 +242,47 @@ const RayColor HeterogeneousAbsorptiveMedium::Transmittance(const Vec4f& startPo
     if (distance > FLT_EPSILON)
     {
         dir /= distance;
-        float t = 0.0f;
 
-        const Vec4f scaledExctinctionCoeff = mExctinctionCoeff.ToVec4f() * mInvMaxExctinction;
+        const Vec4f exctinctionCoeff = mExctinctionCoeff.ToVec4f();
 
-        // ratio tracking
-        for (;;)
+        // ratio tracking within a segment of constant majorant
+        const auto trackSegment = [&](float minT, float maxT, float maxDensity)
         {
-            const float u = ctx.randomGenerator.GetFloat();
-            t -= Log(1.0f - u) * mInvMaxExctinction;
-            if (t >= distance)
+            if (maxDensity <= 0.0f)
+            {
+                // empty space
+                return true;
+            }
+
+            const float invMajorant = mInvMaxExctinction / maxDensity;
+            const Vec4f scaledExctinctionCoeff = exctinctionCoeff * invMajorant;
+
+            float t = minT;
+            for (;;)
             {
-                break;
+                const float u = ctx.randomGenerator.GetFloat();
+                t -= Log(1.0f - u) * invMajorant;
+                if (t >= maxT)
+                {
+                    break;
+                }
+
+                const Vec4f p = startPoint + dir * t;
+                const Vec4f density = mDensityTexture->Evaluate(p);
+                transmittance *= Vec4f::Max(Vec4f::Zero(), Vec4f(1.0f) - scaledExctinctionCoeff * density);
             }
 
-            const Vec4f p = startPoint + dir * t;
-            const Vec4f density = mDensityTexture->Evaluate(p);
-            transmittance *= Vec4f(1.0f) - scaledExctinctionCoeff * density;
+            return true;
+        };
+
+        if (const MajorantGrid* majorantGrid = mDensityTexture->GetMajorantGrid())
+        {
+            majorantGrid->Traverse(startPoint, dir, 0.0f, distance, trackSegment);
+        }
+        else
+        {
+            // no majorant grid, assume density is bounded by 1.0
+            trackSegment(0.0f, distance, 1.0f);
         }
     }
 
@@ -338,28 +381,56 @@ const RayColor HeterogeneousScatteringMedium::Sample(const Ray& ray, float minDi
 
     if (maxDistance < FLT_MAX) // TODO
     {
-        const float invMaxDensity = 1.0f;
+        const float invExctinction = 1.0f / mExctinctionCoeff.Luminance();
+        bool scattered = false;
 
-        float t = minDistance;
-        while (true)
+        // delta tracking within a segment of constant majorant
+        const auto trackSegment = [&](float minT, float maxT, float maxDensity)
         {
-            const Vec4f u = ctx.randomGenerator.GetVec4f();
-
-            t -= Log(1.0f - u.x) * invMaxDensity / mExctinctionCoeff.Luminance();
-            if (t >= maxDistance)
+            if (maxDensity <= 0.0f)
             {
-                break;
+                // empty space
+                return true;
             }
 
-            const Vec4f p = ray.GetAtDistance(t);
-            const Vec4f density = mDensityTexture->Evaluate(p);
-            if (density.x * invMaxDensity > u.y) // TODO non-monochromatic density
-            {
-                mPhaseFunction->Sample(-ray.dir, outScatteringEvent.direction, Vec2f(u.z, u.w));
-                outScatteringEvent.distance = t;
+            const float invMaxDensity = 1.0f / maxDensity;
 
-                return RayColor::ResolveRGB(ctx.wavelength, mScatteringAlbedo);
+            float t = minT;
+            for (;;)
+            {
+                const Vec4f u = ctx.randomGenerator.GetVec4f();
+
+                t -= Log(1.0f - u.x) * invMaxDensity * invExctinction;
+                if (t >= maxT)
+                {
+                    return true;
+                }
+
+                const Vec4f p = ray.GetAtDistance(t);
+                const Vec4f density = mDensityTexture->Evaluate(p);
+                if (density.x * invMaxDensity > u.y) // TODO non-monochromatic density
+                {
+                    mPhaseFunction->Sample(-ray.dir, outScatteringEvent.direction, Vec2f(u.z, u.w));
+                    outScatteringEvent.distance = t;
+                    scattered = true;
+                    return false;
+                }
             }
+        };
+
+        if (const MajorantGrid* majorantGrid = mDensityTexture->GetMajorantGrid())
+        {
+            majorantGrid->Traverse(ray.origin, ray.dir, minDistance, maxDistance, trackSegment);
+        }
+        else
+        {
+            // no majorant grid, assume density is bounded by 1.0
+            trackSegment(minDistance, maxDistance, 1.0f);
+        }
+
+        if (scattered)
+        {
+            return RayColor::ResolveRGB(ctx.wavelength, mScatteringAlbedo);
         }
     }
 
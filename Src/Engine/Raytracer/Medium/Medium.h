@@ -91,6 +91,9 @@ public:
     NFE_RAYTRACER_API virtual const RayColor Sample(const Math::Ray& ray, float minDistance, float maxDistance, MediumScatteringEvent& outScatteringEvent, RenderingContext& context) const override;
     NFE_RAYTRACER_API virtual const RayColor Transmittance(const Math::Vec4f& startPoint, const Math::Vec4f& endPoint, RenderingContext& context) const override;
 
+    virtual bool OnPropertyChanged(const Common::StringView propertyName) override;
+    virtual void OnDeserialized() override;
+
 protected:
 
     TexturePtr mDensityTexture;
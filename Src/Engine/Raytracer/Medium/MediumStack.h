@@ -0,0 +1,115 @@
+#pragma once
+
+#include "../Raytracer.h"
+
+namespace NFE {
+namespace RT {
+
+// medium overlapping a ray segment (see Scene::GetMediaAlongRay)
+struct MediumInterval
+{
+    const IMedium* medium = nullptr;
+    float minDistance = 0.0f;
+    float maxDistance = 0.0f;
+};
+
+// Media containing current path vertex, the innermost medium is on the top.
+// Updated on medium boundaries crossing, so the scene does not need to be queried for each path segment.
+class MediumStack
+{
+public:
+    static constexpr uint32 MaxSize = 8;
+
+    NFE_FORCE_INLINE void Clear()
+    {
+        mSize = 0;
+    }
+
+    NFE_FORCE_INLINE bool Empty() const
+    {
+        return mSize == 0;
+    }
+
+    NFE_FORCE_INLINE uint32 Size() const
+    {
+        return mSize;
+    }
+
+    // get current (innermost) medium
+    NFE_FORCE_INLINE const IMedium* Top() const
+    {
+        return mSize > 0 ? mMedia[mSize - 1] : nullptr;
+    }
+
+    // enter a medium, returns false if the stack is full
+    NFE_FORCE_INLINE bool Push(const IMedium* medium)
+    {
+        if (mSize >= MaxSize)
+        {
+            return false;
+        }
+
+        mMedia[mSize++] = medium;
+        return true;
+    }
+
+    // exit a medium
+    // NOTE: overlapping media can be exited in different order than entered, so the medium is not necessarily on the top
+    NFE_FORCE_INLINE void Pop(const IMedium* medium)
+    {
+        for (uint32 i = mSize; i-- > 0; )
+        {
+            if (mMedia[i] == medium)
+            {
+                for (uint32 j = i + 1; j < mSize; ++j)
+                {
+                    mMedia[j - 1] = mMedia[j];
+                }
+                mSize--;
+                return;
+            }
+        }
+    }
+
+    // update the stack after crossing ray segment [0, segmentLength]
+    // intervals must be sorted by entry distance (as returned by Scene::GetMediaAlongRay)
+    // media exited within the segment are removed, media entered within the segment and not exited are pushed in entry order
+    void Cross(const MediumInterval* intervals, const uint32 numIntervals, const float segmentLength)
+    {
+        for (uint32 i = 0; i < numIntervals; ++i)
+        {
+            if (intervals[i].maxDistance < segmentLength)
+            {
+                Pop(intervals[i].medium);
+            }
+        }
+
+        for (uint32 i = 0; i < numIntervals; ++i)
+        {
+            if (intervals[i].minDistance > 0.0f && intervals[i].maxDistance >= segmentLength)
+            {
+                Push(intervals[i].medium);
+            }
+        }
+    }
+
+    // find interval of a given medium (nullptr if the medium does not overlap the segment)
+    NFE_FORCE_INLINE static const MediumInterval* FindInterval(const MediumInterval* intervals, const uint32 numIntervals, const IMedium* medium)
+    {
+        for (uint32 i = 0; i < numIntervals; ++i)
+        {
+            if (intervals[i].medium == medium)
+            {
+                return intervals + i;
+            }
+        }
+        return nullptr;
+    }
+
+private:
+    const IMedium* mMedia[MaxSize];
+    uint32 mSize = 0;
+};
+
+} // namespace RT
+} // namespace NFE
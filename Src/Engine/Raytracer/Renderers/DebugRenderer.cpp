@@ -43,6 +43,16 @@ namespace RT {
 
 using namespace Math;
 
+namespace {
+
+// only modes that read material or texture data benefit from coherent shading order
+bool UsesMaterialData(DebugRenderingMode mode)
+{
+    return mode >= DebugRenderingMode::BaseColor && mode <= DebugRenderingMode::IoR;
+}
+
+} // namespace
+
 DebugRenderer::DebugRenderer()
     : renderingMode(DebugRenderingMode::BaseColor)
 {
@@ -212,89 +222,95 @@ void DebugRenderer::Raytrace_Packet(RayPacket& packet, const RenderParam& param,
 {
     param.scene.Traverse({ packet, context });
 
+    // shade hit points grouped by texture/material/object instead of ray order
+    // NOTE: geometry-only modes (depth, normals, etc.) don't touch materials, so sorting would be a pure overhead
+    const bool sortHitPoints = UsesMaterialData(renderingMode);
+    if (sortHitPoints)
+    {
+        param.scene.SortHitPoints(context, packet.numRays);
+    }
+
     ShadingData shadingData;
 
-    const uint32 numGroups = packet.GetNumGroups();
-    for (uint32 i = 0; i < numGroups; ++i)
+    for (uint32 i = 0; i < packet.numRays; ++i)
     {
-        Vec4f weights[RayPacket::GroupSize];
-        packet.rayWeights[i].Unpack(weights);
+        const uint32 rayIndex = sortHitPoints ? context.sortedHitPoints[i] : i;
+        const uint32 groupIndex = rayIndex / RayPacket::GroupSize;
+        const uint32 laneIndex = rayIndex % RayPacket::GroupSize;
 
-        Vec4f rayOrigins[RayPacket::GroupSize];
-        Vec4f rayDirs[RayPacket::GroupSize];
-        packet.groups[i].rays[0].origin.Unpack(rayOrigins);
-        packet.groups[i].rays[0].dir.Unpack(rayDirs);
+        const HitPoint& hitPoint = context.hitPoints[rayIndex];
+        const RayPacketTypes::Ray& simdRay = packet.groups[groupIndex].rays[0];
+        const RayPacketTypes::Vec3f& simdWeight = packet.rayWeights[groupIndex];
 
-        for (uint32 j = 0; j < RayPacket::GroupSize; ++j)
-        {
-            const HitPoint& hitPoint = context.hitPoints[RayPacket::GroupSize * i + j];
+        const Vec4f rayOrigin(simdRay.origin.x[laneIndex], simdRay.origin.y[laneIndex], simdRay.origin.z[laneIndex]);
+        const Vec4f rayDir(simdRay.dir.x[laneIndex], simdRay.dir.y[laneIndex], simdRay.dir.z[laneIndex]);
+        const Vec4f weight(simdWeight.x[laneIndex], simdWeight.y[laneIndex], simdWeight.z[laneIndex]);
 
-            Vec4f color = Vec4f::Zero();
+        Vec4f color = Vec4f::Zero();
 
-            if (hitPoint.distance != FLT_MAX)
+        if (hitPoint.distance != FLT_MAX)
+        {
+            if (renderingMode != DebugRenderingMode::TriangleID && renderingMode != DebugRenderingMode::Depth)
             {
-                if (renderingMode != DebugRenderingMode::TriangleID && renderingMode != DebugRenderingMode::Depth)
+                param.scene.EvaluateIntersection(Ray(rayOrigin, rayDir), hitPoint, context.time, shadingData.intersection);
+            }
+
+            switch (renderingMode)
+            {
+                case DebugRenderingMode::CameraLight:
                 {
-                    param.scene.EvaluateIntersection(Ray(rayOrigins[j], rayDirs[j]), hitPoint, context.time, shadingData.intersection);
+                    const float NdotL = Vec4f::Dot3(rayDir, shadingData.intersection.frame[2]);
+                    color = Vec4f(Abs(NdotL)); // TODO use texture
+                    break;
                 }
 
-                switch (renderingMode)
+                case DebugRenderingMode::Depth:
                 {
-                    case DebugRenderingMode::CameraLight:
-                    {
-                        const float NdotL = Vec4f::Dot3(rayDirs[j], shadingData.intersection.frame[2]);
-                        color = Vec4f(Abs(NdotL)); // TODO use texture
-                        break;
-                    }
-
-                    case DebugRenderingMode::Depth:
-                    {
-                        const float logDepth = std::max<float>(0.0f, (log2f(hitPoint.distance) + 5.0f) / 10.0f);
-                        color = Vec4f(logDepth);
-                        break;
-                    }
-                    case DebugRenderingMode::Tangents:
-                    {
-                        color = BipolarToUnipolar(shadingData.intersection.frame[0]);
-                        break;
-                    }
-                    case DebugRenderingMode::Bitangents:
-                    {
-                        color = BipolarToUnipolar(shadingData.intersection.frame[1]);
-                        break;
-                    }
-                    case DebugRenderingMode::Normals:
-                    {
-                        color = BipolarToUnipolar(shadingData.intersection.frame[2]);
-                        break;
-                    }
-                    case DebugRenderingMode::Position:
-                    {
-                        color = BipolarToUnipolar(shadingData.intersection.frame.GetTranslation());
-                        break;
-                    }
-                    case DebugRenderingMode::TexCoords:
-                    {
-                        color = BipolarToUnipolar(shadingData.intersection.texCoord);
-                        break;
-                    }
-                    case DebugRenderingMode::TriangleID:
-                    {
-                        const uint64 hash = Hash((uint64)hitPoint.objectId | ((uint64)hitPoint.subObjectId << 32));
-                        const float hue = (float)(uint32)hash / (float)UINT32_MAX;
-                        const float saturation = 0.5f + 0.5f * (float)(uint32)(hash >> 32) / (float)UINT32_MAX;
-                        color = weights[j] * HSVtoRGB(hue, saturation, 1.0f);
-                        break;
-                    }
+                    const float logDepth = std::max<float>(0.0f, (log2f(hitPoint.distance) + 5.0f) / 10.0f);
+                    color = Vec4f(logDepth);
+                    break;
+                }
+                case DebugRenderingMode::Tangents:
+                {
+                    color = BipolarToUnipolar(shadingData.intersection.frame[0]);
+                    break;
+                }
+                case DebugRenderingMode::Bitangents:
+                {
+                    color = BipolarToUnipolar(shadingData.intersection.frame[1]);
+                    break;
+                }
+                case DebugRenderingMode::Normals:
+                {
+                    color = BipolarToUnipolar(shadingData.intersection.frame[2]);
+                    break;
+                }
+                case DebugRenderingMode::Position:
+                {
+                    color = BipolarToUnipolar(shadingData.intersection.frame.GetTranslation());
+                    break;
+                }
+                case DebugRenderingMode::TexCoords:
+                {
+                    color = BipolarToUnipolar(shadingData.intersection.texCoord);
+                    break;
+                }
+                case DebugRenderingMode::TriangleID:
+                {
+                    const uint64 hash = Hash((uint64)hitPoint.objectId | ((uint64)hitPoint.subObjectId << 32));
+                    const float hue = (float)(uint32)hash / (float)UINT32_MAX;
+                    const float saturation = 0.5f + 0.5f * (float)(uint32)(hash >> 32) / (float)UINT32_MAX;
+                    color = weight * HSVtoRGB(hue, saturation, 1.0f);
+                    break;
                 }
             }
+        }
 
-            // clamp color
-            color = Vec4f::Max(Vec4f::Zero(), color);
+        // clamp color
+        color = Vec4f::Max(Vec4f::Zero(), color);
 
-            const ImageLocationInfo& imageLocation = packet.imageLocations[RayPacket::GroupSize * i + j];
-            param.film.AccumulateColor(imageLocation.x, imageLocation.y, color);
-        }
+        const ImageLocationInfo& imageLocation = packet.imageLocations[rayIndex];
+        param.film.AccumulateColor(imageLocation.x, imageLocation.y, color);
     }
 }
 
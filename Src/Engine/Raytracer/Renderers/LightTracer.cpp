@@ -147,7 +147,7 @@ const RayColor LightTracer::RenderPixel(const Ray&, const RenderParam& param, Re
 
                     const Ray shadowRay(samplePos + shadingData.intersection.frame[2] * 0.0001f, dirToCamera);
 
-                    if (!param.scene.Traverse_Shadow({ shadowRay, shadowHitPoint, ctx }))
+                    if (!param.scene.Traverse_Shadow({ shadowRay, shadowHitPoint, ctx }, &param.camera))
                     {
                         const float cameraPdfA = param.camera.PdfW(-dirToCamera) / cameraDistanceSqr;
                         const RayColor contribution = (cameraFactor * throughput) * cameraPdfA;
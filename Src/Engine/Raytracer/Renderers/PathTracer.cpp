@@ -10,6 +10,7 @@
 #include "Scene/Object/SceneObject_Shape.h"
 #include "Medium/Medium.h"
 #include "Material/Material.h"
+#include "Rendering/Film.h"
 #include "Traversal/TraversalContext.h"
 #include "Sampling/GenericSampler.h"
 #include "../Common/Reflection/ReflectionUtils.hpp"
@@ -75,7 +76,111 @@ const RayColor PathTracer::EvaluateGlobalLights(const Scene& scene, const Ray& r
     return result;
 }
 
+namespace {
+
+const Ray GetPacketRay(const RayPacket& packet, const uint32 rayIndex)
+{
+    const uint32 groupIndex = rayIndex / RayPacket::GroupSize;
+    const uint32 laneIndex = rayIndex % RayPacket::GroupSize;
+    const RayPacketTypes::Ray& simdRay = packet.groups[groupIndex].rays[0];
+
+    const Vec4f rayOrigin(simdRay.origin.x[laneIndex], simdRay.origin.y[laneIndex], simdRay.origin.z[laneIndex]);
+    const Vec4f rayDir(simdRay.dir.x[laneIndex], simdRay.dir.y[laneIndex], simdRay.dir.z[laneIndex]);
+    return Ray(rayOrigin, rayDir);
+}
+
+} // namespace
+
 const RayColor PathTracer::RenderPixel(const Math::Ray& primaryRay, const RenderParam& param, RenderingContext& context) const
+{
+    return TracePath(primaryRay, nullptr, nullptr, param, context);
+}
+
+void PathTracer::Raytrace_Packet(RayPacket& packet, const RenderParam& param, RenderingContext& context) const
+{
+    param.scene.Traverse({ packet, context });
+
+    // shade hit points grouped by texture/material/object instead of ray order
+    const uint32 numHits = param.scene.SortHitPoints(context, packet.numRays);
+
+    // primary hits are shaded in batches of consecutive hit points sharing the same material,
+    // so material parameters can be evaluated for multiple points at once
+    constexpr uint32 MaxBatchSize = 8;
+    ShadingData batch[MaxBatchSize];
+    uint32 batchRayIndices[MaxBatchSize];
+    uint32 batchSize = 0;
+
+    const auto flushBatch = [&]()
+    {
+        param.scene.EvaluateShadingData(batch, batchSize, context);
+
+        for (uint32 i = 0; i < batchSize; ++i)
+        {
+            TracePacketRay(packet, batchRayIndices[i], batch + i, param, context);
+        }
+
+        batchSize = 0;
+    };
+
+    ShadingData shadingData;
+
+    for (uint32 i = 0; i < numHits; ++i)
+    {
+        const uint32 rayIndex = context.sortedHitPoints[i];
+        const HitPoint& hitPoint = context.hitPoints[rayIndex];
+
+        const Ray ray = GetPacketRay(packet, rayIndex);
+        param.scene.EvaluateIntersection(ray, hitPoint, context.time, shadingData.intersection);
+        shadingData.outgoingDirWorldSpace = -ray.dir;
+
+        if (batchSize > 0 && batch[0].intersection.material != shadingData.intersection.material)
+        {
+            flushBatch();
+        }
+
+        batch[batchSize] = shadingData;
+        batchRayIndices[batchSize] = rayIndex;
+
+        if (++batchSize == MaxBatchSize)
+        {
+            flushBatch();
+        }
+    }
+
+    flushBatch();
+
+    // misses are placed after the hits
+    for (uint32 i = numHits; i < packet.numRays; ++i)
+    {
+        TracePacketRay(packet, context.sortedHitPoints[i], nullptr, param, context);
+    }
+}
+
+void PathTracer::TracePacketRay(const RayPacket& packet, const uint32 rayIndex, const ShadingData* primaryShadingData, const RenderParam& param, RenderingContext& context) const
+{
+    const ImageLocationInfo& imageLocation = packet.imageLocations[rayIndex];
+
+    // packet traversal marks misses with FLT_MAX distance
+    HitPoint primaryHitPoint = context.hitPoints[rayIndex];
+    if (primaryHitPoint.distance == FLT_MAX)
+    {
+        primaryHitPoint.Reset();
+    }
+
+    const uint32 groupIndex = rayIndex / RayPacket::GroupSize;
+    const uint32 laneIndex = rayIndex % RayPacket::GroupSize;
+    const RayPacketTypes::Vec3f& simdWeight = packet.rayWeights[groupIndex];
+    const Vec4f weight(simdWeight.x[laneIndex], simdWeight.y[laneIndex], simdWeight.z[laneIndex]);
+
+    context.sampler.ResetPixel(imageLocation.x, imageLocation.y);
+
+    const RayColor color = TracePath(GetPacketRay(packet, rayIndex), &primaryHitPoint, primaryShadingData, param, context);
+    NFE_ASSERT(color.IsValid(), "");
+
+    param.film.AccumulateColor(imageLocation.x, imageLocation.y, weight * color.ConvertToTristimulus(context.wavelength));
+}
+
+const RayColor PathTracer::TracePath(const Math::Ray& primaryRay, const HitPoint* primaryHitPoint, const ShadingData* primaryShadingData, const RenderParam& param, RenderingContext& context) const
 {
     HitPoint hitPoint;
     Ray ray = primaryRay;
@@ -90,7 +195,11 @@ const RayColor PathTracer::RenderPixel(const Math::Ray& primaryRay, const Render
     uint32 depth = 0;
 
     const ISceneObject* sceneObject = nullptr;
-    const IMedium* currentMedium = param.scene.GetMediumAtPoint(context, primaryRay.origin);
+
+    // media are looked up only once, then tracked on boundaries crossing
+    MediumStack mediumStack;
+    param.scene.GetMediaAtPoint(context, primaryRay, mediumStack);
+    const IMedium* currentMedium = mediumStack.Top();
 
 #ifndef NFE_CONFIGURATION_FINAL
     const auto reportHitPoint = [&]()
@@ -110,15 +219,32 @@ const RayColor PathTracer::RenderPixel(const Math::Ray& primaryRay, const Render
 
     for (;;)
     {
-        hitPoint.Reset();
-        //hitPoint.distance = HitPoint::DefaultDistance;
-        param.scene.Traverse({ ray, hitPoint, context });
+        // primary ray may be already traversed and shaded (packet rendering)
+        const bool isPrimaryHitKnown = depth == 0 && primaryHitPoint;
+
+        if (isPrimaryHitKnown)
+        {
+            hitPoint = *primaryHitPoint;
+        }
+        else
+        {
+            hitPoint.Reset();
+            param.scene.Traverse({ ray, hitPoint, context });
+        }
 
-        // sample medium first
+        // sample medium first (only the part of the segment overlapped by the medium)
+        MediumInterval mediumIntervals[MediumStack::MaxSize];
+        const MediumInterval* mediumInterval = nullptr;
         if (currentMedium)
+        {
+            const uint32 numMediumIntervals = param.scene.GetMediaAlongRay(context, ray, hitPoint.distance, mediumIntervals, MediumStack::MaxSize);
+            mediumInterval = MediumStack::FindInterval(mediumIntervals, numMediumIntervals, currentMedium);
+        }
+
+        if (mediumInterval)
         {
             MediumScatteringEvent event;
-            const RayColor mediumWeight = currentMedium->Sample(ray, 0.0f, hitPoint.distance, event, context);
+            const RayColor mediumWeight = currentMedium->Sample(ray, mediumInterval->minDistance, mediumInterval->maxDistance, event, context);
             NFE_ASSERT(mediumWeight.IsValid(), "");
 
             // HACK
@@ -166,8 +292,16 @@ const RayColor PathTracer::RenderPixel(const Math::Ray& primaryRay, const Render
         NFE_ASSERT(sceneObject, "");
 
         // fill up structure with shading data
-        param.scene.EvaluateIntersection(ray, hitPoint, context.time, shadingData.intersection);
-        shadingData.outgoingDirWorldSpace = -ray.dir;
+        if (isPrimaryHitKnown)
+        {
+            NFE_ASSERT(primaryShadingData, "Missing shading data of primary hit");
+            shadingData = *primaryShadingData;
+        }
+        else
+        {
+            param.scene.EvaluateIntersection(ray, hitPoint, context.time, shadingData.intersection);
+            shadingData.outgoingDirWorldSpace = -ray.dir;
+        }
 
         // handle medium transition
         if (const ShapeSceneObject* shapeObject = RTTI::Cast<ShapeSceneObject>(sceneObject))
@@ -176,21 +310,20 @@ const RayColor PathTracer::RenderPixel(const Math::Ray& primaryRay, const Render
             
             if (!shapeObject->GetMaterial())
             {
-                const bool enter = Vec4f::Dot3(ray.dir, shadingData.intersection.frame[2]) < 0.0f;
-
-                if (enter)
-                {
-                    currentMedium = newMedium;
+                // TODO get rid of the offset - use ray filters instead
+                const float crossedDistance = hitPoint.distance + 0.001f;
 
-                }
-                else
+                if (newMedium)
                 {
-                    // TODO pop medium from stack
-                    currentMedium = nullptr;
+                    // coincident boundaries of other media may be crossed at once, so all the media along the segment are checked
+                    MediumInterval crossedIntervals[MediumStack::MaxSize];
+                    const uint32 numCrossedIntervals = param.scene.GetMediaAlongRay(context, ray, crossedDistance, crossedIntervals, MediumStack::MaxSize);
+                    mediumStack.Cross(crossedIntervals, numCrossedIntervals, crossedDistance);
                 }
 
-                // TODO get rid of the offset - use ray filters instead
-                ray.origin = ray.GetAtDistance(hitPoint.distance + 0.001f);
+                currentMedium = mediumStack.Top();
+
+                ray.origin = ray.GetAtDistance(crossedDistance);
                 depth++;
                 continue;
             }
@@ -207,7 +340,10 @@ const RayColor PathTracer::RenderPixel(const Math::Ray& primaryRay, const Render
             break;
         }
 
-        param.scene.EvaluateShadingData(shadingData, context);
+        if (!isPrimaryHitKnown)
+        {
+            param.scene.EvaluateShadingData(shadingData, context);
+        }
 
         // accumulate emission color
         NFE_ASSERT(shadingData.materialParams.emissionColor.IsValid(), "");
@@ -16,9 +16,17 @@ public:
     PathTracer();
 
     virtual const RayColor RenderPixel(const Math::Ray& ray, const RenderParam& param, RenderingContext& ctx) const override;
+    virtual void Raytrace_Packet(RayPacket& packet, const RenderParam& param, RenderingContext& context) const override;
 
 private:
 
+    // trace whole path starting with a primary ray
+    // if primary hit point is provided, the primary ray is not traversed, and shading data of the hit (if any) is already evaluated
+    const RayColor TracePath(const Math::Ray& primaryRay, const HitPoint* primaryHitPoint, const ShadingData* primaryShadingData, const RenderParam& param, RenderingContext& context) const;
+
+    // trace path for a single ray of a traversed packet and accumulate its color
+    void TracePacketRay(const RayPacket& packet, const uint32 rayIndex, const ShadingData* primaryShadingData, const RenderParam& param, RenderingContext& context) const;
+
     // compute radiance from a hit local lights
     const RayColor EvaluateLight(const LightSceneObject* lightObject, const Math::Ray& ray, const IntersectionData& intersection, RenderingContext& context) const;
 
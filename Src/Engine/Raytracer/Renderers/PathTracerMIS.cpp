@@ -7,6 +7,7 @@
 #include "Scene/Light/Light.h"
 #include "Scene/Object/SceneObject_Light.h"
 #include "Scene/Object/SceneObject_Shape.h"
+#include "Medium/Medium.h"
 #include "Material/Material.h"
 #include "Traversal/TraversalContext.h"
 #include "Sampling/GenericSampler.h"
@@ -41,6 +42,20 @@ NFE_FORCE_INLINE static float PdfAtoW(const float pdfA, const float distance, co
     return FastDivide(pdfA * Sqr(distance), Abs(cosThere));
 }
 
+// compute transmittance of a medium along a ray segment [0, maxDistance]
+static const RayColor EvaluateMediumTransmittance(const Scene& scene, const IMedium* medium, const Ray& ray, float maxDistance, RenderingContext& context)
+{
+    MediumInterval intervals[MediumStack::MaxSize];
+    const uint32 numIntervals = scene.GetMediaAlongRay(context, ray, maxDistance, intervals, MediumStack::MaxSize);
+
+    if (const MediumInterval* interval = MediumStack::FindInterval(intervals, numIntervals, medium))
+    {
+        return medium->Transmittance(ray.GetAtDistance(interval->minDistance), ray.GetAtDistance(interval->maxDistance), context);
+    }
+
+    return RayColor::One();
+}
+
 PathTracerMIS::PathTracerMIS()
     : lightSamplingWeight(LdrColorRGB::White())
     , BSDFSamplingWeight(LdrColorRGB::White())
@@ -88,6 +103,8 @@ const RayColor PathTracerMIS::SampleLight(const Scene& scene, const HitPoint& hi
 
     NFE_ASSERT(bsdfPdfW >= 0.0f && IsValid(bsdfPdfW), "");
 
+    RayColor transmittance = RayColor::One();
+
     // cast shadow ray
     {
         HitPoint shadowHitPoint;
@@ -102,7 +119,7 @@ const RayColor PathTracerMIS::SampleLight(const Scene& scene, const HitPoint& hi
             shadowRay.origin += shadowRay.dir * SecondaryRayOffset;
 
             context.counters.numShadowRays++;
-            if (scene.Traverse_Shadow({ shadowRay, shadowHitPoint, context }))
+            if (scene.Traverse_Shadow({ shadowRay, shadowHitPoint, context }, &light))
             {
                 // shadow ray missed the light - light is occluded
                 return RayColor::Zero();
@@ -111,6 +128,12 @@ const RayColor PathTracerMIS::SampleLight(const Scene& scene, const HitPoint& hi
             {
                 context.counters.numShadowRaysHit++;
             }
+
+            // unoccluded shadow ray does not cross any medium boundary, so it's attenuated by the current medium only
+            if (pathState.medium)
+            {
+                transmittance = EvaluateMediumTransmittance(scene, pathState.medium, shadowRay, shadowHitPoint.distance, context);
+            }
         }
     }
 
@@ -130,7 +153,7 @@ const RayColor PathTracerMIS::SampleLight(const Scene& scene, const HitPoint& hi
         weight = CombineMis(illuminateResult.directPdfW * lightPickProbability, bsdfPdfW);
     }
 
-    const RayColor result = (radiance * factor) * FastDivide(weight, lightPickProbability * illuminateResult.directPdfW);
+    const RayColor result = (radiance * factor * transmittance) * FastDivide(weight, lightPickProbability * illuminateResult.directPdfW);
     NFE_ASSERT(result.IsValid(), "");
 
     return result;
@@ -287,7 +310,12 @@ const RayColor PathTracerMIS::RenderPixel(const Math::Ray& primaryRay, const Ren
     PathState pathState;
 
     const ISceneObject* sceneObject = nullptr;
-    const IMedium* currentMedium = param.scene.GetMediumAtPoint(context, primaryRay.origin);
+
+    // media are looked up only once, then tracked on boundaries crossing
+    MediumStack mediumStack;
+    param.scene.GetMediaAtPoint(context, primaryRay, mediumStack);
+    const IMedium* currentMedium = mediumStack.Top();
+    pathState.medium = currentMedium;
 
     const float lightPickProbability = GetLightPickingProbability(param.scene, context);
 
@@ -313,6 +341,19 @@ const RayColor PathTracerMIS::RenderPixel(const Math::Ray& primaryRay, const Ren
         //hitPoint.distance = HitPoint::DefaultDistance;
         param.scene.Traverse({ ray, hitPoint, context });
 
+        // attenuate by the medium (only the part of the segment overlapped by the medium)
+        if (currentMedium)
+        {
+            throughput *= EvaluateMediumTransmittance(param.scene, currentMedium, ray, hitPoint.distance, context);
+            NFE_ASSERT(throughput.IsValid(), "");
+
+            if (throughput.AlmostZero())
+            {
+                pathTerminationReason = PathTerminationReason::AttenuatedInMedium;
+                break;
+            }
+        }
+
         // ray missed - return background light color
         if (hitPoint.distance == HitPoint::DefaultDistance)
         {
@@ -351,21 +392,21 @@ const RayColor PathTracerMIS::RenderPixel(const Math::Ray& primaryRay, const Ren
 
             if (!shapeObject->GetMaterial())
             {
-                const bool enter = Vec4f::Dot3(ray.dir, shadingData.intersection.frame[2]) < 0.0f;
-
-                if (enter)
-                {
-                    currentMedium = newMedium;
+                // TODO get rid of the offset - use ray filters instead
+                const float crossedDistance = hitPoint.distance + 0.001f;
 
-                }
-                else
+                if (newMedium)
                 {
-                    // TODO pop medium from stack
-                    currentMedium = nullptr;
+                    // coincident boundaries of other media may be crossed at once, so all the media along the segment are checked
+                    MediumInterval crossedIntervals[MediumStack::MaxSize];
+                    const uint32 numCrossedIntervals = param.scene.GetMediaAlongRay(context, ray, crossedDistance, crossedIntervals, MediumStack::MaxSize);
+                    mediumStack.Cross(crossedIntervals, numCrossedIntervals, crossedDistance);
                 }
 
-                // TODO get rid of the offset - use ray filters instead
-                ray.origin = ray.GetAtDistance(hitPoint.distance + 0.001f);
+                currentMedium = mediumStack.Top();
+                pathState.medium = currentMedium;
+
+                ray.origin = ray.GetAtDistance(crossedDistance);
                 pathState.depth++;
                 continue;
             }
@@ -26,6 +26,7 @@ private:
         uint32 depth = 0u;
         float lastPdfW = 1.0f;
         bool lastSpecular = true;
+        const IMedium* medium = nullptr;    // medium containing the current path vertex
     };
 
     float GetLightPickingProbability(const Scene& scene, RenderingContext& context) const;
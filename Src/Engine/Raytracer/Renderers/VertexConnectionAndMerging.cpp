@@ -178,7 +178,17 @@ void VertexConnectionAndMerging::PreRender(Common::TaskBuilder& builder, const R
         }
 
         // prepare for merge
-        mPhotons.Resize_SkipConstructor(mPhotonCountPrefixSum.Back());
+        if (!mPhotons.Resize(mPhotonCountPrefixSum.Back()))
+        {
+            // drop photons of this iteration
+            NFE_LOG_ERROR("VCM: Failed to allocate photons buffer");
+            for (uint32 i = 0; i < contexts.Size(); ++i)
+            {
+                static_cast<VertexConnectionAndMergingContext*>(contexts[i].rendererContext.Get())->photons.Clear();
+                mPhotonCountPrefixSum[i] = 0;
+            }
+            mPhotons.Clear();
+        }
 
         // merge photon lists from all thread contexts
         builder.ParallelFor("VCM/CopyPhotons", contexts.Size(), [this, contexts] (const TaskContext&, uint32 index)
@@ -187,8 +197,11 @@ void VertexConnectionAndMerging::PreRender(Common::TaskBuilder& builder, const R
             VertexConnectionAndMergingContext& rendererContext = *static_cast<VertexConnectionAndMergingContext*>(ctx.rendererContext.Get());
 
             const uint32 numPhotonsToAdd = rendererContext.photons.Size();
-            const uint32 offset = mPhotonCountPrefixSum[index] - numPhotonsToAdd;
-            memcpy(mPhotons.Data() + offset, rendererContext.photons.Data(), numPhotonsToAdd * sizeof(Photon));
+            if (numPhotonsToAdd > 0)
+            {
+                const uint32 offset = mPhotonCountPrefixSum[index] - numPhotonsToAdd;
+                memcpy(mPhotons.Data() + offset, rendererContext.photons.Data(), numPhotonsToAdd * sizeof(Photon));
+            }
 
             rendererContext.photons.Clear();
         });
@@ -709,7 +722,7 @@ const RayColor VertexConnectionAndMerging::SampleLight(const Scene& scene, const
             Ray shadowRay(shadingData.intersection.frame.GetTranslation(), illuminateResult.directionToLight);
             shadowRay.origin += shadowRay.dir * SecondaryRayOffset;
 
-            if (scene.Traverse_Shadow({ shadowRay, hitPoint, ctx }))
+            if (scene.Traverse_Shadow({ shadowRay, hitPoint, ctx }, &light))
             {
                 // shadow ray missed the light - light is occluded
                 return RayColor::Zero();
@@ -819,7 +832,8 @@ const RayColor VertexConnectionAndMerging::ConnectVertices(const Scene& scene, P
             Ray shadowRay(shadingData.intersection.frame.GetTranslation(), lightDir);
             shadowRay.origin += shadowRay.dir * SecondaryRayOffset;
 
-            if (scene.Traverse_Shadow({ shadowRay, hitPoint, ctx }))
+            // consecutive camera vertices are connected to the same light vertices
+            if (scene.Traverse_Shadow({ shadowRay, hitPoint, ctx }, &lightVertex))
             {
                 // line between vertices is occluded by other geometry
                 return RayColor::Zero();
@@ -973,7 +987,7 @@ void VertexConnectionAndMerging::ConnectToCamera(const RenderParam& renderParams
         Ray shadowRay(samplePos, dirToCamera);
         shadowRay.origin += shadowRay.dir * SecondaryRayOffset;
 
-        if (renderParams.scene.Traverse_Shadow({ shadowRay, shadowHitPoint, ctx }))
+        if (renderParams.scene.Traverse_Shadow({ shadowRay, shadowHitPoint, ctx }, &renderParams.camera))
         {
             // vertex is occluded
             return;
@@ -162,7 +162,7 @@ private:
 #endif // NFE_VCM_USE_KD_TREE
 
     // list of all recorded light photons
-    Common::DynArray<Photon> mPhotons;
+    LargeArray<Photon> mPhotons;
 
     // summed counts of photons from each thread context
     Common::DynArray<uint32> mPhotonCountPrefixSum;
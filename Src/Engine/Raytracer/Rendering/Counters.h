@@ -40,6 +40,8 @@ struct RayTracingCounters
     uint64 numShadowRays;
     uint64 numShadowRaysHit;
     uint64 numPrimaryRays;
+    uint64 numOccluderCacheTests;   // shadow rays tested against cached occluder
+    uint64 numOccluderCacheHits;    // shadow rays occluded by cached occluder
 
 #ifdef NFE_ENABLE_INTERSECTION_COUNTERS
     uint64 numRayBoxTests;
@@ -55,6 +57,8 @@ struct RayTracingCounters
         numShadowRays = 0;
         numShadowRaysHit = 0;
         numPrimaryRays = 0;
+        numOccluderCacheTests = 0;
+        numOccluderCacheHits = 0;
 
 #ifdef NFE_ENABLE_INTERSECTION_COUNTERS
         numRayBoxTests = 0;
@@ -83,6 +87,8 @@ struct RayTracingCounters
         numShadowRays += other.numShadowRays;
         numShadowRaysHit += other.numShadowRaysHit;
         numPrimaryRays += other.numPrimaryRays;
+        numOccluderCacheTests += other.numOccluderCacheTests;
+        numOccluderCacheHits += other.numOccluderCacheHits;
 
 #ifdef NFE_ENABLE_INTERSECTION_COUNTERS
         numRayBoxTests += other.numRayBoxTests;
@@ -0,0 +1,90 @@
+#include "PCH.h"
+#include "NumaBlockQueue.h"
+
+namespace NFE {
+namespace RT {
+
+using namespace Common;
+
+void NumaBlockQueue::Init(const ArrayView<const Block> blocks, uint32 imageHeight, uint32 numNodes)
+{
+    NFE_ASSERT(numNodes > 0, "Invalid number of NUMA nodes");
+
+    // band of a block is determined by its first row
+    const auto getBlockNode = [imageHeight, numNodes](const Block& block)
+    {
+        const uint64 node = static_cast<uint64>(block.minY) * numNodes / Math::Max(1u, imageHeight);
+        return Math::Min(static_cast<uint32>(node), numNodes - 1u);
+    };
+
+    mNodeOffsets.Clear();
+    mNodeOffsets.Resize(numNodes + 1, 0u);
+    for (const Block& block : blocks)
+    {
+        mNodeOffsets[getBlockNode(block) + 1]++;
+    }
+    for (uint32 i = 0; i < numNodes; ++i)
+    {
+        mNodeOffsets[i + 1] += mNodeOffsets[i];
+    }
+
+    // counting sort, keeps order of blocks within a node
+    DynArray<uint32> positions;
+    positions.Resize(numNodes);
+    for (uint32 i = 0; i < numNodes; ++i)
+    {
+        positions[i] = mNodeOffsets[i];
+    }
+
+    mBlocks.Resize(blocks.Size());
+    for (const Block& block : blocks)
+    {
+        mBlocks[positions[getBlockNode(block)]++] = block;
+    }
+
+    if (mNumNodes != numNodes)
+    {
+        mNodeCounters = MakeUniquePtr<NodeCounter[]>(numNodes);
+        mNumNodes = numNodes;
+    }
+
+    Reset();
+}
+
+void NumaBlockQueue::Reset()
+{
+    for (uint32 i = 0; i < mNumNodes; ++i)
+    {
+        mNodeCounters[i].value = 0;
+    }
+}
+
+bool NumaBlockQueue::Pop(uint32 node, Block& outBlock)
+{
+    for (uint32 i = 0; i < mNumNodes; ++i)
+    {
+        const uint32 targetNode = (node + i) % mNumNodes;
+        const uint32 firstBlock = mNodeOffsets[targetNode];
+        const uint32 numBlocks = mNodeOffsets[targetNode + 1] - firstBlock;
+
+        std::atomic<uint32>& counter = mNodeCounters[targetNode].value;
+
+        // don't bump counters of exhausted nodes
+        if (counter.load(std::memory_order_relaxed) >= numBlocks)
+        {
+            continue;
+        }
+
+        const uint32 index = counter.fetch_add(1);
+        if (index < numBlocks)
+        {
+            outBlock = mBlocks[firstBlock + index];
+            return true;
+        }
+    }
+
+    return false;
+}
+
+} // namespace RT
+} // namespace NFE
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "../Raytracer.h"
+#include "../../Common/Math/Rectangle.hpp"
+#include "../../Common/Containers/DynArray.hpp"
+#include "../../Common/Containers/UniquePtr.hpp"
+
+#include <atomic>
+
+namespace NFE {
+namespace RT {
+
+// Queue of image blocks processed by the thread pool.
+// Image is split into horizontal bands (one per NUMA node) and blocks are preferably processed by threads
+// running on the node of the band. When a node runs out of its blocks, its threads take blocks of other nodes.
+// NOTE: memory pages are placed on the node which touches them first, so per-pixel buffers cleared with this queue
+// end up on the nodes of threads rendering them
+class NumaBlockQueue
+{
+public:
+    using Block = Math::Rectangle<uint32>;
+
+    // group blocks by NUMA nodes
+    void Init(const Common::ArrayView<const Block> blocks, uint32 imageHeight, uint32 numNodes);
+
+    // restart processing of the blocks
+    void Reset();
+
+    // get next block to be processed by a thread running on a given node
+    // returns false if all the blocks were already taken
+    bool Pop(uint32 node, Block& outBlock);
+
+    NFE_FORCE_INLINE uint32 Size() const { return mBlocks.Size(); }
+
+private:
+    struct NFE_ALIGN(NFE_CACHE_LINE_SIZE) NodeCounter
+    {
+        std::atomic<uint32> value = 0;
+    };
+
+    Common::DynArray<Block> mBlocks;            // blocks sorted by node
+    Common::DynArray<uint32> mNodeOffsets;      // first block of each node (plus the end)
+    Common::UniquePtr<NodeCounter[]> mNodeCounters;
+    uint32 mNumNodes = 0;
+};
+
+} // namespace RT
+} // namespace NFE
@@ -0,0 +1,419 @@
+#include "PCH.h"
+#include "RenderCheckpoint.h"
+#include "../Utils/Bitmap.h"
+#include "../Scene/Camera.h"
+#include "RenderingParams.h"
+#include "../Common/Logger/Logger.hpp"
+#include "../Common/Math/Vec3f.hpp"
+
+#include <atomic>
+
+namespace NFE {
+namespace RT {
+
+using namespace Common;
+using namespace Math;
+
+namespace {
+
+// header and each of the slots start at page boundary, so they can be flushed independently
+static constexpr size_t CheckpointPageSize = 4096;
+static constexpr size_t SlotHeaderSize = 256;
+
+// 64-bit checksum used to detect torn slots
+// NOTE: data size must be a multiple of 4 bytes
+static uint64 ComputeChecksum(const uint8* data, size_t size)
+{
+    uint64 hash = 0xCBF29CE484222325ull;
+
+    size_t i = 0;
+    for (; i + sizeof(uint64) <= size; i += sizeof(uint64))
+    {
+        uint64 word;
+        memcpy(&word, data + i, sizeof(uint64));
+        hash = (hash ^ word) * 0x9E3779B97F4A7C15ull;
+        hash ^= hash >> 32;
+    }
+
+    if (i < size)
+    {
+        uint32 word;
+        memcpy(&word, data + i, sizeof(uint32));
+        hash = (hash ^ word) * 0x9E3779B97F4A7C15ull;
+        hash ^= hash >> 32;
+    }
+
+    return hash ^ size;
+}
+
+// incrementally hashed values (each one is mixed in separately, so padding bytes are never read)
+class IdentityHasher
+{
+public:
+    template<typename T>
+    void Add(const T& value)
+    {
+        static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "Only plain values can be hashed");
+        Add(&value, sizeof(T));
+    }
+
+    void Add(const Vec4f& value)
+    {
+        Add(value.x);
+        Add(value.y);
+        Add(value.z);
+        Add(value.w);
+    }
+
+    void Add(const void* data, size_t size)
+    {
+        const uint8* bytes = static_cast<const uint8*>(data);
+        for (size_t i = 0; i < size; ++i)
+        {
+            mHash = (mHash ^ bytes[i]) * 0x100000001B3ull;
+        }
+    }
+
+    uint64 GetHash() const { return mHash; }
+
+private:
+    uint64 mHash = 0xCBF29CE484222325ull;
+};
+
+} // namespace
+
+struct RenderCheckpoint::FileHeader
+{
+    static constexpr uint32 Magic = 0x50434B52; // "RKCP"
+    static constexpr uint32 CurrentVersion = 3;
+
+    uint32 magic;
+    uint32 version;
+    uint32 width;
+    uint32 height;
+    uint32 maxBlocks;
+    uint32 padding;
+    uint64 slotSize;
+    uint64 identityHash;
+
+    // generation of the last complete checkpoint (zero if there is none)
+    // stored in slot (generation % 2)
+    std::atomic<uint64> generation;
+};
+
+struct RenderCheckpoint::SlotHeader
+{
+    // checksum of the rest of the slot header and the slot data
+    uint64 checksum;
+
+    uint64 generation;
+    State state;
+    uint32 numBlocks;
+};
+
+RenderCheckpoint::FileHeader& RenderCheckpoint::GetHeader() const
+{
+    return *static_cast<FileHeader*>(mFile.GetData());
+}
+
+uint8* RenderCheckpoint::GetSlotData(uint32 slot) const
+{
+    return static_cast<uint8*>(mFile.GetData()) + CheckpointPageSize + slot * mSlotSize;
+}
+
+uint64 RenderCheckpoint::ComputeIdentityHash(const StringView& scenePath, const Camera& camera, const RenderingParams& params)
+{
+    IdentityHasher hasher;
+
+    hasher.Add(scenePath.Data(), scenePath.Length());
+
+    hasher.Add(camera.mTransform.GetTranslation());
+    hasher.Add(camera.mTransform.GetRotation().q);
+    hasher.Add(camera.mAspectRatio);
+    hasher.Add(camera.mFieldOfView);
+    hasher.Add(camera.mDOF.focalPlaneDistance);
+    hasher.Add(camera.mDOF.aperture);
+    hasher.Add(camera.mDOF.enable);
+    hasher.Add(camera.mDOF.bokehShape);
+    hasher.Add(camera.mDOF.apertureBlades);
+    hasher.Add(camera.barrelDistortionConstFactor);
+    hasher.Add(camera.barrelDistortionVariableFactor);
+    hasher.Add(camera.enableBarellDistortion);
+
+    hasher.Add(params.samplingParams.sequence);
+    hasher.Add(params.samplingParams.dimensions);
+    hasher.Add(params.samplingParams.useBlueNoiseDithering);
+    hasher.Add(params.antiAliasingSpread);
+    hasher.Add(params.motionBlurStrength);
+    hasher.Add(params.maxRayDepth);
+    hasher.Add(params.minRussianRouletteDepth);
+    hasher.Add(params.tileSize);
+    hasher.Add(params.numPreviewPasses);
+    hasher.Add(params.traversalMode);
+    hasher.Add(params.lightSamplingStrategy);
+    hasher.Add(params.visualizeTimePerPixel);
+    hasher.Add(params.adaptiveSettings.enable);
+    hasher.Add(params.adaptiveSettings.numInitialPasses);
+    hasher.Add(params.adaptiveSettings.minBlockSize);
+    hasher.Add(params.adaptiveSettings.maxBlockSize);
+    hasher.Add(params.adaptiveSettings.subdivisionTreshold);
+    hasher.Add(params.adaptiveSettings.convergenceTreshold);
+    hasher.Add(params.reprojectionSettings.enable);
+    hasher.Add(params.reprojectionSettings.sampleCountDecay);
+    hasher.Add(params.reprojectionSettings.maxCarriedSamples);
+    hasher.Add(params.reprojectionSettings.depthTolerance);
+
+    return hasher.GetHash();
+}
+
+bool RenderCheckpoint::Open(const StringView& path, uint32 width, uint32 height, uint32 maxBlocks, uint64 identityHash)
+{
+    Close();
+
+    static_assert(std::atomic<uint64>::is_always_lock_free, "Checkpoint generation must be updated with a single store");
+    static_assert(sizeof(FileHeader) <= CheckpointPageSize, "File header is too big");
+    static_assert(sizeof(SlotHeader) <= SlotHeaderSize, "Slot header is too big");
+
+    mWidth = width;
+    mHeight = height;
+    mMaxBlocks = maxBlocks;
+
+    const size_t slotSize = RoundUp(GetSlotDataSize(maxBlocks), CheckpointPageSize);
+
+    if (!mFile.Open(path, CheckpointPageSize + 2u * slotSize))
+    {
+        NFE_LOG_ERROR("Failed to open render checkpoint file");
+        Close();
+        return false;
+    }
+
+    mSlotSize = slotSize;
+
+    FileHeader& header = GetHeader();
+    if (header.magic != FileHeader::Magic || header.version != FileHeader::CurrentVersion ||
+        header.width != width || header.height != height || header.maxBlocks != maxBlocks || header.slotSize != slotSize ||
+        header.identityHash != identityHash)
+    {
+        if (header.magic == FileHeader::Magic && header.version == FileHeader::CurrentVersion &&
+            header.identityHash != identityHash && header.generation.load() > 0)
+        {
+            NFE_LOG_WARNING("Render checkpoint: Checkpoint was written for a different image (scene, camera or settings), discarding it");
+        }
+
+        // not a checkpoint or checkpoint of a different image - start from scratch
+        memset(mFile.GetData(), 0, CheckpointPageSize);
+        header.magic = FileHeader::Magic;
+        header.version = FileHeader::CurrentVersion;
+        header.width = width;
+        header.height = height;
+        header.maxBlocks = maxBlocks;
+        header.slotSize = slotSize;
+        header.identityHash = identityHash;
+        header.generation.store(0);
+
+        if (!mFile.Flush(0, CheckpointPageSize))
+        {
+            Close();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void RenderCheckpoint::Close()
+{
+    mFile.Close();
+    mSlotSize = 0;
+    mWidth = 0;
+    mHeight = 0;
+    mMaxBlocks = 0;
+}
+
+size_t RenderCheckpoint::GetSlotDataSize(uint32 numBlocks) const
+{
+    const size_t numPixels = static_cast<size_t>(mWidth) * static_cast<size_t>(mHeight);
+    return
+        SlotHeaderSize +
+        2u * numPixels * sizeof(Vec3f) +    // sum + secondary sum
+        numPixels * sizeof(uint32) +        // extra samples
+        numBlocks * sizeof(Block);
+}
+
+bool RenderCheckpoint::IsSlotValid(uint32 slot, uint64 generation) const
+{
+    const uint8* data = GetSlotData(slot);
+    const SlotHeader& slotHeader = *reinterpret_cast<const SlotHeader*>(data);
+
+    if (slotHeader.generation != generation || slotHeader.numBlocks > mMaxBlocks)
+    {
+        return false;
+    }
+
+    // detect slot that was not completely written back to the disk (e.g. power loss or VM preemption)
+    const size_t checksumSize = sizeof(SlotHeader::checksum);
+    return slotHeader.checksum == ComputeChecksum(data + checksumSize, GetSlotDataSize(slotHeader.numBlocks) - checksumSize);
+}
+
+int32 RenderCheckpoint::FindValidSlot() const
+{
+    if (!IsOpened())
+    {
+        return -1;
+    }
+
+    const uint64 generation = GetHeader().generation.load(std::memory_order_acquire);
+    if (generation == 0)
+    {
+        return -1;
+    }
+
+    if (IsSlotValid(generation % 2, generation))
+    {
+        return static_cast<int32>(generation % 2);
+    }
+
+    // the latest slot is torn, fallback to the previous checkpoint (it's never overwritten before the latest one is activated)
+    if (generation > 1 && IsSlotValid((generation - 1) % 2, generation - 1))
+    {
+        NFE_LOG_WARNING("Render checkpoint: Latest checkpoint (generation %llu) is corrupted, using the previous one", generation);
+        return static_cast<int32>((generation - 1) % 2);
+    }
+
+    NFE_LOG_WARNING("Render checkpoint: Checkpoint is corrupted");
+    return -1;
+}
+
+bool RenderCheckpoint::HasValidState() const
+{
+    return FindValidSlot() >= 0;
+}
+
+bool RenderCheckpoint::Write(const State& state, const Bitmap& sum, const Bitmap& secondarySum, const uint32* extraSamples,
+                             const DynArray<Block>& blocks, bool sync)
+{
+    if (!IsOpened())
+    {
+        return false;
+    }
+
+    if (sum.GetWidth() != mWidth || sum.GetHeight() != mHeight ||
+        secondarySum.GetWidth() != mWidth || secondarySum.GetHeight() != mHeight)
+    {
+        NFE_LOG_ERROR("Render checkpoint: Image size does not match");
+        return false;
+    }
+
+    if (blocks.Size() > mMaxBlocks)
+    {
+        NFE_LOG_ERROR("Render checkpoint: Too many adaptive blocks (%u, max is %u)", blocks.Size(), mMaxBlocks);
+        return false;
+    }
+
+    FileHeader& header = GetHeader();
+    const uint64 generation = header.generation.load() + 1;
+    const uint32 slot = generation % 2;
+
+    // write to the inactive slot, so the last checkpoint stays valid until the new one is complete
+    uint8* slotData = GetSlotData(slot);
+    uint8* data = slotData + SlotHeaderSize;
+
+    const size_t rowSize = mWidth * sizeof(Vec3f);
+    for (uint32 y = 0; y < mHeight; ++y)
+    {
+        memcpy(data, &sum.GetPixelRef<Vec3f>(0, y), rowSize);
+        data += rowSize;
+    }
+    for (uint32 y = 0; y < mHeight; ++y)
+    {
+        memcpy(data, &secondarySum.GetPixelRef<Vec3f>(0, y), rowSize);
+        data += rowSize;
+    }
+
+    const size_t numPixels = static_cast<size_t>(mWidth) * static_cast<size_t>(mHeight);
+    memcpy(data, extraSamples, numPixels * sizeof(uint32));
+    data += numPixels * sizeof(uint32);
+
+    if (!blocks.Empty())
+    {
+        memcpy(data, blocks.Data(), blocks.Size() * sizeof(Block));
+    }
+
+    // slot header is written last, the checksum covers it too
+    SlotHeader& slotHeader = *reinterpret_cast<SlotHeader*>(slotData);
+    slotHeader.generation = generation;
+    slotHeader.state = state;
+    slotHeader.numBlocks = blocks.Size();
+
+    const size_t checksumSize = sizeof(SlotHeader::checksum);
+    slotHeader.checksum = ComputeChecksum(slotData + checksumSize, GetSlotDataSize(blocks.Size()) - checksumSize);
+
+    // make sure the slot reaches the disk before it's activated
+    const size_t slotOffset = CheckpointPageSize + slot * mSlotSize;
+    if (sync && !mFile.Flush(slotOffset, mSlotSize, true))
+    {
+        return false;
+    }
+
+    // activate the slot
+    // NOTE: without sync the OS writes back pages in any order, so the activation can reach the disk before the slot data
+    // (e.g. when the machine looses power) - such torn slot is detected with the checksum and the previous one is used instead
+    std::atomic_thread_fence(std::memory_order_release);
+    header.generation.store(generation, std::memory_order_release);
+
+    if (sync)
+    {
+        return mFile.Flush(0, CheckpointPageSize, true);
+    }
+
+    return mFile.Flush(slotOffset, mSlotSize, false) && mFile.Flush(0, CheckpointPageSize, false);
+}
+
+bool RenderCheckpoint::Read(State& outState, Bitmap& sum, Bitmap& secondarySum, uint32* extraSamples, DynArray<Block>& outBlocks) const
+{
+    const int32 slot = FindValidSlot();
+    if (slot < 0)
+    {
+        return false;
+    }
+
+    if (sum.GetWidth() != mWidth || sum.GetHeight() != mHeight ||
+        secondarySum.GetWidth() != mWidth || secondarySum.GetHeight() != mHeight)
+    {
+        NFE_LOG_ERROR("Render checkpoint: Image size does not match");
+        return false;
+    }
+
+    const uint8* data = GetSlotData(static_cast<uint32>(slot));
+
+    const SlotHeader& slotHeader = *reinterpret_cast<const SlotHeader*>(data);
+    data += SlotHeaderSize;
+
+    const size_t rowSize = mWidth * sizeof(Vec3f);
+    for (uint32 y = 0; y < mHeight; ++y)
+    {
+        memcpy(&sum.GetPixelRef<Vec3f>(0, y), data, rowSize);
+        data += rowSize;
+    }
+    for (uint32 y = 0; y < mHeight; ++y)
+    {
+        memcpy(&secondarySum.GetPixelRef<Vec3f>(0, y), data, rowSize);
+        data += rowSize;
+    }
+
+    const size_t numPixels = static_cast<size_t>(mWidth) * static_cast<size_t>(mHeight);
+    memcpy(extraSamples, data, numPixels * sizeof(uint32));
+    data += numPixels * sizeof(uint32);
+
+    outBlocks.Resize(slotHeader.numBlocks);
+    if (slotHeader.numBlocks > 0)
+    {
+        memcpy(outBlocks.Data(), data, slotHeader.numBlocks * sizeof(Block));
+    }
+
+    outState = slotHeader.state;
+    return true;
+}
+
+} // namespace RT
+} // namespace NFE
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "../Raytracer.h"
+#include "../../Common/FileSystem/MemoryMappedFile.hpp"
+#include "../../Common/Math/Rectangle.hpp"
+#include "../../Common/Containers/DynArray.hpp"
+
+namespace NFE {
+namespace RT {
+
+class Bitmap;
+
+/**
+ * Persistent state of progressive rendering stored in a memory-mapped file.
+ *
+ * The file contains two slots for the state. New state is always written to the inactive slot
+ * and the slot is activated with a single 64-bit store to the file header, so the file always
+ * contains a complete state, even if the process is killed during the write.
+ * Each slot is protected with a checksum, so a slot that was only partially written back to the disk
+ * (power loss, VM preemption) is detected on load and the previous checkpoint is used instead.
+ */
+class NFE_RAYTRACER_API RenderCheckpoint
+{
+    NFE_MAKE_NONCOPYABLE(RenderCheckpoint)
+    NFE_MAKE_NONMOVEABLE(RenderCheckpoint)
+
+public:
+    using Block = Math::Rectangle<uint32>;
+
+    // small (non-image) part of the rendering state
+    struct State
+    {
+        uint32 passesFinished = 0;
+        uint32 firstPassIndex = 0;
+        uint64 haltonSeed = 0;
+        uint32 haltonSampleIndex = 0;
+        uint32 activePixels = 0;
+        uint32 activeBlocks = 0;
+        float converged = 0.0f;
+        float averageError = 0.0f;
+    };
+
+    RenderCheckpoint() = default;
+
+    // compute hash identifying rendered image (scene, camera and rendering settings)
+    static uint64 ComputeIdentityHash(const Common::StringView& scenePath, const Camera& camera, const RenderingParams& params);
+
+    // open (or create) checkpoint file for image of given size
+    // if the file contains a checkpoint of different size or identity hash (see ComputeIdentityHash), it is discarded
+    bool Open(const Common::StringView& path, uint32 width, uint32 height, uint32 maxBlocks, uint64 identityHash);
+    void Close();
+
+    NFE_FORCE_INLINE bool IsOpened() const { return mFile.IsOpened(); }
+    NFE_FORCE_INLINE uint32 GetMaxBlocks() const { return mMaxBlocks; }
+
+    // check if the file contains complete checkpoint (with matching checksum)
+    bool HasValidState() const;
+
+    // store rendering state
+    // if 'sync' is true, the function waits until the data reaches the disk before the new state is activated,
+    // otherwise the write-back is only scheduled (if the OS crashes, the previous state is restored)
+    bool Write(const State& state, const Bitmap& sum, const Bitmap& secondarySum, const uint32* extraSamples,
+               const Common::DynArray<Block>& blocks, bool sync);
+
+    // restore rendering state
+    bool Read(State& outState, Bitmap& sum, Bitmap& secondarySum, uint32* extraSamples, Common::DynArray<Block>& outBlocks) const;
+
+private:
+    struct FileHeader;
+    struct SlotHeader;
+
+    FileHeader& GetHeader() const;
+    uint8* GetSlotData(uint32 slot) const;
+    size_t GetSlotDataSize(uint32 numBlocks) const;
+
+    bool IsSlotValid(uint32 slot, uint64 generation) const;
+
+    // get slot containing the latest valid checkpoint, returns -1 if there's none
+    int32 FindValidSlot() const;
+
+    Common::MemoryMappedFile mFile;
+    size_t mSlotSize = 0;
+    uint32 mWidth = 0;
+    uint32 mHeight = 0;
+    uint32 mMaxBlocks = 0;
+};
+
+} // namespace RT
+} // namespace NFE
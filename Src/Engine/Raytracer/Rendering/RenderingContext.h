@@ -33,6 +33,73 @@ struct NFE_RAYTRACER_API SpectrumDebugData
     void Accumulate(const RayColor& rayColor, const Wavelength& wavelength);
 };
 
+// Key used to group hit points before shading.
+// Hit points with the same key use the same textures, material and object transform.
+struct HitPointShadingKey
+{
+    const ITexture* texture;
+    const Material* material;
+    uint32 objectId;
+
+    NFE_FORCE_INLINE bool operator == (const HitPointShadingKey& other) const
+    {
+        return texture == other.texture && material == other.material && objectId == other.objectId;
+    }
+
+    NFE_FORCE_INLINE bool operator < (const HitPointShadingKey& other) const
+    {
+        if (texture != other.texture) return texture < other.texture;
+        if (material != other.material) return material < other.material;
+        return objectId < other.objectId;
+    }
+};
+
+// Scratch buffers used by Scene::SortHitPoints()
+struct HitPointSortBuffers
+{
+    static constexpr uint32 HashTableSize = 2 * MaxRayPacketSize;
+    static constexpr uint16 InvalidBucket = UINT16_MAX;
+
+    // unique shading keys
+    HitPointShadingKey bucketKeys[MaxRayPacketSize];
+
+    // hash table mapping shading key to a bucket (stores bucket index + 1, zero means empty slot)
+    uint16 hashTable[HashTableSize];
+
+    // bucket index for each hit point
+    uint16 hitBuckets[MaxRayPacketSize];
+
+    // buckets ordered by shading key
+    uint16 bucketOrder[MaxRayPacketSize];
+
+    // number of hit points in a bucket, then output offset of a bucket
+    uint16 bucketOffsets[MaxRayPacketSize];
+};
+
+// Last occluder of shadow rays cast towards a common target (see Scene::Traverse_Shadow).
+// Consecutive shadow rays towards the same light (or camera, or light path vertex) are likely
+// to be blocked by the same triangle, so it's tested before the full traversal.
+struct ShadowOccluderCache
+{
+    static constexpr uint32 NumEntries = 16;
+
+    struct Entry
+    {
+        const void* key = nullptr;
+        uint32 objectId = HitPoint::InvalidObject;
+        uint32 subObjectId = HitPoint::InvalidObject;
+    };
+
+    // keys are mapped directly to entries, colliding keys evict each other
+    NFE_FORCE_INLINE Entry& GetEntry(const void* key)
+    {
+        const size_t hash = reinterpret_cast<size_t>(key) / sizeof(void*);
+        return entries[(hash ^ (hash >> 5)) % NumEntries];
+    }
+
+    Entry entries[NumEntries];
+};
+
 /**
  * A structure with local (per-thread) data.
  * It's like a hub for all global params (read only) and local state (read write).
@@ -71,6 +138,9 @@ public:
     // counters used in local ray traversal routines
     LocalCounters localCounters;
 
+    // last shadow ray occluders
+    ShadowOccluderCache occluderCache;
+
     // for motion blur sampling
     float time = 0.0f;
 
@@ -87,6 +157,10 @@ public:
 
     HitPoint hitPoints[MaxRayPacketSize];
 
+    // hit point indices ordered for coherent shading (see Scene::SortHitPoints)
+    uint16 sortedHitPoints[MaxRayPacketSize];
+    HitPointSortBuffers hitPointSortBuffers;
+
     // TODO separate stacks for scene and mesh
     RayPacketTypes::RayMaskType activeRaysMask[RayPacket::MaxNumGroups];
     uint16 activeGroupsIndices[RayPacket::MaxNumGroups];
@@ -9,6 +9,12 @@ NFE_BEGIN_DEFINE_ENUM(NFE::RT::TraversalMode)
 NFE_END_DEFINE_ENUM()
 
 
+NFE_BEGIN_DEFINE_ENUM(NFE::RT::SampleSequence)
+    NFE_ENUM_OPTION(Halton);
+    NFE_ENUM_OPTION(Sobol);
+NFE_END_DEFINE_ENUM()
+
+
 NFE_BEGIN_DEFINE_ENUM(NFE::RT::LightSamplingStrategy)
     NFE_ENUM_OPTION(Single);
     NFE_ENUM_OPTION(All);
@@ -27,8 +33,19 @@ NFE_DEFINE_CLASS(NFE::RT::AdaptiveRenderingSettings)
 NFE_END_DEFINE_CLASS()
 
 
+NFE_DEFINE_CLASS(NFE::RT::ReprojectionSettings)
+{
+    NFE_CLASS_MEMBER(enable);
+    NFE_CLASS_MEMBER(sampleCountDecay).Min(0.0f).Max(1.0f);
+    NFE_CLASS_MEMBER(maxCarriedSamples).Min(1).Max(1024);
+    NFE_CLASS_MEMBER(depthTolerance).Min(1.0e-4f).Max(1.0f).LogScale(10.0f);
+}
+NFE_END_DEFINE_CLASS()
+
+
 NFE_DEFINE_CLASS(NFE::RT::SamplingParams)
 {
+    NFE_CLASS_MEMBER(sequence);
     NFE_CLASS_MEMBER(dimensions).Min(0).Max(128);
     NFE_CLASS_MEMBER(useBlueNoiseDithering);
 }
@@ -39,6 +56,7 @@ NFE_DEFINE_CLASS(NFE::RT::RenderingParams)
 {
     NFE_CLASS_MEMBER(maxRayDepth).Min(0).Max(64);
     NFE_CLASS_MEMBER(tileSize).Min(4).Max(256);
+    NFE_CLASS_MEMBER(numPreviewPasses).Min(0).Max(3);
     NFE_CLASS_MEMBER(antiAliasingSpread).Min(0.0f).Max(3.0f);
     NFE_CLASS_MEMBER(motionBlurStrength).Min(0.0f).Max(1.0f);
     NFE_CLASS_MEMBER(minRussianRouletteDepth).Min(0).Max(256);
@@ -47,5 +65,6 @@ NFE_DEFINE_CLASS(NFE::RT::RenderingParams)
     NFE_CLASS_MEMBER(visualizeTimePerPixel);
     NFE_CLASS_MEMBER(samplingParams);
     NFE_CLASS_MEMBER(adaptiveSettings);
+    NFE_CLASS_MEMBER(reprojectionSettings);
 }
 NFE_END_DEFINE_CLASS()
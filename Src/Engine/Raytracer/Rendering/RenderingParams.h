@@ -23,6 +23,12 @@ enum class TraversalMode : uint8
     Packet,
 };
 
+enum class SampleSequence : uint8
+{
+    Halton,
+    Sobol,  // Owen-scrambled
+};
+
 enum class LightSamplingStrategy : uint8
 {
     Single,
@@ -43,16 +49,39 @@ public:
     float convergenceTreshold = 0.0001f;
 };
 
+struct ReprojectionSettings
+{
+    NFE_DECLARE_CLASS(ReprojectionSettings)
+
+public:
+    // reuse accumulated samples when the camera moves instead of restarting from scratch
+    bool enable = false;
+
+    // fraction of the per-pixel sample count carried over to the new camera position
+    // lower values make stale (view-dependent) shading fade out faster
+    float sampleCountDecay = 0.5f;
+
+    // upper limit of the sample count carried over
+    uint32 maxCarriedSamples = 64;
+
+    // maximum relative difference of first-hit distances for a reprojected pixel to be accepted
+    float depthTolerance = 0.05f;
+};
+
 struct SamplingParams
 {
     NFE_DECLARE_CLASS(SamplingParams)
 
 public:
-    // Number of sample dimensions generated by low-discrepancy sampler
+    // Low-discrepancy sequence used for sampling
+    SampleSequence sequence = SampleSequence::Sobol;
+
+    // Number of sample dimensions generated by Halton sequence
     // Note: If more dimensions is required during integration, uniform random samples will be used
+    // Sobol sequence generates any number of dimensions
     uint32 dimensions = 64;
 
-    // Enables image-space sample dithering based on blue noise pattern
+    // Enables image-space sample dithering based on blue noise pattern (Halton sequence only)
     bool useBlueNoiseDithering = true;
 };
 
@@ -80,6 +109,10 @@ public:
     // rendering tile dimensions (tiles are processed as a tasks in thread pool in parallel)
     uint16 tileSize = 32;
 
+    // number of low resolution preview passes rendered after reset (0 - disabled)
+    // each preview pass traces 4x less pixels than the next one, e.g. for 2 passes: 1/16, 1/4 and then full resolution
+    uint32 numPreviewPasses = 0;
+
     // select mode of ray traversal
     TraversalMode traversalMode = TraversalMode::Single;
 
@@ -92,10 +125,14 @@ public:
 
     // adaptive rendering settings
     AdaptiveRenderingSettings adaptiveSettings;
+
+    // camera-move reprojection settings
+    ReprojectionSettings reprojectionSettings;
 };
 
 } // namespace RT
 } // namespace NFE
 
 NFE_DECLARE_ENUM_TYPE(NFE::RT::TraversalMode)
+NFE_DECLARE_ENUM_TYPE(NFE::RT::SampleSequence)
 NFE_DECLARE_ENUM_TYPE(NFE::RT::LightSamplingStrategy)
@@ -0,0 +1,279 @@
+#include "PCH.h"
+#include "TileFarm.h"
+#include "Viewport.h"
+#include "../Common/Logger/Logger.hpp"
+#include "../Common/Utils/ScopedLock.hpp"
+#include "../Common/Utils/Stream/InputStream.hpp"
+#include "../Common/Utils/Stream/OutputStream.hpp"
+#include "../Common/Utils/Stream/BufferInputStream.hpp"
+#include "../Common/Utils/Stream/BufferOutputStream.hpp"
+#include "../Common/Memory/Buffer.hpp"
+
+namespace NFE {
+namespace RT {
+
+using namespace Common;
+using namespace Math;
+
+bool TileFarmJob::Write(OutputStream& stream) const
+{
+    return
+        stream.Write(region.minX) &&
+        stream.Write(region.maxX) &&
+        stream.Write(region.minY) &&
+        stream.Write(region.maxY) &&
+        stream.Write(firstPass) &&
+        stream.Write(numPasses);
+}
+
+bool TileFarmJob::Read(InputStream& stream)
+{
+    return
+        stream.Read(region.minX) &&
+        stream.Read(region.maxX) &&
+        stream.Read(region.minY) &&
+        stream.Read(region.maxY) &&
+        stream.Read(firstPass) &&
+        stream.Read(numPasses);
+}
+
+TileFarmCoordinator::TileFarmCoordinator()
+    : mViewport(nullptr)
+    , mNumJobs(0)
+    , mNumMergedJobs(0)
+{ }
+
+bool TileFarmCoordinator::Init(Viewport& viewport, const Settings& settings)
+{
+    const uint32 width = viewport.GetWidth();
+    const uint32 height = viewport.GetHeight();
+    if (width == 0 || height == 0)
+    {
+        NFE_LOG_ERROR("TileFarm: Viewport is empty");
+        return false;
+    }
+
+    if (settings.totalPasses == 0 || settings.passesPerJob == 0)
+    {
+        NFE_LOG_ERROR("TileFarm: Invalid number of passes");
+        return false;
+    }
+
+    NFE_SCOPED_LOCK(mLock);
+
+    mViewport = &viewport;
+    mViewport->SetRenderRegion(Rectangle<uint32>());
+    mViewport->Reset();
+
+    const uint32 blockSizeX = settings.blockSize > 0 ? settings.blockSize : width;
+    const uint32 blockSizeY = settings.blockSize > 0 ? settings.blockSize : height;
+    const uint32 numBlocksX = (width + blockSizeX - 1) / blockSizeX;
+    const uint32 numBlocksY = (height + blockSizeY - 1) / blockSizeY;
+    const uint32 numPassRanges = (settings.totalPasses + settings.passesPerJob - 1) / settings.passesPerJob;
+
+    mPendingJobs.Clear();
+    mPendingJobs.Reserve(numBlocksX * numBlocksY * numPassRanges);
+
+    // whole image gets refined progressively: all the blocks for given pass range are dispatched first
+    for (uint32 i = numPassRanges; i-- > 0; )
+    {
+        for (uint32 j = numBlocksX * numBlocksY; j-- > 0; )
+        {
+            const uint32 blockX = j % numBlocksX;
+            const uint32 blockY = j / numBlocksX;
+
+            TileFarmJob job;
+            job.region = Rectangle<uint32>(
+                blockX * blockSizeX,
+                Min(width, (blockX + 1) * blockSizeX),
+                blockY * blockSizeY,
+                Min(height, (blockY + 1) * blockSizeY));
+            job.firstPass = i * settings.passesPerJob;
+            job.numPasses = Min(settings.passesPerJob, settings.totalPasses - job.firstPass);
+            mPendingJobs.PushBack(job);
+        }
+    }
+
+    mNumJobs = mPendingJobs.Size();
+    mNumMergedJobs = 0;
+
+    mJobsConditionVariable.SignalAll();
+
+    return true;
+}
+
+bool TileFarmCoordinator::GetNextJob(TileFarmJob& outJob)
+{
+    NFE_SCOPED_LOCK(mLock);
+
+    if (mPendingJobs.Empty())
+    {
+        return false;
+    }
+
+    outJob = mPendingJobs.Back();
+    mPendingJobs.PopBack();
+    return true;
+}
+
+bool TileFarmCoordinator::WaitForJob(TileFarmJob& outJob)
+{
+    ScopedExclusiveLock<Mutex> lock(mLock);
+
+    while (mPendingJobs.Empty())
+    {
+        if (mNumMergedJobs >= mNumJobs)
+        {
+            return false;
+        }
+
+        mJobsConditionVariable.Wait(lock);
+    }
+
+    outJob = mPendingJobs.Back();
+    mPendingJobs.PopBack();
+    return true;
+}
+
+void TileFarmCoordinator::ReturnJob(const TileFarmJob& job)
+{
+    NFE_SCOPED_LOCK(mLock);
+
+    mPendingJobs.PushBack(job);
+    mJobsConditionVariable.SignalAll();
+}
+
+bool TileFarmCoordinator::ServeWorker(InputStream& input, OutputStream& output)
+{
+    Buffer resultBuffer;
+
+    TileFarmJob job;
+    while (WaitForJob(job))
+    {
+        uint64 resultSize = 0;
+        if (!job.Write(output) || !input.Read(resultSize))
+        {
+            NFE_LOG_ERROR("TileFarm: Lost connection with worker");
+            ReturnJob(job);
+            return false;
+        }
+
+        // whole result is received before merging, so broken connection does not leave partially merged samples
+        if (!resultBuffer.Resize(resultSize) || input.Read(resultBuffer.Data(), resultSize) != resultSize)
+        {
+            NFE_LOG_ERROR("TileFarm: Failed to receive job result");
+            ReturnJob(job);
+            return false;
+        }
+
+        BufferInputStream resultStream(resultBuffer.Data(), resultSize);
+        if (!MergeResult(resultStream))
+        {
+            ReturnJob(job);
+            return false;
+        }
+    }
+
+    // let the worker know there is no more work
+    return TileFarmJob().Write(output);
+}
+
+bool TileFarmCoordinator::MergeResult(InputStream& stream)
+{
+    NFE_SCOPED_LOCK(mLock);
+
+    if (!mViewport)
+    {
+        NFE_LOG_ERROR("TileFarm: Coordinator is not initialized");
+        return false;
+    }
+
+    if (!mViewport->MergeSamples(stream))
+    {
+        return false;
+    }
+
+    mNumMergedJobs++;
+    mJobsConditionVariable.SignalAll();
+    return true;
+}
+
+void TileFarmCoordinator::PostProcess()
+{
+    NFE_SCOPED_LOCK(mLock);
+
+    if (mViewport)
+    {
+        mViewport->PostProcess();
+    }
+}
+
+bool TileFarmCoordinator::IsFinished() const
+{
+    NFE_SCOPED_LOCK(mLock);
+
+    return mPendingJobs.Empty() && mNumMergedJobs >= mNumJobs;
+}
+
+bool TileFarmWorker::ProcessJob(Viewport& viewport, const Scene& scene, const Camera& camera, const TileFarmJob& job, OutputStream& resultStream)
+{
+    if (job.numPasses == 0)
+    {
+        NFE_LOG_ERROR("TileFarm: Empty job");
+        return false;
+    }
+
+    viewport.SetRenderRegion(job.region);
+    viewport.SetFirstPassIndex(job.firstPass);
+    viewport.Reset();
+
+    // NOTE: preview passes (if enabled) are not counted as finished passes
+    while (viewport.GetProgress().passesFinished < job.numPasses)
+    {
+        if (!viewport.Render(scene, camera))
+        {
+            return false;
+        }
+    }
+
+    return viewport.WriteSamples(resultStream);
+}
+
+bool TileFarmWorker::Run(Viewport& viewport, const Scene& scene, const Camera& camera, InputStream& input, OutputStream& output)
+{
+    Buffer resultBuffer;
+
+    for (;;)
+    {
+        TileFarmJob job;
+        if (!job.Read(input))
+        {
+            NFE_LOG_ERROR("TileFarm: Lost connection with coordinator");
+            return false;
+        }
+
+        if (job.numPasses == 0)
+        {
+            // no more work
+            return true;
+        }
+
+        // result size must be known before sending it
+        resultBuffer.Clear();
+        BufferOutputStream resultStream(resultBuffer);
+        if (!ProcessJob(viewport, scene, camera, job, resultStream))
+        {
+            return false;
+        }
+
+        const uint64 resultSize = resultStream.GetSize();
+        if (!output.Write(resultSize) || output.Write(resultStream.GetData(), resultStream.GetSize()) != resultSize)
+        {
+            NFE_LOG_ERROR("TileFarm: Failed to send job result");
+            return false;
+        }
+    }
+}
+
+} // namespace RT
+} // namespace NFE
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "../Raytracer.h"
+#include "../../Common/Math/Rectangle.hpp"
+#include "../../Common/Containers/DynArray.hpp"
+#include "../../Common/System/Mutex.hpp"
+#include "../../Common/System/ConditionVariable.hpp"
+
+namespace NFE {
+namespace RT {
+
+class Viewport;
+
+// Single unit of work rendered by a tile farm worker
+struct TileFarmJob
+{
+    Math::Rectangle<uint32> region;     // image region to render
+    uint32 firstPass = 0;               // index of the first sampling pass (jobs covering the same pixels never share passes)
+    uint32 numPasses = 0;
+
+    NFE_RAYTRACER_API bool Write(Common::OutputStream& stream) const;
+    NFE_RAYTRACER_API bool Read(Common::InputStream& stream);
+};
+
+/**
+ * Coordinator of multi-process rendering.
+ * Splits the image into jobs (image blocks and/or sampling pass ranges) and merges samples sent back by the workers.
+ * Jobs and results are exchanged via streams, so any transport can be used (sockets, shared memory, files, etc.).
+ *
+ * Protocol (see ServeWorker and TileFarmWorker::Run):
+ * - coordinator sends a job (TileFarmJob::Write), job with zero passes means there is no more work
+ * - worker responds with result size (uint64) followed by the samples (Viewport::WriteSamples)
+ */
+class TileFarmCoordinator
+{
+    NFE_MAKE_NONCOPYABLE(TileFarmCoordinator)
+    NFE_MAKE_NONMOVEABLE(TileFarmCoordinator)
+
+public:
+    struct Settings
+    {
+        // number of sampling passes for the whole image
+        uint32 totalPasses = 64;
+
+        // number of sampling passes rendered in a single job
+        uint32 passesPerJob = 8;
+
+        // size of image blocks assigned to the workers (0 - each job covers whole image)
+        uint32 blockSize = 0;
+    };
+
+    NFE_RAYTRACER_API TileFarmCoordinator();
+
+    // build list of jobs covering viewport's image
+    // NOTE: the viewport is reset, merged samples are accumulated in it
+    NFE_RAYTRACER_API bool Init(Viewport& viewport, const Settings& settings);
+
+    // get next job to be sent to a worker (thread-safe)
+    // returns false if all the jobs were dispatched
+    NFE_RAYTRACER_API bool GetNextJob(TileFarmJob& outJob);
+
+    // get next job to be sent to a worker (thread-safe)
+    // if all the jobs were dispatched, waits until they are merged, as some of them may be returned by other workers
+    // returns false if all the jobs were merged
+    NFE_RAYTRACER_API bool WaitForJob(TileFarmJob& outJob);
+
+    // put back job that was not finished (e.g. worker disconnected), it will be dispatched again (thread-safe)
+    NFE_RAYTRACER_API void ReturnJob(const TileFarmJob& job);
+
+    // send jobs to a single worker and merge its results until all the jobs are finished (thread-safe, blocking)
+    // should be called once per worker connection, unfinished job is returned if the connection fails
+    NFE_RAYTRACER_API bool ServeWorker(Common::InputStream& input, Common::OutputStream& output);
+
+    // merge samples sent back by a worker (thread-safe)
+    NFE_RAYTRACER_API bool MergeResult(Common::InputStream& stream);
+
+    // generate viewport's front buffer from the samples merged so far
+    NFE_RAYTRACER_API void PostProcess();
+
+    // all the jobs were dispatched and merged
+    NFE_RAYTRACER_API bool IsFinished() const;
+
+    NFE_FORCE_INLINE uint32 GetNumJobs() const { return mNumJobs; }
+    NFE_FORCE_INLINE uint32 GetNumMergedJobs() const { return mNumMergedJobs; }
+
+private:
+    Viewport* mViewport;
+
+    // jobs to be dispatched, in reversed order
+    Common::DynArray<TileFarmJob> mPendingJobs;
+
+    uint32 mNumJobs;
+    uint32 mNumMergedJobs;
+
+    mutable Common::Mutex mLock;
+    Common::ConditionVariable mJobsConditionVariable;  // signaled when a job is returned or merged
+};
+
+/**
+ * Worker side of multi-process rendering.
+ */
+class TileFarmWorker
+{
+public:
+    // render a job and write the samples to the result stream
+    // NOTE: the viewport must have the same resolution as the coordinator's one
+    NFE_RAYTRACER_API static bool ProcessJob(Viewport& viewport, const Scene& scene, const Camera& camera, const TileFarmJob& job, Common::OutputStream& resultStream);
+
+    // process jobs sent by a coordinator (see TileFarmCoordinator::ServeWorker) until there is no more work
+    NFE_RAYTRACER_API static bool Run(Viewport& viewport, const Scene& scene, const Camera& camera, Common::InputStream& input, Common::OutputStream& output);
+};
+
+} // namespace RT
+} // namespace NFE
@@ -3,9 +3,12 @@
 #include "Film.h"
 #include "Tonemapping.h"
 #include "Scene/Camera.h"
+#include "Scene/Scene.h"
+#include "Traversal/TraversalContext.h"
 #include "Textures/Texture.h"
 #include "Utils/BitmapUtils.h"
 #include "Utils/Profiler.h"
+#include "Utils/TextureCache.h"
 #include "../Common/System/Timer.hpp"
 #include "../Common/Math/SamplingHelpers.hpp"
 #include "../Common/Math/PackedLoadVec4f.hpp"
@@ -16,6 +19,9 @@
 #include "../Common/Logger/Logger.hpp"
 #include "../Common/Utils/ThreadPool.hpp"
 #include "../Common/Utils/Waitable.hpp"
+#include "../Common/Utils/Stream/InputStream.hpp"
+#include "../Common/Utils/Stream/OutputStream.hpp"
+#include "../Common/Containers/StaticArray.hpp"
 #include "../Common/Reflection/Types/ReflectionClassType.hpp"
 #include "../Common/Reflection/Types/ReflectionUniquePtrType.hpp"
 #include "../Common/Reflection/ReflectionUtils.hpp"
@@ -33,8 +39,6 @@ Viewport::Viewport()
 {
     InitThreadData();
 
-    mBlurredImages.Resize(mPostprocessParams.params.bloom.elements.Size());
-
     PrepareHilbertCurve(mParams.tileSize);
 }
 
@@ -64,14 +68,83 @@ void Viewport::InitThreadData()
 
 bool Viewport::InitBluredImages()
 {
+    // Bloom images are blurred on a downsampled image pyramid, so the blur cost does not depend on sigma.
+    // Each bloom element blurs result of the previous one, so the effective sigma accumulates.
+    // Pyramid level is chosen so the blur kernel still spans a few pixels, and the blur applied
+    // by downsampling (2x2 box filter at each level) is subtracted from the sigma.
+
+    static constexpr float MinBloomSigma = 2.0f; // in pyramid level pixels
+    static constexpr uint32 MaxBloomLevels = 8;
+
+    const BloomParams& bloomParams = mPostprocessParams.params.bloom;
+
+    mBlurredImages.Clear();
+    mBloomPyramid.Clear();
+
+    if (GetWidth() == 0 || GetHeight() == 0)
+    {
+        return true;
+    }
+
+    if (!mBlurredImages.Resize(bloomParams.elements.Size()))
+    {
+        return false;
+    }
+
+    uint32 numLevels = 0;
+    float accumulatedVariance = 0.0f;
+
+    for (uint32 i = 0; i < bloomParams.elements.Size(); ++i)
+    {
+        const float sigma = bloomParams.elements[i].sigma;
+        accumulatedVariance += sigma * sigma;
+
+        uint32 level = 0;
+        while (level < MaxBloomLevels &&
+               sqrtf(accumulatedVariance) >= MinBloomSigma * static_cast<float>(2u << level) &&
+               (GetWidth() >> (level + 1u)) > 0 && (GetHeight() >> (level + 1u)) > 0)
+        {
+            level++;
+        }
+
+        const float levelScale = static_cast<float>(1u << level);
+        const float downsamplingVariance = (levelScale * levelScale - 1.0f) / 12.0f;
+
+        BloomImage& bloomImage = mBlurredImages[i];
+        bloomImage.level = level;
+        bloomImage.sigma = sqrtf(Max(0.0f, accumulatedVariance - downsamplingVariance)) / levelScale;
+
+        numLevels = Max(numLevels, level);
+    }
+
+    if (!mBloomPyramid.Resize(numLevels))
+    {
+        return false;
+    }
+
     Bitmap::InitData initData;
+    initData.format = Bitmap::Format::R32G32B32_Float;
     initData.width = GetWidth();
     initData.height = GetHeight();
-    initData.format = Bitmap::Format::R32G32B32_Float;
 
-    for (Bitmap& blurredImage : mBlurredImages)
+    for (Bitmap& levelImage : mBloomPyramid)
     {
-        if (!blurredImage.Init(initData))
+        initData.width = (initData.width + 1u) / 2u;
+        initData.height = (initData.height + 1u) / 2u;
+
+        if (!levelImage.Init(initData))
+        {
+            return false;
+        }
+    }
+
+    for (BloomImage& bloomImage : mBlurredImages)
+    {
+        const Bitmap& sourceImage = bloomImage.level == 0 ? mSum : mBloomPyramid[bloomImage.level - 1u];
+        initData.width = sourceImage.GetWidth();
+        initData.height = sourceImage.GetHeight();
+
+        if (!bloomImage.image.Init(initData) || !bloomImage.temp.Init(initData))
         {
             return false;
         }
@@ -93,10 +166,13 @@ bool Viewport::Resize(uint32 width, uint32 height)
         return true;
     }
 
+    // Accumulation buffers are spread over NUMA nodes by first touch (see ClearAccumulationBuffers),
+    // so they don't use large pages, which would make the placement much coarser.
     Bitmap::InitData initData;
     initData.width = width;
     initData.height = height;
     initData.format = Bitmap::Format::R32G32B32_Float;
+    initData.useDefaultAllocator = true;
 
     if (!mSum.Init(initData))
     {
@@ -116,13 +192,20 @@ bool Viewport::Resize(uint32 width, uint32 height)
         return false;
     }
 
-    mPassesPerPixel.Resize(width * height);
+    // per-pixel buffers are first touched on NUMA nodes, when cleared in ClearAccumulationBuffers
+    mCarriedSamples.Clear();
+    mCarriedSamples.Resize_SkipConstructor(width * height);
+    mConvergedPasses.Clear();
+    mConvergedPasses.Resize_SkipConstructor(width * height);
+    mPixelSalt.Clear();
+    mPixelSalt.Resize_SkipConstructor(width * height);
+    mPixelSaltSeed = mRandomGenerator.GetLong();
+    mPixelSaltValid = false;
 
-    mPixelSalt.Resize(width * height);
-    for (uint32 i = 0; i < width * height; ++i)
-    {
-        mPixelSalt[i] = mRandomGenerator.GetVec4f().ToVec2f();
-    }
+    mHasLastCamera = false;
+
+    // checkpoint layout depends on image size
+    CloseCheckpoint();
 
     Reset();
 
@@ -140,22 +223,465 @@ void Viewport::SetPixelBreakpoint(uint32 x, uint32 y)
 #endif
 }
 
+void Viewport::SetRenderRegion(const Block& region)
+{
+    mRenderRegion = region;
+}
+
+void Viewport::SetFirstPassIndex(uint32 index)
+{
+    mFirstPassIndex = index;
+}
+
+void Viewport::PostProcess()
+{
+    if (GetWidth() == 0 || GetHeight() == 0)
+    {
+        return;
+    }
+
+    // front buffer is generated from the accumulated samples only, there is no preview pass to show
+    mPreviewLevel = 0;
+
+    mPostprocessParams.fullUpdateRequired = true;
+    mPostprocessParams.numPasses = mProgress.passesFinished;
+
+    Waitable waitable;
+    {
+        TaskBuilder taskBuilder(waitable);
+        PerformPostProcess(taskBuilder);
+    }
+    waitable.Wait();
+}
+
+bool Viewport::WriteSamples(OutputStream& stream) const
+{
+    NFE_SCOPED_TIMER(WriteSamples);
+
+    const Block region = GetRenderRegion();
+
+    SamplesHeader header;
+    header.magic = SamplesHeader::Magic;
+    header.version = SamplesHeader::CurrentVersion;
+    header.width = GetWidth();
+    header.height = GetHeight();
+    header.region = region;
+
+    if (!stream.Write(header))
+    {
+        NFE_LOG_ERROR("Viewport: Failed to write samples header");
+        return false;
+    }
+
+    DynArray<uint32> numSamples;
+    numSamples.Resize(region.Width());
+
+    for (uint32 y = region.minY; y < region.maxY; ++y)
+    {
+        const size_t rowDataSize = sizeof(Vec3f) * region.Width();
+        const Vec3f& sumRow = mSum.GetPixelRef<Vec3f>(region.minX, y);
+        const Vec3f& secondarySumRow = mSecondarySum.GetPixelRef<Vec3f>(region.minX, y);
+
+        for (uint32 x = region.minX; x < region.maxX; ++x)
+        {
+            numSamples[x - region.minX] = GetNumPixelSamples(x, y);
+        }
+
+        if (stream.Write(&sumRow, rowDataSize) != rowDataSize ||
+            stream.Write(&secondarySumRow, rowDataSize) != rowDataSize ||
+            stream.Write(numSamples.Data(), sizeof(uint32) * numSamples.Size()) != sizeof(uint32) * numSamples.Size())
+        {
+            NFE_LOG_ERROR("Viewport: Failed to write samples");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Viewport::MergeSamples(InputStream& stream)
+{
+    NFE_SCOPED_TIMER(MergeSamples);
+
+    SamplesHeader header;
+    if (stream.Read(&header, sizeof(header)) != sizeof(header))
+    {
+        NFE_LOG_ERROR("Viewport: Failed to read samples header");
+        return false;
+    }
+
+    if (header.magic != SamplesHeader::Magic || header.version != SamplesHeader::CurrentVersion)
+    {
+        NFE_LOG_ERROR("Viewport: Invalid samples header");
+        return false;
+    }
+
+    if (header.width != GetWidth() || header.height != GetHeight())
+    {
+        NFE_LOG_ERROR("Viewport: Samples resolution (%ux%u) does not match the viewport (%ux%u)",
+            header.width, header.height, GetWidth(), GetHeight());
+        return false;
+    }
+
+    const Block& region = header.region;
+    if (region.minX >= region.maxX || region.minY >= region.maxY || region.maxX > GetWidth() || region.maxY > GetHeight())
+    {
+        NFE_LOG_ERROR("Viewport: Invalid samples region");
+        return false;
+    }
+
+    DynArray<Vec3f> sumRow;
+    DynArray<Vec3f> secondarySumRow;
+    DynArray<uint32> numSamples;
+    sumRow.Resize(region.Width());
+    secondarySumRow.Resize(region.Width());
+    numSamples.Resize(region.Width());
+
+    for (uint32 y = region.minY; y < region.maxY; ++y)
+    {
+        const size_t rowDataSize = sizeof(Vec3f) * region.Width();
+        if (stream.Read(sumRow.Data(), rowDataSize) != rowDataSize ||
+            stream.Read(secondarySumRow.Data(), rowDataSize) != rowDataSize ||
+            stream.Read(numSamples.Data(), sizeof(uint32) * numSamples.Size()) != sizeof(uint32) * numSamples.Size())
+        {
+            NFE_LOG_ERROR("Viewport: Failed to read samples");
+            return false;
+        }
+
+        for (uint32 x = region.minX; x < region.maxX; ++x)
+        {
+            const uint32 i = x - region.minX;
+            mSum.GetPixelRef<Vec3f>(x, y) += sumRow[i];
+            mSecondarySum.GetPixelRef<Vec3f>(x, y) += secondarySumRow[i];
+            mCarriedSamples[GetWidth() * y + x] += numSamples[i];
+        }
+    }
+
+    mPostprocessParams.fullUpdateRequired = true;
+
+    return true;
+}
+
+bool Viewport::OpenCheckpoint(const StringView& path, uint64 identityHash, uint32 intervalPasses)
+{
+    if (GetWidth() == 0 || GetHeight() == 0)
+    {
+        NFE_LOG_ERROR("Viewport: Cannot open checkpoint for empty viewport");
+        return false;
+    }
+
+    if (!mCheckpoint.Open(path, GetWidth(), GetHeight(), GetMaxNumBlocks(), identityHash))
+    {
+        return false;
+    }
+
+    mCheckpointInterval = intervalPasses;
+
+    if (mCheckpoint.HasValidState())
+    {
+        if (!ResumeFromCheckpoint())
+        {
+            NFE_LOG_WARNING("Viewport: Failed to resume rendering from checkpoint");
+            Reset();
+        }
+    }
+
+    return true;
+}
+
+void Viewport::CloseCheckpoint()
+{
+    mCheckpoint.Close();
+    mCheckpointInterval = 0;
+}
+
+bool Viewport::WriteCheckpoint(bool sync)
+{
+    NFE_SCOPED_TIMER(WriteCheckpoint);
+
+    if (!mCheckpoint.IsOpened())
+    {
+        return false;
+    }
+
+    RenderCheckpoint::State state;
+    state.passesFinished = mProgress.passesFinished;
+    state.activePixels = mProgress.activePixels;
+    state.activeBlocks = mProgress.activeBlocks;
+    state.converged = mProgress.converged;
+    state.averageError = mProgress.averageError;
+    state.firstPassIndex = mFirstPassIndex;
+    state.haltonSeed = mHaltonSeed;
+    state.haltonSampleIndex = mHaltonSampleIndex;
+
+    return mCheckpoint.Write(state, mSum, mSecondarySum, mCarriedSamples.Data(), mBlocks, sync);
+}
+
+bool Viewport::ResumeFromCheckpoint()
+{
+    RenderCheckpoint::State state;
+    if (!mCheckpoint.Read(state, mSum, mSecondarySum, mCarriedSamples.Data(), mBlocks))
+    {
+        return false;
+    }
+
+    mProgress.passesFinished = state.passesFinished;
+    mProgress.activePixels = state.activePixels;
+    mProgress.activeBlocks = state.activeBlocks;
+    mProgress.converged = state.converged;
+    mProgress.averageError = state.averageError;
+    mFirstPassIndex = state.firstPassIndex;
+    mHaltonSeed = state.haltonSeed;
+    InitHaltonSequence(state.haltonSeed, state.haltonSampleIndex);
+
+    mPreviewLevel = 0;
+    mDepthBufferValid = false;
+    mPostprocessParams.fullUpdateRequired = true;
+
+    GenerateRenderingTiles();
+
+    return true;
+}
+
+// number of blocks after full subdivision of a block (see UpdateBlocksList)
+static uint32 CountSubBlocks(uint32 width, uint32 height, uint32 minBlockSize)
+{
+    if (width <= minBlockSize && height <= minBlockSize)
+    {
+        return 1;
+    }
+
+    if (width > height)
+    {
+        return CountSubBlocks(width / 2u, height, minBlockSize) + CountSubBlocks(width - width / 2u, height, minBlockSize);
+    }
+
+    return CountSubBlocks(width, height / 2u, minBlockSize) + CountSubBlocks(width, height - height / 2u, minBlockSize);
+}
+
+uint32 Viewport::GetMaxNumBlocks() const
+{
+    const AdaptiveRenderingSettings& settings = mParams.adaptiveSettings;
+
+    // initial blocks list consists of full blocks and (possibly) smaller blocks at the right and bottom edges
+    const uint32 blockSize = settings.maxBlockSize;
+    const uint32 width = GetWidth();
+    const uint32 height = GetHeight();
+    const uint32 fullColumns = width / blockSize;
+    const uint32 fullRows = height / blockSize;
+    const uint32 lastColumnWidth = width % blockSize;
+    const uint32 lastRowHeight = height % blockSize;
+
+    uint64 numBlocks = static_cast<uint64>(fullColumns) * fullRows * CountSubBlocks(blockSize, blockSize, settings.minBlockSize);
+    if (lastColumnWidth > 0)
+    {
+        numBlocks += static_cast<uint64>(fullRows) * CountSubBlocks(lastColumnWidth, blockSize, settings.minBlockSize);
+    }
+    if (lastRowHeight > 0)
+    {
+        numBlocks += static_cast<uint64>(fullColumns) * CountSubBlocks(blockSize, lastRowHeight, settings.minBlockSize);
+    }
+    if (lastColumnWidth > 0 && lastRowHeight > 0)
+    {
+        numBlocks += CountSubBlocks(lastColumnWidth, lastRowHeight, settings.minBlockSize);
+    }
+
+    return static_cast<uint32>(Min<uint64>(numBlocks, static_cast<uint64>(width) * height));
+}
+
 void Viewport::Reset()
 {
     mPostprocessParams.fullUpdateRequired = true;
 
     mProgress = RenderingProgress();
 
-    mHaltonSequence.Initialize(mParams.samplingParams.dimensions);
+    ResetHaltonSequence();
 
-    mSum.Clear();
-    mSecondarySum.Clear();
+    ClearAccumulationBuffers();
 
-    memset(mPassesPerPixel.Data(), 0, sizeof(uint32) * GetWidth() * GetHeight());
+    mDepthBufferValid = false;
+
+    mPreviewLevel = Min(mParams.numPreviewPasses, 3u);
 
     BuildInitialBlocksList();
 }
 
+void Viewport::ComputeDepthBuffer(const Scene& scene, const Camera& camera, DynArray<float>& outDepth, TaskBuilder& taskBuilder)
+{
+    const uint32 width = GetWidth();
+    const uint32 height = GetHeight();
+    const Vec4f invSize = VECTOR_ONE2 / Vec4f::FromIntegers(width, height, 1, 1);
+
+    taskBuilder.ParallelFor("ComputeDepthBuffer", height, [this, &scene, &camera, &outDepth, width, height, invSize](const TaskContext& context, uint32 y)
+    {
+        RenderingContext& ctx = mThreadData[context.threadId];
+        ctx.params = &mParams;
+        ctx.time = 0.0f;
+
+        const uint32 realY = height - 1u - y;
+
+        for (uint32 x = 0; x < width; ++x)
+        {
+            const Vec4f coords = Vec4f::FromIntegers(x, realY, 0, 0) * invSize;
+            const Ray ray = camera.GeneratePinholeRay(coords);
+
+            HitPoint hitPoint;
+            scene.Traverse({ ray, hitPoint, ctx });
+
+            outDepth[width * y + x] = hitPoint.distance;
+        }
+    });
+}
+
+bool Viewport::Reproject(const Scene& scene, const Camera& camera)
+{
+    NFE_SCOPED_TIMER(Reproject);
+
+    const ReprojectionSettings& settings = mParams.reprojectionSettings;
+    const uint32 width = GetWidth();
+    const uint32 height = GetHeight();
+
+    if (!settings.enable || !mHasLastCamera || width == 0 || height == 0)
+    {
+        Reset();
+        return false;
+    }
+
+    // buffers are allocated lazily, so memory is not wasted when reprojection is not used
+    if (mPrevSum.GetWidth() != width || mPrevSum.GetHeight() != height)
+    {
+        Bitmap::InitData initData;
+        initData.width = width;
+        initData.height = height;
+        initData.format = Bitmap::Format::R32G32B32_Float;
+
+        if (!mPrevSum.Init(initData) || !mPrevSecondarySum.Init(initData))
+        {
+            Reset();
+            return false;
+        }
+    }
+
+    mDepthBuffer.Resize(width * height);
+    mPrevDepthBuffer.Resize(width * height);
+    mPrevCarriedSamples.Resize(width * height);
+
+    if (!Bitmap::Copy(mPrevSum, mSum) || !Bitmap::Copy(mPrevSecondarySum, mSecondarySum))
+    {
+        Reset();
+        return false;
+    }
+
+    mPrevCarriedSamples.Swap(mCarriedSamples);
+    mPrevDepthBuffer.Swap(mDepthBuffer);
+
+    const Camera& prevCamera = mLastCamera;
+    const Vec4f prevCameraPosition = prevCamera.GetLocalToWorld().GetTranslation();
+    const uint32 prevPasses = mProgress.passesFinished;
+    const Vec4f filmSize = Vec4f::FromIntegers(width, height, 1, 1);
+    const Vec4f invSize = VECTOR_ONE2 / filmSize;
+
+    Waitable waitable;
+    {
+        TaskBuilder taskBuilder(waitable);
+
+        // depth for the previous camera is missing after a reset
+        if (!mDepthBufferValid)
+        {
+            ComputeDepthBuffer(scene, prevCamera, mPrevDepthBuffer, taskBuilder);
+        }
+
+        ComputeDepthBuffer(scene, camera, mDepthBuffer, taskBuilder);
+
+        taskBuilder.Fence();
+
+        taskBuilder.ParallelFor("Reproject", height, [&](const TaskContext&, uint32 y)
+        {
+            const uint32 realY = height - 1u - y;
+
+            for (uint32 x = 0; x < width; ++x)
+            {
+                const uint32 pixelIndex = width * y + x;
+
+                Vec3f& sum = mSum.GetPixelRef<Vec3f>(x, y);
+                Vec3f& secondarySum = mSecondarySum.GetPixelRef<Vec3f>(x, y);
+                sum = Vec3f();
+                secondarySum = Vec3f();
+                mCarriedSamples[pixelIndex] = 0;
+                mConvergedPasses[pixelIndex] = 0;
+
+                // find world-space position of the first hit
+                // NOTE: background is reprojected as a point at infinity (direction only)
+                const Vec4f coords = Vec4f::FromIntegers(x, realY, 0, 0) * invSize;
+                const Ray ray = camera.GeneratePinholeRay(coords);
+                const float depth = mDepthBuffer[pixelIndex];
+                const bool isBackground = depth == HitPoint::DefaultDistance;
+                const Vec4f worldPosition = isBackground ? (prevCameraPosition + ray.dir) : Vec4f::MulAndAdd(ray.dir, depth, ray.origin);
+
+                Vec4f prevFilmCoords;
+                if (!prevCamera.WorldToFilm(worldPosition, prevFilmCoords))
+                {
+                    continue;
+                }
+
+                const int32 prevX = static_cast<int32>(floorf(prevFilmCoords.x * filmSize.x + 0.5f));
+                const int32 prevY = static_cast<int32>(height - 1u) - static_cast<int32>(floorf(prevFilmCoords.y * filmSize.y + 0.5f));
+                if (static_cast<uint32>(prevX) >= width || static_cast<uint32>(prevY) >= height)
+                {
+                    continue;
+                }
+
+                const uint32 prevPixelIndex = width * static_cast<uint32>(prevY) + static_cast<uint32>(prevX);
+                const float prevDepth = mPrevDepthBuffer[prevPixelIndex];
+
+                // reject disoccluded pixels
+                if (isBackground)
+                {
+                    if (prevDepth != HitPoint::DefaultDistance)
+                    {
+                        continue;
+                    }
+                }
+                else
+                {
+                    const float expectedDepth = (worldPosition - prevCameraPosition).Length3();
+                    if (!(Abs(prevDepth - expectedDepth) <= settings.depthTolerance * expectedDepth))
+                    {
+                        continue;
+                    }
+                }
+
+                // carry decayed sample count forward
+                const uint32 prevNumSamples = prevPasses + mPrevCarriedSamples[prevPixelIndex];
+                const uint32 numCarriedSamples = Min(settings.maxCarriedSamples, static_cast<uint32>(static_cast<float>(prevNumSamples) * settings.sampleCountDecay));
+                if (numCarriedSamples == 0)
+                {
+                    continue;
+                }
+
+                const float scale = static_cast<float>(numCarriedSamples) / static_cast<float>(prevNumSamples);
+                sum = mPrevSum.GetPixelRef<Vec3f>(static_cast<uint32>(prevX), static_cast<uint32>(prevY)) * scale;
+                secondarySum = mPrevSecondarySum.GetPixelRef<Vec3f>(static_cast<uint32>(prevX), static_cast<uint32>(prevY)) * scale;
+                mCarriedSamples[pixelIndex] = numCarriedSamples;
+            }
+        });
+    }
+    waitable.Wait();
+
+    mDepthBufferValid = true;
+
+    // reprojected image is already better than low resolution preview
+    mPreviewLevel = 0;
+
+    mPostprocessParams.fullUpdateRequired = true;
+    mProgress = RenderingProgress();
+    ResetHaltonSequence();
+
+    BuildInitialBlocksList();
+
+    return true;
+}
+
 bool Viewport::SetRenderer(IRenderer* renderer)
 {
     mRenderer = renderer;
@@ -206,11 +732,7 @@ bool Viewport::SetRenderingParams(const RenderingParams& params)
 
 bool Viewport::SetPostprocessParams(const PostprocessParams& params)
 {
-    if (mBlurredImages.Size() != params.bloom.elements.Size())
-    {
-        mBlurredImages.Resize(params.bloom.elements.Size());
-        InitBluredImages();
-    }
+    const bool bloomChanged = !RTTI::Compare(mPostprocessParams.params.bloom, params.bloom);
 
     if (!RTTI::Compare(mPostprocessParams.params.lutParams, params.lutParams) ||
         !RTTI::Compare(mPostprocessParams.params.colorGradingParams, params.colorGradingParams) ||
@@ -225,6 +747,11 @@ bool Viewport::SetPostprocessParams(const PostprocessParams& params)
         mPostprocessParams.fullUpdateRequired = true;
     }
 
+    if (bloomChanged || mBlurredImages.Size() != params.bloom.elements.Size())
+    {
+        InitBluredImages();
+    }
+
     // TODO validation
 
     return true;
@@ -253,19 +780,46 @@ bool Viewport::Render(const Scene& scene, const Camera& camera)
         return false;
     }
 
-    DynArray<uint32> seed(mHaltonSequence.GetNumDimensions());
+    const bool useSobol = mParams.samplingParams.sequence == SampleSequence::Sobol;
+
+    DynArray<uint32> seed;
+    if (!useSobol)
     {
+        seed.Resize(mHaltonSequence.GetNumDimensions());
         for (uint32 i = 0; i < mHaltonSequence.GetNumDimensions(); ++i)
         {
             seed[i] = mHaltonSequence.GetInt(i);
         }
         mHaltonSequence.NextSampleLeap();
+        mHaltonSampleIndex++;
     }
 
     const uint32 numThreads = ThreadPool::GetInstance().GetNumThreads();
     const ArrayView<RenderingContext> renderingContexts(mThreadData.Get(), numThreads);
 
-    Film film(mSum, mProgress.passesFinished % 2 == 0 ? &mSecondarySum : nullptr);
+    // low resolution preview passes are not accumulated, samples are only upsampled in post-process
+    const bool isPreviewPass = mPreviewLevel > 0;
+    if (isPreviewPass)
+    {
+        if (mPreviewImage.GetWidth() != width || mPreviewImage.GetHeight() != height)
+        {
+            Bitmap::InitData initData;
+            initData.width = width;
+            initData.height = height;
+            initData.format = Bitmap::Format::R32G32B32_Float;
+
+            if (!mPreviewImage.Init(initData))
+            {
+                return false;
+            }
+        }
+
+        mPreviewImage.Clear();
+    }
+
+    Film film = isPreviewPass ?
+        Film(mPreviewImage) :
+        Film(mSum, mProgress.passesFinished % 2 == 0 ? &mSecondarySum : nullptr);
     const IRenderer::RenderParam renderParam = { scene, camera, mProgress.passesFinished, film };
 
     Waitable waitable;
@@ -282,7 +836,14 @@ bool Viewport::Render(const Scene& scene, const Camera& camera)
             ctx.pixelBreakpoint = mPendingPixelBreakpoint;
 #endif // NFE_CONFIGURATION_FINAL
 
-            ctx.sampler.ResetFrame(seed, ctx.params->samplingParams.useBlueNoiseDithering);
+            if (useSobol)
+            {
+                ctx.sampler.ResetFrame(mFirstPassIndex + mProgress.passesFinished);
+            }
+            else
+            {
+                ctx.sampler.ResetFrame(seed, ctx.params->samplingParams.useBlueNoiseDithering);
+            }
         }
 
 #ifndef NFE_CONFIGURATION_FINAL
@@ -304,26 +865,50 @@ bool Viewport::Render(const Scene& scene, const Camera& camera)
         taskBuilder.Fence();
 
         // render tiles
-        taskBuilder.ParallelFor("Render", mRenderingTiles.Size(), [pixelOffset, this, &renderParam] (const TaskContext& context, uint32 index)
+        // each task takes a tile from the queue, preferably from the NUMA node of the running thread
+        mRenderingTilesQueue.Reset();
+        taskBuilder.ParallelFor("Render", mRenderingTilesQueue.Size(), [pixelOffset, this, &renderParam] (const TaskContext& context, uint32)
         {
+            Block tile;
+            if (!mRenderingTilesQueue.Pop(ThreadPool::GetInstance().GetThreadNumaNode(context.threadId), tile))
+            {
+                return;
+            }
+
             const TileRenderingContext tileContext =
             {
                 *mRenderer,
                 renderParam,
-                pixelOffset* mThreadData[0].params->antiAliasingSpread
+                pixelOffset* mThreadData[0].params->antiAliasingSpread,
+                GetPreviewPixelStep()
             };
-            RenderTile(tileContext, mThreadData[context.threadId], mRenderingTiles[index]);
+            RenderTile(tileContext, mThreadData[context.threadId], tile);
         });
 
         taskBuilder.Fence();
 
+        mPostprocessParams.numPasses = 1u + mProgress.passesFinished;
         PerformPostProcess(taskBuilder);
     }
     waitable.Wait();
 
-    mProgress.passesFinished++;
+    // no texture sampling is in progress now, so evicted texture tiles can be freed
+    TextureCache::GetInstance().CollectGarbage();
+
+    mLastCamera = camera;
+    mHasLastCamera = true;
+
+    if (isPreviewPass)
+    {
+        // next pass will use 4x more pixels, full resolution accumulation starts when the level reaches zero
+        mPreviewLevel--;
+    }
+    else
+    {
+        mProgress.passesFinished++;
+    }
 
-    if ((mProgress.passesFinished > 0) && (mProgress.passesFinished % 2 == 0))
+    if (!isPreviewPass && (mProgress.passesFinished > 0) && (mProgress.passesFinished % 2 == 0))
     {
         if (mParams.adaptiveSettings.enable)
         {
@@ -336,6 +921,13 @@ bool Viewport::Render(const Scene& scene, const Camera& camera)
         }
     }
 
+    if (!isPreviewPass && mCheckpoint.IsOpened() && mCheckpointInterval > 0 && (mProgress.passesFinished % mCheckpointInterval == 0))
+    {
+        // don't block rendering waiting for the disk
+        // mapped memory survives process crash, a slot torn by OS crash or power loss is discarded on load (checksum mismatch)
+        WriteCheckpoint(false);
+    }
+
     // accumulate counters
     mCounters.Reset();
     for (const RenderingContext& ctx : renderingContexts)
@@ -350,6 +942,9 @@ void Viewport::RenderTile(const TileRenderingContext& tileContext, RenderingCont
 {
     NFE_SCOPED_TIMER(Viewport_RenderTile);
 
+    // texture cache epoch is announced once for the whole tile, not for every texel
+    const TextureCache::AccessScope textureAccessScope;
+
     Timer timer;
 
     NFE_ASSERT(tile.minX < tile.maxX, "");
@@ -360,63 +955,81 @@ void Viewport::RenderTile(const TileRenderingContext& tileContext, RenderingCont
     const Vec4f filmSize = Vec4f::FromIntegers(GetWidth(), GetHeight(), 1, 1);
     const Vec4f invSize = VECTOR_ONE2 / filmSize;
 
-    if (ctx.params->traversalMode == TraversalMode::Single)
+    const auto renderPixel = [&](uint32 x, uint32 y)
     {
-        uint32 x = tile.minX;
-        uint32 y = tile.minY;
+        const uint32 realY = GetHeight() - 1u - y;
 
-        for (const TileOffset& tileOffset : mTileOffsets)
+#ifndef NFE_CONFIGURATION_FINAL
+        if (ctx.pixelBreakpoint.x == x && ctx.pixelBreakpoint.y == y)
         {
-            x += tileOffset.x;
-            y += tileOffset.y;
+            NFE_BREAK();
+        }
+#endif // NFE_CONFIGURATION_FINAL
 
-            if (x >= tile.maxX || y >= tile.maxY)
-            {
-                continue;
-            }
+        const Vec4f coords = (Vec4f::FromIntegers(x, realY, 0, 0) + tileContext.sampleOffset) * invSize;
 
-            const uint32 realY = GetHeight() - 1u - y;
+        ctx.sampler.ResetPixel(x, y);
+        ctx.time = ctx.randomGenerator.GetFloat() * ctx.params->motionBlurStrength;
+#ifdef NFE_ENABLE_SPECTRAL_RENDERING
+        ctx.wavelength.Randomize(ctx.sampler.GetFloat());
+#endif // NFE_ENABLE_SPECTRAL_RENDERING
 
-#ifndef NFE_CONFIGURATION_FINAL
-            if (ctx.pixelBreakpoint.x == x && ctx.pixelBreakpoint.y == y)
-            {
-                NFE_BREAK();
-            }
-#endif // NFE_CONFIGURATION_FINAL
+        // generate primary ray
+        const Ray ray = tileContext.renderParam.camera.GenerateRay(coords, ctx);
+
+        if (ctx.params->visualizeTimePerPixel)
+        {
+            timer.Start();
+        }
 
-            const Vec4f coords = (Vec4f::FromIntegers(x, realY, 0, 0) + tileContext.sampleOffset) * invSize;
+        RayColor color = tileContext.renderer.RenderPixel(ray, tileContext.renderParam, ctx);
+        NFE_ASSERT(color.IsValid(), "");
 
-            ctx.sampler.ResetPixel(x, y);
-            ctx.time = ctx.randomGenerator.GetFloat() * ctx.params->motionBlurStrength;
-#ifdef NFE_ENABLE_SPECTRAL_RENDERING
-            ctx.wavelength.Randomize(ctx.sampler.GetFloat());
+        if (ctx.params->visualizeTimePerPixel)
+        {
+            const float timePerRay = 1000.0f * static_cast<float>(timer.Stop());
+            color = RayColor(timePerRay);
+        }
+
+        const Vec4f sampleColor = color.ConvertToTristimulus(ctx.wavelength);
+
+#ifndef NFE_ENABLE_SPECTRAL_RENDERING
+        // exception: in spectral rendering these values can get below zero due to RGB->Spectrum conversion
+        NFE_ASSERT((sampleColor >= Vec4f::Zero()).All(), "");
 #endif // NFE_ENABLE_SPECTRAL_RENDERING
 
-            // generate primary ray
-            const Ray ray = tileContext.renderParam.camera.GenerateRay(coords, ctx);
+        tileContext.renderParam.film.AccumulateColor(x, y, sampleColor);
+    };
 
-            if (ctx.params->visualizeTimePerPixel)
+    const uint32 pixelStep = tileContext.pixelStep;
+
+    if (pixelStep > 1)
+    {
+        // low resolution preview pass: trace only pixels lying on a coarse grid (regardless of traversal mode)
+        for (uint32 y = RoundUp(tile.minY, pixelStep); y < tile.maxY; y += pixelStep)
+        {
+            for (uint32 x = RoundUp(tile.minX, pixelStep); x < tile.maxX; x += pixelStep)
             {
-                timer.Start();
+                renderPixel(x, y);
             }
+        }
+    }
+    else if (ctx.params->traversalMode == TraversalMode::Single)
+    {
+        uint32 x = tile.minX;
+        uint32 y = tile.minY;
 
-            RayColor color = tileContext.renderer.RenderPixel(ray, tileContext.renderParam, ctx);
-            NFE_ASSERT(color.IsValid(), "");
+        for (const TileOffset& tileOffset : mTileOffsets)
+        {
+            x += tileOffset.x;
+            y += tileOffset.y;
 
-            if (ctx.params->visualizeTimePerPixel)
+            if (x >= tile.maxX || y >= tile.maxY)
             {
-                const float timePerRay = 1000.0f * static_cast<float>(timer.Stop());
-                color = RayColor(timePerRay);
+                continue;
             }
 
-            const Vec4f sampleColor = color.ConvertToTristimulus(ctx.wavelength);
-
-#ifndef NFE_ENABLE_SPECTRAL_RENDERING
-            // exception: in spectral rendering these values can get below zero due to RGB->Spectrum conversion
-            NFE_ASSERT((sampleColor >= Vec4f::Zero()).All(), "");
-#endif // NFE_ENABLE_SPECTRAL_RENDERING
-
-            tileContext.renderParam.film.AccumulateColor(x, y, sampleColor);
+            renderPixel(x, y);
         }
     }
     else if (ctx.params->traversalMode == TraversalMode::Packet)
@@ -547,28 +1160,83 @@ void Viewport::RenderTile(const TileRenderingContext& tileContext, RenderingCont
         ctx.counters.Append(ctx.localCounters);
     }
 
-    ctx.counters.numPrimaryRays += (uint64)(tile.maxY - tile.minY) * (uint64)(tile.maxX - tile.minX);
+    ctx.counters.numPrimaryRays += (uint64)(tile.maxY - tile.minY) * (uint64)(tile.maxX - tile.minX) / (uint64)Sqr(pixelStep);
 }
 
-void Viewport::PerformPostProcess(TaskBuilder& taskBuilder)
+void Viewport::UpdateBloom(TaskBuilder& taskBuilder)
 {
-    NFE_SCOPED_TIMER(PerformPostProcess);
+    NFE_SCOPED_TIMER(UpdateBloom);
+
+    using Region = BitmapUtils::Region;
 
-    if (!mBlurredImages.Empty() && mPostprocessParams.params.bloom.factor > 0.0f)
+    // find region of the image that has changed
+    Region dirtyRegion(0, GetWidth(), 0, GetHeight());
+    if (!mPostprocessParams.fullUpdateRequired)
     {
-        for (uint32 i = 0; i < mBlurredImages.Size(); ++i)
+        if (mRenderingTiles.Empty())
         {
-            const Bitmap& sourceBitmap = i == 0 ? mSum : mBlurredImages[i - 1];
-
-            BitmapUtils::GaussianBlurParams blurParams;
-            blurParams.numPasses = mPostprocessParams.params.bloom.elements[i].numBlurPasses;
-            blurParams.sigma = mPostprocessParams.params.bloom.elements[i].sigma;     
-            BitmapUtils::GaussianBlur(mBlurredImages[i], sourceBitmap, blurParams, taskBuilder);
+            return;
+        }
 
-            taskBuilder.Fence();
+        dirtyRegion = mRenderingTiles.Front();
+        for (const Block& tile : mRenderingTiles)
+        {
+            dirtyRegion.minX = Min(dirtyRegion.minX, tile.minX);
+            dirtyRegion.maxX = Max(dirtyRegion.maxX, tile.maxX);
+            dirtyRegion.minY = Min(dirtyRegion.minY, tile.minY);
+            dirtyRegion.maxY = Max(dirtyRegion.maxY, tile.maxY);
         }
     }
 
+    // update pyramid
+    StaticArray<Region, 16> levelRegions;
+    levelRegions.PushBack(dirtyRegion);
+    for (uint32 i = 0; i < mBloomPyramid.Size(); ++i)
+    {
+        const Region& prevRegion = levelRegions.Back();
+        const Region region(prevRegion.minX / 2u, (prevRegion.maxX + 1u) / 2u, prevRegion.minY / 2u, (prevRegion.maxY + 1u) / 2u);
+        levelRegions.PushBack(region);
+
+        const Bitmap& sourceBitmap = i == 0 ? mSum : mBloomPyramid[i - 1];
+        BitmapUtils::Downsample(mBloomPyramid[i], sourceBitmap, region, taskBuilder);
+        taskBuilder.Fence();
+    }
+
+    // blur each bloom element on its own pyramid level
+    for (uint32 i = 0; i < mBlurredImages.Size(); ++i)
+    {
+        BloomImage& bloomImage = mBlurredImages[i];
+        const Bitmap& sourceBitmap = bloomImage.level == 0 ? mSum : mBloomPyramid[bloomImage.level - 1u];
+
+        BitmapUtils::GaussianBlurParams blurParams;
+        blurParams.numPasses = mPostprocessParams.params.bloom.elements[i].numBlurPasses;
+        blurParams.sigma = bloomImage.sigma;
+
+        // blurred image changes within blur radius from the dirty region
+        const Region& levelRegion = levelRegions[bloomImage.level];
+        const uint32 radius = BitmapUtils::GetGaussianBlurRadius(blurParams);
+        blurParams.region = Region(
+            levelRegion.minX > radius ? levelRegion.minX - radius : 0u,
+            levelRegion.maxX + radius,
+            levelRegion.minY > radius ? levelRegion.minY - radius : 0u,
+            levelRegion.maxY + radius);
+
+        BitmapUtils::GaussianBlur(bloomImage.image, sourceBitmap, bloomImage.temp, blurParams, taskBuilder);
+    }
+
+    taskBuilder.Fence();
+}
+
+void Viewport::PerformPostProcess(TaskBuilder& taskBuilder)
+{
+    NFE_SCOPED_TIMER(PerformPostProcess);
+
+    // NOTE: bloom is not applied in preview passes, as the "sum" image is empty at this point
+    if (!mBlurredImages.Empty() && mPostprocessParams.params.bloom.factor > 0.0f && mPreviewLevel == 0)
+    {
+        UpdateBloom(taskBuilder);
+    }
+
     mPostprocessParams.colorScale = Vec4f(exp2f(mPostprocessParams.params.exposure));
 
     if (!mPostprocessLUT.IsGenerated() || mPostprocessParams.lutGenerationRequired)
@@ -644,6 +1312,49 @@ static void ApplyDither(Vec4f& color, Random& randomGenerator)
     color += dither * (1.0f / scale);
 }
 
+// bilinear upsampling of bloom pyramid level
+static const Vec4f SampleBloomImage(const Bitmap& bitmap, uint32 level, uint32 x, uint32 y)
+{
+    if (level == 0)
+    {
+        return Vec4f(bitmap.GetPixelRef<Vec3f>(x, y));
+    }
+
+    const float scale = 1.0f / static_cast<float>(1u << level);
+    const float fx = Max(0.0f, (static_cast<float>(x) + 0.5f) * scale - 0.5f);
+    const float fy = Max(0.0f, (static_cast<float>(y) + 0.5f) * scale - 0.5f);
+
+    const uint32 x0 = Min(static_cast<uint32>(fx), bitmap.GetWidth() - 1u);
+    const uint32 y0 = Min(static_cast<uint32>(fy), bitmap.GetHeight() - 1u);
+    const uint32 x1 = Min(x0 + 1u, bitmap.GetWidth() - 1u);
+    const uint32 y1 = Min(y0 + 1u, bitmap.GetHeight() - 1u);
+    const float wx = fx - static_cast<float>(x0);
+    const float wy = fy - static_cast<float>(y0);
+
+    const Vec4f top = Vec4f::Lerp(Vec4f(bitmap.GetPixelRef<Vec3f>(x0, y0)), Vec4f(bitmap.GetPixelRef<Vec3f>(x1, y0)), wx);
+    const Vec4f bottom = Vec4f::Lerp(Vec4f(bitmap.GetPixelRef<Vec3f>(x0, y1)), Vec4f(bitmap.GetPixelRef<Vec3f>(x1, y1)), wx);
+    return Vec4f::Lerp(top, bottom, wy);
+}
+
+// bilinear upsampling of low resolution preview pass
+// samples are stored in full resolution image, but only at pixels with coordinates being multiple of the step
+static const Vec4f SamplePreviewImage(const Bitmap& bitmap, uint32 step, uint32 x, uint32 y)
+{
+    const uint32 lastX = (bitmap.GetWidth() - 1u) / step * step;
+    const uint32 lastY = (bitmap.GetHeight() - 1u) / step * step;
+
+    const uint32 x0 = x / step * step;
+    const uint32 y0 = y / step * step;
+    const uint32 x1 = Min(x0 + step, lastX);
+    const uint32 y1 = Min(y0 + step, lastY);
+    const float wx = static_cast<float>(x - x0) / static_cast<float>(step);
+    const float wy = static_cast<float>(y - y0) / static_cast<float>(step);
+
+    const Vec4f top = Vec4f::Lerp(Vec4f(bitmap.GetPixelRef<Vec3f>(x0, y0)), Vec4f(bitmap.GetPixelRef<Vec3f>(x1, y0)), wx);
+    const Vec4f bottom = Vec4f::Lerp(Vec4f(bitmap.GetPixelRef<Vec3f>(x0, y1)), Vec4f(bitmap.GetPixelRef<Vec3f>(x1, y1)), wx);
+    return Vec4f::Lerp(top, bottom, wy);
+}
+
 void Viewport::PostProcessTile(const Block& block, uint32 threadID)
 {
     NFE_SCOPED_TIMER(Viewport_PostProcessTile);
@@ -653,18 +1364,24 @@ void Viewport::PostProcessTile(const Block& block, uint32 threadID)
     const PostprocessParams& params = mPostprocessParams.params;
     NFE_ASSERT(params.tonemapper, "Tonemapper missing");
 
-    const bool useBloom = params.bloom.factor > 0.0f && !mBlurredImages.Empty();
-    const float fireflyFilterTreshold = params.fireflyFilterTreshold;
+    const uint32 previewPixelStep = GetPreviewPixelStep();
+    const bool isPreview = previewPixelStep > 1;
+
+    const bool useBloom = params.bloom.factor > 0.0f && !mBlurredImages.Empty() && !isPreview;
+    const float fireflyFilterTreshold = isPreview ? FLT_MAX : params.fireflyFilterTreshold;
 
-    // exposure + scale down by number of rendering passes finished
+    // exposure + scale down by number of rendering passes finished (plus samples carried over by reprojection)
     // TODO support different number of passes per-pixel (adaptive rendering)
-    const Vec4f pixelScaling = mPostprocessParams.colorScale / (float)(1u + mProgress.passesFinished);
+    // preview image contains exactly one sample per pixel
+    const uint32 numPasses = isPreview ? 1u : mPostprocessParams.numPasses;
   
     for (uint32 y = block.minY; y < block.maxY; ++y)
     {
         for (uint32 x = block.minX; x < block.maxX; ++x)
         {
-            Vec4f rawValue = Vec4f_Load_Vec3f_Unsafe(mSum.GetPixelRef<Vec3f>(x, y));
+            Vec4f rawValue = isPreview ?
+                SamplePreviewImage(mPreviewImage, previewPixelStep, x, y) :
+                Vec4f_Load_Vec3f_Unsafe(mSum.GetPixelRef<Vec3f>(x, y));
 
             // anti-firefly filtering
             if (fireflyFilterTreshold < 100.0f)
@@ -694,7 +1411,7 @@ void Viewport::PostProcessTile(const Block& block, uint32 threadID)
                 Vec4f bloomColor = Vec4f::Zero();
                 for (uint32 i = 0; i < mBlurredImages.Size(); ++i)
                 {
-                    const Vec4f blurredColor = Vec4f_Load_Vec3f_Unsafe(mBlurredImages[i].GetPixelRef<Vec3f>(x, y));
+                    const Vec4f blurredColor = SampleBloomImage(mBlurredImages[i].image, mBlurredImages[i].level, x, y);
                     bloomColor = Vec4f::MulAndAdd(blurredColor, params.bloom.elements[i].weight, bloomColor);
                 }
                 rawValue = Vec4f::Lerp(rawValue, bloomColor, params.bloom.factor);
@@ -719,8 +1436,9 @@ void Viewport::PostProcessTile(const Block& block, uint32 threadID)
 #endif
 
             // scale down by number of rendering passes finished
-            // TODO support different number of passes per-pixel (adaptive rendering)
-            rgbColor *= pixelScaling;
+            // NOTE: pixels may have no samples yet when the image is assembled from merged samples
+            const uint32 numSamples = Max(1u, numPasses + mCarriedSamples[GetWidth() * y + x]);
+            rgbColor *= mPostprocessParams.colorScale / static_cast<float>(numSamples);
 
             if (params.filmGrainStrength > 0.0f)
             {
@@ -753,14 +1471,14 @@ float Viewport::ComputeBlockError(const Block& block) const
 
     NFE_ASSERT(mProgress.passesFinished % 2 == 0, "This funcion can be only called after even number of passes");
 
-    const float imageScalingFactor = 1.0f / (float)mProgress.passesFinished;
-
     float totalError = 0.0f;
     for (uint32 y = block.minY; y < block.maxY; ++y)
     {
         float rowError = 0.0f;
         for (uint32 x = block.minX; x < block.maxX; ++x)
         {
+            const uint32 numSamples = mProgress.passesFinished + mCarriedSamples[GetWidth() * y + x];
+            const float imageScalingFactor = 1.0f / (float)numSamples;
             const Vec4f a = imageScalingFactor * Vec4f_Load_Vec3f_Unsafe(mSum.GetPixelRef<Vec3f>(x, y));
             const Vec4f b = (2.0f * imageScalingFactor) * Vec4f_Load_Vec3f_Unsafe(mSecondarySum.GetPixelRef<Vec3f>(x, y));
             const Vec4f diff = Vec4f::Abs(a - b);
@@ -777,6 +1495,67 @@ float Viewport::ComputeBlockError(const Block& block) const
     return totalError * Sqrt((float)blockArea / (float)totalArea) / (float)blockArea;
 }
 
+void Viewport::ClearAccumulationBuffers()
+{
+    NFE_SCOPED_TIMER(ClearAccumulationBuffers);
+
+    const uint32 width = GetWidth();
+    const uint32 height = GetHeight();
+    if (width == 0 || height == 0)
+    {
+        return;
+    }
+
+    static constexpr uint32 RowsPerBlock = 16;
+
+    DynArray<Block> blocks;
+    for (uint32 y = 0; y < height; y += RowsPerBlock)
+    {
+        blocks.PushBack(Block(0, width, y, Min(height, y + RowsPerBlock)));
+    }
+
+    ThreadPool& threadPool = ThreadPool::GetInstance();
+
+    NumaBlockQueue queue;
+    queue.Init(blocks, height, threadPool.GetNumNumaNodes());
+
+    // salt is generated only after resize, seeded per block, so it does not depend on the blocks processing order
+    const bool initPixelSalt = !mPixelSaltValid;
+
+    Waitable waitable;
+    {
+        TaskBuilder taskBuilder(waitable);
+        taskBuilder.ParallelFor("Viewport/ClearAccumulationBuffers", queue.Size(), [&](const TaskContext& context, uint32)
+        {
+            Block block;
+            if (!queue.Pop(threadPool.GetThreadNumaNode(context.threadId), block))
+            {
+                return;
+            }
+
+            for (uint32 y = block.minY; y < block.maxY; ++y)
+            {
+                memset(static_cast<void*>(&mSum.GetPixelRef<Vec3f>(0, y)), 0, width * sizeof(Vec3f));
+                memset(static_cast<void*>(&mSecondarySum.GetPixelRef<Vec3f>(0, y)), 0, width * sizeof(Vec3f));
+                memset(mCarriedSamples.Data() + y * width, 0, width * sizeof(uint32));
+                memset(mConvergedPasses.Data() + y * width, 0, width * sizeof(uint32));
+            }
+
+            if (initPixelSalt)
+            {
+                Random random(mPixelSaltSeed + block.minY);
+                for (uint32 i = block.minY * width; i < block.maxY * width; ++i)
+                {
+                    mPixelSalt[i] = random.GetVec2f();
+                }
+            }
+        });
+    }
+    waitable.Wait();
+
+    mPixelSaltValid = true;
+}
+
 void Viewport::GenerateRenderingTiles()
 {
     NFE_SCOPED_TIMER(GenerateRenderingTiles);
@@ -804,6 +1583,10 @@ void Viewport::GenerateRenderingTiles()
 #endif
     }
 
+    // preview passes trace only every n-th pixel, so the tiles can be proportionally bigger
+    tileSizeX *= GetPreviewPixelStep();
+    tileSizeY *= GetPreviewPixelStep();
+
     for (const Block& block : mBlocks)
     {
         const uint32 rows = 1 + (block.Height() - 1) / tileSizeX;
@@ -827,6 +1610,8 @@ void Viewport::GenerateRenderingTiles()
             }
         }
     }
+
+    mRenderingTilesQueue.Init(mRenderingTiles, GetHeight(), ThreadPool::GetInstance().GetNumNumaNodes());
 }
 
 void Viewport::BuildInitialBlocksList()
@@ -835,22 +1620,23 @@ void Viewport::BuildInitialBlocksList()
 
     mBlocks.Clear();
 
+    const Block region = GetRenderRegion();
     const uint32 blockSize = mParams.adaptiveSettings.maxBlockSize;
-    const uint32 rows = 1 + (GetHeight() - 1) / blockSize;
-    const uint32 columns = 1 + (GetWidth() - 1) / blockSize;
+    const uint32 rows = 1 + (region.Height() - 1) / blockSize;
+    const uint32 columns = 1 + (region.Width() - 1) / blockSize;
 
     for (uint32 j = 0; j < rows; ++j)
     {
         Block block;
 
-        block.minY = j * blockSize;
-        block.maxY = Min(GetHeight(), (j + 1) * blockSize);
+        block.minY = region.minY + j * blockSize;
+        block.maxY = Min(region.maxY, region.minY + (j + 1) * blockSize);
         NFE_ASSERT(block.maxY > block.minY, "");
 
         for (uint32 i = 0; i < columns; ++i)
         {
-            block.minX = i * blockSize;
-            block.maxX = Min(GetWidth(), (i + 1) * blockSize);
+            block.minX = region.minX + i * blockSize;
+            block.maxX = Min(region.maxX, region.minX + (i + 1) * blockSize);
             NFE_ASSERT(block.maxX > block.minX, "");
 
             mBlocks.PushBack(block);
@@ -860,6 +1646,40 @@ void Viewport::BuildInitialBlocksList()
     mProgress.activeBlocks = mBlocks.Size();
 }
 
+Viewport::Block Viewport::GetRenderRegion() const
+{
+    const Block region(
+        Min(mRenderRegion.minX, GetWidth()),
+        Min(mRenderRegion.maxX, GetWidth()),
+        Min(mRenderRegion.minY, GetHeight()),
+        Min(mRenderRegion.maxY, GetHeight()));
+
+    if (region.minX >= region.maxX || region.minY >= region.maxY)
+    {
+        return Block(0, GetWidth(), 0, GetHeight());
+    }
+
+    return region;
+}
+
+void Viewport::ResetHaltonSequence()
+{
+    mHaltonSeed = mRandomGenerator.GetLong();
+    InitHaltonSequence(mHaltonSeed, mFirstPassIndex);
+}
+
+void Viewport::InitHaltonSequence(uint64 seed, uint32 sampleIndex)
+{
+    mHaltonSequence.Initialize(mParams.samplingParams.dimensions, seed);
+
+    for (uint32 i = 0; i < sampleIndex; ++i)
+    {
+        mHaltonSequence.NextSampleLeap();
+    }
+
+    mHaltonSampleIndex = sampleIndex;
+}
+
 void Viewport::UpdateBlocksList()
 {
     NFE_SCOPED_TIMER(UpdateBlocksList);
@@ -881,6 +1701,15 @@ void Viewport::UpdateBlocksList()
         if (blockError < settings.convergenceTreshold)
         {
             // block is fully converged - remove it
+            // remember how many samples its pixels got, they won't be rendered in the next passes
+            for (uint32 y = block.minY; y < block.maxY; ++y)
+            {
+                for (uint32 x = block.minX; x < block.maxX; ++x)
+                {
+                    mConvergedPasses[GetWidth() * y + x] = mProgress.passesFinished;
+                }
+            }
+
             mBlocks[i] = mBlocks.Back();
             mBlocks.PopBack();
             continue;
@@ -952,6 +1781,13 @@ void Viewport::UpdateBlocksList()
     mProgress.activeBlocks = mBlocks.Size();
 }
 
+uint32 Viewport::GetNumPixelSamples(uint32 x, uint32 y) const
+{
+    const uint32 pixelIndex = GetWidth() * y + x;
+    const uint32 convergedPasses = mConvergedPasses[pixelIndex];
+    return (convergedPasses > 0 ? convergedPasses : mProgress.passesFinished) + mCarriedSamples[pixelIndex];
+}
+
 void Viewport::VisualizeActiveBlocks(Bitmap& bitmap) const
 {
     NFE_SCOPED_TIMER(VisualizeActiveBlocks);
@@ -6,7 +6,10 @@
 #include "RenderingContext.h"
 #include "Counters.h"
 #include "PostProcess.h"
+#include "RenderCheckpoint.h"
+#include "NumaBlockQueue.h"
 #include "../Renderers/Renderer.h"
+#include "../Scene/Camera.h"
 #include "../Sampling/HaltonSampler.h"
 #include "../Sampling/GenericSampler.h"
 #include "../Utils/Bitmap.h"
@@ -48,8 +51,44 @@ public:
     NFE_RAYTRACER_API bool Render(const Scene& scene, const Camera& camera);
     NFE_RAYTRACER_API void Reset();
 
+    // Restart accumulation for a new camera placement, reusing samples accumulated for the previously rendered camera.
+    // Accumulated image is warped using first-hit depth, disoccluded pixels are rejected.
+    // Falls back to Reset() when reprojection is disabled or not possible. Returns true if the samples were reused.
+    NFE_RAYTRACER_API bool Reproject(const Scene& scene, const Camera& camera);
+
     NFE_RAYTRACER_API void SetPixelBreakpoint(uint32 x, uint32 y);
 
+    // Restrict rendering to a region of the image (empty region means whole image)
+    // NOTE: takes effect after Reset()
+    NFE_RAYTRACER_API void SetRenderRegion(const Math::Rectangle<uint32>& region);
+
+    // Set index of the first sampling pass, so viewports rendering the same image (e.g. in different processes)
+    // do not generate the same samples
+    // NOTE: takes effect after Reset()
+    NFE_RAYTRACER_API void SetFirstPassIndex(uint32 index);
+
+    // Generate front buffer from the accumulated samples without rendering (e.g. after merging samples)
+    // NOTE: ends pending low resolution preview passes
+    NFE_RAYTRACER_API void PostProcess();
+
+    // Serialize samples accumulated in the render region
+    NFE_RAYTRACER_API bool WriteSamples(Common::OutputStream& stream) const;
+
+    // Add samples serialized with WriteSamples() to the accumulated image
+    // Merged samples are counted per-pixel, so the samples may cover any part of the image
+    NFE_RAYTRACER_API bool MergeSamples(Common::InputStream& stream);
+
+    // Attach checkpoint file, so rendering can be resumed after the process gets killed
+    // If the file contains a checkpoint of an image with the same resolution and identity hash, the rendering state is restored from it,
+    // otherwise the checkpoint is discarded. See RenderCheckpoint::ComputeIdentityHash.
+    // Checkpoint is written (asynchronously) every 'intervalPasses' passes, zero disables periodic writes.
+    NFE_RAYTRACER_API bool OpenCheckpoint(const Common::StringView& path, uint64 identityHash, uint32 intervalPasses = 16);
+    NFE_RAYTRACER_API void CloseCheckpoint();
+
+    // Write current rendering state to the checkpoint file
+    // If 'sync' is true, waits until the data is written to the disk.
+    NFE_RAYTRACER_API bool WriteCheckpoint(bool sync = true);
+
     NFE_FORCE_INLINE const Bitmap& GetFrontBuffer() const { return mFrontBuffer; }
     NFE_FORCE_INLINE const Bitmap& GetSumBuffer() const { return mSum; }
 
@@ -59,6 +98,9 @@ public:
     NFE_FORCE_INLINE const RenderingProgress& GetProgress() const { return mProgress; }
     NFE_FORCE_INLINE const RayTracingCounters& GetCounters() const { return mCounters; }
 
+    // number of samples accumulated in a pixel (pixels of converged blocks don't get samples from further passes)
+    NFE_RAYTRACER_API uint32 GetNumPixelSamples(uint32 x, uint32 y) const;
+
     NFE_RAYTRACER_API void VisualizeActiveBlocks(Bitmap& bitmap) const;
 
 private:
@@ -72,6 +114,7 @@ private:
         const IRenderer& renderer;
         IRenderer::RenderParam renderParam;
         const Math::Vec4f sampleOffset;
+        const uint32 pixelStep; // only every n-th pixel (in both directions) is traced in preview passes
     };
 
     struct NFE_ALIGN(16) PostprocessParamsInternal
@@ -79,10 +122,33 @@ private:
         PostprocessParams params;
 
         Math::Vec4f colorScale = Math::Vec4f::Zero();
+        uint32 numPasses = 0; // number of passes in the "sum" image (excluding per-pixel extra samples)
         bool fullUpdateRequired = false;
         bool lutGenerationRequired = false;
     };
 
+    // blurred image used for bloom
+    struct BloomImage
+    {
+        Bitmap image;       // blurred image (in pyramid level resolution)
+        Bitmap temp;        // temporary image for separable blur
+        uint32 level = 0;   // bloom pyramid level
+        float sigma = 0.0f; // blur sigma in pyramid level pixels
+    };
+
+    // header of serialized samples (see WriteSamples)
+    struct SamplesHeader
+    {
+        static constexpr uint32 Magic = 0x534D5352; // "RSMS"
+        static constexpr uint32 CurrentVersion = 1;
+
+        uint32 magic = 0;
+        uint32 version = 0;
+        uint32 width = 0;
+        uint32 height = 0;
+        Block region;
+    };
+
     struct TileOffset
     {
         int8 x : 4;
@@ -91,6 +157,21 @@ private:
 
     void BuildInitialBlocksList();
 
+    // render region clipped to the image
+    Block GetRenderRegion() const;
+
+    // restart Halton sequence with a new seed (skipping samples before the first pass)
+    void ResetHaltonSequence();
+
+    // initialize Halton sequence and skip given number of samples
+    void InitHaltonSequence(uint64 seed, uint32 sampleIndex);
+
+    // restore rendering state from the checkpoint file
+    bool ResumeFromCheckpoint();
+
+    // upper bound on number of adaptive rendering blocks
+    uint32 GetMaxNumBlocks() const;
+
     // compute average error (variance) in the image
     void ComputeError();
 
@@ -100,12 +181,19 @@ private:
     // generate list of tiles to be rendered (updates mRenderingTiles)
     void GenerateRenderingTiles();
 
+    // clear accumulated samples (in parallel, each NUMA node clears the rows it renders)
+    void ClearAccumulationBuffers();
+
     void UpdateBlocksList();
 
+    // trace primary (pinhole) rays and store first-hit distances
+    void ComputeDepthBuffer(const Scene& scene, const Camera& camera, Common::DynArray<float>& outDepth, Common::TaskBuilder& taskBuilder);
+
     // raytrace single image tile (will be called from multiple threads)
     void RenderTile(const TileRenderingContext& tileContext, RenderingContext& renderingContext, const Block& tile);
 
     bool InitBluredImages();
+    void UpdateBloom(Common::TaskBuilder& taskBuilder);
     void PerformPostProcess(Common::TaskBuilder& taskBuilder);
 
     // generate "front buffer" image from "sum" image
@@ -113,10 +201,15 @@ private:
 
     void PrepareHilbertCurve(uint32 tileSize);
 
+    // distance between traced pixels in current pass (1 for full resolution passes)
+    NFE_FORCE_INLINE uint32 GetPreviewPixelStep() const { return 1u << mPreviewLevel; }
+
     IRenderer* mRenderer;
 
     Math::Random mRandomGenerator;
     HaltonSequence mHaltonSequence;
+    uint64 mHaltonSeed = 0;
+    uint32 mHaltonSampleIndex = 0;      // number of samples taken from the Halton sequence
 
     Common::DynArray<GenericSampler> mSamplers;
     Common::UniquePtr<RenderingContext[]> mThreadData;
@@ -124,11 +217,34 @@ private:
     Bitmap mSum;                        // image with accumulated samples (floating point, high dynamic range)
     Bitmap mSecondarySum;               // contains image with every second sample - required for adaptive rendering
     Bitmap mFrontBuffer;                // postprocesses image (low dynamic range)
-    Common::DynArray<Bitmap> mBlurredImages;    // blurred images for bloom
-    Common::DynArray<uint32> mPassesPerPixel;
+    Bitmap mPreviewImage;               // samples of the current low resolution preview pass
+    Common::DynArray<Bitmap> mBloomPyramid;     // downsampled "sum" images (level 1 and higher) for bloom
+    Common::DynArray<BloomImage> mBlurredImages;    // blurred images for bloom
+    Common::DynArray<uint32> mCarriedSamples;  // number of extra samples (reprojected or merged) on top of passesFinished
+    Common::DynArray<uint32> mConvergedPasses; // number of passes after which pixel's block converged (0 - pixel is still rendered)
     Common::DynArray<Math::Vec2f> mPixelSalt; // salt value for each pixel
+    uint64 mPixelSaltSeed = 0;
+    bool mPixelSaltValid = false;       // salt is generated when accumulation buffers are cleared after resize
     Common::DynArray<TileOffset> mTileOffsets;
 
+    // camera-move reprojection
+    Camera mLastCamera;                         // camera used in the last rendering pass
+    Bitmap mPrevSum;                            // copy of "sum" image before reprojection
+    Bitmap mPrevSecondarySum;                   // copy of "secondary sum" image before reprojection
+    Common::DynArray<uint32> mPrevCarriedSamples;
+    Common::DynArray<float> mDepthBuffer;       // first-hit distances for the last camera
+    Common::DynArray<float> mPrevDepthBuffer;
+    bool mHasLastCamera = false;
+    bool mDepthBufferValid = false;
+
+    uint32 mPreviewLevel = 0;           // number of preview passes left, preview pass traces 1/4^level of the pixels
+
+    Block mRenderRegion;                // empty means whole image
+    uint32 mFirstPassIndex = 0;
+
+    RenderCheckpoint mCheckpoint;
+    uint32 mCheckpointInterval = 0;
+
     RenderingParams mParams;
     PostprocessParamsInternal mPostprocessParams;
     PostprocessLUT mPostprocessLUT;
@@ -139,6 +255,7 @@ private:
 
     Common::DynArray<Block> mBlocks;
     Common::DynArray<Block> mRenderingTiles;
+    NumaBlockQueue mRenderingTilesQueue;    // rendering tiles assigned to NUMA nodes
 
 #ifndef NFE_CONFIGURATION_FINAL
     PixelBreakpoint mPendingPixelBreakpoint;
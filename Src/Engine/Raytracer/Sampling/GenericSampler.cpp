@@ -1,5 +1,6 @@
 #include "PCH.h"
 #include "GenericSampler.h"
+#include "SobolSequence.h"
 #include "../Common/Math/Random.hpp"
 
 namespace NFE {
@@ -66,7 +67,8 @@ NFE_FORCE_INLINE static uint32 XorShift(uint32 x)
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
 RandomSampler::RandomSampler(Math::Random& randomGenerator)
-    : mRandomGenerator(randomGenerator)
+    : ISampler(Type::Random)
+    , mRandomGenerator(randomGenerator)
 { }
 
 uint32 RandomSampler::GetUint()
@@ -77,7 +79,8 @@ uint32 RandomSampler::GetUint()
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
 GenericSampler::GenericSampler()
-    : mBlueNoiseTexture(BlueNoise::GetTexture())
+    : ISampler(Type::Generic)
+    , mBlueNoiseTexture(BlueNoise::GetTexture())
 {
 }
 
@@ -85,6 +88,15 @@ void GenericSampler::ResetFrame(const DynArray<uint32>& seed, bool useBlueNoise)
 {
     mCurrentSample = seed;
     mBlueNoiseTextureLayers = mBlueNoiseTexture && useBlueNoise ? BlueNoise::TextureLayers : 0;
+    mUseSobol = false;
+}
+
+void GenericSampler::ResetFrame(uint32 sampleIndex)
+{
+    mCurrentSample.Clear();
+    mBlueNoiseTextureLayers = 0;
+    mSobolSampleIndex = sampleIndex;
+    mUseSobol = true;
 }
 
 void GenericSampler::ResetPixel(const uint32 x, const uint32 y)
@@ -99,7 +111,11 @@ uint32 GenericSampler::GetUint()
 {
     uint32 sample;
 
-    if (mSamplesGenerated < mCurrentSample.Size())
+    if (mUseSobol)
+    {
+        sample = SobolSequence::Sample(mSobolSampleIndex, mSamplesGenerated++, mSalt);
+    }
+    else if (mSamplesGenerated < mCurrentSample.Size())
     {
         sample = mCurrentSample[mSamplesGenerated];
 
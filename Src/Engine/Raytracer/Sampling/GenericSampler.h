@@ -7,13 +7,13 @@
 namespace NFE {
 namespace RT {
 
+// Base class for samplers
+// NOTE: GetUint() is dispatched on sampler type instead of being virtual, because it's called many times per path
 class ISampler
 {
 public:
-    virtual ~ISampler() = default;
-
     // get next sample
-    virtual uint32 GetUint() = 0;
+    NFE_FORCE_INLINE uint32 GetUint();
 
     NFE_FORCE_INLINE float GetFloat()
     {
@@ -29,34 +29,51 @@ public:
     {
         return Math::Vec3f{ GetFloat(), GetFloat(), GetFloat() };
     }
+
+protected:
+    enum class Type : uint8
+    {
+        Random,
+        Generic,
+    };
+
+    NFE_FORCE_INLINE explicit ISampler(Type type) : mType(type) { }
+    ~ISampler() = default;
+
+private:
+    Type mType;
 };
 
-class RandomSampler : public ISampler
+class RandomSampler final : public ISampler
 {
 public:
     RandomSampler(Math::Random& randomGenerator);
 
     // get next sample
-    virtual uint32 GetUint() override;
+    uint32 GetUint();
 
 private:
     Math::Random& mRandomGenerator;
 };
 
-class GenericSampler : public ISampler
+class GenericSampler final : public ISampler
 {
 public:
     GenericSampler();
 
-    // move to next frame
+    // move to next frame (use precomputed sample, e.g. from Halton sequence)
     void ResetFrame(const Common::DynArray<uint32>& sample, bool useBlueNoise);
 
+    // move to next frame (use Owen-scrambled Sobol sequence)
+    // NOTE: per-pixel salt is used as scrambling seed, so the blue noise dithering is not needed
+    void ResetFrame(uint32 sampleIndex);
+
     // move to next pixel
     void ResetPixel(const uint32 x, const uint32 y);
 
     // get next sample
     // NOTE: effectively goes to next sample dimension
-    virtual uint32 GetUint() override;
+    uint32 GetUint();
 
     Math::Random* fallbackGenerator = nullptr;
 
@@ -69,11 +86,25 @@ private:
     uint32 mSalt = 0;
     uint32 mSamplesGenerated = 0;
 
+    uint32 mSobolSampleIndex = 0;
+    bool mUseSobol = false;
+
     const uint16* mBlueNoiseTexture = nullptr;
 
     Common::DynArray<uint32> mCurrentSample;
 };
 
+uint32 ISampler::GetUint()
+{
+    if (mType == Type::Generic)
+    {
+        return static_cast<GenericSampler*>(this)->GetUint();
+    }
+
+    NFE_ASSERT(mType == Type::Random, "Invalid sampler type");
+    return static_cast<RandomSampler*>(this)->GetUint();
+}
+
 
 } // namespace RT
 } // namespace NFE
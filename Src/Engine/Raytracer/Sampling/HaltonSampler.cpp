@@ -194,10 +194,12 @@ void HaltonSequence::InitStart()
     }
 }
 
-void HaltonSequence::Initialize(uint32 dim)
+void HaltonSequence::Initialize(uint32 dim, uint64 seed)
 {
     ClearPermutation();
 
+    mRandom.Reset(seed);
+
     assert(mDimensions <= MaxDimensions);
     mDimensions = dim;
 
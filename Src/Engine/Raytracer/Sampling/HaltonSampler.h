@@ -17,7 +17,8 @@ public:
 
     NFE_RAYTRACER_API HaltonSequence();
     NFE_RAYTRACER_API ~HaltonSequence();
-    NFE_RAYTRACER_API void Initialize(uint32 mDimensions);
+    // seed determines randomized start point and digit permutations (the same seed gives the same sequence)
+    NFE_RAYTRACER_API void Initialize(uint32 mDimensions, uint64 seed);
 
     NFE_FORCE_INLINE uint32 GetNumDimensions() const { return mDimensions; }
 
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "../Raytracer.h"
+#include "../../Common/Math/Math.hpp"
+#include "../../Common/Utils/BitUtils.hpp"
+
+namespace NFE {
+namespace RT {
+
+// Owen-scrambled Sobol sequence
+// Based on "Practical Hash-based Owen Scrambling" (Brent Burley, 2020)
+// Any dimension of any sample can be generated in constant time and without any mutable state.
+// Higher dimensions are padded with independently shuffled and scrambled 4D Sobol sequences.
+class SobolSequence
+{
+public:
+    static constexpr uint32 NumBaseDimensions = 4;
+    static constexpr uint32 NumBits = 32;
+
+    // get scrambled sample value
+    // seed decorrelates sequences (e.g. per-pixel salt)
+    NFE_FORCE_INLINE static uint32 Sample(uint32 index, uint32 dimension, uint32 seed)
+    {
+        const uint32 baseDimension = dimension % NumBaseDimensions;
+        const uint32 groupSeed = Math::Hash(seed ^ Math::Hash(dimension / NumBaseDimensions));
+
+        // all dimensions in a group share the same index shuffling, so they stay stratified with each other
+        const uint32 shuffledIndex = NestedUniformScramble(index, groupSeed);
+        const uint32 value = SampleUnscrambled(shuffledIndex, baseDimension);
+        return NestedUniformScramble(value, Math::Hash(groupSeed + baseDimension));
+    }
+
+    // plain (unscrambled) Sobol sequence
+    NFE_FORCE_INLINE static uint32 SampleUnscrambled(uint32 index, uint32 baseDimension)
+    {
+        NFE_ASSERT(baseDimension < NumBaseDimensions, "Invalid Sobol dimension");
+
+        const uint32* directions = Directions[baseDimension];
+
+        uint32 result = 0;
+        for (uint32 bit = 0; index; index >>= 1, ++bit)
+        {
+            if (index & 1u)
+            {
+                result ^= directions[bit];
+            }
+        }
+        return result;
+    }
+
+    // hash-based Owen scrambling
+    NFE_FORCE_INLINE static uint32 NestedUniformScramble(uint32 x, uint32 seed)
+    {
+        x = Common::BitUtils<uint32>::ReverseBits(x);
+        x = LaineKarrasPermutation(x, seed);
+        return Common::BitUtils<uint32>::ReverseBits(x);
+    }
+
+private:
+    // scrambles bits of reversed integer, each bit is affected only by lower bits
+    NFE_FORCE_INLINE static uint32 LaineKarrasPermutation(uint32 x, uint32 seed)
+    {
+        x ^= x * 0x3d20adeau;
+        x += seed;
+        x *= (seed >> 16) | 1u;
+        x ^= x * 0x05526c56u;
+        x ^= x * 0x53a22864u;
+        return x;
+    }
+
+    // precomputed direction numbers (Joe & Kuo)
+    NFE_RAYTRACER_API static const uint32 Directions[NumBaseDimensions][NumBits];
+};
+
+} // namespace RT
+} // namespace NFE
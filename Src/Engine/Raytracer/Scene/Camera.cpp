@@ -117,6 +117,18 @@ const Ray Camera::GenerateRay(const Vec4f& coords, RenderingContext& context) co
     return Ray(origin, direction);
 }
 
+const Ray Camera::GeneratePinholeRay(const Vec4f& coords) const
+{
+    const Vec4f offsetedCoords = UnipolarToBipolar(coords);
+
+    const Vec4f direction = Vec4f::MulAndAdd(
+        Vec4f::MulAndAdd(mLocalToWorld[0], offsetedCoords.x * mAspectRatio, mLocalToWorld[1] * offsetedCoords.y),
+        mTanHalfFoV,
+        mLocalToWorld[2]);
+
+    return Ray(mLocalToWorld.GetTranslation(), direction);
+}
+
 bool Camera::WorldToFilm(const Vec4f& worldPosition, Vec4f& outFilmCoords) const
 {
     // TODO motion blur
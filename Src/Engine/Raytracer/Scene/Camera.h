@@ -71,6 +71,10 @@ public:
     NFE_RAYTRACER_API NFE_FORCE_NOINLINE const Math::Ray GenerateRay(const Math::Vec4f& coords, RenderingContext& context) const;
     NFE_FORCE_NOINLINE const RayPacketTypes::Ray GenerateSimdRay(const RayPacketTypes::Vec2f& coords, RenderingContext& context) const;
 
+    // Generate ray through the pinhole (ignores depth of field, lens distortion and motion blur)
+    // x and y coordinates should be in [0.0f, 1.0f) range.
+    NFE_RAYTRACER_API const Math::Ray GeneratePinholeRay(const Math::Vec4f& coords) const;
+
     NFE_FORCE_INLINE const Math::Vec4f GenerateBokeh(const Math::Vec3f sample) const;
     NFE_FORCE_INLINE const RayPacketTypes::Vec2f GenerateSimdBokeh(RenderingContext& context) const;
 
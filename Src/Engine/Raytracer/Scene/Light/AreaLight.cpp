@@ -13,6 +13,7 @@ NFE_DEFINE_POLYMORPHIC_CLASS(NFE::RT::AreaLight)
 {
     NFE_CLASS_PARENT(NFE::RT::ILight);
     NFE_CLASS_MEMBER(mShape).NonNull();
+    NFE_CLASS_MEMBER(mTexture);
 }
 NFE_END_DEFINE_CLASS()
 
@@ -37,6 +38,16 @@ AreaLight::AreaLight(ShapePtr shape, const Math::HdrColorRGB& color)
     mShape->MakeSamplable();
 }
 
+bool AreaLight::MakeSamplable()
+{
+    if (!mShape->MakeSamplable())
+    {
+        return false;
+    }
+
+    return !mTexture || mTexture->MakeSamplable(SampleDistortion::Uniform);
+}
+
 const Box AreaLight::GetBoundingBox() const
 {
     return mShape->GetBoundingBox();
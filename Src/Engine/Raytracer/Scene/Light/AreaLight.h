@@ -29,6 +29,7 @@ public:
     virtual const RayColor GetRadiance(const RadianceParam& param, float* outDirectPdfA, float* outEmissionPdfW) const override;
     virtual const RayColor Emit(const EmitParam& param, EmitResult& outResult) const override;
     virtual Flags GetFlags() const override final;
+    virtual bool MakeSamplable() override;
 
     TexturePtr mTexture;
 
@@ -7,12 +7,13 @@
 #include "../../../Common/Math/SamplingHelpers.hpp"
 #include "../../../Common/Math/Transcendental.hpp"
 #include "../../../Common/Reflection/ReflectionClassDefine.hpp"
+#include "../../../Common/Reflection/Types/ReflectionSharedPtrType.hpp"
 
 
 NFE_DEFINE_POLYMORPHIC_CLASS(NFE::RT::BackgroundLight)
 {
     NFE_CLASS_PARENT(NFE::RT::ILight);
-    // NFE_CLASS_MEMBER(mTexture); // TODO
+    NFE_CLASS_MEMBER(mTexture);
 }
 NFE_END_DEFINE_CLASS()
 
@@ -40,6 +41,11 @@ void BackgroundLight::SetTexture(const TexturePtr& texture)
     }
 }
 
+bool BackgroundLight::MakeSamplable()
+{
+    return !mTexture || mTexture->MakeSamplable(SampleDistortion::Spherical);
+}
+
 const Box BackgroundLight::GetBoundingBox() const
 {
     return Box::Full();
@@ -24,6 +24,7 @@ public:
     virtual const RayColor GetRadiance(const RadianceParam& param, float* outDirectPdfA, float* outEmissionPdfW) const override;
     virtual const RayColor Emit(const EmitParam& param, EmitResult& outResult) const override;
     virtual Flags GetFlags() const override final;
+    virtual bool MakeSamplable() override;
 
     //const RayColor GetBackgroundColor(const Math::Vec4f& dir, const Wavelength& wavelength, float* outDirectPdfW, float* outEmissionPdfW) const;
 
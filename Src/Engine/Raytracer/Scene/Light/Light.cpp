@@ -46,5 +46,10 @@ bool ILight::Traverse_Shadow(const SingleTraversalContext&, const uint32) const
     return false;
 }
 
+bool ILight::MakeSamplable()
+{
+    return true;
+}
+
 } // namespace RT
 } // namespace NFE
@@ -105,6 +105,10 @@ public:
     // Get light flags.
     virtual Flags GetFlags() const = 0;
 
+    // Prepare light's shape and texture for sampling.
+    // NOTE: must be called again if the light was restored from serialized data.
+    NFE_RAYTRACER_API virtual bool MakeSamplable();
+
 private:
     // light object cannot be copied
     ILight(const ILight&) = delete;
@@ -28,6 +28,28 @@ SpotLight::SpotLight(const Math::HdrColorRGB& color, const float angle)
     mIsDelta = mCosAngle > CosEpsilon;
 }
 
+bool SpotLight::OnPropertyChanged(const Common::StringView propertyName)
+{
+    if (propertyName == "mAngle")
+    {
+        NFE_ASSERT(mAngle >= 0.0f && mAngle < NFE_MATH_2PI, "");
+        mCosAngle = cosf(mAngle);
+        mIsDelta = mCosAngle > CosEpsilon;
+        return true;
+    }
+
+    return ILight::OnPropertyChanged(propertyName);
+}
+
+void SpotLight::OnDeserialized()
+{
+    ILight::OnDeserialized();
+
+    NFE_ASSERT(mAngle >= 0.0f && mAngle < NFE_MATH_2PI, "");
+    mCosAngle = cosf(mAngle);
+    mIsDelta = mCosAngle > CosEpsilon;
+}
+
 const Box SpotLight::GetBoundingBox() const
 {
     return Box(Vec4f::Zero());
@@ -10,7 +10,10 @@ class SpotLight : public ILight
     NFE_DECLARE_POLYMORPHIC_CLASS(SpotLight)
 
 public:
-    NFE_RAYTRACER_API SpotLight(const Math::HdrColorRGB& color, const float angle);
+    NFE_RAYTRACER_API SpotLight(const Math::HdrColorRGB& color = Math::HdrColorRGB(1.0f), const float angle = NFE_MATH_PI / 4.0f);
+
+    virtual bool OnPropertyChanged(const Common::StringView propertyName) override;
+    virtual void OnDeserialized() override;
 
     virtual const Math::Box GetBoundingBox() const override;
     virtual const RayColor Illuminate(const IlluminateParam& param, IlluminateResult& outResult) const override;
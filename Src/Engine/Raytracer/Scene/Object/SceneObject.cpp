@@ -6,7 +6,10 @@
 NFE_DEFINE_POLYMORPHIC_CLASS(NFE::RT::ISceneObject)
 {
     NFE_CLASS_MEMBER(mTransform);
-    // TODO velocity
+    NFE_CLASS_MEMBER(mEndTransform);
+    NFE_CLASS_MEMBER(mScale);
+    NFE_CLASS_MEMBER(mEndScale);
+    NFE_CLASS_MEMBER(mHasMotion);
 }
 NFE_END_DEFINE_CLASS()
 
@@ -16,7 +19,45 @@ namespace RT {
 
 using namespace Math;
 
+// number of time samples used to compute motion bounds of a rotating object
+static const uint32 NumMotionBoundsSamples = 16;
+
+// split local->world matrix into scale, rotation and translation
+static void DecomposeMatrix(const Matrix4& matrix, Transform& outTransform, Vec4f& outScale)
+{
+    outScale = Vec4f(matrix.GetRow(0).Length3(), matrix.GetRow(1).Length3(), matrix.GetRow(2).Length3(), 1.0f);
+
+    // mirroring is represented as negative scale along X axis
+    if (matrix.Determinant() < 0.0f)
+    {
+        outScale.x = -outScale.x;
+    }
+
+    NFE_ASSERT((outScale != Vec4f::Zero()).All3(), "Degenerate transform matrix");
+
+    Matrix4 rotationMatrix = matrix;
+    rotationMatrix.rows[0] /= outScale.x;
+    rotationMatrix.rows[1] /= outScale.y;
+    rotationMatrix.rows[2] /= outScale.z;
+
+    outTransform = Transform::FromMatrix(rotationMatrix);
+}
+
+// local->world matrix: scale, then rotate, then translate
+static const Matrix4 ComposeMatrix(const Transform& transform, const Vec4f& scale)
+{
+    return Matrix4::MakeScaling(scale) * transform.ToMatrix();
+}
+
+// world->local matrix
+static const Matrix4 ComposeInverseMatrix(const Transform& transform, const Vec4f& scale)
+{
+    return transform.Inverted().ToMatrix() * Matrix4::MakeScaling(Vec4f::Reciprocal(scale));
+}
+
 ISceneObject::ISceneObject()
+    : mScale(1.0f)
+    , mEndScale(1.0f)
 {
     mBaseTransform = Matrix4::Identity();
     mInverseTranform = Matrix4::Identity();
@@ -26,47 +67,153 @@ ISceneObject::~ISceneObject() = default;
 
 bool ISceneObject::OnPropertyChanged(const Common::StringView propertyName)
 {
-    if (propertyName == "mTransform")
+    if (propertyName == "mTransform" || propertyName == "mScale")
     {
         NFE_ASSERT(mTransform.IsValid(), "");
-        mBaseTransform = mTransform.ToMatrix();
-        mInverseTranform = mTransform.Inverted().ToMatrix();
+        NFE_ASSERT(mScale.IsValid(), "");
+        UpdateBaseTransform();
+        return true;
+    }
+    else if (propertyName == "mEndTransform" || propertyName == "mEndScale")
+    {
+        NFE_ASSERT(mEndTransform.IsValid(), "");
+        NFE_ASSERT(mEndScale.IsValid(), "");
         return true;
     }
 
     return IObject::OnPropertyChanged(propertyName);
 }
 
+void ISceneObject::OnDeserialized()
+{
+    IObject::OnDeserialized();
+
+    NFE_ASSERT(mTransform.IsValid(), "");
+    NFE_ASSERT(mScale.IsValid(), "");
+    UpdateBaseTransform();
+}
+
+void ISceneObject::UpdateBaseTransform()
+{
+    mBaseTransform = ComposeMatrix(mTransform, mScale);
+    mInverseTranform = ComposeInverseMatrix(mTransform, mScale);
+}
+
+void ISceneObject::SetTransform(const Math::Transform& transform, const Math::Vec4f& scale)
+{
+    NFE_ASSERT(transform.IsValid(), "");
+    NFE_ASSERT(scale.IsValid(), "");
+
+    mTransform = transform;
+    mScale = scale;
+    UpdateBaseTransform();
+}
+
 void ISceneObject::SetTransform(const Math::Matrix4& matrix)
 {
     NFE_ASSERT(matrix.IsValid(), "");
 
-    mTransform = Transform::FromMatrix(matrix);
+    DecomposeMatrix(matrix, mTransform, mScale);
+    UpdateBaseTransform();
+}
 
-    mBaseTransform = matrix;
+void ISceneObject::SetEndTransform(const Math::Transform& transform, const Math::Vec4f& scale)
+{
+    NFE_ASSERT(transform.IsValid(), "");
+    NFE_ASSERT(scale.IsValid(), "");
 
-    // TODO scaling support
-    mInverseTranform = matrix.Inverted();
+    mEndTransform = transform;
+    mEndScale = scale;
+    mHasMotion = true;
+}
+
+void ISceneObject::SetEndTransform(const Math::Matrix4& matrix)
+{
+    NFE_ASSERT(matrix.IsValid(), "");
+
+    DecomposeMatrix(matrix, mEndTransform, mEndScale);
+    mHasMotion = true;
+}
+
+Box ISceneObject::GetBoundingBox() const
+{
+    Box startBox, endBox;
+    GetMotionBounds(startBox, endBox);
+
+    return { startBox, endBox };
+}
+
+void ISceneObject::GetMotionBounds(Box& outStartBox, Box& outEndBox) const
+{
+    const Box localBox = GetLocalBoundingBox();
+
+    outStartBox = mBaseTransform.TransformBox(localBox);
+
+    if (!mHasMotion)
+    {
+        outEndBox = outStartBox;
+        return;
+    }
+
+    outEndBox = ComposeMatrix(mEndTransform, mEndScale).TransformBox(localBox);
+
+    // interpolated boxes are exact for translation only, rotating object may stick out of them
+    // find how much the boxes need to be extended, so they contain the object at sampled points in time
+    Vec4f minExtension = Vec4f::Zero();
+    Vec4f maxExtension = Vec4f::Zero();
+    for (uint32 i = 1; i < NumMotionBoundsSamples; ++i)
+    {
+        const float t = static_cast<float>(i) / static_cast<float>(NumMotionBoundsSamples);
+        const Box box = GetTransform(t).TransformBox(localBox);
+
+        minExtension = Vec4f::Max(minExtension, Vec4f::Lerp(outStartBox.min, outEndBox.min, t) - box.min);
+        maxExtension = Vec4f::Max(maxExtension, box.max - Vec4f::Lerp(outStartBox.max, outEndBox.max, t));
+    }
+
+    // the object can still stick out between the samples - add distance between rotation arc and its chord
+    const float cosHalfAngle = Min(1.0f, Abs(Vec4f::Dot4(mTransform.GetRotation(), mEndTransform.GetRotation())));
+    const float angle = 2.0f * acosf(cosHalfAngle);
+    const Vec4f maxScale = Vec4f::Max(Vec4f::Abs(mScale), Vec4f::Abs(mEndScale));
+    const float radius = (maxScale * Vec4f::Max(Vec4f::Abs(localBox.min), Vec4f::Abs(localBox.max))).Length3();
+    const Vec4f margin(radius * (1.0f - cosf(0.5f * angle / static_cast<float>(NumMotionBoundsSamples))));
+
+    minExtension += margin;
+    maxExtension += margin;
+
+    outStartBox.min -= minExtension;
+    outStartBox.max += maxExtension;
+    outEndBox.min -= minExtension;
+    outEndBox.max += maxExtension;
 }
 
 const Matrix4 ISceneObject::GetTransform(const float t) const
 {
-    NFE_UNUSED(t);
     NFE_ASSERT(t >= 0.0f && t <= 1.0f, "");
 
-    // TODO motion blur
+    if (!mHasMotion)
+    {
+        return mBaseTransform;
+    }
 
-    return mBaseTransform;
+    return ComposeMatrix(Transform::Interpolate(mTransform, mEndTransform, t), Vec4f::Lerp(mScale, mEndScale, t));
 }
 
 const Matrix4 ISceneObject::GetInverseTransform(const float t) const
 {
-    NFE_UNUSED(t);
     NFE_ASSERT(t >= 0.0f && t <= 1.0f, "");
 
-    // TODO motion blur
+    if (!mHasMotion)
+    {
+        return mInverseTranform;
+    }
 
-    return mInverseTranform;
+    return ComposeInverseMatrix(Transform::Interpolate(mTransform, mEndTransform, t), Vec4f::Lerp(mScale, mEndScale, t));
+}
+
+bool ITraceableSceneObject::Traverse_Shadow_SubObject(const SingleTraversalContext& context, const uint32 objectID, const uint32 subObjectID) const
+{
+    NFE_UNUSED(subObjectID);
+    return Traverse_Shadow(context, objectID);
 }
 
 } // namespace RT
@@ -27,11 +27,27 @@ public:
     NFE_RAYTRACER_API ISceneObject();
     NFE_RAYTRACER_API virtual ~ISceneObject();
 
-    NFE_RAYTRACER_API void SetTransform(const Math::Transform& transform);
+    // Set transform at time=0.0
+    // NOTE: matrix is decomposed into scale, rotation and translation (shear is not supported)
+    NFE_RAYTRACER_API void SetTransform(const Math::Transform& transform, const Math::Vec4f& scale = Math::Vec4f(1.0f));
     NFE_RAYTRACER_API void SetTransform(const Math::Matrix4& matrix);
 
-    // Get world-space bounding box
-    virtual Math::Box GetBoundingBox() const = 0;
+    // Set transform at time=1.0 (enables motion blur)
+    // Translation and scale are interpolated linearly, rotation - spherically
+    NFE_RAYTRACER_API void SetEndTransform(const Math::Transform& transform, const Math::Vec4f& scale = Math::Vec4f(1.0f));
+    NFE_RAYTRACER_API void SetEndTransform(const Math::Matrix4& matrix);
+
+    NFE_FORCE_INLINE bool HasMotion() const { return mHasMotion; }
+
+    // Get local-space bounding box
+    virtual Math::Box GetLocalBoundingBox() const = 0;
+
+    // Get world-space bounding box (covering whole motion)
+    Math::Box GetBoundingBox() const;
+
+    // Get world-space bounding boxes at time=0.0 and time=1.0, such that a box linearly interpolated
+    // between them contains the object at any point in time
+    void GetMotionBounds(Math::Box& outStartBox, Math::Box& outEndBox) const;
 
     // get transform at time=0
     NFE_FORCE_INLINE const Math::Matrix4& GetBaseTransform() const { return mBaseTransform; }
@@ -44,13 +60,18 @@ public:
 private:
 
     virtual bool OnPropertyChanged(const Common::StringView propertyName) override;
+    virtual void OnDeserialized() override;
+
+    void UpdateBaseTransform();
 
     Math::Matrix4 mBaseTransform;   // local->world transform at time=0.0
     Math::Matrix4 mInverseTranform; // world->local transform at time=0.0
 
-    Math::Transform mTransform;
-
-    // TODO velocity
+    Math::Transform mTransform;     // transform at time=0.0
+    Math::Transform mEndTransform;  // transform at time=1.0 (used only if mHasMotion is set)
+    Math::Vec4f mScale;             // scale at time=0.0 (applied before the transform)
+    Math::Vec4f mEndScale;          // scale at time=1.0 (used only if mHasMotion is set)
+    bool mHasMotion = false;
 };
 
 class ITraceableSceneObject : public ISceneObject
@@ -63,10 +84,18 @@ public:
     // check shadow ray occlusion
     virtual bool Traverse_Shadow(const SingleTraversalContext& context, const uint32 objectID) const = 0;
 
+    // check shadow ray occlusion by a single sub-object (e.g. triangle) found by a previous shadow ray
+    // by default whole object is tested
+    virtual bool Traverse_Shadow_SubObject(const SingleTraversalContext& context, const uint32 objectID, const uint32 subObjectID) const;
+
     // Calculate input data for shading routine
     // NOTE: all calculations are performed in local space
     // NOTE: frame[3] (translation) will be already filled, because it can be always calculated from ray distance
     virtual void EvaluateIntersection(const HitPoint& hitPoint, IntersectionData& outIntersectionData) const = 0;
+
+    // Get material at given hit point (without evaluating full intersection data)
+    // Used for sorting hit points before shading
+    virtual const Material* GetHitMaterial(const HitPoint& hitPoint) const = 0;
 };
 
 } // namespace RT
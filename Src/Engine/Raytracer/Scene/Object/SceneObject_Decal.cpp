@@ -24,10 +24,9 @@ using namespace Math;
 
 DecalSceneObject::DecalSceneObject() = default;
 
-Box DecalSceneObject::GetBoundingBox() const
+Box DecalSceneObject::GetLocalBoundingBox() const
 {
-    const Box localSpaceBox(Vec4f::Zero(), 1.0f);
-    return { GetBaseTransform().TransformBox(localSpaceBox), GetTransform(1.0f).TransformBox(localSpaceBox) };
+    return Box(Vec4f::Zero(), 1.0f);
 }
 
 void DecalSceneObject::Apply(ShadingData& shadingData, RenderingContext& context) const
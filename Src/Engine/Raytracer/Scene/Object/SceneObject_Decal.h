@@ -20,7 +20,7 @@ class DecalSceneObject : public ISceneObject
 public:
     NFE_RAYTRACER_API explicit DecalSceneObject();
 
-    virtual Math::Box GetBoundingBox() const override;
+    virtual Math::Box GetLocalBoundingBox() const override;
 
     void Apply(ShadingData& shadingData, RenderingContext& context) const;
 
@@ -1,6 +1,7 @@
 #include "PCH.h"
 #include "SceneObject_Light.h"
 #include "../Light/AreaLight.h"
+#include "../Light/PointLight.h"
 #include "../../Shapes/Shape.h"
 #include "../Common/Reflection/ReflectionClassDefine.hpp"
 #include "../Common/Reflection/Types/ReflectionUniquePtrType.hpp"
@@ -17,16 +18,23 @@ NFE_END_DEFINE_CLASS()
 namespace NFE {
 namespace RT {
 
+using namespace Common;
 using namespace Math;
 
+LightSceneObject::LightSceneObject()
+{
+    mLight = MakeUniquePtr<PointLight>();
+}
+
+LightSceneObject::~LightSceneObject() = default;
+
 LightSceneObject::LightSceneObject(LightPtr light)
     : mLight(std::move(light))
 { }
 
-Box LightSceneObject::GetBoundingBox() const
+Box LightSceneObject::GetLocalBoundingBox() const
 {
-    const Box localSpaceBox = mLight->GetBoundingBox();
-    return { GetBaseTransform().TransformBox(localSpaceBox), GetTransform(1.0f).TransformBox(localSpaceBox) };
+    return mLight->GetBoundingBox();
 }
 
 void LightSceneObject::Traverse(const SingleTraversalContext& context, const uint32 objectID) const
@@ -62,6 +70,12 @@ void LightSceneObject::EvaluateIntersection(const HitPoint& hitPoint, Intersecti
     }
 }
 
+const Material* LightSceneObject::GetHitMaterial(const HitPoint& hitPoint) const
+{
+    NFE_UNUSED(hitPoint);
+    return nullptr;
+}
+
 
 } // namespace RT
 } // namespace NFE
@@ -12,12 +12,15 @@ class LightSceneObject : public ITraceableSceneObject
     NFE_DECLARE_POLYMORPHIC_CLASS(LightSceneObject)
 
 public:
+    NFE_RAYTRACER_API LightSceneObject();
     NFE_RAYTRACER_API explicit LightSceneObject(LightPtr light);
+    NFE_RAYTRACER_API ~LightSceneObject();
 
     NFE_FORCE_INLINE const ILight& GetLight() const { return *mLight; }
+    NFE_FORCE_INLINE ILight& GetLight() { return *mLight; }
 
 private:
-    virtual Math::Box GetBoundingBox() const override;
+    virtual Math::Box GetLocalBoundingBox() const override;
 
     virtual void Traverse(const SingleTraversalContext& context, const uint32 objectID) const override;
     virtual void Traverse(const PacketTraversalContext& context, const uint32 objectID, const uint32 numActiveGroups) const override;
@@ -25,6 +28,7 @@ private:
     virtual bool Traverse_Shadow(const SingleTraversalContext& context, const uint32 objectID) const override;
 
     virtual void EvaluateIntersection(const HitPoint& hitPoint, IntersectionData& outIntersectionData) const override;
+    virtual const Material* GetHitMaterial(const HitPoint& hitPoint) const override;
 
     LightPtr mLight;
 };
@@ -1,6 +1,7 @@
 #include "PCH.h"
 #include "SceneObject_Shape.h"
 #include "Shapes/Shape.h"
+#include "Shapes/SphereShape.h"
 #include "Material/Material.h"
 #include "Medium/Medium.h"
 #include "../Common/Reflection/ReflectionClassDefine.hpp"
@@ -10,6 +11,7 @@ NFE_DEFINE_POLYMORPHIC_CLASS(NFE::RT::ShapeSceneObject)
 {
     NFE_CLASS_PARENT(NFE::RT::ISceneObject);
     NFE_CLASS_MEMBER(mShape).NonNull();
+    NFE_CLASS_MEMBER(mMaterial);
     NFE_CLASS_MEMBER(mMedium);
 }
 NFE_END_DEFINE_CLASS()
@@ -18,18 +20,25 @@ NFE_END_DEFINE_CLASS()
 namespace NFE {
 namespace RT {
 
+using namespace Common;
 using namespace Math;
 
+ShapeSceneObject::ShapeSceneObject()
+{
+    mShape = MakeSharedPtr<SphereShape>();
+}
+
+ShapeSceneObject::~ShapeSceneObject() = default;
+
 ShapeSceneObject::ShapeSceneObject(const ShapePtr& shape)
     : mShape(shape)
 {
     NFE_ASSERT(mShape, "Invalid shape");
 }
 
-Box ShapeSceneObject::GetBoundingBox() const
+Box ShapeSceneObject::GetLocalBoundingBox() const
 {
-    const Box localSpaceBox = mShape->GetBoundingBox();
-    return { GetBaseTransform().TransformBox(localSpaceBox), GetTransform(1.0f).TransformBox(localSpaceBox) };
+    return mShape->GetBoundingBox();
 }
 
 void ShapeSceneObject::BindMaterial(const MaterialPtr& material)
@@ -52,6 +61,11 @@ bool ShapeSceneObject::Traverse_Shadow(const SingleTraversalContext& context, co
     return mShape->Traverse_Shadow(context, objectID);
 }
 
+bool ShapeSceneObject::Traverse_Shadow_SubObject(const SingleTraversalContext& context, const uint32 objectID, const uint32 subObjectID) const
+{
+    return mShape->Traverse_Shadow_SubObject(context, objectID, subObjectID);
+}
+
 void ShapeSceneObject::Traverse(const PacketTraversalContext& context, const uint32 objectID, const uint32 numActiveGroups) const
 {
     return mShape->Traverse(context, objectID, numActiveGroups);
@@ -65,6 +79,13 @@ void ShapeSceneObject::EvaluateIntersection(const HitPoint& hitPoint, Intersecti
     mShape->EvaluateIntersection(hitPoint, outIntersectionData);
 }
 
+const Material* ShapeSceneObject::GetHitMaterial(const HitPoint& hitPoint) const
+{
+    // shape's per-subobject material overrides the one bound to the object
+    const Material* material = mShape->GetSubObjectMaterial(hitPoint.subObjectId);
+    return material ? material : mMaterial.Get();
+}
+
 
 } // namespace RT
 } // namespace NFE
@@ -16,7 +16,9 @@ class ShapeSceneObject : public ITraceableSceneObject
     NFE_DECLARE_POLYMORPHIC_CLASS(ShapeSceneObject)
 
 public:
+    NFE_RAYTRACER_API ShapeSceneObject();
     NFE_RAYTRACER_API ShapeSceneObject(const ShapePtr& shape);
+    NFE_RAYTRACER_API ~ShapeSceneObject();
 
     const IShape* GetShape() const { return mShape.Get(); }
     const Material* GetMaterial() const { return mMaterial.Get(); }
@@ -26,14 +28,16 @@ public:
     NFE_RAYTRACER_API void BindMedium(const MediumPtr& medium);
 
 private:
-    virtual Math::Box GetBoundingBox() const override;
+    virtual Math::Box GetLocalBoundingBox() const override;
 
     virtual void Traverse(const SingleTraversalContext& context, const uint32 objectID) const override;
     virtual void Traverse(const PacketTraversalContext& context, const uint32 objectID, const uint32 numActiveGroups) const override;
 
     virtual bool Traverse_Shadow(const SingleTraversalContext& context, const uint32 objectID) const override;
+    virtual bool Traverse_Shadow_SubObject(const SingleTraversalContext& context, const uint32 objectID, const uint32 subObjectID) const override;
 
     virtual void EvaluateIntersection(const HitPoint& hitPoint, IntersectionData& outIntersectionData) const override;
+    virtual const Material* GetHitMaterial(const HitPoint& hitPoint) const override;
 
     ShapePtr mShape;
     MaterialPtr mMaterial;
@@ -83,10 +83,16 @@ bool Scene::BuildBVH()
 
     // build BVH for traceable objects
     {
-        DynArray<Box> boxes;
+        bool hasMotion = false;
+        DynArray<Box> boxes, startBoxes, endBoxes;
         for (const ISceneObject* obj : mTraceableObjects)
         {
-            boxes.PushBack(obj->GetBoundingBox());
+            Box startBox, endBox;
+            obj->GetMotionBounds(startBox, endBox);
+            startBoxes.PushBack(startBox);
+            endBoxes.PushBack(endBox);
+            boxes.PushBack(Box(startBox, endBox));
+            hasMotion |= obj->HasMotion();
         }
 
         BVHBuilder::Indices newOrder;
@@ -97,13 +103,52 @@ bool Scene::BuildBVH()
         }
 
         DynArray<const ITraceableSceneObject*> newObjectsArray;
+        DynArray<Box> newStartBoxes, newEndBoxes;
         newObjectsArray.Reserve(mTraceableObjects.Size());
+        newStartBoxes.Reserve(mTraceableObjects.Size());
+        newEndBoxes.Reserve(mTraceableObjects.Size());
         for (uint32 i = 0; i < mTraceableObjects.Size(); ++i)
         {
             uint32 sourceIndex = newOrder[i];
             newObjectsArray.PushBack(mTraceableObjects[sourceIndex]);
+            newStartBoxes.PushBack(startBoxes[sourceIndex]);
+            newEndBoxes.PushBack(endBoxes[sourceIndex]);
         }
         mTraceableObjects = std::move(newObjectsArray);
+
+        // the tree is built for bounds covering whole motion, but traversed with bounds interpolated in time
+        if (hasMotion)
+        {
+            mTraceableObjectsBVH.SetMotionBounds(newStartBoxes.Data(), newEndBoxes.Data());
+        }
+    }
+
+    // build BVH for media
+    {
+        DynArray<Box> boxes;
+        for (const ShapeSceneObject* obj : mMediumObjects)
+        {
+            boxes.PushBack(obj->GetBoundingBox());
+        }
+
+        BvhBuildingParams params;
+        params.heuristics = BvhBuildingParams::Heuristics::Volume;
+
+        BVHBuilder::Indices newOrder;
+        BVHBuilder bvhBuilder(mMediumObjectsBVH);
+        if (!bvhBuilder.Build(boxes.Data(), boxes.Size(), params, newOrder))
+        {
+            return false;
+        }
+
+        DynArray<const ShapeSceneObject*> newObjectsArray;
+        newObjectsArray.Reserve(mMediumObjects.Size());
+        for (uint32 i = 0; i < mMediumObjects.Size(); ++i)
+        {
+            uint32 sourceIndex = newOrder[i];
+            newObjectsArray.PushBack(mMediumObjects[sourceIndex]);
+        }
+        mMediumObjects = std::move(newObjectsArray);
     }
 
     // build BVH for decals
@@ -173,7 +218,34 @@ bool Scene::Traverse_Object_Shadow(const SingleTraversalContext& context, const
         context.context
     };
 
-    return object->Traverse_Shadow(objectContext, objectID);
+    if (object->Traverse_Shadow(objectContext, objectID))
+    {
+        // remember occluding object (shapes may also set sub-object ID)
+        context.hitPoint.objectId = objectID;
+        return true;
+    }
+
+    return false;
+}
+
+bool Scene::Traverse_Object_Shadow_SubObject(const SingleTraversalContext& context, const uint32 objectID, const uint32 subObjectID) const
+{
+    const ITraceableSceneObject* object = mTraceableObjects[objectID];
+
+    const Matrix4 invTransform = object->GetInverseTransform(context.context.time);
+
+    // transform ray to local-space
+    Ray transformedRay = invTransform.TransformRay_Unsafe(context.ray);
+    transformedRay.originDivDir = transformedRay.origin * transformedRay.invDir;
+
+    const SingleTraversalContext objectContext =
+    {
+        transformedRay,
+        context.hitPoint,
+        context.context
+    };
+
+    return object->Traverse_Shadow_SubObject(objectContext, objectID, subObjectID);
 }
 
 void Scene::Traverse_Leaf(const SingleTraversalContext& context, const uint32 objectID, const BVH::Node& node) const
@@ -248,13 +320,20 @@ void Scene::Traverse(const SingleTraversalContext& context) const
     else
     {
         // full BVH traversal
-        GenericTraverse(context, 0, this);
+        if (mTraceableObjectsBVH.HasMotion())
+        {
+            GenericTraverse(context, 0, this, MotionNodeBoxes(mTraceableObjectsBVH, context.context.time));
+        }
+        else
+        {
+            GenericTraverse(context, 0, this);
+        }
     }
 
     context.context.counters.Append(context.context.localCounters);
 }
 
-bool Scene::Traverse_Shadow(const SingleTraversalContext& context) const
+bool Scene::Traverse_Shadow(const SingleTraversalContext& context, const void* occluderCacheKey) const
 {
     const uint32 numObjects = mTraceableObjects.Size();
 
@@ -262,14 +341,55 @@ bool Scene::Traverse_Shadow(const SingleTraversalContext& context) const
     {
         return false;
     }
-    else if (numObjects == 1) // bypass BVH
+
+    // test last occluder for this key first
+    ShadowOccluderCache::Entry* cacheEntry = nullptr;
+    if (occluderCacheKey)
     {
-        return Traverse_Object_Shadow(context, 0);
+        cacheEntry = &context.context.occluderCache.GetEntry(occluderCacheKey);
+
+        // NOTE: object index check is required, because the cache may contain entries from a previous scene
+        if (cacheEntry->key == occluderCacheKey && cacheEntry->objectId < numObjects)
+        {
+            context.context.counters.numOccluderCacheTests++;
+            if (Traverse_Object_Shadow_SubObject(context, cacheEntry->objectId, cacheEntry->subObjectId))
+            {
+                context.context.counters.numOccluderCacheHits++;
+                return true;
+            }
+        }
+    }
+
+    bool occluded = false;
+    if (numObjects == 1) // bypass BVH
+    {
+        occluded = Traverse_Object_Shadow(context, 0);
+    }
+    else if (mTraceableObjectsBVH.HasMotion()) // full BVH traversal
+    {
+        occluded = GenericTraverse_Shadow(context, 0, this, MotionNodeBoxes(mTraceableObjectsBVH, context.context.time));
     }
-    else // full BVH traversal
+    else
     {
-        return GenericTraverse_Shadow(context, 0, this);
+        occluded = GenericTraverse_Shadow(context, 0, this);
     }
+
+    if (cacheEntry)
+    {
+        if (occluded)
+        {
+            cacheEntry->key = occluderCacheKey;
+            cacheEntry->objectId = context.hitPoint.objectId;
+            cacheEntry->subObjectId = context.hitPoint.subObjectId;
+        }
+        else if (cacheEntry->key == occluderCacheKey)
+        {
+            // cached occluder is stale, don't test it again
+            *cacheEntry = ShadowOccluderCache::Entry();
+        }
+    }
+
+    return occluded;
 }
 
 void Scene::Traverse(const PacketTraversalContext& context) const
@@ -308,7 +428,11 @@ void Scene::Traverse(const PacketTraversalContext& context) const
 
         mTraceableObjects.Front()->Traverse(context, 0, numRayGroups);
     }
-    else // full BVH traversal
+    else if (mTraceableObjectsBVH.HasMotion()) // full BVH traversal
+    {
+        GenericTraverse<Scene, 0>(context, 0, this, numRayGroups, MotionNodeBoxes(mTraceableObjectsBVH, context.context.time));
+    }
+    else
     {
         GenericTraverse<Scene, 0>(context, 0, this, numRayGroups);
     }
@@ -385,6 +509,99 @@ void Scene::EvaluateIntersection(const Ray& ray, const HitPoint& hitPoint, const
     }
 }
 
+uint32 Scene::SortHitPoints(RenderingContext& context, const uint32 numRays) const
+{
+    NFE_ASSERT(numRays <= MaxRayPacketSize, "");
+
+    HitPointSortBuffers& buffers = context.hitPointSortBuffers;
+
+    // only part of the hash table is used for small packets
+    const uint32 hashTableSize = Min(NextPowerOfTwo(Max(2u * numRays, 2u)), HitPointSortBuffers::HashTableSize);
+    const uint32 hashMask = hashTableSize - 1;
+    memset(buffers.hashTable, 0, sizeof(uint16) * hashTableSize);
+
+    // assign bucket to each hit point and count bucket sizes
+    uint32 numBuckets = 0;
+    uint32 numHits = 0;
+    for (uint32 i = 0; i < numRays; ++i)
+    {
+        const HitPoint& hitPoint = context.hitPoints[i];
+        if (hitPoint.distance == FLT_MAX)
+        {
+            buffers.hitBuckets[i] = HitPointSortBuffers::InvalidBucket;
+            continue;
+        }
+
+        HitPointShadingKey key;
+        key.objectId = hitPoint.objectId;
+        key.material = mTraceableObjects[hitPoint.objectId]->GetHitMaterial(hitPoint);
+        key.texture = key.material ? key.material->baseColor.GetTexture() : nullptr;
+
+        const uint64 keyHash = Hash(static_cast<uint64>(reinterpret_cast<size_t>(key.material)) ^ (static_cast<uint64>(key.objectId) << 32u));
+
+        uint32 slot = static_cast<uint32>(keyHash) & hashMask;
+        for (;;)
+        {
+            const uint32 bucketIndexPlusOne = buffers.hashTable[slot];
+            if (bucketIndexPlusOne == 0)
+            {
+                // new key
+                buffers.bucketKeys[numBuckets] = key;
+                buffers.bucketOffsets[numBuckets] = 0;
+                buffers.hashTable[slot] = static_cast<uint16>(++numBuckets);
+                break;
+            }
+
+            if (buffers.bucketKeys[bucketIndexPlusOne - 1] == key)
+            {
+                break;
+            }
+
+            slot = (slot + 1) & hashMask;
+        }
+
+        const uint16 bucketIndex = static_cast<uint16>(buffers.hashTable[slot] - 1);
+        buffers.hitBuckets[i] = bucketIndex;
+        buffers.bucketOffsets[bucketIndex]++;
+        numHits++;
+    }
+
+    // order buckets, so the ones sharing texture and material are adjacent
+    // NOTE: number of buckets is usually very small comparing to number of hits
+    for (uint32 i = 0; i < numBuckets; ++i)
+    {
+        buffers.bucketOrder[i] = static_cast<uint16>(i);
+    }
+    std::sort(buffers.bucketOrder, buffers.bucketOrder + numBuckets, [&buffers](uint16 a, uint16 b)
+    {
+        return buffers.bucketKeys[a] < buffers.bucketKeys[b];
+    });
+
+    // convert bucket sizes to output offsets
+    uint32 offset = 0;
+    for (uint32 i = 0; i < numBuckets; ++i)
+    {
+        const uint16 bucketIndex = buffers.bucketOrder[i];
+        const uint32 bucketSize = buffers.bucketOffsets[bucketIndex];
+        buffers.bucketOffsets[bucketIndex] = static_cast<uint16>(offset);
+        offset += bucketSize;
+    }
+    NFE_ASSERT(offset == numHits, "");
+
+    // scatter hit point indices
+    uint32 missOffset = numHits;
+    for (uint32 i = 0; i < numRays; ++i)
+    {
+        const uint16 bucketIndex = buffers.hitBuckets[i];
+        const uint32 targetIndex = bucketIndex != HitPointSortBuffers::InvalidBucket ?
+            buffers.bucketOffsets[bucketIndex]++ :
+            missOffset++;
+        context.sortedHitPoints[targetIndex] = static_cast<uint16>(i);
+    }
+
+    return numHits;
+}
+
 void Scene::EvaluateShadingData(ShadingData& shadingData, RenderingContext& context) const
 {
     if (shadingData.intersection.material)
@@ -395,6 +612,26 @@ void Scene::EvaluateShadingData(ShadingData& shadingData, RenderingContext& cont
     }
 }
 
+void Scene::EvaluateShadingData(ShadingData* shadingData, const uint32 count, RenderingContext& context) const
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    const Material* material = shadingData[0].intersection.material;
+    if (material)
+    {
+        material->EvaluateShadingData(context.wavelength, shadingData, count);
+
+        for (uint32 i = 0; i < count; ++i)
+        {
+            NFE_ASSERT(shadingData[i].intersection.material == material, "Shading points in a batch must share the material");
+            EvaluateDecals(shadingData[i], context);
+        }
+    }
+}
+
 void Scene::EvaluateDecals(ShadingData& shadingData, RenderingContext& context) const
 {
     if (mDecals.Empty())
@@ -485,62 +722,226 @@ void Scene::EvaluateDecals(ShadingData& shadingData, RenderingContext& context)
     }
 }
 
-const IMedium* Scene::GetMediumAtPoint(const RenderingContext& context, const Math::Vec4f& p) const
+template<typename NodeTest, typename LeafFunc>
+static void TraverseMediaBVH(const BVH& bvh, const NodeTest& nodeTest, const LeafFunc& leafFunc)
 {
-    // TODO what in case of overlapping media?
+    if (bvh.GetNumNodes() == 0)
+    {
+        return;
+    }
+
+    // all nodes
+    const BVH::Node* __restrict nodes = bvh.GetNodes();
 
-    for (const ShapeSceneObject* object : mMediumObjects)
+    // "nodes to visit" stack
+    uint32 stackSize = 0;
+    const BVH::Node* __restrict nodesStack[BVH::MaxDepth];
+
+    // BVH traversal
+    for (const BVH::Node* __restrict currentNode = nodes;;)
     {
-        const IMedium* medium = object->GetMedium();
-        NFE_ASSERT(medium, "");
+        if (currentNode->IsLeaf())
+        {
+            for (uint32 i = 0; i < currentNode->numLeaves; ++i)
+            {
+                if (!leafFunc(currentNode->childIndex + i))
+                {
+                    return;
+                }
+            }
+        }
+        else
+        {
+            const BVH::Node* __restrict childA = nodes + currentNode->childIndex;
+            const BVH::Node* __restrict childB = childA + 1;
 
-        // transform point to local-space
-        const Matrix4 invTransform = object->GetInverseTransform(context.time);
-        const Vec4f localPoint = invTransform.TransformPoint(p);
+            const bool hitA = nodeTest(childA->GetBox());
+            const bool hitB = nodeTest(childB->GetBox());
 
-        if (object->GetShape()->Intersect(localPoint))
+            if (hitA && hitB)
+            {
+                currentNode = childA;
+                nodesStack[stackSize++] = childB;
+                continue;
+            }
+            if (hitA)
+            {
+                currentNode = childA;
+                continue;
+            }
+            if (hitB)
+            {
+                currentNode = childB;
+                continue;
+            }
+        }
+
+        if (stackSize == 0)
         {
-            return medium;
+            break;
         }
+
+        // pop a node
+        currentNode = nodesStack[--stackSize];
+    }
+}
+
+uint32 Scene::GetMediaAlongRay(RenderingContext& context, const Ray& ray, float maxDistance, MediumInterval* outIntervals, uint32 maxIntervals) const
+{
+    if (maxIntervals == 0)
+    {
+        return 0;
     }
 
-    return nullptr;
+    uint32 numIntervals = 0;
+
+    TraverseMediaBVH(mMediumObjectsBVH,
+        [&ray, maxDistance](const Box& box)
+        {
+            float nearDist, farDist;
+            return Intersect_BoxRay_TwoSided(ray, box, nearDist, farDist) && farDist > 0.0f && nearDist < maxDistance;
+        },
+        [&](uint32 objectIndex)
+        {
+            const ShapeSceneObject* object = mMediumObjects[objectIndex];
+            NFE_ASSERT(object->GetMedium(), "");
+
+            // transform ray to local-space
+            const Matrix4 invTransform = object->GetInverseTransform(context.time);
+            const Ray transformedRay = invTransform.TransformRay_Unsafe(ray);
+
+            ShapeIntersection shapeIntersection;
+            if (!object->GetShape()->Intersect(transformedRay, context, shapeIntersection))
+            {
+                return true;
+            }
+
+            if (shapeIntersection.farDist <= 0.0f || shapeIntersection.nearDist >= maxDistance)
+            {
+                return true;
+            }
+
+            // clamp to ray origin and the segment end
+            MediumInterval interval;
+            interval.medium = object->GetMedium();
+            interval.minDistance = Max(shapeIntersection.nearDist, 0.0f);
+            interval.maxDistance = Min(shapeIntersection.farDist, maxDistance);
+
+            // insert keeping the intervals sorted
+            uint32 i = Min(numIntervals, maxIntervals - 1u);
+            if (i < numIntervals && interval.minDistance >= outIntervals[i].minDistance)
+            {
+                // the list is full and the interval is further than all the others
+                return true;
+            }
+            for (; i > 0 && outIntervals[i - 1].minDistance > interval.minDistance; --i)
+            {
+                outIntervals[i] = outIntervals[i - 1];
+            }
+            outIntervals[i] = interval;
+            numIntervals = Min(numIntervals + 1u, maxIntervals);
+
+            return true;
+        });
+
+    return numIntervals;
 }
 
 const IMedium* Scene::GetMedium(RenderingContext& context, const Ray& ray, float solidGeometryDistance, float& outMinDistance, float& outMaxDistance) const
 {
-    // TODO proper BVH for volumes set
-    // TODO handling overlapping volumes
+    MediumInterval interval;
+    if (GetMediaAlongRay(context, ray, solidGeometryDistance, &interval, 1) == 0)
+    {
+        return nullptr;
+    }
+
+    outMinDistance = interval.minDistance;
+    outMaxDistance = interval.maxDistance;
+    return interval.medium;
+}
+
+const IMedium* Scene::GetMediumAtPoint(RenderingContext& context, const Math::Vec4f& p) const
+{
+    // any direction gives the same order of nested media
+    MediumStack stack;
+    GetMediaAtPoint(context, Ray(p, Vec4f(0.0f, 0.0f, 1.0f)), stack);
+    return stack.Top();
+}
+
+void Scene::GetMediaAtPoint(RenderingContext& context, const Ray& ray, MediumStack& outStack) const
+{
+    outStack.Clear();
+
+    // Media containing the ray origin are ordered by distance to their boundary behind the origin,
+    // as if they were entered by the ray. A nested medium is always exited before the outer one, so the order
+    // matches containment regardless of the ray direction.
+    const Ray backwardRay(ray.origin, -ray.dir);
 
-    /*
-    for (const MediumSceneObject* object : mMediumObjects)
+    struct ContainingMedium
     {
-        // transform ray to local-space
-        const Matrix4 invTransform = object->GetInverseTransform(context.time);
-        const Ray transformedRay = invTransform.TransformRay_Unsafe(ray);
+        const IMedium* medium;
+        float boundaryDistance;
+    };
+    ContainingMedium media[MediumStack::MaxSize];
+    uint32 numMedia = 0;
 
-        ShapeIntersection shapeIntersection;
-        if (object->GetShape()->Intersect(transformedRay, shapeIntersection))
+    TraverseMediaBVH(mMediumObjectsBVH,
+        [&ray](const Box& box)
         {
-            if (shapeIntersection.farDist > 0.0f && shapeIntersection.nearDist < solidGeometryDistance)
+            return box.Intersects(ray.origin);
+        },
+        [&](uint32 objectIndex)
+        {
+            const ShapeSceneObject* object = mMediumObjects[objectIndex];
+            NFE_ASSERT(object->GetMedium(), "");
+
+            // transform ray to local-space
+            const Matrix4 invTransform = object->GetInverseTransform(context.time);
+            const Ray transformedRay = invTransform.TransformRay_Unsafe(backwardRay);
+
+            ShapeIntersection shapeIntersection;
+            if (!object->GetShape()->Intersect(transformedRay, context, shapeIntersection))
             {
-                // clamp to ray origin and solid geometry
-                outMinDistance = Max(shapeIntersection.nearDist, 0.0f);
-                outMaxDistance = Min(shapeIntersection.farDist, solidGeometryDistance);
+                return true;
+            }
 
-                return object->GetMedium();
+            // origin must be inside the medium
+            if (shapeIntersection.nearDist > 0.0f || shapeIntersection.farDist <= 0.0f)
+            {
+                return true;
             }
-        }
-    }
-    */
 
-    (void)context;
-    (void)ray;
-    (void)solidGeometryDistance;
-    (void)outMinDistance;
-    (void)outMaxDistance;
+            const float boundaryDistance = shapeIntersection.farDist;
 
-    return nullptr;
+            // insert keeping descending distance order, the innermost media are kept if there are too many
+            uint32 i = Min(numMedia, MediumStack::MaxSize - 1u);
+            if (i < numMedia)
+            {
+                if (boundaryDistance >= media[0].boundaryDistance)
+                {
+                    return true;
+                }
+
+                // drop the outermost medium
+                for (uint32 j = 1; j < numMedia; ++j)
+                {
+                    media[j - 1] = media[j];
+                }
+            }
+            for (; i > 0 && media[i - 1].boundaryDistance < boundaryDistance; --i)
+            {
+                media[i] = media[i - 1];
+            }
+            media[i] = { object->GetMedium(), boundaryDistance };
+            numMedia = Min(numMedia + 1u, MediumStack::MaxSize);
+
+            return true;
+        });
+
+    for (uint32 i = 0; i < numMedia; ++i)
+    {
+        outStack.Push(media[i].medium);
+    }
 }
 
 } // namespace RT
@@ -5,7 +5,10 @@
 #include "../Color/RayColor.h"
 #include "../Traversal/HitPoint.h"
 #include "../BVH/BVH.h"
+#include "../Medium/MediumStack.h"
+#include "../Utils/Bitmap.h"
 #include "../../Common/Containers/DynArray.hpp"
+#include "../../Common/Containers/String.hpp"
 #include "../../Common/Containers/UniquePtr.hpp"
 #include "../../Common/Memory/Aligned.hpp"
 
@@ -14,6 +17,16 @@ namespace RT {
 
 using SceneObjectPtr = Common::UniquePtr<ISceneObject>;
 
+// Inputs a scene archive was created from, stored in the archive to detect if it's outdated
+struct SceneArchiveSources
+{
+    // files the archived objects were created from (scene description, meshes, etc.)
+    Common::DynArray<Common::String> files;
+
+    // application defined loading options affecting the archived objects (e.g. mesh compression)
+    Common::String options;
+};
+
 /**
  * Rendering scene.
  * Allows for placing objects (meshes, lights, etc.) and raytracing them.
@@ -33,25 +46,52 @@ public:
 
     NFE_RAYTRACER_API bool BuildBVH();
 
+    // Store scene objects in a binary archive: reflected object graph followed by mesh data (vertex buffers and BVHs).
+    // Bitmaps are not stored, textures reference them by file path.
+    // Modification times of the source files are stored along with the loading options.
+    // NOTE: must not be called during rendering
+    NFE_RAYTRACER_API bool SaveArchive(const Common::StringView& path, const SceneArchiveSources& sources);
+
+    // Check if an archive exists, was created with the same loading options and none of its source files was modified since.
+    NFE_RAYTRACER_API static bool IsArchiveUpToDate(const Common::StringView& path, const Common::StringView& options);
+
+    // Add objects stored with SaveArchive() to the scene. BuildBVH() must be called afterwards.
+    NFE_RAYTRACER_API bool LoadArchive(const Common::StringView& path, const Bitmap::LoadParams& bitmapLoadParams);
+
     NFE_FORCE_INLINE const BVH& GetBVH() const { return mTraceableObjectsBVH; }
     NFE_FORCE_INLINE const ITraceableSceneObject* GetHitObject(uint32 id) const { return mTraceableObjects[id]; }
     NFE_FORCE_INLINE const Common::DynArray<const LightSceneObject*>& GetLights() const { return mLights; }
     NFE_FORCE_INLINE const Common::DynArray<const LightSceneObject*>& GetGlobalLights() const { return mGlobalLights; }
 
-    // find medium intersection for a given ray
+    // find nearest medium overlapping a ray segment [0, solidGeometryDistance]
     const IMedium* GetMedium(RenderingContext& context, const Math::Ray& ray, float solidGeometryDistance, float& outMinDistance, float& outMaxDistance) const;
 
-    const IMedium* GetMediumAtPoint(const RenderingContext& context, const Math::Vec4f& p) const;
+    // find all media overlapping a ray segment [0, maxDistance], sorted by entry distance
+    // distances are clamped to the segment, returns number of intervals written
+    NFE_RAYTRACER_API uint32 GetMediaAlongRay(RenderingContext& context, const Math::Ray& ray, float maxDistance, MediumInterval* outIntervals, uint32 maxIntervals) const;
+
+    // get innermost medium containing given point
+    const IMedium* GetMediumAtPoint(RenderingContext& context, const Math::Vec4f& p) const;
+
+    // fill medium stack with all media containing ray origin, ordered as if they were entered along the ray (the innermost on the top)
+    NFE_RAYTRACER_API void GetMediaAtPoint(RenderingContext& context, const Math::Ray& ray, MediumStack& outStack) const;
 
     // traverse the scene, returns hit points
     NFE_RAYTRACER_API void Traverse(const SingleTraversalContext& context) const;
     NFE_RAYTRACER_API void Traverse(const PacketTraversalContext& context) const;
 
     // cast shadow ray
-    bool Traverse_Shadow(const SingleTraversalContext& context) const;
+    // if a key identifying shadow ray target (e.g. light) is provided, last occluder of shadow rays
+    // with the same key is tested first (see ShadowOccluderCache)
+    NFE_RAYTRACER_API bool Traverse_Shadow(const SingleTraversalContext& context, const void* occluderCacheKey = nullptr) const;
 
     NFE_RAYTRACER_API void EvaluateIntersection(const Math::Ray& ray, const HitPoint& hitPoint, const float time, IntersectionData& outIntersectionData) const;
 
+    // sort packet hit points (after packet traversal) so hits sharing texture, material and object are adjacent
+    // writes ordered hit point indices to context.sortedHitPoints, misses are placed at the end (in ray order)
+    // returns number of hits
+    NFE_RAYTRACER_API uint32 SortHitPoints(RenderingContext& context, const uint32 numRays) const;
+
     void TraceRay_Simd8(const RayPacketTypes::Ray& ray, RenderingContext& context, RayColor* outColors) const;
 
     void Traverse_Leaf(const SingleTraversalContext& context, const uint32 objectID, const BVH::Node& node) const;
@@ -61,12 +101,16 @@ public:
 
     void EvaluateShadingData(ShadingData& shadingData, RenderingContext& context) const;
 
+    // batched variant of EvaluateShadingData() for shading points sharing the same material
+    void EvaluateShadingData(ShadingData* shadingData, const uint32 count, RenderingContext& context) const;
+
 private:
     Scene(const Scene&) = delete;
     Scene& operator = (const Scene&) = delete;
 
     NFE_FORCE_NOINLINE void Traverse_Object(const SingleTraversalContext& context, const uint32 objectID) const;
     NFE_FORCE_NOINLINE bool Traverse_Object_Shadow(const SingleTraversalContext& context, const uint32 objectID) const;
+    NFE_FORCE_NOINLINE bool Traverse_Object_Shadow_SubObject(const SingleTraversalContext& context, const uint32 objectID, const uint32 subObjectID) const;
 
     void EvaluateDecals(ShadingData& shadingData, RenderingContext& context) const;
 
@@ -80,6 +124,7 @@ private:
     BVH mTraceableObjectsBVH;
 
     Common::DynArray<const ShapeSceneObject*> mMediumObjects;
+    BVH mMediumObjectsBVH;
 
     Common::DynArray<const DecalSceneObject*> mDecals;
     BVH mDecalsBVH;
@@ -0,0 +1,527 @@
+#include "PCH.h"
+#include "Scene.h"
+#include "Light/Light.h"
+#include "Object/SceneObject_Light.h"
+#include "Shapes/MeshShape.h"
+#include "Textures/BitmapTexture.h"
+#include "Textures/BitmapTexture3D.h"
+#include "Utils/TextureCache.h"
+#include "../Common/FileSystem/File.hpp"
+#include "../Common/FileSystem/FileSystem.hpp"
+#include "../Common/Memory/Buffer.hpp"
+#include "../Common/Containers/HashMap.hpp"
+#include "../Common/Reflection/ReflectionClassDefine.hpp"
+#include "../Common/Reflection/ReflectionUtils.hpp"
+#include "../Common/Reflection/Serializer.hpp"
+#include "../Common/Reflection/Types/ReflectionUniquePtrType.hpp"
+#include "../Common/Utils/Stream/BufferInputStream.hpp"
+#include "../Common/Utils/Stream/BufferOutputStream.hpp"
+#include "../Common/Utils/Stream/FileInputStream.hpp"
+#include "../Common/Utils/TaskBuilder.hpp"
+#include "../Common/Utils/Waitable.hpp"
+#include "../Common/System/Timer.hpp"
+
+
+
+namespace NFE {
+namespace RT {
+
+// Single scene object stored in an archive.
+// NOTE: objects are not stored as one array, because serialized size of a single member is limited.
+class SceneArchiveEntry : public IObject
+{
+    NFE_DECLARE_POLYMORPHIC_CLASS(SceneArchiveEntry)
+
+public:
+    SceneObjectPtr object;
+};
+
+} // namespace RT
+} // namespace NFE
+
+
+NFE_DEFINE_POLYMORPHIC_CLASS(NFE::RT::SceneArchiveEntry)
+{
+    NFE_CLASS_MEMBER(object);
+}
+NFE_END_DEFINE_CLASS()
+
+
+namespace NFE {
+namespace RT {
+
+using namespace Common;
+
+namespace {
+
+struct SceneArchiveHeader
+{
+    static constexpr uint32 Magic = 'rtsa';
+    static constexpr uint32 CurrentVersion = 4;
+
+    uint32 magic;
+    uint32 version;
+};
+
+// source file of an archive, stored after the header along with the loading options
+struct SceneArchiveSourceFile
+{
+    String path;
+    int64 modificationTime = 0;
+};
+
+// bitmap referenced by textures in a loaded archive
+struct SceneArchiveBitmap
+{
+    String path;
+    bool streamed = false;
+    BitmapPtr bitmap;
+    TiledBitmapPtr tiledBitmap;
+    DynArray<BitmapTexture*> textures;
+};
+
+// returns -1 if the file does not exist
+int64 GetFileModificationTime(const String& path)
+{
+    uint64 modificationTime = 0;
+    if (!FileSystem::GetModificationTime(path, modificationTime))
+    {
+        return -1;
+    }
+
+    return static_cast<int64>(modificationTime);
+}
+
+bool WriteString(OutputStream& stream, const StringView& str)
+{
+    return stream.WriteCompressedUint(str.Length()) && stream.Write(str.Data(), str.Length()) == str.Length();
+}
+
+bool ReadString(InputStream& stream, String& outString)
+{
+    // limit protects from allocating garbage sizes when reading a corrupted file
+    static constexpr uint32 MaxLength = 64 * 1024;
+
+    uint32 length = 0;
+    if (!stream.ReadCompressedUint(length) || length > MaxLength)
+    {
+        return false;
+    }
+
+    outString = String();
+    if (length > 0)
+    {
+        DynArray<char> chars;
+        if (!chars.Resize(length) || stream.Read(chars.Data(), length) != length)
+        {
+            return false;
+        }
+
+        outString = String(chars.Data(), length);
+    }
+
+    return true;
+}
+
+bool WriteArchiveSources(OutputStream& stream, const SceneArchiveSources& sources)
+{
+    if (!WriteString(stream, sources.options) || !stream.WriteCompressedUint(sources.files.Size()))
+    {
+        return false;
+    }
+
+    for (const String& filePath : sources.files)
+    {
+        const int64 modificationTime = GetFileModificationTime(filePath);
+        if (modificationTime < 0)
+        {
+            NFE_LOG_ERROR("Scene archive: Source file '%s' does not exist", filePath.Str());
+            return false;
+        }
+
+        if (!WriteString(stream, filePath) || !stream.Write(modificationTime))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool ReadArchiveSources(InputStream& stream, String& outOptions, DynArray<SceneArchiveSourceFile>& outFiles)
+{
+    uint32 numFiles = 0;
+    if (!ReadString(stream, outOptions) || !stream.ReadCompressedUint(numFiles))
+    {
+        return false;
+    }
+
+    for (uint32 i = 0; i < numFiles; ++i)
+    {
+        SceneArchiveSourceFile file;
+        if (!ReadString(stream, file.path) || !stream.Read(file.modificationTime))
+        {
+            return false;
+        }
+        outFiles.PushBack(std::move(file));
+    }
+
+    return true;
+}
+
+bool WriteArchiveFile(const StringView& path, const Buffer& data)
+{
+    File file;
+    if (!file.Open(path, AccessMode::Write, true))
+    {
+        NFE_LOG_ERROR("Scene archive: Failed to create file '%.*s'", path.Length(), path.Data());
+        return false;
+    }
+
+    if (file.Write(data.Data(), data.Size()) != data.Size())
+    {
+        NFE_LOG_ERROR("Scene archive: Failed to write file '%.*s'", path.Length(), path.Data());
+        return false;
+    }
+
+    return true;
+}
+
+bool ReadArchiveFile(const StringView& path, Buffer& outData)
+{
+    File file;
+    if (!file.Open(path, AccessMode::Read))
+    {
+        NFE_LOG_ERROR("Scene archive: Failed to open file '%.*s'", path.Length(), path.Data());
+        return false;
+    }
+
+    const int64 fileSize = file.GetSize();
+    if (fileSize <= 0 || !outData.Resize(static_cast<size_t>(fileSize)))
+    {
+        NFE_LOG_ERROR("Scene archive: Failed to read file '%.*s'", path.Length(), path.Data());
+        return false;
+    }
+
+    if (file.Read(outData.Data(), outData.Size()) != outData.Size())
+    {
+        NFE_LOG_ERROR("Scene archive: Failed to read file '%.*s'", path.Length(), path.Data());
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace
+
+bool Scene::SaveArchive(const StringView& path, const SceneArchiveSources& sources)
+{
+    if (mAllObjects.Empty())
+    {
+        NFE_LOG_ERROR("Scene archive: Scene is empty");
+        return false;
+    }
+
+    Timer timer;
+
+    // scene keeps ownership of the objects, so they are moved to the archive entries only for the serialization
+    DynArray<SharedPtr<SceneArchiveEntry>> entries;
+    DynArray<ObjectPtr> rootObjects;
+    for (SceneObjectPtr& object : mAllObjects)
+    {
+        SharedPtr<SceneArchiveEntry> entry = MakeSharedPtr<SceneArchiveEntry>();
+        entry->object = std::move(object);
+        rootObjects.PushBack(entry);
+        entries.PushBack(std::move(entry));
+    }
+
+    Buffer buffer;
+    DynArray<ObjectPtr> allObjects;
+    bool success = false;
+    {
+        BufferOutputStream bufferStream(buffer);
+        OutputStream& stream = bufferStream;
+
+        SceneArchiveHeader header;
+        header.magic = SceneArchiveHeader::Magic;
+        header.version = SceneArchiveHeader::CurrentVersion;
+
+        success = stream.Write(header) && WriteArchiveSources(stream, sources) && RTTI::Serialize(rootObjects, stream, &allObjects);
+
+        // validate objects (this can't be done before the serialization, as all the objects are not known yet)
+        DynArray<const MeshShape*> meshes;
+        for (const ObjectPtr& object : allObjects)
+        {
+            if (!success)
+            {
+                break;
+            }
+
+            const RTTI::Type* type = object->GetDynamicType();
+            if (!type->IsConstructible())
+            {
+                NFE_LOG_ERROR("Scene archive: Objects of type '%s' can't be deserialized", type->GetName().Str());
+                success = false;
+            }
+            else if (RTTI::Cast<BitmapTexture3D>(object.Get()))
+            {
+                NFE_LOG_ERROR("Scene archive: 3D bitmap textures are not supported");
+                success = false;
+            }
+            else if (const MeshShape* mesh = RTTI::Cast<MeshShape>(object.Get()))
+            {
+                meshes.PushBack(mesh);
+            }
+        }
+
+        // mesh data is stored after the object graph, in order of serialization
+        if (success)
+        {
+            success = stream.Write(meshes.Size());
+            for (const MeshShape* mesh : meshes)
+            {
+                success = success && mesh->Write(stream);
+            }
+        }
+    }
+
+    for (uint32 i = 0; i < mAllObjects.Size(); ++i)
+    {
+        mAllObjects[i] = std::move(entries[i]->object);
+    }
+
+    if (!success)
+    {
+        NFE_LOG_ERROR("Scene archive: Failed to serialize the scene");
+        return false;
+    }
+
+    if (!WriteArchiveFile(path, buffer))
+    {
+        return false;
+    }
+
+    NFE_LOG_INFO("Scene archive '%.*s' saved in %.3f ms (%u objects, %u KB)",
+        path.Length(), path.Data(), timer.Stop() * 1000.0, allObjects.Size(), static_cast<uint32>(buffer.Size() / 1024u));
+    return true;
+}
+
+bool Scene::IsArchiveUpToDate(const StringView& path, const StringView& options)
+{
+    // archive was not created yet
+    if (GetFileModificationTime(String(path)) < 0)
+    {
+        return false;
+    }
+
+    FileInputStream fileStream(path);
+    InputStream& stream = fileStream;
+
+    SceneArchiveHeader header;
+    if (!stream.Read(header) || header.magic != SceneArchiveHeader::Magic || header.version != SceneArchiveHeader::CurrentVersion)
+    {
+        NFE_LOG_INFO("Scene archive: '%.*s' is not a scene archive of the current version", path.Length(), path.Data());
+        return false;
+    }
+
+    String archiveOptions;
+    DynArray<SceneArchiveSourceFile> sourceFiles;
+    if (!ReadArchiveSources(stream, archiveOptions, sourceFiles))
+    {
+        NFE_LOG_ERROR("Scene archive: Failed to read source files list of '%.*s'", path.Length(), path.Data());
+        return false;
+    }
+
+    if (archiveOptions != options)
+    {
+        NFE_LOG_INFO("Scene archive: '%.*s' was created with different loading options", path.Length(), path.Data());
+        return false;
+    }
+
+    for (const SceneArchiveSourceFile& file : sourceFiles)
+    {
+        if (GetFileModificationTime(file.path) != file.modificationTime)
+        {
+            NFE_LOG_INFO("Scene archive: Source file '%s' was modified", file.path.Str());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Scene::LoadArchive(const StringView& path, const Bitmap::LoadParams& bitmapLoadParams)
+{
+    Timer timer;
+
+    Buffer buffer;
+    if (!ReadArchiveFile(path, buffer))
+    {
+        return false;
+    }
+
+    BufferInputStream bufferStream(buffer);
+    InputStream& stream = bufferStream;
+
+    SceneArchiveHeader header;
+    if (!stream.Read(header) || header.magic != SceneArchiveHeader::Magic)
+    {
+        NFE_LOG_ERROR("Scene archive: '%.*s' is not a scene archive", path.Length(), path.Data());
+        return false;
+    }
+
+    if (header.version != SceneArchiveHeader::CurrentVersion)
+    {
+        NFE_LOG_ERROR("Scene archive: Unsupported version %u (expected %u)", header.version, SceneArchiveHeader::CurrentVersion);
+        return false;
+    }
+
+    // sources are validated by IsArchiveUpToDate()
+    String options;
+    DynArray<SceneArchiveSourceFile> sourceFiles;
+    if (!ReadArchiveSources(stream, options, sourceFiles))
+    {
+        NFE_LOG_ERROR("Scene archive: Failed to read source files list");
+        return false;
+    }
+
+    DynArray<ObjectPtr> rootObjects;
+    DynArray<ObjectPtr> allObjects;
+    if (!RTTI::Deserialize(rootObjects, stream, &allObjects))
+    {
+        NFE_LOG_ERROR("Scene archive: Failed to deserialize the scene");
+        return false;
+    }
+
+    // restore non-reflected resources
+    uint32 numMeshes = 0;
+    if (!stream.Read(numMeshes))
+    {
+        NFE_LOG_ERROR("Scene archive: Failed to read mesh data");
+        return false;
+    }
+
+    DynArray<SceneArchiveBitmap> bitmaps;
+    HashMap<String, uint32> bitmapIndices;
+    for (const ObjectPtr& object : allObjects)
+    {
+        if (MeshShape* mesh = RTTI::Cast<MeshShape>(object.Get()))
+        {
+            if (numMeshes == 0 || !mesh->Read(stream))
+            {
+                NFE_LOG_ERROR("Scene archive: Failed to read mesh data of '%s'", mesh->GetPath().Str());
+                return false;
+            }
+            numMeshes--;
+        }
+        else if (BitmapTexture* texture = RTTI::Cast<BitmapTexture>(object.Get()))
+        {
+            if (texture->GetPath().Empty())
+            {
+                NFE_LOG_ERROR("Scene archive: Bitmap texture without source path");
+                return false;
+            }
+
+            // the same file can be used by multiple textures
+            const String key = String::Printf("%s:%s", texture->IsStreamed() ? "streamed" : "bitmap", texture->GetPath().Str());
+            const auto insertResult = bitmapIndices.Insert(key, bitmaps.Size());
+            if (insertResult.iterator->second == bitmaps.Size())
+            {
+                SceneArchiveBitmap bitmap;
+                bitmap.path = texture->GetPath();
+                bitmap.streamed = texture->IsStreamed();
+                bitmaps.PushBack(std::move(bitmap));
+            }
+            bitmaps[insertResult.iterator->second].textures.PushBack(texture);
+        }
+    }
+
+    // load bitmaps in parallel
+    if (!bitmaps.Empty())
+    {
+        Waitable waitable;
+        {
+            TaskBuilder builder(waitable);
+            builder.ParallelFor("Scene/LoadArchiveBitmaps", bitmaps.Size(), [&](const TaskContext& context, uint32 index)
+            {
+                SceneArchiveBitmap& bitmap = bitmaps[index];
+                if (bitmap.streamed)
+                {
+                    TiledBitmapPtr tiledBitmap = MakeSharedPtr<TiledBitmap>(bitmap.path.Str());
+                    if (tiledBitmap->Open(bitmap.path.Str()))
+                    {
+                        bitmap.tiledBitmap = std::move(tiledBitmap);
+                    }
+                }
+                else
+                {
+                    // block compression runs as subtasks, so the bitmaps are ready when the waitable is signaled
+                    TaskBuilder compressionBuilder(context);
+                    BitmapPtr loadedBitmap = MakeSharedPtr<Bitmap>(bitmap.path.Str());
+                    if (loadedBitmap->Load(bitmap.path.Str(), bitmapLoadParams, compressionBuilder))
+                    {
+                        bitmap.bitmap = std::move(loadedBitmap);
+                    }
+                }
+            });
+        }
+        waitable.Wait();
+    }
+
+    for (const SceneArchiveBitmap& bitmap : bitmaps)
+    {
+        if (!bitmap.bitmap && !bitmap.tiledBitmap)
+        {
+            NFE_LOG_ERROR("Scene archive: Failed to load bitmap '%s'", bitmap.path.Str());
+            return false;
+        }
+
+        for (BitmapTexture* texture : bitmap.textures)
+        {
+            if (bitmap.streamed)
+            {
+                texture->SetBitmap(bitmap.tiledBitmap);
+            }
+            else
+            {
+                texture->SetBitmap(bitmap.bitmap);
+            }
+        }
+    }
+
+    // lights sampling data depends on the restored meshes and bitmaps
+    DynArray<SceneObjectPtr> objects;
+    objects.Reserve(rootObjects.Size());
+    for (const ObjectPtr& rootObject : rootObjects)
+    {
+        SceneArchiveEntry* entry = RTTI::Cast<SceneArchiveEntry>(rootObject.Get());
+        if (!entry || !entry->object)
+        {
+            NFE_LOG_ERROR("Scene archive: Corrupted data (invalid root object)");
+            return false;
+        }
+
+        if (LightSceneObject* lightObject = RTTI::Cast<LightSceneObject>(entry->object.Get()))
+        {
+            if (!lightObject->GetLight().MakeSamplable())
+            {
+                NFE_LOG_ERROR("Scene archive: Failed to initialize light");
+                return false;
+            }
+        }
+
+        objects.PushBack(std::move(entry->object));
+    }
+
+    for (SceneObjectPtr& object : objects)
+    {
+        AddObject(std::move(object));
+    }
+
+    NFE_LOG_INFO("Scene archive '%.*s' loaded in %.3f ms (%u objects, %u bitmaps)",
+        path.Length(), path.Data(), timer.Stop() * 1000.0, allObjects.Size(), bitmaps.Size());
+    return true;
+}
+
+} // namespace RT
+} // namespace NFE
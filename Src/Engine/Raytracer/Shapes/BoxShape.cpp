@@ -137,6 +137,13 @@ bool BoxShape::OnPropertyChanged(const Common::StringView propertyName)
     return IShape::OnPropertyChanged(propertyName);
 }
 
+void BoxShape::OnDeserialized()
+{
+    IShape::OnDeserialized();
+
+    OnSizeChanged();
+}
+
 void BoxShape::OnSizeChanged()
 {
     NFE_ASSERT(mSize.x > 0.0f, "");
@@ -22,6 +22,7 @@ private:
     virtual void EvaluateIntersection(const HitPoint& hitPoint, IntersectionData& outIntersectionData) const override;
 
     virtual bool OnPropertyChanged(const Common::StringView propertyName) override;
+    virtual void OnDeserialized() override;
 
     void OnSizeChanged();
 
@@ -47,6 +47,15 @@ bool CylinderShape::OnPropertyChanged(const Common::StringView propertyName)
     return IShape::OnPropertyChanged(propertyName);
 }
 
+void CylinderShape::OnDeserialized()
+{
+    IShape::OnDeserialized();
+
+    mRadius = Max(mRadius, 0.000001f);
+    mInvRadius = 1.0f / mRadius;
+    mHeight = Max(mHeight, 0.000001f);
+}
+
 const Box CylinderShape::GetBoundingBox() const
 {
     return Box(Vec4f(-mRadius, -mRadius, 0.0f), Vec4f(mRadius, mRadius, mHeight));
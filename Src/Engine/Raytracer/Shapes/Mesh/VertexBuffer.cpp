@@ -1,6 +1,20 @@
 #include "PCH.h"
 #include "VertexBuffer.h"
 #include "Material/Material.h"
+#include "Utils/Memory.h"
+#include "../Common/Math/PackedLoadVec4f.hpp"
+#include "../Common/Utils/Stream/InputStream.hpp"
+#include "../Common/Utils/Stream/OutputStream.hpp"
+#include "../Common/Reflection/ReflectionClassDefine.hpp"
+#include "../Common/Reflection/Types/ReflectionDynArrayType.hpp"
+#include "../Common/Reflection/Types/ReflectionSharedPtrType.hpp"
+
+
+NFE_DEFINE_CLASS(NFE::RT::VertexBuffer)
+{
+    NFE_CLASS_MEMBER(mMaterials);
+}
+NFE_END_DEFINE_CLASS()
 
 namespace NFE {
 namespace RT {
@@ -9,9 +23,43 @@ static_assert(sizeof(VertexIndices) == 16, "Invalid size");
 static_assert(sizeof(VertexShadingData) == 32, "Invalid size");
 static_assert(alignof(VertexIndices) == 16, "Invalid alignment");
 static_assert(alignof(VertexShadingData) == 32, "Invalid alignment");
+static_assert(sizeof(CompactVertexIndices) == 8, "Invalid size");
+static_assert(sizeof(PackedVertexShadingData) == 12, "Invalid size");
 
 using namespace Math;
 
+namespace {
+
+static constexpr uint8 CompactIndicesFlag = 1 << 0;
+static constexpr uint8 PackedShadingDataFlag = 1 << 1;
+
+// triangle vertices are read with unaligned Vec4f loads, which go one float past the last triangle
+static constexpr size_t PreprocessedTrianglesPadding = sizeof(float);
+
+static constexpr float TexCoordQuantizationScale = 65535.0f;
+
+const PackedUnitVector3 PackUnitVector(const Vec3f& v)
+{
+    // zero vector has no valid encoding (it would be decoded as +Z)
+    NFE_ASSERT(Vec3f::Dot(v, v) > 0.0f, "Zero vector can't be packed");
+    return PackedUnitVector3::FromVector(Vec4f(v));
+}
+
+uint16 PackTexCoord(float value, float offset, float invScale)
+{
+    const float quantized = (value - offset) * invScale + 0.5f;
+    return static_cast<uint16>(Clamp(quantized, 0.0f, TexCoordQuantizationScale));
+}
+
+NFE_FORCE_INLINE void UnpackShadingData(const PackedVertexShadingData& input, const Vec2f& texCoordScale, const Vec2f& texCoordOffset, VertexShadingData& output)
+{
+    output.normal = LoadVec4f(input.normal).ToVec3f();
+    output.tangent = LoadVec4f(input.tangent).ToVec3f();
+    output.texCoord = texCoordOffset + texCoordScale * Vec2f(static_cast<float>(input.texCoord[0]), static_cast<float>(input.texCoord[1]));
+}
+
+} // namespace
+
 VertexBuffer::VertexBuffer()
     : mBuffer(nullptr)
     , mPreprocessedTriangles(nullptr)
@@ -28,13 +76,13 @@ void VertexBuffer::Clear()
 {
     if (mBuffer)
     {
-        NFE_FREE(mBuffer);
+        SystemAllocator::Free(mBuffer);
         mBuffer = nullptr;
     }
 
     if (mPreprocessedTriangles)
     {
-        NFE_FREE(mPreprocessedTriangles);
+        SystemAllocator::Free(mPreprocessedTriangles);
         mPreprocessedTriangles = nullptr;
     }
 
@@ -43,6 +91,10 @@ void VertexBuffer::Clear()
     mVertexIndexBufferOffset = 0;
     mShadingDataBufferOffset = 0;
     mMaterialBufferOffset = 0;
+    mCompactIndices = false;
+    mPackedShadingData = false;
+    mTexCoordScale = Vec2f();
+    mTexCoordOffset = Vec2f();
 
     mMaterials.Clear();
 }
@@ -74,10 +126,55 @@ bool VertexBuffer::Initialize(const VertexBufferDesc& desc)
         return false;
     }
 
+    // all the indices must fit in 16 bits (UINT16_MAX is reserved for "no material")
+    mCompactIndices = desc.compactIndices && desc.numVertices <= UINT16_MAX + 1u && desc.numMaterials < UINT16_MAX;
+    // octahedral encoding can't represent missing (zero) normals and tangents
+    mPackedShadingData = desc.packShadingData && desc.normals && desc.tangents;
+
+    if (desc.compactIndices && !mCompactIndices)
+    {
+        NFE_LOG_DEBUG("Mesh is too big for 16-bit indices (%u vertices, %u materials)", desc.numVertices, desc.numMaterials);
+    }
+
+    if (desc.packShadingData && !mPackedShadingData)
+    {
+        NFE_LOG_DEBUG("Mesh has no normals or tangents, shading data won't be packed");
+    }
+
+    // texture coordinates are quantized to 16 bits within mesh's UV bounding box
+    Vec2f texCoordInvScale;
+    if (mPackedShadingData && desc.texCoords)
+    {
+        Vec2f minTexCoord = desc.texCoords[0];
+        Vec2f maxTexCoord = desc.texCoords[0];
+        for (uint32 i = 1; i < desc.numVertices; ++i)
+        {
+            minTexCoord = Vec2f::Min(minTexCoord, desc.texCoords[i]);
+            maxTexCoord = Vec2f::Max(maxTexCoord, desc.texCoords[i]);
+        }
+
+        const Vec2f range = maxTexCoord - minTexCoord;
+        mTexCoordOffset = minTexCoord;
+        mTexCoordScale = range / TexCoordQuantizationScale;
+        texCoordInvScale.x = range.x > 0.0f ? TexCoordQuantizationScale / range.x : 0.0f;
+        texCoordInvScale.y = range.y > 0.0f ? TexCoordQuantizationScale / range.y : 0.0f;
+
+        // rounding error is half of the quantization step
+        const float maxError = 0.5f * Max(mTexCoordScale.x, mTexCoordScale.y);
+        if (maxError > desc.maxTexCoordError)
+        {
+            NFE_LOG_DEBUG("Texture coordinates range is too big to be packed (error = %f, max allowed = %f), shading data won't be packed",
+                maxError, desc.maxTexCoordError);
+            mPackedShadingData = false;
+            mTexCoordScale = Vec2f();
+            mTexCoordOffset = Vec2f();
+        }
+    }
+
     const size_t preprocessedTrianglesBufferSize = sizeof(ProcessedTriangle) * desc.numTriangles;
     const size_t positionsBufferSize = sizeof(Vec3f) * desc.numVertices;
-    const size_t indexBufferSize = sizeof(VertexIndices) * desc.numTriangles;
-    const size_t shadingDataBufferSize = sizeof(VertexShadingData) * desc.numVertices;
+    const size_t indexBufferSize = (mCompactIndices ? sizeof(CompactVertexIndices) : sizeof(VertexIndices)) * desc.numTriangles;
+    const size_t shadingDataBufferSize = (mPackedShadingData ? sizeof(PackedVertexShadingData) : sizeof(VertexShadingData)) * desc.numVertices;
     const size_t materialBufferSize = sizeof(Material*) * desc.numMaterials;
 
     mVertexIndexBufferOffset = RoundUp<size_t>(positionsBufferSize, alignof(VertexIndices));
@@ -88,7 +185,7 @@ bool VertexBuffer::Initialize(const VertexBufferDesc& desc)
 
 
     NFE_LOG_DEBUG("Allocating vertex buffer for mesh, size = %u", bufferSizeRequired);
-    mBuffer = (char*)NFE_MALLOC(bufferSizeRequired, NFE_CACHE_LINE_SIZE);
+    mBuffer = (char*)SystemAllocator::Allocate(bufferSizeRequired, NFE_CACHE_LINE_SIZE);
     if (!mBuffer)
     {
         NFE_LOG_ERROR("Memory allocation failed");
@@ -105,7 +202,7 @@ bool VertexBuffer::Initialize(const VertexBufferDesc& desc)
 
     // preprocess triangles
     {
-        mPreprocessedTriangles = (ProcessedTriangle*)NFE_MALLOC(preprocessedTrianglesBufferSize, NFE_CACHE_LINE_SIZE);
+        mPreprocessedTriangles = (ProcessedTriangle*)SystemAllocator::Allocate(preprocessedTrianglesBufferSize + PreprocessedTrianglesPadding, NFE_CACHE_LINE_SIZE);
         if (!mPreprocessedTriangles)
         {
             NFE_LOG_ERROR("Memory allocation failed");
@@ -130,10 +227,10 @@ bool VertexBuffer::Initialize(const VertexBufferDesc& desc)
     // fill index buffer
     {
         VertexIndices* buffer = reinterpret_cast<VertexIndices*>(mBuffer + mVertexIndexBufferOffset);
+        CompactVertexIndices* compactBuffer = reinterpret_cast<CompactVertexIndices*>(mBuffer + mVertexIndexBufferOffset);
         for (uint32 i = 0; i < desc.numTriangles; ++i)
         {
-            VertexIndices& indices = buffer[i];
-
+            VertexIndices indices;
             indices.i0 = desc.vertexIndexBuffer[3 * i];
             indices.i1 = desc.vertexIndexBuffer[3 * i + 1];
             indices.i2 = desc.vertexIndexBuffer[3 * i + 2];
@@ -143,6 +240,18 @@ bool VertexBuffer::Initialize(const VertexBufferDesc& desc)
             NFE_ASSERT(indices.i1 < desc.numVertices, "Vertex index out of bounds");
             NFE_ASSERT(indices.i2 < desc.numVertices, "Vertex index out of bounds");
             NFE_ASSERT(indices.materialIndex < desc.numMaterials || indices.materialIndex == UINT32_MAX, "Material index out of bounds");
+
+            if (mCompactIndices)
+            {
+                compactBuffer[i].i0 = static_cast<uint16>(indices.i0);
+                compactBuffer[i].i1 = static_cast<uint16>(indices.i1);
+                compactBuffer[i].i2 = static_cast<uint16>(indices.i2);
+                compactBuffer[i].materialIndex = indices.materialIndex != UINT32_MAX ? static_cast<uint16>(indices.materialIndex) : UINT16_MAX;
+            }
+            else
+            {
+                buffer[i] = indices;
+            }
         }
     }
 
@@ -151,18 +260,33 @@ bool VertexBuffer::Initialize(const VertexBufferDesc& desc)
     // fill vertex shading data buffer
     {
         VertexShadingData* buffer = reinterpret_cast<VertexShadingData*>(mBuffer + mShadingDataBufferOffset);
+        PackedVertexShadingData* packedBuffer = reinterpret_cast<PackedVertexShadingData*>(mBuffer + mShadingDataBufferOffset);
+
         for (uint32 i = 0; i < desc.numVertices; ++i)
         {
-            buffer[i].normal = desc.normals ? desc.normals[i] : Vec3f();
-            buffer[i].tangent = desc.tangents ? desc.tangents[i] : Vec3f();
-            buffer[i].texCoord = desc.texCoords ? desc.texCoords[i] : Vec2f();
-
-            NFE_ASSERT(buffer[i].normal.IsValid(), "Corrupted normal vector");
-            NFE_ASSERT(buffer[i].tangent.IsValid(), "Corrupted tangent vector");
-            NFE_ASSERT(buffer[i].texCoord.IsValid(), "Corrupted texture coordinates");
-            NFE_ASSERT(Abs(1.0f - buffer[i].normal.Length()) < 0.0001f, "Normal vector is not normalized");
-            NFE_ASSERT(Abs(1.0f - buffer[i].tangent.Length()) < 0.0001f, "Tangent vector is not normalized");
-            NFE_ASSERT(Abs(Vec3f::Dot(buffer[i].normal, buffer[i].tangent)) < 0.0001f, "Normal and tangent vectors are not orthogonal");
+            VertexShadingData data;
+            data.normal = desc.normals ? desc.normals[i] : Vec3f();
+            data.tangent = desc.tangents ? desc.tangents[i] : Vec3f();
+            data.texCoord = desc.texCoords ? desc.texCoords[i] : Vec2f();
+
+            NFE_ASSERT(data.normal.IsValid(), "Corrupted normal vector");
+            NFE_ASSERT(data.tangent.IsValid(), "Corrupted tangent vector");
+            NFE_ASSERT(data.texCoord.IsValid(), "Corrupted texture coordinates");
+            NFE_ASSERT(Abs(1.0f - data.normal.Length()) < 0.0001f, "Normal vector is not normalized");
+            NFE_ASSERT(Abs(1.0f - data.tangent.Length()) < 0.0001f, "Tangent vector is not normalized");
+            NFE_ASSERT(Abs(Vec3f::Dot(data.normal, data.tangent)) < 0.0001f, "Normal and tangent vectors are not orthogonal");
+
+            if (mPackedShadingData)
+            {
+                packedBuffer[i].normal = PackUnitVector(data.normal);
+                packedBuffer[i].tangent = PackUnitVector(data.tangent);
+                packedBuffer[i].texCoord[0] = PackTexCoord(data.texCoord.x, mTexCoordOffset.x, texCoordInvScale.x);
+                packedBuffer[i].texCoord[1] = PackTexCoord(data.texCoord.y, mTexCoordOffset.y, texCoordInvScale.y);
+            }
+            else
+            {
+                buffer[i] = data;
+            }
         }
     }
 
@@ -184,12 +308,151 @@ bool VertexBuffer::Initialize(const VertexBufferDesc& desc)
     return true;
 }
 
+bool VertexBuffer::Write(Common::OutputStream& stream) const
+{
+    const size_t preprocessedTrianglesBufferSize = sizeof(ProcessedTriangle) * mNumTriangles;
+
+    uint8 flags = 0;
+    if (mCompactIndices)
+    {
+        flags |= CompactIndicesFlag;
+    }
+    if (mPackedShadingData)
+    {
+        flags |= PackedShadingDataFlag;
+    }
+
+    const bool headerWritten =
+        stream.Write(mNumVertices) &&
+        stream.Write(mNumTriangles) &&
+        stream.Write(mMaterials.Size()) &&
+        stream.Write(flags) &&
+        stream.Write(mTexCoordScale) &&
+        stream.Write(mTexCoordOffset) &&
+        stream.Write(static_cast<uint64>(mVertexIndexBufferOffset)) &&
+        stream.Write(static_cast<uint64>(mShadingDataBufferOffset)) &&
+        stream.Write(static_cast<uint64>(mMaterialBufferOffset));
+    if (!headerWritten)
+    {
+        NFE_LOG_ERROR("Failed to write vertex buffer header");
+        return false;
+    }
+
+    if (mNumTriangles == 0)
+    {
+        return true;
+    }
+
+    // material pointers are not written
+    if (stream.Write(mBuffer, mMaterialBufferOffset) != mMaterialBufferOffset ||
+        stream.Write(mPreprocessedTriangles, preprocessedTrianglesBufferSize) != preprocessedTrianglesBufferSize)
+    {
+        NFE_LOG_ERROR("Failed to write vertex buffer data");
+        return false;
+    }
+
+    return true;
+}
+
+bool VertexBuffer::Read(Common::InputStream& stream)
+{
+    // keep the materials, they are deserialized separately
+    Common::DynArray<MaterialPtr> materials = std::move(mMaterials);
+    Clear();
+    mMaterials = std::move(materials);
+
+    uint32 numVertices = 0;
+    uint32 numTriangles = 0;
+    uint32 numMaterials = 0;
+    uint8 flags = 0;
+    Vec2f texCoordScale;
+    Vec2f texCoordOffset;
+    uint64 vertexIndexBufferOffset = 0;
+    uint64 shadingDataBufferOffset = 0;
+    uint64 materialBufferOffset = 0;
+
+    const bool headerRead =
+        stream.Read(numVertices) &&
+        stream.Read(numTriangles) &&
+        stream.Read(numMaterials) &&
+        stream.Read(flags) &&
+        stream.Read(texCoordScale) &&
+        stream.Read(texCoordOffset) &&
+        stream.Read(vertexIndexBufferOffset) &&
+        stream.Read(shadingDataBufferOffset) &&
+        stream.Read(materialBufferOffset);
+    if (!headerRead)
+    {
+        NFE_LOG_ERROR("Failed to read vertex buffer header");
+        return false;
+    }
+
+    if (numMaterials != mMaterials.Size())
+    {
+        NFE_LOG_ERROR("Vertex buffer data does not match materials list (%u materials expected, got %u)", numMaterials, mMaterials.Size());
+        return false;
+    }
+
+    if (numTriangles == 0)
+    {
+        return true;
+    }
+
+    const size_t preprocessedTrianglesBufferSize = sizeof(ProcessedTriangle) * numTriangles;
+    const size_t bufferSizeRequired = materialBufferOffset + sizeof(Material*) * numMaterials;
+
+    mBuffer = (char*)SystemAllocator::Allocate(bufferSizeRequired, NFE_CACHE_LINE_SIZE);
+    mPreprocessedTriangles = (ProcessedTriangle*)SystemAllocator::Allocate(preprocessedTrianglesBufferSize + PreprocessedTrianglesPadding, NFE_CACHE_LINE_SIZE);
+    if (!mBuffer || !mPreprocessedTriangles)
+    {
+        NFE_LOG_ERROR("Memory allocation failed");
+        return false;
+    }
+
+    if (stream.Read(mBuffer, materialBufferOffset) != materialBufferOffset ||
+        stream.Read(mPreprocessedTriangles, preprocessedTrianglesBufferSize) != preprocessedTrianglesBufferSize)
+    {
+        NFE_LOG_ERROR("Failed to read vertex buffer data");
+        return false;
+    }
+
+    Material** materialBuffer = reinterpret_cast<Material**>(mBuffer + materialBufferOffset);
+    for (uint32 i = 0; i < numMaterials; ++i)
+    {
+        materialBuffer[i] = mMaterials[i].Get();
+    }
+
+    mNumVertices = numVertices;
+    mNumTriangles = numTriangles;
+    mCompactIndices = (flags & CompactIndicesFlag) != 0;
+    mPackedShadingData = (flags & PackedShadingDataFlag) != 0;
+    mTexCoordScale = texCoordScale;
+    mTexCoordOffset = texCoordOffset;
+    mVertexIndexBufferOffset = static_cast<size_t>(vertexIndexBufferOffset);
+    mShadingDataBufferOffset = static_cast<size_t>(shadingDataBufferOffset);
+    mMaterialBufferOffset = static_cast<size_t>(materialBufferOffset);
+
+    return true;
+}
+
 void VertexBuffer::GetVertexIndices(const uint32 triangleIndex, VertexIndices& indices) const
 {
     NFE_ASSERT(triangleIndex < mNumTriangles, "");
 
-    const VertexIndices* buffer = reinterpret_cast<const VertexIndices*>(mBuffer + mVertexIndexBufferOffset);
-    indices = buffer[triangleIndex];
+    if (mCompactIndices)
+    {
+        const CompactVertexIndices* buffer = reinterpret_cast<const CompactVertexIndices*>(mBuffer + mVertexIndexBufferOffset);
+        const CompactVertexIndices& compactIndices = buffer[triangleIndex];
+        indices.i0 = compactIndices.i0;
+        indices.i1 = compactIndices.i1;
+        indices.i2 = compactIndices.i2;
+        indices.materialIndex = compactIndices.materialIndex != UINT16_MAX ? compactIndices.materialIndex : UINT32_MAX;
+    }
+    else
+    {
+        const VertexIndices* buffer = reinterpret_cast<const VertexIndices*>(mBuffer + mVertexIndexBufferOffset);
+        indices = buffer[triangleIndex];
+    }
 }
 
 const Material* VertexBuffer::GetMaterial(const uint32 materialIndex) const
@@ -210,10 +473,30 @@ void VertexBuffer::GetTriangle(const uint32 triangleIndex, RayPacketTypes::Trian
 
 void VertexBuffer::GetShadingData(const VertexIndices& indices, VertexShadingData& a, VertexShadingData& b, VertexShadingData& c) const
 {
-    const VertexShadingData* buffer = reinterpret_cast<const VertexShadingData*>(mBuffer + mShadingDataBufferOffset);
-    a = buffer[indices.i0];
-    b = buffer[indices.i1];
-    c = buffer[indices.i2];
+    if (mPackedShadingData)
+    {
+        const PackedVertexShadingData* buffer = reinterpret_cast<const PackedVertexShadingData*>(mBuffer + mShadingDataBufferOffset);
+        UnpackShadingData(buffer[indices.i0], mTexCoordScale, mTexCoordOffset, a);
+        UnpackShadingData(buffer[indices.i1], mTexCoordScale, mTexCoordOffset, b);
+        UnpackShadingData(buffer[indices.i2], mTexCoordScale, mTexCoordOffset, c);
+    }
+    else
+    {
+        const VertexShadingData* buffer = reinterpret_cast<const VertexShadingData*>(mBuffer + mShadingDataBufferOffset);
+        a = buffer[indices.i0];
+        b = buffer[indices.i1];
+        c = buffer[indices.i2];
+    }
+}
+
+size_t VertexBuffer::GetMemorySize() const
+{
+    if (mNumTriangles == 0)
+    {
+        return 0;
+    }
+
+    return mMaterialBufferOffset + sizeof(Material*) * mMaterials.Size() + sizeof(ProcessedTriangle) * mNumTriangles;
 }
 
 } // namespace RT
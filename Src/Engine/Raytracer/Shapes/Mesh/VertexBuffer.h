@@ -7,12 +7,16 @@
 #include "../../../Common/Math/Vec4f.hpp"
 #include "../../../Common/Math/Triangle.hpp"
 #include "../../../Common/Math/Vec3f.hpp"
+#include "../../../Common/Math/Packed.hpp"
 #include "../../../Common/Containers/DynArray.hpp"
+#include "../../../Common/Containers/SharedPtr.hpp"
+#include "../../../Common/Reflection/ReflectionClassDeclare.hpp"
 
 namespace NFE {
 namespace RT {
 
 class Material;
+using MaterialPtr = Common::SharedPtr<Material>;
 
 struct NFE_ALIGN(16) VertexIndices
 {
@@ -29,10 +33,29 @@ struct NFE_ALIGN(32) VertexShadingData
     Math::Vec2f texCoord;
 };
 
+// vertex indices of a mesh with less than 64K vertices
+struct CompactVertexIndices
+{
+    uint16 i0;
+    uint16 i1;
+    uint16 i2;
+    uint16 materialIndex;   // UINT16_MAX if there is no material
+};
+
+// quantized vertex shading data, decoded in VertexBuffer::GetShadingData
+struct PackedVertexShadingData
+{
+    Math::PackedUnitVector3 normal;
+    Math::PackedUnitVector3 tangent;
+    uint16 texCoord[2];     // unorm16, relative to mesh's texture coordinates bounds
+};
+
 
 // Structure containing packed mesh data (vertices, vertex indices and material indices).
 class VertexBuffer
 {
+    NFE_DECLARE_CLASS(VertexBuffer)
+
 public:
     VertexBuffer();
     ~VertexBuffer();
@@ -43,6 +66,11 @@ public:
     // Initialize the vertex buffer with a new content
     bool Initialize(const VertexBufferDesc& desc);
 
+    // Store/restore packed vertex data in a binary stream.
+    // NOTE: materials are not included (they are reflected), Read() binds the data to the current materials list.
+    bool Write(Common::OutputStream& stream) const;
+    bool Read(Common::InputStream& stream);
+
     // get vertex indices for given triangle
     void GetVertexIndices(const uint32 triangleIndex, VertexIndices& indices) const;
 
@@ -62,6 +90,9 @@ public:
     NFE_FORCE_INLINE uint32 GetNumVertices() const { return mNumVertices; }
     NFE_FORCE_INLINE uint32 GetNumTriangles() const { return mNumTriangles; }
 
+    // get size of vertex buffer data (in bytes)
+    size_t GetMemorySize() const;
+
 private:
 
     char* mBuffer;
@@ -74,6 +105,13 @@ private:
     uint32 mNumVertices;
     uint32 mNumTriangles;
 
+    bool mCompactIndices;       // index buffer contains CompactVertexIndices
+    bool mPackedShadingData;    // shading data buffer contains PackedVertexShadingData
+
+    // decoding of packed texture coordinates: texCoord = offset + scale * unorm16 value
+    Math::Vec2f mTexCoordScale;
+    Math::Vec2f mTexCoordOffset;
+
     Common::DynArray<MaterialPtr> mMaterials;
 };
 
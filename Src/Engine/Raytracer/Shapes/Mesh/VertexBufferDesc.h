@@ -24,6 +24,20 @@ struct VertexBufferDesc
     const Math::Vec2f* texCoords = nullptr;
     const uint32* materialIndexBuffer = nullptr;
     const MaterialPtr* materials = nullptr;
+
+    // store normals and tangents using octahedral encoding and texture coordinates as 16-bit values
+    // relative to the mesh's texture coordinates bounds (12 instead of 32 bytes per vertex)
+    // NOTE: requires normals and tangents to be provided
+    bool packShadingData = false;
+
+    // maximum error of packed texture coordinates (in UV units)
+    // if the texture coordinates range is too big to fit in this error, the shading data is not packed
+    // default is a quarter of a texel of 2048x2048 texture
+    float maxTexCoordError = 0.25f / 2048.0f;
+
+    // store vertex and material indices as 16-bit values if the mesh is small enough
+    // (8 instead of 16 bytes per triangle)
+    bool compactIndices = false;
 };
 
 } // namespace RT
@@ -10,12 +10,15 @@
 #include "../Common/Math/Distribution.hpp"
 #include "../Common/Math/SamplingHelpers.hpp"
 #include "../Common/Math/PackedLoadVec4f.hpp"
+#include "../Common/Utils/Stream/InputStream.hpp"
+#include "../Common/Utils/Stream/OutputStream.hpp"
 #include "../Common/Reflection/ReflectionClassDefine.hpp"
 
 NFE_DEFINE_POLYMORPHIC_CLASS(NFE::RT::MeshShape)
 {
     NFE_CLASS_PARENT(NFE::RT::IShape);
-    // TODO resource path
+    NFE_CLASS_MEMBER(mPath);
+    NFE_CLASS_MEMBER(mVertexBuffer);
 }
 NFE_END_DEFINE_CLASS()
 
@@ -41,7 +44,9 @@ const Box MeshShape::GetBoundingBox() const
 
 bool MeshShape::Initialize(const MeshDesc& desc)
 {
+    mPath = desc.path;
     mBoundingBox = Box::Empty();
+    mImportanceMap.Reset();
 
     const Vec3f* positions = desc.vertexBufferDesc.positions;
     const uint32* indexBuffer = desc.vertexBufferDesc.vertexIndexBuffer;
@@ -63,7 +68,7 @@ bool MeshShape::Initialize(const MeshDesc& desc)
 
     BVHBuilder::Indices newTrianglesOrder;
     BVHBuilder bvhBuilder(mBVH);
-    if (!bvhBuilder.Build(boxes.Data(), desc.vertexBufferDesc.numTriangles, BvhBuildingParams(), newTrianglesOrder))
+    if (!bvhBuilder.Build(boxes.Data(), desc.vertexBufferDesc.numTriangles, desc.bvhParams, newTrianglesOrder))
     {
         return false;
     }
@@ -115,7 +120,40 @@ bool MeshShape::Initialize(const MeshDesc& desc)
 
     // TODO reorder indices
 
-    NFE_LOG_INFO("MeshShape '%s' created successfully", !desc.path.Empty() ? desc.path.Str() : "unnamed");
+    NFE_LOG_INFO("MeshShape '%s' created successfully (vertex data size: %u KB)",
+        !desc.path.Empty() ? desc.path.Str() : "unnamed", static_cast<uint32>(mVertexBuffer.GetMemorySize() / 1024u));
+    return true;
+}
+
+bool MeshShape::Write(OutputStream& stream) const
+{
+    if (!stream.Write(mBoundingBox))
+    {
+        NFE_LOG_ERROR("MeshShape '%s': Failed to write bounding box", mPath.Str());
+        return false;
+    }
+
+    return mVertexBuffer.Write(stream) && mBVH.Write(stream);
+}
+
+bool MeshShape::Read(InputStream& stream)
+{
+    mImportanceMap.Reset();
+    mSurfaceArea = 0.0f;
+    mSurfaceAreaInv = 0.0f;
+
+    if (!stream.Read(mBoundingBox))
+    {
+        NFE_LOG_ERROR("MeshShape '%s': Failed to read bounding box", mPath.Str());
+        return false;
+    }
+
+    if (!mVertexBuffer.Read(stream) || !mBVH.Read(stream))
+    {
+        NFE_LOG_ERROR("MeshShape '%s': Failed to read mesh data", mPath.Str());
+        return false;
+    }
+
     return true;
 }
 
@@ -157,7 +195,7 @@ const Vec4f MeshShape::SampleSurface(const Vec3f& u, Vec4f* outNormal, float* ou
     NFE_ASSERT(mImportanceMap, "Mesh is not samplable");
 
     float pdf = 0.0f;
-    const uint32 triangleIndex = mImportanceMap->SampleDiscrete(u.z, pdf);
+    const uint32 triangleIndex = mImportanceMap->SampleDiscreteAlias(u.z, pdf);
     NFE_ASSERT(triangleIndex < mVertexBuffer.GetNumTriangles(), "");
 
     const ProcessedTriangle& tri = mVertexBuffer.GetTriangle(triangleIndex);
@@ -264,6 +302,39 @@ bool MeshShape::Traverse_Shadow(const SingleTraversalContext& context, const uin
     return GenericTraverse_Shadow<MeshShape>(context, objectID, this);
 }
 
+bool MeshShape::Traverse_Shadow_SubObject(const SingleTraversalContext& context, const uint32 objectID, const uint32 subObjectID) const
+{
+    HitPoint& hitPoint = context.hitPoint;
+
+    // filter triangle (to avoid self-intersections)
+    if (subObjectID >= mVertexBuffer.GetNumTriangles() || (subObjectID == hitPoint.subObjectId && objectID == hitPoint.objectId))
+    {
+        return false;
+    }
+
+#ifdef NFE_ENABLE_INTERSECTION_COUNTERS
+    context.context.localCounters.numRayTriangleTests++;
+#endif // NFE_ENABLE_INTERSECTION_COUNTERS
+
+    float distance, u, v;
+    const ProcessedTriangle& tri = mVertexBuffer.GetTriangle(subObjectID);
+    if (Intersect_TriangleRay(context.ray, Vec4f(&tri.v0.x), Vec4f(&tri.edge1.x), Vec4f(&tri.edge2.x), u, v, distance))
+    {
+        if (distance < hitPoint.distance)
+        {
+            hitPoint.distance = distance;
+
+#ifdef NFE_ENABLE_INTERSECTION_COUNTERS
+            context.context.localCounters.numPassedRayTriangleTests++;
+#endif // NFE_ENABLE_INTERSECTION_COUNTERS
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
 bool MeshShape::Traverse_Leaf_Shadow(const SingleTraversalContext& context, const uint32 objectID, const BVH::Node& node) const
 {
     float distance, u, v;
@@ -291,7 +362,8 @@ bool MeshShape::Traverse_Leaf_Shadow(const SingleTraversalContext& context, cons
         {
             if (distance < hitPoint.distance)
             {
-                hitPoint.distance = distance;
+                // occluder is remembered in the occluder cache
+                hitPoint.Set(distance, objectID, triangleIndex);
 
 #ifdef NFE_ENABLE_INTERSECTION_COUNTERS
                 context.context.localCounters.numPassedRayTriangleTests++;
@@ -378,6 +450,14 @@ void MeshShape::Traverse_Leaf(const PacketTraversalContext& context, const uint3
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
+const Material* MeshShape::GetSubObjectMaterial(const uint32 subObjectId) const
+{
+    VertexIndices indices;
+    mVertexBuffer.GetVertexIndices(subObjectId, indices);
+
+    return indices.materialIndex != UINT32_MAX ? mVertexBuffer.GetMaterial(indices.materialIndex) : nullptr;
+}
+
 NFE_FORCE_NOINLINE
 void MeshShape::EvaluateIntersection(const HitPoint& hitPoint, IntersectionData& outData) const
  {
@@ -398,7 +478,8 @@ void MeshShape::EvaluateIntersection(const HitPoint& hitPoint, IntersectionData&
 
     const Vec4f texCoord0 = Vec4f_Load_Vec2f_Unsafe(vertexShadingData[0].texCoord);
     const Vec4f texCoord1 = Vec4f_Load_Vec2f_Unsafe(vertexShadingData[1].texCoord);
-    const Vec4f texCoord2 = Vec4f_Load_Vec2f_Unsafe(vertexShadingData[2].texCoord);
+    // unsafe load of the last element would read past the array
+    const Vec4f texCoord2 = Vec4f(vertexShadingData[2].texCoord.x, vertexShadingData[2].texCoord.y, 0.0f, 0.0f);
     Vec4f texCoord = coeff1 * texCoord1;
     texCoord = Vec4f::MulAndAdd(coeff2, texCoord2, texCoord);
     texCoord = Vec4f::MulAndAdd(coeff0, texCoord0, texCoord);
@@ -5,6 +5,7 @@
 
 #include "../Traversal/HitPoint.h"
 #include "../BVH/BVH.h"
+#include "../BVH/BVHBuilder.h"
 
 #include "../../Common/Math/Box.hpp"
 #include "../../Common/Math/Ray.hpp"
@@ -18,6 +19,7 @@ namespace RT {
 struct MeshDesc
 {
     VertexBufferDesc vertexBufferDesc;
+    BvhBuildingParams bvhParams;
     Common::String path;
 };
 
@@ -32,16 +34,25 @@ public:
     // Initialize the mesh
     NFE_RAYTRACER_API bool Initialize(const MeshDesc& desc);
 
+    // Store/restore mesh data (vertex buffer and BVH) in a binary stream, so the mesh can be restored without rebuilding.
+    // NOTE: mesh data is not reflected, Read() should be called after the mesh object was deserialized
+    NFE_RAYTRACER_API bool Write(Common::OutputStream& stream) const;
+    NFE_RAYTRACER_API bool Read(Common::InputStream& stream);
+
+    NFE_FORCE_INLINE const Common::String& GetPath() const { return mPath; }
+
     // IShape
     virtual const Math::Box GetBoundingBox() const override;
     virtual float GetSurfaceArea() const override;
     virtual void Traverse(const SingleTraversalContext& context, const uint32 objectID) const override;
     virtual void Traverse(const PacketTraversalContext & context, const uint32 objectID, const uint32 numActiveGroups) const override;
     virtual bool Traverse_Shadow(const SingleTraversalContext& context, const uint32 objectID) const override;
+    virtual bool Traverse_Shadow_SubObject(const SingleTraversalContext& context, const uint32 objectID, const uint32 subObjectID) const override;
     virtual bool Intersect(const Math::Ray& ray, RenderingContext& renderingCtx, ShapeIntersection& outResult) const override;
     virtual bool MakeSamplable() override;
     virtual const Math::Vec4f SampleSurface(const Math::Vec3f& u, Math::Vec4f * outNormal, float* outPdf) const override;
     virtual void EvaluateIntersection(const HitPoint& hitPoint, IntersectionData& outIntersectionData) const override;
+    virtual const Material* GetSubObjectMaterial(const uint32 subObjectId) const override;
 
     NFE_FORCE_INLINE const BVH& GetBVH() const { return mBVH; }
 
@@ -71,6 +71,12 @@ bool IShape::Traverse_Shadow(const SingleTraversalContext& context, const uint32
         && (context.hitPoint.objectId != objectID || context.hitPoint.subObjectId != intersection.subObjectId);
 }
 
+bool IShape::Traverse_Shadow_SubObject(const SingleTraversalContext& context, const uint32 objectID, const uint32 subObjectID) const
+{
+    NFE_UNUSED(subObjectID);
+    return Traverse_Shadow(context, objectID);
+}
+
 bool IShape::Intersect(const Ray&, RenderingContext&, ShapeIntersection&) const
 {
     NFE_FATAL("This shape has no volume");
@@ -132,5 +138,11 @@ bool IShape::MakeSamplable()
     return true;
 }
 
+const Material* IShape::GetSubObjectMaterial(const uint32 subObjectId) const
+{
+    NFE_UNUSED(subObjectId);
+    return nullptr;
+}
+
 } // namespace RT
 } // namespace NFE
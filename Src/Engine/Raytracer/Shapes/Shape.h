@@ -54,6 +54,9 @@ public:
     // traverse the object and check if the ray is occluded
     virtual bool Traverse_Shadow(const SingleTraversalContext& context, const uint32 objectID) const;
 
+    // check if the ray is occluded by given sub-object (whole shape is tested by default)
+    virtual bool Traverse_Shadow_SubObject(const SingleTraversalContext& context, const uint32 objectID, const uint32 subObjectID) const;
+
     // intersect with a ray and return hit points
     // TODO return array of all hit points along the ray
     virtual bool Intersect(const Math::Ray& ray, RenderingContext& renderingCtx, ShapeIntersection& outResult) const;
@@ -80,6 +83,10 @@ public:
     // NOTE: all calculations are performed in local space
     virtual void EvaluateIntersection(const HitPoint& hitPoint, IntersectionData& outIntersectionData) const = 0;
 
+    // Get material assigned to a sub-object (e.g. mesh triangle)
+    // Returns nullptr if the material bound to the scene object should be used
+    virtual const Material* GetSubObjectMaterial(const uint32 subObjectId) const;
+
     // Get world-space bounding box
     virtual const Math::Box GetBoundingBox() const = 0;
 };
@@ -42,6 +42,15 @@ bool SphereShape::OnPropertyChanged(const Common::StringView propertyName)
     return IShape::OnPropertyChanged(propertyName);
 }
 
+void SphereShape::OnDeserialized()
+{
+    IShape::OnDeserialized();
+
+    NFE_ASSERT(mRadius > 0.0f, "");
+    mRadiusD = mRadius;
+    mInvRadius = 1.0f / mRadius;
+}
+
 const Box SphereShape::GetBoundingBox() const
 {
     return Box(Vec4f::Zero(), mRadius);
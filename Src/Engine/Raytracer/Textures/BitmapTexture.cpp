@@ -1,9 +1,11 @@
 #include "PCH.h"
 #include "BitmapTexture.h"
 #include "../Utils/Bitmap.h"
+#include "../Utils/TextureCache.h"
 #include "../Common/Math/ColorHelpers.hpp"
 #include "../Common/Math/Distribution.hpp"
 #include "../Common/Math/WindowFunctions.hpp"
+#include "../Common/Math/Vec8i.hpp"
 #include "../Common/Containers/DynArray.hpp"
 #include "../Common/Reflection/ReflectionClassDefine.hpp"
 #include "../Common/Utils/TaskBuilder.hpp"
@@ -24,6 +26,8 @@ NFE_DEFINE_POLYMORPHIC_CLASS(NFE::RT::BitmapTexture)
     NFE_CLASS_MEMBER(mFilter);
     NFE_CLASS_MEMBER(mBicubicB).Norm();
     NFE_CLASS_MEMBER(mBicubicC).Norm();
+    NFE_CLASS_MEMBER(mPath);
+    NFE_CLASS_MEMBER(mStreamed);
 }
 NFE_END_DEFINE_CLASS()
 
@@ -37,19 +41,53 @@ BitmapTexture::BitmapTexture()
     : mFilter(BitmapTextureFilter::Linear)
     , mBicubicB(128)    // 0.50f
     , mBicubicC(64)     // 0.25f
+    , mStreamed(false)
 {}
 
 BitmapTexture::~BitmapTexture() = default;
 
 BitmapTexture::BitmapTexture(const BitmapPtr& bitmap)
     : BitmapTexture()
+{
+    SetBitmap(bitmap);
+}
+
+BitmapTexture::BitmapTexture(const TiledBitmapPtr& tiledBitmap)
+    : BitmapTexture()
+{
+    SetBitmap(tiledBitmap);
+}
+
+void BitmapTexture::SetBitmap(const BitmapPtr& bitmap)
 {
     mBitmap = bitmap;
+    mTiledBitmap.Reset();
+    mImportanceMap[0].Reset();
+    mImportanceMap[1].Reset();
+
+    mPath = bitmap ? bitmap->GetDebugName() : "";
+    mStreamed = false;
+}
+
+void BitmapTexture::SetBitmap(const TiledBitmapPtr& tiledBitmap)
+{
+    mBitmap.Reset();
+    mTiledBitmap = tiledBitmap;
+    mImportanceMap[0].Reset();
+    mImportanceMap[1].Reset();
+
+    mPath = tiledBitmap ? tiledBitmap->GetDebugName() : "";
+    mStreamed = true;
 }
 
 
 const char* BitmapTexture::GetName() const
 {
+    if (mTiledBitmap)
+    {
+        return mTiledBitmap->GetDebugName();
+    }
+
     if (!mBitmap)
     {
         return "<none>";
@@ -58,17 +96,46 @@ const char* BitmapTexture::GetName() const
     return mBitmap->GetDebugName();
 }
 
+const Vec4ui BitmapTexture::GetSize() const
+{
+    if (mTiledBitmap)
+    {
+        return mTiledBitmap->GetSize();
+    }
+
+    return mBitmap ? mBitmap->GetSize() : Vec4ui::Zero();
+}
+
+const Vec4f BitmapTexture::GetFloatSize() const
+{
+    if (mTiledBitmap)
+    {
+        return mTiledBitmap->GetFloatSize();
+    }
+
+    return mBitmap ? mBitmap->GetFloatSize() : Vec4f::Zero();
+}
+
 const Vec4f BitmapTexture::Evaluate(const Vec4f& coords) const
 {
-    const Bitmap* bitmapPtr = mBitmap.Get();
+    if (const TiledBitmap* tiledBitmapPtr = mTiledBitmap.Get())
+    {
+        return Evaluate_Internal(*tiledBitmapPtr, coords);
+    }
 
-    if (!bitmapPtr)
+    if (const Bitmap* bitmapPtr = mBitmap.Get())
     {
-        return Vec4f::Zero();
+        return Evaluate_Internal(*bitmapPtr, coords);
     }
 
+    return Vec4f::Zero();
+}
+
+template<typename BitmapType>
+const Vec4f BitmapTexture::Evaluate_Internal(const BitmapType& bitmap, const Vec4f& coords) const
+{
     // bitmap size
-    const Vec4i size(bitmapPtr->GetSize().Swizzle<0,1,0,1>());
+    const Vec4i size(bitmap.GetSize().template Swizzle<0,1,0,1>());
 
     // wrap to 0..1 range
     const Vec4f warpedCoords = Vec4f::Mod1(coords);
@@ -77,7 +144,7 @@ const Vec4f BitmapTexture::Evaluate(const Vec4f& coords) const
     const Vec4f pixelOffset = mFilter != BitmapTextureFilter::NearestNeighbor ? Vec4f(0.5f) : Vec4f::Zero();
 
     // compute texel coordinates
-    const Vec4f scaledCoords = warpedCoords * bitmapPtr->mFloatSize.Swizzle<0,1,0,1>() - pixelOffset;
+    const Vec4f scaledCoords = warpedCoords * bitmap.GetFloatSize().template Swizzle<0,1,0,1>() - pixelOffset;
     const Vec4i intCoords = Vec4i::Convert(Vec4f::Floor(scaledCoords));
     Vec4f coordFraction = scaledCoords - intCoords.ConvertToVec4f();
 
@@ -89,7 +156,7 @@ const Vec4f BitmapTexture::Evaluate(const Vec4f& coords) const
 
     if (mFilter == BitmapTextureFilter::NearestNeighbor)
     {
-        result = bitmapPtr->GetPixel(texelCoords.x, texelCoords.y);
+        result = bitmap.GetPixel(texelCoords.x, texelCoords.y);
     }
     else if (mFilter == BitmapTextureFilter::Linear || mFilter == BitmapTextureFilter::LinearSmoothStep)
     {
@@ -100,7 +167,7 @@ const Vec4f BitmapTexture::Evaluate(const Vec4f& coords) const
         texelCoords -= Vec4i::AndNot(texelCoords < size, size);
 
         Vec4f colors[4];
-        bitmapPtr->GetPixelBlock(Vec4ui(texelCoords), colors);
+        bitmap.GetPixelBlock(Vec4ui(texelCoords), colors);
 
         if (mFilter == BitmapTextureFilter::LinearSmoothStep)
         {
@@ -136,7 +203,7 @@ const Vec4f BitmapTexture::Evaluate(const Vec4f& coords) const
                 const float weight = WindowFunctions::MitchellNetravali(d, B, C);
 
                 weightSum += weight;
-                result += bitmapPtr->GetPixel(sampleCoords.x, sampleCoords.y) * weight;
+                result += bitmap.GetPixel(sampleCoords.x, sampleCoords.y) * weight;
                 NFE_ASSERT(result.IsValid(), "");
             }
         }
@@ -156,17 +223,111 @@ const Vec4f BitmapTexture::Evaluate(const Vec4f& coords) const
     return result;
 }
 
-float BitmapTexture::Pdf(SampleDistortion distortion, const Math::Vec4f& coords) const
+const Vec3x8f BitmapTexture::Evaluate(const Vec2x8f& coords) const
 {
-    const Bitmap* bitmapPtr = mBitmap.Get();
+    if (mFilter == BitmapTextureFilter::Bicubic)
+    {
+        // bicubic filter is not vectorized
+        return ITexture::Evaluate(coords);
+    }
+
+    if (const TiledBitmap* tiledBitmapPtr = mTiledBitmap.Get())
+    {
+        return Evaluate_Internal(*tiledBitmapPtr, coords);
+    }
+
+    if (const Bitmap* bitmapPtr = mBitmap.Get())
+    {
+        return Evaluate_Internal(*bitmapPtr, coords);
+    }
+
+    return Vec3x8f::Zero();
+}
+
+template<typename BitmapType>
+const Vec3x8f BitmapTexture::Evaluate_Internal(const BitmapType& bitmap, const Vec2x8f& coords) const
+{
+    // bitmap size
+    const Vec8f width(bitmap.GetFloatSize().x);
+    const Vec8f height(bitmap.GetFloatSize().y);
 
-    if (!bitmapPtr)
+    // half pixel offset
+    const Vec8f pixelOffset(mFilter != BitmapTextureFilter::NearestNeighbor ? 0.5f : 0.0f);
+
+    // wrap to 0..1 range and compute texel coordinates
+    const Vec8f scaledX = (coords.x - Vec8f::Floor(coords.x)) * width - pixelOffset;
+    const Vec8f scaledY = (coords.y - Vec8f::Floor(coords.y)) * height - pixelOffset;
+    Vec8f texelX = Vec8f::Floor(scaledX);
+    Vec8f texelY = Vec8f::Floor(scaledY);
+    Vec8f fractionX = scaledX - texelX;
+    Vec8f fractionY = scaledY - texelY;
+
+    texelX = Vec8f::Select(texelX, texelX - width, texelX >= width);
+    texelY = Vec8f::Select(texelY, texelY - height, texelY >= height);
+    texelX = Vec8f::Select(texelX, texelX + width, texelX < Vec8f::Zero());
+    texelY = Vec8f::Select(texelY, texelY + height, texelY < Vec8f::Zero());
+
+    const Vec8i intTexelX = Vec8i::Convert(texelX);
+    const Vec8i intTexelY = Vec8i::Convert(texelY);
+
+    if (mFilter == BitmapTextureFilter::NearestNeighbor)
+    {
+        Vec4f colors[8];
+        for (uint32 i = 0; i < 8; ++i)
+        {
+            colors[i] = bitmap.GetPixel(intTexelX[i], intTexelY[i]);
+        }
+
+        return Vec3x8f(colors[0], colors[1], colors[2], colors[3], colors[4], colors[5], colors[6], colors[7]);
+    }
+
+    NFE_ASSERT(mFilter == BitmapTextureFilter::Linear || mFilter == BitmapTextureFilter::LinearSmoothStep, "Invalid bitmap filter mode");
+
+    // wrap secondary coordinates
+    const Vec8f nextTexelX = texelX + Vec8f(1.0f);
+    const Vec8f nextTexelY = texelY + Vec8f(1.0f);
+    const Vec8i intNextTexelX = Vec8i::Convert(Vec8f::Select(nextTexelX, Vec8f::Zero(), nextTexelX >= width));
+    const Vec8i intNextTexelY = Vec8i::Convert(Vec8f::Select(nextTexelY, Vec8f::Zero(), nextTexelY >= height));
+
+    // fetch 2x2 blocks for each lane
+    Vec4f colors[4][8];
+    for (uint32 i = 0; i < 8; ++i)
+    {
+        Vec4f block[4];
+        bitmap.GetPixelBlock(Vec4ui(intTexelX[i], intTexelY[i], intNextTexelX[i], intNextTexelY[i]), block);
+
+        colors[0][i] = block[0];
+        colors[1][i] = block[1];
+        colors[2][i] = block[2];
+        colors[3][i] = block[3];
+    }
+
+    const Vec3x8f color00(colors[0][0], colors[0][1], colors[0][2], colors[0][3], colors[0][4], colors[0][5], colors[0][6], colors[0][7]);
+    const Vec3x8f color10(colors[1][0], colors[1][1], colors[1][2], colors[1][3], colors[1][4], colors[1][5], colors[1][6], colors[1][7]);
+    const Vec3x8f color01(colors[2][0], colors[2][1], colors[2][2], colors[2][3], colors[2][4], colors[2][5], colors[2][6], colors[2][7]);
+    const Vec3x8f color11(colors[3][0], colors[3][1], colors[3][2], colors[3][3], colors[3][4], colors[3][5], colors[3][6], colors[3][7]);
+
+    if (mFilter == BitmapTextureFilter::LinearSmoothStep)
+    {
+        fractionX = SmoothStep(fractionX);
+        fractionY = SmoothStep(fractionY);
+    }
+
+    // bilinear interpolation
+    const Vec3x8f value0 = Vec3x8f::MulAndAdd(color01 - color00, fractionY, color00);
+    const Vec3x8f value1 = Vec3x8f::MulAndAdd(color11 - color10, fractionY, color10);
+    return Vec3x8f::MulAndAdd(value1 - value0, fractionX, value0);
+}
+
+float BitmapTexture::Pdf(SampleDistortion distortion, const Math::Vec4f& coords) const
+{
+    if (!mBitmap && !mTiledBitmap)
     {
         return 0.0f;
     }
 
     // bitmap size
-    const Vec4i size(bitmapPtr->GetSize().Swizzle<0, 1, 0, 1>());
+    const Vec4i size(GetSize().Swizzle<0, 1, 0, 1>());
 
     // wrap to 0..1 range
     const Vec4f warpedCoords = Vec4f::Mod1(coords);
@@ -175,19 +336,17 @@ float BitmapTexture::Pdf(SampleDistortion distortion, const Math::Vec4f& coords)
     const Vec4f pixelOffset = mFilter != BitmapTextureFilter::NearestNeighbor ? Vec4f(0.5f) : Vec4f::Zero();
 
     // compute texel coordinates
-    const Vec4f scaledCoords = warpedCoords * bitmapPtr->mFloatSize.Swizzle<0, 1, 0, 1>() - pixelOffset;
+    const Vec4f scaledCoords = warpedCoords * GetFloatSize().Swizzle<0, 1, 0, 1>() - pixelOffset;
     const Vec4i intCoords = Vec4i::Convert(Vec4f::Floor(scaledCoords));
 
     Vec4i texelCoords = intCoords;
     texelCoords -= Vec4i::AndNot(intCoords < size, size);
     texelCoords += size & (intCoords < Vec4i::Zero());
 
-    const uint32 valueIndex = texelCoords.x + texelCoords.y * bitmapPtr->GetWidth();
-
-    return GetImportanceMap(distortion)->Pdf(valueIndex);
+    return GetImportanceMap(distortion)->Pdf(texelCoords.x, texelCoords.y);
 }
 
-const Math::Distribution* BitmapTexture::GetImportanceMap(const SampleDistortion distortion) const
+const Math::Distribution2D* BitmapTexture::GetImportanceMap(const SampleDistortion distortion) const
 {
     if (distortion == SampleDistortion::Uniform)
     {
@@ -206,24 +365,20 @@ const Math::Distribution* BitmapTexture::GetImportanceMap(const SampleDistortion
 
 const Vec4f BitmapTexture::Sample(const Vec3f u, Vec4f& outCoords, SampleDistortion distortion, float* outPdf) const
 {
-    const Math::Distribution* importanceMap = GetImportanceMap(distortion);
+    const Math::Distribution2D* importanceMap = GetImportanceMap(distortion);
     NFE_ASSERT(importanceMap, "Bitmap texture is not samplable");
 
+    // select pixel in constant time, then reuse remapped random variables for offset within the pixel
     float pdf = 0.0f;
-    const uint32 pixelIndex = importanceMap->SampleDiscrete(u.x, pdf);
-
-    const uint32 width = mBitmap->GetWidth();
-    const uint32 height = mBitmap->GetHeight();
-
-    // TODO get rid of division
-    const uint32 x = pixelIndex % width;
-    const uint32 y = pixelIndex / width;
-    NFE_ASSERT(x < width, "");
-    NFE_ASSERT(y < height, "");
+    uint32 x, y;
+    Vec2f pixelOffset;
+    importanceMap->SampleDiscrete(Vec2f(u.x, u.y), x, y, pdf, &pixelOffset);
+    NFE_ASSERT(x < GetSize().x, "");
+    NFE_ASSERT(y < GetSize().y, "");
 
     // TODO this is redundant, because BitmapTexture::Evaluate multiplies coords by size again...
     // TODO bilinar sampling?
-    outCoords = (Vec4f::FromIntegers(x, y, 0, 0) + Vec4f(u.y, u.z)) / mBitmap->mFloatSize;
+    outCoords = (Vec4f::FromIntegers(x, y, 0, 0) + Vec4f(pixelOffset.x, pixelOffset.y)) / GetFloatSize();
 
     if (outPdf)
     {
@@ -235,61 +390,42 @@ const Vec4f BitmapTexture::Sample(const Vec3f u, Vec4f& outCoords, SampleDistort
 
 bool BitmapTexture::MakeSamplable(SampleDistortion distortion)
 {
-    const Math::Distribution* importanceMap = GetImportanceMap(distortion);
+    const Math::Distribution2D* importanceMap = GetImportanceMap(distortion);
     if (importanceMap)
     {
         return true;
     }
 
-    if (!mBitmap)
+    if (!mBitmap && !mTiledBitmap)
     {
         NFE_LOG_ERROR("BitmapTexture: Failed to build importance map, because bitmap is invalid");
         return false;
     }
 
-    NFE_LOG_INFO("BitmapTexture: Generating importance map for bitmap '%s'...", mBitmap->GetDebugName());
-
-    const uint32 width = mBitmap->GetWidth();
-    const uint32 height = mBitmap->GetHeight();
+    NFE_LOG_INFO("BitmapTexture: Generating importance map for bitmap '%s'...", GetName());
 
     DynArray<float> importancePdf;
-    importancePdf.Resize(width * height);
 
-    Waitable waitable;
+    if (mTiledBitmap)
     {
-        TaskBuilder taskBuilder(waitable);
-        taskBuilder.ParallelFor("BitmapTexture/MakeSamplable", height, [&](const TaskContext&, uint32 j)
-        {
-            float rowWeight = 1.0f;
-
-            if (distortion == SampleDistortion::Spherical)
-            {
-                rowWeight = sinf(((float)j + 0.5f) * NFE_MATH_PI / (float)height);
-            }
-
-            for (uint32 i = 0; i < width; ++i)
-            {
-                const Vec4f value = mBitmap->GetPixel(i, j);
-
-                NFE_ASSERT(value.IsValid(), "Invalid value in texture. X=%u, Y=%u", i, j);
-
-                importancePdf[width * j + i] = Max(0.0f, rowWeight * Vec4f::Dot3(c_rgbIntensityWeights, value));
-            }
-        });
+        BuildImportancePdf(*mTiledBitmap, distortion, importancePdf);
+    }
+    else
+    {
+        BuildImportancePdf(*mBitmap, distortion, importancePdf);
     }
-    waitable.Wait();
 
     bool result = false;
 
     if (distortion == SampleDistortion::Uniform)
     {
-        mImportanceMap[0] = MakeUniquePtr<Math::Distribution>();
-        result =  mImportanceMap[0]->Initialize(importancePdf.Data(), importancePdf.Size());
+        mImportanceMap[0] = MakeUniquePtr<Math::Distribution2D>();
+        result = mImportanceMap[0]->Initialize(importancePdf.Data(), GetSize().x, GetSize().y);
     }
     else if (distortion == SampleDistortion::Spherical)
     {
-        mImportanceMap[1] = MakeUniquePtr<Math::Distribution>();
-        result = mImportanceMap[1]->Initialize(importancePdf.Data(), importancePdf.Size());
+        mImportanceMap[1] = MakeUniquePtr<Math::Distribution2D>();
+        result = mImportanceMap[1]->Initialize(importancePdf.Data(), GetSize().x, GetSize().y);
     }
     else
     {
@@ -299,6 +435,88 @@ bool BitmapTexture::MakeSamplable(SampleDistortion distortion)
     return result;
 }
 
+template<typename BitmapType>
+void BitmapTexture::BuildImportancePdf(const BitmapType& bitmap, SampleDistortion distortion, DynArray<float>& outPdf) const
+{
+    const uint32 width = bitmap.GetWidth();
+    const uint32 height = bitmap.GetHeight();
+
+    outPdf.Resize(width * height);
+
+    const auto getRowWeight = [distortion, height](uint32 j)
+    {
+        float rowWeight = 1.0f;
+
+        if (distortion == SampleDistortion::Spherical)
+        {
+            rowWeight = sinf(((float)j + 0.5f) * NFE_MATH_PI / (float)height);
+        }
+
+        return rowWeight;
+    };
+
+    Waitable waitable;
+    {
+        TaskBuilder taskBuilder(waitable);
+
+        bool decodeBlocks = false;
+        if constexpr (std::is_same_v<BitmapType, Bitmap>)
+        {
+            decodeBlocks = Bitmap::IsBlockCompressed(bitmap.GetFormat()) && (width % 4u == 0) && (height % 4u == 0);
+        }
+
+        if (decodeBlocks)
+        {
+            // decode whole 4x4 blocks at once, instead of decoding block palette for every texel
+            taskBuilder.ParallelFor("BitmapTexture/MakeSamplable", height / 4u, [&](const TaskContext&, uint32 blockY)
+            {
+                Vec4f values[16];
+
+                for (uint32 blockX = 0; blockX < width / 4u; ++blockX)
+                {
+                    if constexpr (std::is_same_v<BitmapType, Bitmap>)
+                    {
+                        bitmap.GetCompressedBlock(blockX, blockY, values);
+                    }
+
+                    for (uint32 y = 0; y < 4u; ++y)
+                    {
+                        const uint32 j = 4u * blockY + y;
+                        const float rowWeight = getRowWeight(j);
+
+                        for (uint32 x = 0; x < 4u; ++x)
+                        {
+                            const uint32 i = 4u * blockX + x;
+                            const Vec4f& value = values[4u * y + x];
+
+                            NFE_ASSERT(value.IsValid(), "Invalid value in texture. X=%u, Y=%u", i, j);
+
+                            outPdf[width * j + i] = Max(0.0f, rowWeight * Vec4f::Dot3(c_rgbIntensityWeights, value));
+                        }
+                    }
+                }
+            });
+        }
+        else
+        {
+            taskBuilder.ParallelFor("BitmapTexture/MakeSamplable", height, [&](const TaskContext&, uint32 j)
+            {
+                const float rowWeight = getRowWeight(j);
+
+                for (uint32 i = 0; i < width; ++i)
+                {
+                    const Vec4f value = bitmap.GetPixel(i, j);
+
+                    NFE_ASSERT(value.IsValid(), "Invalid value in texture. X=%u, Y=%u", i, j);
+
+                    outPdf[width * j + i] = Max(0.0f, rowWeight * Vec4f::Dot3(c_rgbIntensityWeights, value));
+                }
+            });
+        }
+    }
+    waitable.Wait();
+}
+
 bool BitmapTexture::IsSamplable(SampleDistortion distortion) const
 {
     return GetImportanceMap(distortion) != nullptr;
@@ -3,6 +3,8 @@
 #include "Texture.h"
 #include "../../Common/Containers/UniquePtr.hpp"
 #include "../../Common/Containers/SharedPtr.hpp"
+#include "../../Common/Containers/DynArray.hpp"
+#include "../../Common/Containers/String.hpp"
 #include "../../Common/Math/Vec4f.hpp"
 #include "../../Common/Reflection/ReflectionEnumMacros.hpp"
 
@@ -10,7 +12,9 @@ namespace NFE {
 namespace RT {
 
 class Bitmap;
+class TiledBitmap;
 using BitmapPtr = Common::SharedPtr<Bitmap>;
+using TiledBitmapPtr = Common::SharedPtr<TiledBitmap>;
 
 enum class BitmapTextureFilter : uint8
 {
@@ -21,6 +25,7 @@ enum class BitmapTextureFilter : uint8
 };
 
 // texture wrapper for Bitmap class
+// can be also backed by TiledBitmap, which streams texels through the global TextureCache
 class BitmapTexture : public ITexture
 {
     NFE_DECLARE_POLYMORPHIC_CLASS(BitmapTexture)
@@ -28,25 +33,51 @@ class BitmapTexture : public ITexture
 public:
     NFE_RAYTRACER_API BitmapTexture();
     NFE_RAYTRACER_API BitmapTexture(const BitmapPtr& bitmap);
+    NFE_RAYTRACER_API BitmapTexture(const TiledBitmapPtr& tiledBitmap);
     ~BitmapTexture();
 
     virtual const char* GetName() const override;
     virtual const Math::Vec4f Evaluate(const Math::Vec4f& coords) const override;
+    virtual const Math::Vec3x8f Evaluate(const Math::Vec2x8f& coords) const override;
     virtual const Math::Vec4f Sample(const Math::Vec3f u, Math::Vec4f& outCoords, SampleDistortion distortion, float* outPdf) const override;
     virtual float Pdf(SampleDistortion distortion, const Math::Vec4f& coords) const override;
 
     virtual bool MakeSamplable(SampleDistortion distortion) override;
     virtual bool IsSamplable(SampleDistortion distortion) const override;
 
+    // source file of the bitmap (bitmaps loaded from files are named after the file path)
+    // used to restore the bitmap when the texture is deserialized, as the texels are not serialized
+    NFE_FORCE_INLINE const Common::String& GetPath() const { return mPath; }
+    NFE_FORCE_INLINE bool IsStreamed() const { return mStreamed; }
+
+    NFE_RAYTRACER_API void SetBitmap(const BitmapPtr& bitmap);
+    NFE_RAYTRACER_API void SetBitmap(const TiledBitmapPtr& tiledBitmap);
+
 private:
-    const Math::Distribution* GetImportanceMap(const SampleDistortion distortion) const;
+    const Math::Distribution2D* GetImportanceMap(const SampleDistortion distortion) const;
+
+    const Math::Vec4ui GetSize() const;
+    const Math::Vec4f GetFloatSize() const;
+
+    template<typename BitmapType>
+    const Math::Vec4f Evaluate_Internal(const BitmapType& bitmap, const Math::Vec4f& coords) const;
+
+    template<typename BitmapType>
+    const Math::Vec3x8f Evaluate_Internal(const BitmapType& bitmap, const Math::Vec2x8f& coords) const;
+
+    template<typename BitmapType>
+    void BuildImportancePdf(const BitmapType& bitmap, SampleDistortion distortion, Common::DynArray<float>& outPdf) const;
 
     BitmapPtr mBitmap;
-    Common::UniquePtr<Math::Distribution> mImportanceMap[2];
+    TiledBitmapPtr mTiledBitmap;
+    Common::UniquePtr<Math::Distribution2D> mImportanceMap[2];
 
     BitmapTextureFilter mFilter;
     uint8 mBicubicB;
     uint8 mBicubicC;
+
+    Common::String mPath;
+    bool mStreamed;
 };
 
 } // namespace RT
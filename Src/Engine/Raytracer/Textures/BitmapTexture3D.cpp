@@ -15,41 +15,77 @@ namespace RT {
 using namespace Common;
 using namespace Math;
 
-BitmapTexture3D::BitmapTexture3D() = default;
+BitmapTexture3D::BitmapTexture3D()
+    : mCoordsScale(0.5f / 1.25f, 0.5f / 0.85f, 0.5f / 1.53f)
+    , mCoordsOffset(0.5f, 0.5f, 0.5f)
+    , mFilter(BitmapTextureFilter::Linear)
+{}
+
 BitmapTexture3D::~BitmapTexture3D() = default;
 
 BitmapTexture3D::BitmapTexture3D(const BitmapPtr& bitmap)
-    : mBitmap(bitmap)
-    , mFilter(BitmapTextureFilter::Linear)
-{}
+    : BitmapTexture3D()
+{
+    mBitmap = bitmap;
+
+    if (mBitmap && mBitmap->GetDepth() > 0)
+    {
+        mMajorantGrid.Build(*mBitmap, mCoordsScale, mCoordsOffset);
+    }
+}
+
+BitmapTexture3D::BitmapTexture3D(const SparseBitmap3DPtr& bitmap)
+    : BitmapTexture3D()
+{
+    mSparseBitmap = bitmap;
+
+    if (mSparseBitmap && mSparseBitmap->GetDepth() > 0)
+    {
+        mMajorantGrid.Build(*mSparseBitmap, mCoordsScale, mCoordsOffset);
+    }
+}
 
 const char* BitmapTexture3D::GetName() const
 {
-    if (!mBitmap)
+    if (mSparseBitmap)
     {
-        return "<none>";
+        return mSparseBitmap->GetDebugName();
     }
 
-    return mBitmap->GetDebugName();
+    if (mBitmap)
+    {
+        return mBitmap->GetDebugName();
+    }
+
+    return "<none>";
 }
 
 const Vec4f BitmapTexture3D::Evaluate(const Vec4f& coords) const
 {
-    const Bitmap* bitmapPtr = mBitmap.Get();
+    if (const SparseBitmap3D* sparseBitmapPtr = mSparseBitmap.Get())
+    {
+        return Evaluate_Internal(*sparseBitmapPtr, coords);
+    }
 
-    if (!bitmapPtr)
+    if (const Bitmap* bitmapPtr = mBitmap.Get())
     {
-        return Vec4f::Zero();
+        return Evaluate_Internal(*bitmapPtr, coords);
     }
 
+    return Vec4f::Zero();
+}
+
+template<typename BitmapType>
+const Vec4f BitmapTexture3D::Evaluate_Internal(const BitmapType& bitmap, const Vec4f& coords) const
+{
     // bitmap size
-    const Vec4i size(bitmapPtr->GetSize());
+    const Vec4i size(bitmap.GetSize());
 
     // wrap to 0..1 range
-    const Vec4f warpedCoords = Vec4f::Mod1(coords * Vec4f(0.5f/1.25f, 0.5f/0.85f, 0.5f/1.53f) + Vec4f(0.5f, 0.5f, 0.5f));
+    const Vec4f warpedCoords = Vec4f::Mod1(Vec4f::MulAndAdd(coords, mCoordsScale, mCoordsOffset));
 
     // compute texel coordinates
-    const Vec4f scaledCoords = warpedCoords * bitmapPtr->mFloatSize;
+    const Vec4f scaledCoords = warpedCoords * bitmap.GetFloatSize();
     const Vec4i intCoords = Vec4i::TruncateAndConvert(scaledCoords);
 
     Vec4i texelCoords = intCoords;
@@ -60,7 +96,7 @@ const Vec4f BitmapTexture3D::Evaluate(const Vec4f& coords) const
 
     if (mFilter == BitmapTextureFilter::NearestNeighbor)
     {
-        result = bitmapPtr->GetPixel3D(texelCoords.x, texelCoords.y, texelCoords.z);
+        result = bitmap.GetPixel3D(texelCoords.x, texelCoords.y, texelCoords.z);
     }
     else if (mFilter == BitmapTextureFilter::Linear)
     {
@@ -70,7 +106,7 @@ const Vec4f BitmapTexture3D::Evaluate(const Vec4f& coords) const
         secondTexelCoords -= Vec4i::AndNot(secondTexelCoords < size, size);
 
         Vec4f colors[8];
-        bitmapPtr->GetPixelBlock3D(Vec4ui(texelCoords), Vec4ui(secondTexelCoords), colors);
+        bitmap.GetPixelBlock3D(Vec4ui(texelCoords), Vec4ui(secondTexelCoords), colors);
 
         // trilinear interpolation
         {
@@ -98,6 +134,11 @@ const Vec4f BitmapTexture3D::Evaluate(const Vec4f& coords) const
     return result;
 }
 
+const MajorantGrid* BitmapTexture3D::GetMajorantGrid() const
+{
+    return mMajorantGrid.IsEmpty() ? nullptr : &mMajorantGrid;
+}
+
 const Vec4f BitmapTexture3D::Sample(const Vec3f u, Vec4f& outCoords, SampleDistortion distortion, float* outPdf) const
 {
     // TODO
@@ -1,26 +1,37 @@
 #pragma once
 
 #include "BitmapTexture.h"
+#include "../Utils/MajorantGrid.h"
+#include "../Utils/SparseBitmap3D.h"
 
 namespace NFE {
 namespace RT {
 
-// 3D texture wrapper for Bitmap class
-class BitmapTexture3D : public ITexture
+// 3D texture wrapper for Bitmap and SparseBitmap3D classes
+class NFE_ALIGN(16) BitmapTexture3D : public ITexture
 {
     NFE_DECLARE_POLYMORPHIC_CLASS(BitmapTexture3D)
 
 public:
     NFE_RAYTRACER_API BitmapTexture3D();
     NFE_RAYTRACER_API BitmapTexture3D(const BitmapPtr& bitmap);
+    NFE_RAYTRACER_API BitmapTexture3D(const SparseBitmap3DPtr& bitmap);
     ~BitmapTexture3D();
 
     virtual const char* GetName() const override;
     virtual const Math::Vec4f Evaluate(const Math::Vec4f& coords) const override;
     virtual const Math::Vec4f Sample(const Math::Vec3f u, Math::Vec4f& outCoords, SampleDistortion distortion, float* outPdf) const override;
+    virtual const MajorantGrid* GetMajorantGrid() const override;
 
 private:
+    template<typename BitmapType>
+    const Math::Vec4f Evaluate_Internal(const BitmapType& bitmap, const Math::Vec4f& coords) const;
+
     BitmapPtr mBitmap;
+    SparseBitmap3DPtr mSparseBitmap;
+    MajorantGrid mMajorantGrid;
+    Math::Vec4f mCoordsScale;
+    Math::Vec4f mCoordsOffset;
     BitmapTextureFilter mFilter;
 };
 
@@ -44,6 +44,13 @@ bool CheckerboardTexture::OnPropertyChanged(const Common::StringView propertyNam
     return ITexture::OnPropertyChanged(propertyName);
 }
 
+void CheckerboardTexture::OnDeserialized()
+{
+    ITexture::OnDeserialized();
+
+    UpdatePdf();
+}
+
 const char* CheckerboardTexture::GetName() const
 {
     return "checkerboard";
@@ -71,7 +78,27 @@ const Vec4f CheckerboardTexture::Evaluate(const Vec4f& coords) const
 
     const VecBool4f conditionVec = warpedCoords > VECTOR_HALVES;
 
-    return (conditionVec.Get<0>() ^ conditionVec.Get<1>() ^ conditionVec.Get<2>()) ? mColorA.ToVec4f() : mColorB.ToVec4f();
+    // NOTE: only XY are used, the same as in the 8-wide version
+    return (conditionVec.Get<0>() ^ conditionVec.Get<1>()) ? mColorA.ToVec4f() : mColorB.ToVec4f();
+}
+
+const Vec3x8f CheckerboardTexture::Evaluate(const Vec2x8f& coords) const
+{
+    // wrap to 0..1 range
+    const Vec8f warpedX = coords.x - Vec8f::Floor(coords.x);
+    const Vec8f warpedY = coords.y - Vec8f::Floor(coords.y);
+
+    const VecBool8f condition = (warpedX > Vec8f(0.5f)) ^ (warpedY > Vec8f(0.5f));
+
+    const Vec4f colorA = mColorA.ToVec4f();
+    const Vec4f colorB = mColorB.ToVec4f();
+
+    return
+    {
+        Vec8f::Select(Vec8f(colorB.x), Vec8f(colorA.x), condition),
+        Vec8f::Select(Vec8f(colorB.y), Vec8f(colorA.y), condition),
+        Vec8f::Select(Vec8f(colorB.z), Vec8f(colorA.z), condition),
+    };
 }
 
 const Vec4f CheckerboardTexture::Sample(const Vec3f u, Vec4f& outCoords, SampleDistortion distortion, float* outPdf) const
@@ -17,9 +17,11 @@ public:
     NFE_RAYTRACER_API CheckerboardTexture(const Math::Vec4f& colorA, const Math::Vec4f& colorB);
 
     virtual bool OnPropertyChanged(const Common::StringView propertyName) override;
+    virtual void OnDeserialized() override;
 
     virtual const char* GetName() const override;
     virtual const Math::Vec4f Evaluate(const Math::Vec4f& coords) const override;
+    virtual const Math::Vec3x8f Evaluate(const Math::Vec2x8f& coords) const override;
     virtual const Math::Vec4f Sample(const Math::Vec3f u, Math::Vec4f& outCoords, SampleDistortion distortion, float* outPdf) const override;
 
 private:
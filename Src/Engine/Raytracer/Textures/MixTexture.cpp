@@ -17,6 +17,8 @@ namespace RT {
 
 using namespace Math;
 
+MixTexture::MixTexture() = default;
+
 MixTexture::MixTexture(const TexturePtr& textureA, const TexturePtr& textureB, const TexturePtr& textureMask)
     : mTextureA(textureA)
     , mTextureB(textureB)
@@ -10,6 +10,7 @@ class MixTexture : public ITexture
     NFE_DECLARE_POLYMORPHIC_CLASS(MixTexture)
 
 public:
+    NFE_RAYTRACER_API MixTexture();
     NFE_RAYTRACER_API MixTexture(const TexturePtr& textureA, const TexturePtr& textureB, const TexturePtr& textureMask);
 
     virtual const char* GetName() const override;
@@ -1,5 +1,6 @@
 #include "PCH.h"
 #include "NoiseTexture.h"
+#include "../Common/Math/Vec8i.hpp"
 #include "../Common/Reflection/ReflectionClassDefine.hpp"
 
 NFE_DEFINE_POLYMORPHIC_CLASS(NFE::RT::NoiseTexture)
@@ -48,6 +49,43 @@ NFE_FORCE_INLINE static float Gradient(const int32 hash, const float x, const fl
     return ((h & 1) ? -u : u) + ((h & 2) ? -2.0f * v : 2.0f * v); // and compute the dot product with (x,y).
 }
 
+// permutation table expanded to 32-bit entries, so it can be used with 8-wide gathers
+struct PermutationTable32
+{
+    int32 values[256];
+
+    PermutationTable32()
+    {
+        for (uint32 i = 0; i < 256; ++i)
+        {
+            values[i] = c_permutationTable[i];
+        }
+    }
+};
+
+static const PermutationTable32 c_permutationTable32;
+
+NFE_FORCE_INLINE static const Vec8i Hash(const Vec8i& i)
+{
+    const Vec8f result = Gather8(reinterpret_cast<const float*>(c_permutationTable32.values), i & Vec8i(0xFF));
+    return Vec8i::Cast(result);
+}
+
+NFE_FORCE_INLINE static const Vec8f Gradient(const Vec8i& hash, const Vec8f& x, const Vec8f& y)
+{
+    const Vec8i h = hash & Vec8i(0x3F);
+
+    // same as scalar version, but branchless
+    const VecBool8f swapUV = (h & Vec8i(0x3C)).ConvertToVec8f() != Vec8f::Zero();
+    const Vec8f u = Vec8f::Select(x, y, swapUV);
+    const Vec8f v = Vec8f::Select(y, x, swapUV);
+
+    // flip signs using low hash bits
+    const Vec8f signU = ((h & Vec8i(1)) << 31).AsVec8f();
+    const Vec8f signV = ((h & Vec8i(2)) << 30).AsVec8f();
+    return (u ^ signU) + ((2.0f * v) ^ signV);
+}
+
 } // namespace
 
 
@@ -163,6 +201,54 @@ float NoiseTexture::EvaluateInternal(const Math::Vec4f& coords) const
     return v;
 }
 
+const Vec8f NoiseTexture::EvaluateInternal(const Vec2x8f& coords) const
+{
+    // 8-wide version of the scalar EvaluateInternal
+
+    const float F2 = 0.366025403f;
+    const float G2 = 0.211324865f;
+
+    const Vec8f s = (coords.x + coords.y) * F2;
+    const Vec8f i = Vec8f::Floor(coords.x + s);
+    const Vec8f j = Vec8f::Floor(coords.y + s);
+
+    const Vec8f t = (i + j) * G2;
+    const Vec8f x0 = coords.x - (i - t);
+    const Vec8f y0 = coords.y - (j - t);
+
+    // offsets for second (middle) corner of simplex
+    const Vec8f i1 = Vec8f::Select(Vec8f::Zero(), Vec8f(1.0f), x0 > y0);
+    const Vec8f j1 = Vec8f(1.0f) - i1;
+
+    const Vec8f x1 = x0 - i1 + Vec8f(G2);
+    const Vec8f y1 = y0 - j1 + Vec8f(G2);
+    const Vec8f x2 = x0 + Vec8f(2.0f * G2 - 1.0f);
+    const Vec8f y2 = y0 + Vec8f(2.0f * G2 - 1.0f);
+
+    // hashed gradient indices of the three simplex corners
+    const Vec8i ii = Vec8i::Convert(i);
+    const Vec8i jj = Vec8i::Convert(j);
+    const Vec8i ii1 = Vec8i::Convert(i1);
+    const Vec8i jj1 = Vec8i::Convert(j1);
+    const Vec8i gi0 = utils::Hash(ii + utils::Hash(jj));
+    const Vec8i gi1 = utils::Hash(ii + ii1 + utils::Hash(jj + jj1));
+    const Vec8i gi2 = utils::Hash(ii + 1 + utils::Hash(jj + 1));
+
+    // contributions from the three corners
+    Vec8f t0 = Vec8f::Max(Vec8f::Zero(), Vec8f(0.5f) - x0 * x0 - y0 * y0);
+    Vec8f t1 = Vec8f::Max(Vec8f::Zero(), Vec8f(0.5f) - x1 * x1 - y1 * y1);
+    Vec8f t2 = Vec8f::Max(Vec8f::Zero(), Vec8f(0.5f) - x2 * x2 - y2 * y2);
+    t0 *= t0;
+    t1 *= t1;
+    t2 *= t2;
+    const Vec8f n0 = t0 * t0 * utils::Gradient(gi0, x0, y0);
+    const Vec8f n1 = t1 * t1 * utils::Gradient(gi1, x1, y1);
+    const Vec8f n2 = t2 * t2 * utils::Gradient(gi2, x2, y2);
+
+    const Vec8f v = Vec8f::MulAndAdd(n0 + n1 + n2, 22.615325f, Vec8f(0.5f));
+    return v.Clamped(Vec8f::Zero(), Vec8f(1.0f));
+}
+
 const Vec4f NoiseTexture::Evaluate(const Vec4f& coords) const
 {
     float value = 0.0f;
@@ -179,6 +265,30 @@ const Vec4f NoiseTexture::Evaluate(const Vec4f& coords) const
     return Vec4f::Lerp(mColorA.ToVec4f(), mColorB.ToVec4f(), value);
 }
 
+const Vec3x8f NoiseTexture::Evaluate(const Vec2x8f& coords) const
+{
+    Vec8f value = Vec8f::Zero();
+
+    float octaveValueScale = 0.5f;
+    float octaveCoordScale = 1.0f;
+    for (uint32 i = 0; i < mNumOctaves; ++i)
+    {
+        value = Vec8f::MulAndAdd(EvaluateInternal(coords * octaveCoordScale), octaveValueScale, value);
+        octaveValueScale *= 0.5f;
+        octaveCoordScale *= 2.0f;
+    }
+
+    const Vec4f colorA = mColorA.ToVec4f();
+    const Vec4f colorB = mColorB.ToVec4f();
+
+    return
+    {
+        Vec8f::Lerp(Vec8f(colorA.x), Vec8f(colorB.x), value),
+        Vec8f::Lerp(Vec8f(colorA.y), Vec8f(colorB.y), value),
+        Vec8f::Lerp(Vec8f(colorA.z), Vec8f(colorB.z), value),
+    };
+}
+
 const Vec4f NoiseTexture::Sample(const Vec3f u, Vec4f& outCoords, SampleDistortion distortion, float* outPdf) const
 {
     NFE_UNUSED(distortion);
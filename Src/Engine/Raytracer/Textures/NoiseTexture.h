@@ -21,9 +21,11 @@ public:
 
     virtual const char* GetName() const override;
     virtual const Math::Vec4f Evaluate(const Math::Vec4f& coords) const override;
+    virtual const Math::Vec3x8f Evaluate(const Math::Vec2x8f& coords) const override;
     virtual const Math::Vec4f Sample(const Math::Vec3f u, Math::Vec4f& outCoords, SampleDistortion distortion, float* outPdf) const override;
 
     float EvaluateInternal(const Math::Vec4f& coords) const;
+    const Math::Vec8f EvaluateInternal(const Math::Vec2x8f& coords) const;
 
 private:
     Math::HdrColorRGBA mColorA;
@@ -46,6 +46,14 @@ bool NoiseTexture3D::OnPropertyChanged(const Common::StringView propertyName)
     return ITexture::OnPropertyChanged(propertyName);
 }
 
+void NoiseTexture3D::OnDeserialized()
+{
+    ITexture::OnDeserialized();
+
+    // 1/sum(1 / 2^n), n = 0 ... mNumOctaves-1
+    mScale = 1.0f / (2.0f - powf(2.0f, 1.0f - mNumOctaves));
+}
+
 const char* NoiseTexture3D::GetName() const
 {
     return "noise3d";
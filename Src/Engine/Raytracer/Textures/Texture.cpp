@@ -12,6 +12,25 @@ using namespace Math;
 
 ITexture::~ITexture() = default;
 
+const Vec3x8f ITexture::Evaluate(const Vec2x8f& coords) const
+{
+    Vec4f colors[8];
+    for (uint32 i = 0; i < 8; ++i)
+    {
+        colors[i] = Evaluate(Vec4f(coords.x[i], coords.y[i], 0.0f, 0.0f));
+    }
+
+    return Vec3x8f(colors[0], colors[1], colors[2], colors[3], colors[4], colors[5], colors[6], colors[7]);
+}
+
+const Vec3x16f ITexture::Evaluate(const Vec2x16f& coords) const
+{
+    const Vec3x8f low = Evaluate(Vec2x8f(coords.x.Low(), coords.y.Low()));
+    const Vec3x8f high = Evaluate(Vec2x8f(coords.x.High(), coords.y.High()));
+
+    return Vec3x16f(Vec16f(low.x, high.x), Vec16f(low.y, high.y), Vec16f(low.z, high.z));
+}
+
 bool ITexture::MakeSamplable(SampleDistortion distortion)
 {
     NFE_UNUSED(distortion);
@@ -24,6 +43,11 @@ bool ITexture::IsSamplable(SampleDistortion distortion) const
     return true;
 }
 
+const MajorantGrid* ITexture::GetMajorantGrid() const
+{
+    return nullptr;
+}
+
 float ITexture::Pdf(SampleDistortion distortion, const Math::Vec4f& coords) const
 {
     NFE_UNUSED(distortion);
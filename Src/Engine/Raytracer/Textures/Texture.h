@@ -2,6 +2,10 @@
 
 #include "../Raytracer.h"
 #include "../../Common/Math/Vec4f.hpp"
+#include "../../Common/Math/Vec2x8f.hpp"
+#include "../../Common/Math/Vec3x8f.hpp"
+#include "../../Common/Math/Vec2x16f.hpp"
+#include "../../Common/Math/Vec3x16f.hpp"
 #include "../../Common/Containers/SharedPtr.hpp"
 #include "../../Common/Memory/Aligned.hpp"
 #include "../../Common/Reflection/ReflectionClassDeclare.hpp"
@@ -9,6 +13,8 @@
 namespace NFE {
 namespace RT {
 
+class MajorantGrid;
+
 enum class SampleDistortion
 {
     Uniform,
@@ -33,6 +39,14 @@ public:
     // evaluate texture color at given coordinates
     virtual const Math::Vec4f Evaluate(const Math::Vec4f& coords) const = 0;
 
+    // evaluate texture color at 8 coordinates at once (alpha channel is dropped)
+    // NOTE: default implementation falls back to scalar Evaluate()
+    virtual const Math::Vec3x8f Evaluate(const Math::Vec2x8f& coords) const;
+
+    // evaluate texture color at 16 coordinates at once (alpha channel is dropped)
+    // NOTE: default implementation evaluates two 8-wide halves
+    virtual const Math::Vec3x16f Evaluate(const Math::Vec2x16f& coords) const;
+
     // get pdf of sampling given coordinates
     virtual float Pdf(SampleDistortion distortion, const Math::Vec4f& coords) const;
 
@@ -48,6 +62,10 @@ public:
 
     // check if the texture is samplable (if it's not, calling Sample is illegal)
     virtual bool IsSamplable(SampleDistortion distortion) const;
+
+    // get grid of local maximum values (used for tracking rays through heterogeneous media)
+    // NOTE: can return nullptr if the texture does not provide one
+    virtual const MajorantGrid* GetMajorantGrid() const;
 };
 
 using TexturePtr = Common::SharedPtr<ITexture>;
@@ -118,7 +118,7 @@ void ReorderRays(RenderingContext& context, uint32 numGroups, uint32 traversalDe
     }
 }
 
-uint32 TestRayPacket(RayPacket& packet, uint32 numGroups, const BVH::Node& node, RenderingContext& context, uint32 traversalDepth)
+uint32 TestRayPacket(RayPacket& packet, uint32 numGroups, const Box& nodeBox, RenderingContext& context, uint32 traversalDepth)
 {
     static_assert(8 * sizeof(RayPacketTypes::RayMaskType) >= RayPacketTypes::GroupSize, "Ray mask type is too small");
 
@@ -126,7 +126,7 @@ uint32 TestRayPacket(RayPacket& packet, uint32 numGroups, const BVH::Node& node,
 
     uint32 raysHit = 0;
 
-    const auto box = node.GetSimdBox<RayPacketTypes::Vec3f>();
+    const Math::SimdBox<RayPacketTypes::Vec3f> box(nodeBox);
 
     for (uint32 i = 0; i < numGroups; ++i)
     {
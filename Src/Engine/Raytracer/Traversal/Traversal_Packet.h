@@ -22,11 +22,12 @@ NFE_FORCE_NOINLINE uint32 RemoveMissedGroups(RenderingContext& context, uint32 n
 // reorder rays to restore coherency
 NFE_FORCE_NOINLINE void ReorderRays(RenderingContext& context, uint32 numRays, uint32 traversalDepth);
 
-// test all alive groups in a packet agains a BVH node
-NFE_FORCE_NOINLINE uint32 TestRayPacket(RayPacket& packet, uint32 numGroups, const BVH::Node& node, RenderingContext& context, uint32 traversalDepth);
+// test all alive groups in a packet agains a BVH node bounds
+NFE_FORCE_NOINLINE uint32 TestRayPacket(RayPacket& packet, uint32 numGroups, const Math::Box& nodeBox, RenderingContext& context, uint32 traversalDepth);
 
-template <typename ObjectType, uint32 traversalDepth>
-NFE_FORCE_NOINLINE void GenericTraverse(const PacketTraversalContext& context, const uint32 objectID, const ObjectType* object, uint32 numActiveGroups)
+// 'nodeBoxes' provides node bounds (see StaticNodeBoxes and MotionNodeBoxes)
+template <typename ObjectType, uint32 traversalDepth, typename NodeBoxes = StaticNodeBoxes>
+NFE_FORCE_NOINLINE void GenericTraverse(const PacketTraversalContext& context, const uint32 objectID, const ObjectType* object, uint32 numActiveGroups, const NodeBoxes& nodeBoxes = NodeBoxes())
 {
     // all nodes
     const BVH::Node* __restrict nodes = object->GetBVH().GetNodes();
@@ -59,7 +60,7 @@ NFE_FORCE_NOINLINE void GenericTraverse(const PacketTraversalContext& context, c
         const StackFrame& frame = stack[--stackSize];
 
         uint32 numGroups = frame.numActiveGroups;
-        uint32 raysHit = TestRayPacket(context.ray, numGroups, *frame.node, context.context, traversalDepth);
+        uint32 raysHit = TestRayPacket(context.ray, numGroups, nodeBoxes(*frame.node), context.context, traversalDepth);
 
 #ifdef NFE_ENABLE_INTERSECTION_COUNTERS
         context.context.localCounters.numRayBoxTests += RayPacketTypes::GroupSize * numGroups;
@@ -14,8 +14,9 @@ namespace NFE {
 namespace RT {
 
 // simple single-ray traversal
-template <typename ObjectType>
-void GenericTraverse(const SingleTraversalContext& context, const uint32 objectID, const ObjectType* object)
+// 'nodeBoxes' provides node bounds (see StaticNodeBoxes and MotionNodeBoxes)
+template <typename ObjectType, typename NodeBoxes = StaticNodeBoxes>
+void GenericTraverse(const SingleTraversalContext& context, const uint32 objectID, const ObjectType* object, const NodeBoxes& nodeBoxes = NodeBoxes())
 {
     float distanceA, distanceB;
 
@@ -44,12 +45,12 @@ void GenericTraverse(const SingleTraversalContext& context, const uint32 objectI
             const BVH::Node* __restrict childA = nodes + currentNode->childIndex;
             const BVH::Node* __restrict childB = childA + 1;
 
-            bool hitA = Intersect_BoxRay(context.ray, childA->GetBox(), distanceA);
+            bool hitA = Intersect_BoxRay(context.ray, nodeBoxes(*childA), distanceA);
 
             // prefetch grand-children
             NFE_PREFETCH_L1(nodes + childA->childIndex);
 
-            bool hitB = Intersect_BoxRay(context.ray, childB->GetBox(), distanceB);
+            bool hitB = Intersect_BoxRay(context.ray, nodeBoxes(*childB), distanceB);
 
             // Note: according to Intel manuals, prefetch instructions should not be grouped together
             NFE_PREFETCH_L1(nodes + childB->childIndex);
@@ -97,8 +98,8 @@ void GenericTraverse(const SingleTraversalContext& context, const uint32 objectI
     }
 }
 
-template <typename ObjectType>
-bool GenericTraverse_Shadow(const SingleTraversalContext& context, const uint32 objectID, const ObjectType* object)
+template <typename ObjectType, typename NodeBoxes = StaticNodeBoxes>
+bool GenericTraverse_Shadow(const SingleTraversalContext& context, const uint32 objectID, const ObjectType* object, const NodeBoxes& nodeBoxes = NodeBoxes())
 {
     float distanceA, distanceB;
 
@@ -133,12 +134,12 @@ bool GenericTraverse_Shadow(const SingleTraversalContext& context, const uint32
             // prefetch grand-children
             NFE_PREFETCH_L1(nodes + childA->childIndex);
 
-            bool hitA = Intersect_BoxRay(context.ray, childA->GetBox(), distanceA);
+            bool hitA = Intersect_BoxRay(context.ray, nodeBoxes(*childA), distanceA);
 
             // Note: according to Intel manuals, prefetch instructions should not be grouped together
             NFE_PREFETCH_L1(nodes + childB->childIndex);
 
-            bool hitB = Intersect_BoxRay(context.ray, childB->GetBox(), distanceB);
+            bool hitB = Intersect_BoxRay(context.ray, nodeBoxes(*childB), distanceB);
 
             // box occlusion
             hitA &= (distanceA < context.hitPoint.distance);
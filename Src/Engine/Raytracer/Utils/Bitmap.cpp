@@ -5,6 +5,12 @@
 #include "../Common/Math/PackedLoadVec4f.hpp"
 #include "../Common/Logger/Logger.hpp"
 #include "../Common/System/Timer.hpp"
+#include "../Common/Containers/String.hpp"
+#include "../Common/FileSystem/FileSystem.hpp"
+#include "../Common/System/Thread.hpp"
+#include "../Common/Utils/TaskBuilder.hpp"
+#include "../Common/Utils/Waitable.hpp"
+
 
 namespace NFE {
 namespace RT {
@@ -93,6 +99,7 @@ const char* Bitmap::FormatToString(Format format)
     case Format::R16G16B16A16_Half:         return "R16G16B16A16_Half";
     case Format::R9G9B9E5_SharedExp:        return "R9G9B9E5_SharedExp";
     case Format::BC1:                       return "BC1";
+    case Format::BC1_sRGB:                  return "BC1_sRGB";
     case Format::BC4:                       return "BC4";
     case Format::BC5:                       return "BC5";
     }
@@ -124,6 +131,7 @@ Bitmap::Bitmap(const char* debugName)
     , mPalette(nullptr)
     , mPaletteSize(0)
     , mFormat(Format::Unknown)
+    , mUsesSystemAllocator(false)
 {
     NFE_ASSERT(debugName, "Invalid debug name");
     mDebugName = strdup(debugName);
@@ -185,14 +193,21 @@ void Bitmap::Release()
 {
     if (mData)
     {
-        NFE_FREE(mData);
+        if (mUsesSystemAllocator)
+        {
+            SystemAllocator::Free(mData);
+        }
+        else
+        {
+            NFE_FREE(mData);
+        }
         mData = nullptr;
     }
 
     if (mPalette)
     {
         NFE_FREE(mPalette);
-        mData = nullptr;
+        mPalette = nullptr;
     }
 
     mSize = Vec4ui::Zero();
@@ -219,7 +234,16 @@ bool Bitmap::Init(const InitData& initData)
     // align to cache line
     const uint32 marigin = NFE_CACHE_LINE_SIZE;
 
-    mData = (uint8*)NFE_MALLOC(dataSize + marigin, NFE_CACHE_LINE_SIZE);
+    // big bitmaps (e.g. textures) are allocated with system allocator, so they can use large pages
+    mUsesSystemAllocator = !initData.useDefaultAllocator;
+    if (mUsesSystemAllocator)
+    {
+        mData = (uint8*)SystemAllocator::Allocate(dataSize + marigin, NFE_CACHE_LINE_SIZE);
+    }
+    else
+    {
+        mData = (uint8*)NFE_MALLOC(dataSize + marigin, NFE_CACHE_LINE_SIZE);
+    }
 
     if (!mData)
     {
@@ -295,6 +319,106 @@ bool Bitmap::Copy(Bitmap& target, const Bitmap& source)
 }
 
 bool Bitmap::Load(const char* path)
+{
+    return LoadFile(path);
+}
+
+bool Bitmap::Load(const char* path, const LoadParams& params)
+{
+    if (params.blockCompress && Common::Thread::IsMainThread())
+    {
+        bool result = false;
+        Common::Waitable waitable;
+        {
+            Common::TaskBuilder taskBuilder(waitable);
+            result = Load_Internal(path, params, &taskBuilder);
+        }
+        waitable.Wait();
+        return result;
+    }
+
+    // waiting for tasks on a worker thread could deadlock, so everything is done on the calling thread
+    return Load_Internal(path, params, nullptr);
+}
+
+bool Bitmap::Load(const char* path, const LoadParams& params, Common::TaskBuilder& taskBuilder)
+{
+    return Load_Internal(path, params, &taskBuilder);
+}
+
+bool Bitmap::Load_Internal(const char* path, const LoadParams& params, Common::TaskBuilder* taskBuilder)
+{
+    if (!params.blockCompress)
+    {
+        return LoadFile(path);
+    }
+
+    Common::String cachePath(path);
+    cachePath += ".bc.dds";
+
+    if (params.useCache)
+    {
+        uint64 sourceTime = 0;
+        uint64 cacheTime = 0;
+        if (Common::FileSystem::GetModificationTime(Common::StringView(path), sourceTime) &&
+            Common::FileSystem::GetModificationTime(cachePath, cacheTime) && cacheTime >= sourceTime)
+        {
+            if (LoadFile(cachePath.Str()))
+            {
+                return true;
+            }
+
+            NFE_LOG_WARNING("Bitmap: Failed to load cached compressed image '%s', rebuilding", cachePath.Str());
+        }
+    }
+
+    if (!LoadFile(path))
+    {
+        return false;
+    }
+
+    if (GetBlockCompressedFormat(mFormat) == Format::Unknown || GetDepth() > 1 || GetWidth() % 4 != 0 || GetHeight() % 4 != 0)
+    {
+        // keep uncompressed (e.g. HDR formats)
+        return true;
+    }
+
+    Timer timer;
+
+    if (!BlockCompress_Internal(taskBuilder))
+    {
+        return true;
+    }
+
+    // runs when the compressed data is in place
+    auto onCompressed = [this, sourcePath = Common::String(path), cachePath, timer, useCache = params.useCache]() mutable
+    {
+        const float elapsedTime = static_cast<float>(1000.0 * timer.Stop());
+        NFE_LOG_INFO("Bitmap '%s' compressed to %s in %.3fms", sourcePath.Str(), FormatToString(mFormat), elapsedTime);
+
+        if (useCache)
+        {
+            SaveDDS(cachePath.Str());
+        }
+    };
+
+    if (taskBuilder)
+    {
+        taskBuilder->Fence();
+        taskBuilder->Task("Bitmap/SaveCompressed", [onCompressed](const Common::TaskContext&) mutable
+        {
+            onCompressed();
+        });
+    }
+    else
+    {
+        onCompressed();
+    }
+
+    return true;
+}
+
+bool Bitmap::LoadFile(const char* path)
 {
     Timer timer;
 
@@ -985,37 +1109,29 @@ void Bitmap::GetPixelBlock(const Vec4ui coords, Vec4f* outColors) const
 
     case Format::BC1:
     {
-        color[0] = DecodeBC1(mData, coords.x, coords.y, GetWidth());
-        color[1] = DecodeBC1(mData, coords.z, coords.y, GetWidth());
-        color[2] = DecodeBC1(mData, coords.x, coords.w, GetWidth());
-        color[3] = DecodeBC1(mData, coords.z, coords.w, GetWidth());
+        DecodeBC1Quad(mData, coords, GetWidth(), color);
         break;
     }
 
     case Format::BC1_sRGB:
     {
-        color[0] = Convert_sRGB_To_Linear(DecodeBC1(mData, coords.x, coords.y, GetWidth()));
-        color[1] = Convert_sRGB_To_Linear(DecodeBC1(mData, coords.z, coords.y, GetWidth()));
-        color[2] = Convert_sRGB_To_Linear(DecodeBC1(mData, coords.x, coords.w, GetWidth()));
-        color[3] = Convert_sRGB_To_Linear(DecodeBC1(mData, coords.z, coords.w, GetWidth()));
+        DecodeBC1Quad(mData, coords, GetWidth(), color);
+        color[0] = Convert_sRGB_To_Linear(color[0]);
+        color[1] = Convert_sRGB_To_Linear(color[1]);
+        color[2] = Convert_sRGB_To_Linear(color[2]);
+        color[3] = Convert_sRGB_To_Linear(color[3]);
         break;
     }
 
     case Format::BC4:
     {
-        color[0] = DecodeBC4(mData, coords.x, coords.y, GetWidth());
-        color[1] = DecodeBC4(mData, coords.z, coords.y, GetWidth());
-        color[2] = DecodeBC4(mData, coords.x, coords.w, GetWidth());
-        color[3] = DecodeBC4(mData, coords.z, coords.w, GetWidth());
+        DecodeBC4Quad(mData, coords, GetWidth(), color);
         break;
     }
 
     case Format::BC5:
     {
-        color[0] = DecodeBC5(mData, coords.x, coords.y, GetWidth());
-        color[1] = DecodeBC5(mData, coords.z, coords.y, GetWidth());
-        color[2] = DecodeBC5(mData, coords.x, coords.w, GetWidth());
-        color[3] = DecodeBC5(mData, coords.z, coords.w, GetWidth());
+        DecodeBC5Quad(mData, coords, GetWidth(), color);
         break;
     }
 
@@ -1085,27 +1201,28 @@ void Bitmap::GetPixelBlock3D(const Vec4ui coordsA, const Vec4ui coordsB, Vec4f*
     {
     case Format::R8_UNorm:
     {
-        color[0] = Vec4f::FromInteger(static_cast<uint32>(rowData0[coordsA.x]));
-        color[1] = Vec4f::FromInteger(static_cast<uint32>(rowData0[coordsB.x]));
-        color[2] = Vec4f::FromInteger(static_cast<uint32>(rowData1[coordsA.x]));
-        color[3] = Vec4f::FromInteger(static_cast<uint32>(rowData1[coordsB.x]));
-        color[4] = Vec4f::FromInteger(static_cast<uint32>(rowData2[coordsA.x]));
-        color[5] = Vec4f::FromInteger(static_cast<uint32>(rowData2[coordsB.x]));
-        color[6] = Vec4f::FromInteger(static_cast<uint32>(rowData3[coordsA.x]));
-        color[7] = Vec4f::FromInteger(static_cast<uint32>(rowData3[coordsB.x]));
+        const Vec4f scale(1.0f / 255.0f);
+        color[0] = Vec4f::FromInteger(static_cast<uint32>(rowData0[coordsA.x])) * scale;
+        color[1] = Vec4f::FromInteger(static_cast<uint32>(rowData0[coordsB.x])) * scale;
+        color[2] = Vec4f::FromInteger(static_cast<uint32>(rowData1[coordsA.x])) * scale;
+        color[3] = Vec4f::FromInteger(static_cast<uint32>(rowData1[coordsB.x])) * scale;
+        color[4] = Vec4f::FromInteger(static_cast<uint32>(rowData2[coordsA.x])) * scale;
+        color[5] = Vec4f::FromInteger(static_cast<uint32>(rowData2[coordsB.x])) * scale;
+        color[6] = Vec4f::FromInteger(static_cast<uint32>(rowData3[coordsA.x])) * scale;
+        color[7] = Vec4f::FromInteger(static_cast<uint32>(rowData3[coordsB.x])) * scale;
         break;
     }
     case Format::R16_UNorm:
     {
         const Vec4f scale(1.0f / 65535.0f);
-        color[0] = Vec4f::FromInteger(reinterpret_cast<const uint16*>(rowData0)[coordsA.x]);
-        color[1] = Vec4f::FromInteger(reinterpret_cast<const uint16*>(rowData0)[coordsB.x]);
-        color[2] = Vec4f::FromInteger(reinterpret_cast<const uint16*>(rowData1)[coordsA.x]);
-        color[3] = Vec4f::FromInteger(reinterpret_cast<const uint16*>(rowData1)[coordsB.x]);
-        color[4] = Vec4f::FromInteger(reinterpret_cast<const uint16*>(rowData2)[coordsA.x]);
-        color[5] = Vec4f::FromInteger(reinterpret_cast<const uint16*>(rowData2)[coordsB.x]);
-        color[6] = Vec4f::FromInteger(reinterpret_cast<const uint16*>(rowData3)[coordsA.x]);
-        color[7] = Vec4f::FromInteger(reinterpret_cast<const uint16*>(rowData3)[coordsB.x]);
+        color[0] = Vec4f::FromInteger(reinterpret_cast<const uint16*>(rowData0)[coordsA.x]) * scale;
+        color[1] = Vec4f::FromInteger(reinterpret_cast<const uint16*>(rowData0)[coordsB.x]) * scale;
+        color[2] = Vec4f::FromInteger(reinterpret_cast<const uint16*>(rowData1)[coordsA.x]) * scale;
+        color[3] = Vec4f::FromInteger(reinterpret_cast<const uint16*>(rowData1)[coordsB.x]) * scale;
+        color[4] = Vec4f::FromInteger(reinterpret_cast<const uint16*>(rowData2)[coordsA.x]) * scale;
+        color[5] = Vec4f::FromInteger(reinterpret_cast<const uint16*>(rowData2)[coordsB.x]) * scale;
+        color[6] = Vec4f::FromInteger(reinterpret_cast<const uint16*>(rowData3)[coordsA.x]) * scale;
+        color[7] = Vec4f::FromInteger(reinterpret_cast<const uint16*>(rowData3)[coordsB.x]) * scale;
         break;
     }
     case Format::R32_Float:
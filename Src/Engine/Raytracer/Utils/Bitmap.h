@@ -65,9 +65,18 @@ public:
         const void* data = nullptr;
         uint32 stride = 0;
         uint32 paletteSize = 0;
+        // don't allocate the data with SystemAllocator (i.e. never use large pages)
         bool useDefaultAllocator = false;
     };
 
+    struct LoadParams
+    {
+        // compress to BC1/BC4/BC5 after loading (if the format allows)
+        bool blockCompress = false;
+        // store compressed bitmap next to the source file (with ".bc.dds" suffix) and reuse it when it's up to date
+        bool useCache = true;
+    };
+
     NFE_RAYTRACER_API Bitmap(const char* debugName = "<unnamed>");
     NFE_RAYTRACER_API ~Bitmap();
     NFE_RAYTRACER_API Bitmap(Bitmap&&);
@@ -113,6 +122,7 @@ public:
 
 
     NFE_FORCE_INLINE const Math::Vec4ui& GetSize() const { return mSize; }
+    NFE_FORCE_INLINE const Math::Vec4f& GetFloatSize() const { return mFloatSize; }
     NFE_FORCE_INLINE uint32 GetWidth() const { return mSize.x; }
     NFE_FORCE_INLINE uint32 GetHeight() const { return mSize.y; }
     NFE_FORCE_INLINE uint32 GetDepth() const { return mSize.z; }
@@ -140,10 +150,19 @@ public:
 
     // load from file
     NFE_RAYTRACER_API bool Load(const char* path);
+    NFE_RAYTRACER_API bool Load(const char* path, const LoadParams& params);
+
+    // load from file, block compression (if requested) is pushed as parallel tasks to the task builder
+    // NOTE: the bitmap must be kept alive and must not be accessed until the pushed tasks finish
+    NFE_RAYTRACER_API bool Load(const char* path, const LoadParams& params, Common::TaskBuilder& taskBuilder);
 
     // save to BMP file
     NFE_RAYTRACER_API bool SaveBMP(const char* path, bool flipVertically) const;
 
+    // save to DDS file
+    // NOTE: must be block compressed format
+    NFE_RAYTRACER_API bool SaveDDS(const char* path) const;
+
     // save to OpenEXR file
     // NOTE: must be float or Half format
     NFE_RAYTRACER_API bool SaveEXR(const char* path, const float exposure = 1.0f) const;
@@ -164,23 +183,49 @@ public:
     // get 2x2x2 pixel block
     NFE_RAYTRACER_API void GetPixelBlock3D(const Math::Vec4ui coordsA, const Math::Vec4ui coordsB, Math::Vec4f* outColors) const;
 
+    // decode all 16 pixels of a 4x4 block (in row-major order)
+    // NOTE: the bitmap must be in block compressed format
+    NFE_RAYTRACER_API void GetCompressedBlock(uint32 blockX, uint32 blockY, Math::Vec4f* outColors) const;
+
     // fill with zeros
     NFE_RAYTRACER_API void Clear();
 
     // scale pixels by a given value
     NFE_RAYTRACER_API bool Scale(const Math::Vec4f& factor);
+
+    // convert to block compressed format (BC1 for opaque color, BC4 for single channel, BC5 for two channels)
+    // NOTE: width and height must be multiply of 4
+    NFE_RAYTRACER_API bool BlockCompress();
+
+    // same as above, but the compression is pushed as parallel tasks to the task builder
+    // (e.g. as subtasks of the calling task) and the data is replaced by a continuation task
+    // NOTE: the bitmap must be kept alive and must not be accessed until the pushed tasks finish
+    NFE_RAYTRACER_API bool BlockCompress(Common::TaskBuilder& taskBuilder);
+
+    // get block compressed format matching given uncompressed format (Unknown if not supported)
+    static Format GetBlockCompressedFormat(Format format);
+
+    // check if the format is one of BCn formats
+    NFE_RAYTRACER_API static bool IsBlockCompressed(Format format);
     
 private:
 
     friend class BitmapTexture;
     friend class BitmapTexture3D;
     friend class BitmapUtils;
+    friend class TiledBitmap;
 
     bool LoadBMP(FILE* file, const char* path);
     bool LoadDDS(FILE* file, const char* path);
     bool LoadEXR(FILE* file, const char* path);
     bool LoadVDB(FILE* file, const char* path);
 
+    bool LoadFile(const char* path);
+
+    // when the task builder is not provided, everything is done on the calling thread
+    bool Load_Internal(const char* path, const LoadParams& params, Common::TaskBuilder* taskBuilder);
+    bool BlockCompress_Internal(Common::TaskBuilder* taskBuilder);
+
     Math::Vec4ui mSize = Math::Vec4ui::Zero(); // width, height, depth, stride
     Math::Vec4f mFloatSize = Math::Vec4f::Zero();
     char* mDebugName;
@@ -188,6 +233,7 @@ private:
     uint8* mPalette;
     uint32 mPaletteSize;    // number of colors in the palette
     Format mFormat;
+    bool mUsesSystemAllocator;  // data allocated with SystemAllocator (see InitData::useDefaultAllocator)
 };
 
 using BitmapPtr = Common::SharedPtr<Bitmap>;
@@ -227,56 +227,60 @@ typedef enum DXGI_FORMAT
 
 using namespace Math;
 
-bool Bitmap::LoadDDS(FILE* file, const char* path)
+namespace {
+
+struct DDS_PIXELFORMAT
 {
-    struct DDS_PIXELFORMAT
-    {
-        uint32 size;
-        uint32 flags;
-        uint32 fourCC;
-        uint32 rgbBitCount;
-        uint32 rBitMask;
-        uint32 gBitMask;
-        uint32 bBitMask;
-        uint32 aBitMask;
-    };
-
-    struct Header
-    {
-        uint32 magic;
-        uint32 size;
-        uint32 flags;
-        uint32 height;
-        uint32 width;
-        uint32 pitchOrLinearSize;
-        uint32 depth;
-        uint32 mipMapCount;
-        uint32 reserved1[11];
-
-        //  DDPIXELFORMAT
-        DDS_PIXELFORMAT pixelFormat;
-
-        //  DDCAPS2
-        struct
-        {
-            uint32 caps1;
-            uint32 caps2;
-            uint32 DDSX;
-            uint32 reserved;
-        } sCaps;
+    uint32 size;
+    uint32 flags;
+    uint32 fourCC;
+    uint32 rgbBitCount;
+    uint32 rBitMask;
+    uint32 gBitMask;
+    uint32 bBitMask;
+    uint32 aBitMask;
+};
 
-        uint32 dwReserved2;
-    };
+struct Header
+{
+    uint32 magic;
+    uint32 size;
+    uint32 flags;
+    uint32 height;
+    uint32 width;
+    uint32 pitchOrLinearSize;
+    uint32 depth;
+    uint32 mipMapCount;
+    uint32 reserved1[11];
 
-    struct HeaderDX10
+    //  DDPIXELFORMAT
+    DDS_PIXELFORMAT pixelFormat;
+
+    //  DDCAPS2
+    struct
     {
-        uint32 dxgiFormat;
-        uint32 resourceDimension;
-        uint32 miscFlag;
-        uint32 arraySize;
-        uint32 miscFlags2;
-    };
+        uint32 caps1;
+        uint32 caps2;
+        uint32 DDSX;
+        uint32 reserved;
+    } sCaps;
+
+    uint32 dwReserved2;
+};
+
+struct HeaderDX10
+{
+    uint32 dxgiFormat;
+    uint32 resourceDimension;
+    uint32 miscFlag;
+    uint32 arraySize;
+    uint32 miscFlags2;
+};
+
+} // namespace
 
+bool Bitmap::LoadDDS(FILE* file, const char* path)
+{
     // read header
     Header header;
     if (fread(&header, sizeof(header), 1, file) != 1)
@@ -544,5 +548,75 @@ bool Bitmap::LoadDDS(FILE* file, const char* path)
     return true;
 }
 
+bool Bitmap::SaveDDS(const char* path) const
+{
+    DXGI_FORMAT dxgiFormat = DXGI_FORMAT_UNKNOWN;
+    switch (mFormat)
+    {
+    case Format::BC1:       dxgiFormat = DXGI_FORMAT_BC1_UNORM; break;
+    case Format::BC1_sRGB:  dxgiFormat = DXGI_FORMAT_BC1_UNORM_SRGB; break;
+    case Format::BC4:       dxgiFormat = DXGI_FORMAT_BC4_UNORM; break;
+    case Format::BC5:       dxgiFormat = DXGI_FORMAT_BC5_UNORM; break;
+    default:
+        NFE_LOG_ERROR("Bitmap::SaveDDS: Unsupported format: %s", FormatToString(mFormat));
+        return false;
+    }
+
+    if (GetDepth() > 1)
+    {
+        NFE_LOG_ERROR("Bitmap::SaveDDS: Cannot save 3D texture as DDS file");
+        return false;
+    }
+
+    const size_t dataSize = GetDataSize();
+
+    Header header;
+    memset(&header, 0, sizeof(header));
+    header.magic = DDS_MAGIC_NUMBER;
+    header.size = sizeof(Header) - sizeof(uint32);
+    header.flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_LINEARSIZE;
+    header.height = GetHeight();
+    header.width = GetWidth();
+    header.pitchOrLinearSize = static_cast<uint32>(dataSize);
+    header.depth = 1;
+    header.mipMapCount = 1;
+    header.pixelFormat.size = sizeof(DDS_PIXELFORMAT);
+    header.pixelFormat.flags = DDPF_FOURCC;
+    header.pixelFormat.fourCC = MAKEFOURCC('D', 'X', '1', '0');
+    header.sCaps.caps1 = 0x1000; // DDSCAPS_TEXTURE
+
+    HeaderDX10 headerDX10;
+    memset(&headerDX10, 0, sizeof(headerDX10));
+    headerDX10.dxgiFormat = dxgiFormat;
+    headerDX10.resourceDimension = 3; // D3D10_RESOURCE_DIMENSION_TEXTURE2D
+    headerDX10.arraySize = 1;
+
+    FILE* file = fopen(path, "wb");
+    if (!file)
+    {
+        NFE_LOG_ERROR("Failed to open target image '%s', errno = %u", path, errno);
+        return false;
+    }
+
+    if (fwrite(&header, sizeof(Header), 1, file) != 1 ||
+        fwrite(&headerDX10, sizeof(HeaderDX10), 1, file) != 1)
+    {
+        NFE_LOG_ERROR("Failed to write DDS header to file '%s', errno = %u", path, errno);
+        fclose(file);
+        return false;
+    }
+
+    if (fwrite(mData, dataSize, 1, file) != 1)
+    {
+        NFE_LOG_ERROR("Failed to write bitmap image data to file '%s', errno = %u", path, errno);
+        fclose(file);
+        return false;
+    }
+
+    NFE_LOG_INFO("Image file '%s' written successfully", path);
+    fclose(file);
+    return true;
+}
+
 } // namespace RT
 } // namespace NFE
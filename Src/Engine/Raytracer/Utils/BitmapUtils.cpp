@@ -2,6 +2,7 @@
 #include "BitmapUtils.h"
 #include "../Common/Logger/Logger.hpp"
 #include "../Common/Utils/TaskBuilder.hpp"
+#include "../Common/Math/Vec8f.hpp"
 
 
 
@@ -18,6 +19,22 @@ static void BoxBlur_Internal(T* __restrict targetLine, const T* __restrict srcLi
 {
     const float factor = 1.0f / (float)(2u * radius + 1u);
 
+    if (2u * radius + 1u > width)
+    {
+        // line shorter than the kernel, just clamp the coordinates
+        const int32 lastIndex = static_cast<int32>(width) - 1;
+        for (int32 j = 0; j <= lastIndex; ++j)
+        {
+            T val = srcLine[Clamp(j - static_cast<int32>(radius), 0, lastIndex)];
+            for (int32 k = j - static_cast<int32>(radius) + 1; k <= j + static_cast<int32>(radius); ++k)
+            {
+                val += srcLine[Clamp(k, 0, lastIndex)];
+            }
+            targetLine[j] = val * factor;
+        }
+        return;
+    }
+
     const T* __restrict srcLineBegin = srcLine;
     const T* __restrict srcLineEnd = srcLine;
 
@@ -49,16 +66,48 @@ static void BoxBlur_Internal(T* __restrict targetLine, const T* __restrict srcLi
     }
 }
 
+// compute radii of box filters approximating Gaussian filter
+// based on http://blog.ivank.net/fastest-gaussian-blur.html
+static void ComputeBoxBlurRadii(const BitmapUtils::GaussianBlurParams& params, uint32& outSmallRadius, uint32& outNumSmallBoxes)
+{
+    const float n = static_cast<float>(params.numPasses);
+    const float sigmaSqr = params.sigma * params.sigma;
+
+    const float wIdeal = sqrtf((12.0f * sigmaSqr / n) + 1.0f);
+    uint32 wl = Max(1u, (uint32)floorf(wIdeal));
+    if (wl % 2 == 0)
+    {
+        wl--;
+    }
+
+    const float wlf = static_cast<float>(wl);
+    const float mIdeal = (12.0f * sigmaSqr - n * wlf * wlf - 4.0f * n * wlf - 3.0f * n) / (-4.0f * wlf - 4.0f);
+
+    // box of width 'wl' has radius (wl-1)/2, other boxes are one pixel wider on each side
+    outSmallRadius = (wl - 1u) / 2u;
+    outNumSmallBoxes = static_cast<uint32>(Clamp(roundf(mIdeal), 0.0f, n));
+}
+
+uint32 BitmapUtils::GetGaussianBlurRadius(const GaussianBlurParams& params)
+{
+    uint32 smallRadius, numSmallBoxes;
+    ComputeBoxBlurRadii(params, smallRadius, numSmallBoxes);
+    return params.numPasses * (smallRadius + 1u) - numSmallBoxes;
+}
 
 // Note: should be inside GaussianBlur, but there's bug in MSCV compiler and the const is not captured as const in a lambda...
 static constexpr const uint32 MaxLineSize = 4096;
 static constexpr const uint32 NumColumnsPerTask = 16;
 
-using TempLineType = Vec4f[NumColumnsPerTask][MaxLineSize];
-static thread_local TempLineType gTempLineA;
-static thread_local TempLineType gTempLineB;
+// vertical blur processes pairs of columns at once
+using TempRowType = Vec4f[MaxLineSize];
+using TempColumnsType = Vec8f[NumColumnsPerTask / 2][MaxLineSize];
+static thread_local TempRowType gTempRowA;
+static thread_local TempRowType gTempRowB;
+static thread_local TempColumnsType gTempColumnsA;
+static thread_local TempColumnsType gTempColumnsB;
 
-bool BitmapUtils::GaussianBlur(Bitmap& targetBitmap, const Bitmap& sourceBitmap, const GaussianBlurParams params, Common::TaskBuilder& taskBuilder)
+bool BitmapUtils::GaussianBlur(Bitmap& targetBitmap, const Bitmap& sourceBitmap, Bitmap& tempBitmap, const GaussianBlurParams& params, Common::TaskBuilder& taskBuilder)
 {
     NFE_ASSERT(params.numPasses > 0, "");
 
@@ -75,103 +124,121 @@ bool BitmapUtils::GaussianBlur(Bitmap& targetBitmap, const Bitmap& sourceBitmap,
         return false;
     }
 
-    if (targetBitmap.mFormat != sourceBitmap.mFormat)
+    if (targetBitmap.mFormat != sourceBitmap.mFormat || targetBitmap.mFormat != tempBitmap.mFormat)
     {
-        NFE_LOG_ERROR("GaussianBlur: Source and target bitmap formats do not match");
+        NFE_LOG_ERROR("GaussianBlur: Source, target and temporary bitmap formats do not match");
         return false;
     }
 
-    if ((targetBitmap.GetWidth() != sourceBitmap.GetWidth()) || (targetBitmap.GetHeight() != sourceBitmap.GetHeight()))
+    if ((targetBitmap.GetWidth() != sourceBitmap.GetWidth()) || (targetBitmap.GetHeight() != sourceBitmap.GetHeight()) ||
+        (targetBitmap.GetWidth() != tempBitmap.GetWidth()) || (targetBitmap.GetHeight() != tempBitmap.GetHeight()))
     {
-        NFE_LOG_ERROR("GaussianBlur: Source and target bitmap dimensions do not match");
+        NFE_LOG_ERROR("GaussianBlur: Source, target and temporary bitmap dimensions do not match");
         return false;
     }
 
-    // based on http://blog.ivank.net/fastest-gaussian-blur.html
-
-    float wIdeal = sqrtf((12.0f * params.sigma * params.sigma / params.numPasses) + 1.0f);
-    uint32 wl = (uint32)floorf(wIdeal);
-    if (wl % 2 == 0)
-    {
-        wl--;
-    }
-
-    const uint32 wu = wl + 2;
-    const float mIdeal = (12.0f * params.sigma * params.sigma - params.numPasses * wl * wl - 4.0f * params.numPasses * wl - 3.0f * params.numPasses) / (-4.0f * wl - 4.0f);
-    const float m = roundf(mIdeal);
+    uint32 smallRadius, numSmallBoxes;
+    ComputeBoxBlurRadii(params, smallRadius, numSmallBoxes);
+    const uint32 numPasses = params.numPasses;
+    const uint32 totalRadius = GetGaussianBlurRadius(params);
 
     const uint32 width = targetBitmap.GetWidth();
     const uint32 height = targetBitmap.GetHeight();
 
-    // horizontal blur
-    taskBuilder.ParallelFor("BitmapUtils::GaussianBlur/Horizontal", height, [=, &sourceBitmap, &targetBitmap] (const TaskContext&, const uint32 y)
+    Region region = params.region;
+    if (region.maxX <= region.minX || region.maxY <= region.minY)
+    {
+        region = Region(0, width, 0, height);
+    }
+    region.maxX = Min(region.maxX, width);
+    region.maxY = Min(region.maxY, height);
+
+    // pixels within the blur radius from the region must be processed too, so the results inside the region are exact
+    const Region extendedRegion(
+        region.minX > totalRadius ? region.minX - totalRadius : 0u,
+        Min(region.maxX + totalRadius, width),
+        region.minY > totalRadius ? region.minY - totalRadius : 0u,
+        Min(region.maxY + totalRadius, height));
+
+    // horizontal blur (source -> temp)
+    // only columns from the region are written, but all the rows needed by vertical blur are processed
+    const uint32 numRows = extendedRegion.Height();
+    taskBuilder.ParallelFor("BitmapUtils::GaussianBlur/Horizontal", numRows, [=, &sourceBitmap, &tempBitmap] (const TaskContext&, const uint32 rowIndex)
     {
-        Vec4f* sourceLinePtr = gTempLineB[0];
-        Vec4f* targetLinePtr = gTempLineA[0];
+        const uint32 y = extendedRegion.minY + rowIndex;
+        const uint32 lineSize = extendedRegion.Width();
+
+        Vec4f* sourceLinePtr = gTempRowB;
+        Vec4f* targetLinePtr = gTempRowA;
 
-        const Vec3f* sourceRowPtr = &sourceBitmap.GetPixelRef<Vec3f>(0, y);
-        for (uint32 x = 0; x < width; ++x)
+        const Vec3f* sourceRowPtr = &sourceBitmap.GetPixelRef<Vec3f>(extendedRegion.minX, y);
+        for (uint32 x = 0; x < lineSize; ++x)
         {
-            sourceLinePtr[x] = Vec4f((float*)(sourceRowPtr + x));
+            sourceLinePtr[x] = Vec4f(sourceRowPtr[x]);
         }
 
-        for (uint32 i = 0; i < params.numPasses; ++i)
+        for (uint32 i = 0; i < numPasses; ++i)
         {
-            const uint32 radius = i < m ? wl : wu;
-            BoxBlur_Internal(targetLinePtr, sourceLinePtr, radius, width);
+            const uint32 radius = i < numSmallBoxes ? smallRadius : smallRadius + 1u;
+            BoxBlur_Internal(targetLinePtr, sourceLinePtr, radius, lineSize);
             std::swap(sourceLinePtr, targetLinePtr);
         }
 
-        Vec3f* targetRowPtr = &targetBitmap.GetPixelRef<Vec3f>(0, y);
-        for (uint32 x = 0; x < width; ++x)
+        Vec3f* targetRowPtr = &tempBitmap.GetPixelRef<Vec3f>(region.minX, y);
+        const Vec4f* resultPtr = sourceLinePtr + (region.minX - extendedRegion.minX);
+        for (uint32 x = 0; x < region.Width(); ++x)
         {
-            *(targetRowPtr + x) = sourceLinePtr[x].ToVec3f();
+            targetRowPtr[x] = resultPtr[x].ToVec3f();
         }
     });
 
     taskBuilder.Fence();
 
-    // vertical blur
-    const uint32 numTasksForVerticalBlur = (width + NumColumnsPerTask - 1) / NumColumnsPerTask;
-    taskBuilder.ParallelFor("BitmapUtils::GaussianBlur/Vertical", numTasksForVerticalBlur, [=, &targetBitmap] (const TaskContext&, const uint32 columnGroupIndex)
+    // vertical blur (temp -> target)
+    const uint32 numTasksForVerticalBlur = (region.Width() + NumColumnsPerTask - 1) / NumColumnsPerTask;
+    taskBuilder.ParallelFor("BitmapUtils::GaussianBlur/Vertical", numTasksForVerticalBlur, [=, &tempBitmap, &targetBitmap] (const TaskContext&, const uint32 columnGroupIndex)
     {
         // Note: in opossite to horizontal blur, vertical blur is done in batches of few columns to improve cache performance
+        // Pairs of columns are packed into 8-wide vectors
 
-        const uint32 numColumnsInTask = Min(width - columnGroupIndex * NumColumnsPerTask, NumColumnsPerTask);
+        const uint32 firstColumn = region.minX + columnGroupIndex * NumColumnsPerTask;
+        const uint32 numColumnsInTask = Min(region.maxX - firstColumn, NumColumnsPerTask);
+        const uint32 numColumnPairs = (numColumnsInTask + 1) / 2;
+        const uint32 lineSize = extendedRegion.Height();
 
-        Vec4f* sourceLinePtr = nullptr;
-        Vec4f* targetLinePtr = nullptr;
-
-        for (uint32 y = 0; y < height; ++y)
+        for (uint32 y = 0; y < lineSize; ++y)
         {
-            const Vec3f* pixels = &targetBitmap.GetPixelRef<Vec3f>(columnGroupIndex * NumColumnsPerTask, y);
-            for (uint32 i = 0; i < numColumnsInTask; ++i)
+            const Vec3f* pixels = &tempBitmap.GetPixelRef<Vec3f>(firstColumn, extendedRegion.minY + y);
+            for (uint32 i = 0; i < numColumnPairs; ++i)
             {
-                gTempLineA[i][y] = Vec4f(pixels[i]);
+                const uint32 secondColumn = Min(2u * i + 1u, numColumnsInTask - 1u);
+                gTempColumnsA[i][y] = Vec8f(Vec4f(pixels[2u * i]), Vec4f(pixels[secondColumn]));
             }
         }
 
-        for (uint32 i = 0; i < numColumnsInTask; ++i)
+        for (uint32 i = 0; i < numColumnPairs; ++i)
         {
-            sourceLinePtr = gTempLineA[i];
-            targetLinePtr = gTempLineB[i];
+            Vec8f* sourceLinePtr = gTempColumnsA[i];
+            Vec8f* targetLinePtr = gTempColumnsB[i];
 
-            for (uint32 j = 0; j < params.numPasses; ++j)
+            for (uint32 j = 0; j < numPasses; ++j)
             {
-                const uint32 radius = j < m ? wl : wu;
-                BoxBlur_Internal(targetLinePtr, sourceLinePtr, radius, height);
+                const uint32 radius = j < numSmallBoxes ? smallRadius : smallRadius + 1u;
+                BoxBlur_Internal(targetLinePtr, sourceLinePtr, radius, lineSize);
                 std::swap(sourceLinePtr, targetLinePtr);
             }
         }
 
-        const TempLineType& srcLine = params.numPasses % 2 == 0 ? gTempLineA : gTempLineB;
+        const TempColumnsType& srcLine = numPasses % 2 == 0 ? gTempColumnsA : gTempColumnsB;
 
-        for (uint32 y = 0; y < height; ++y)
+        for (uint32 y = region.minY; y < region.maxY; ++y)
         {
-            Vec3f* pixels = &targetBitmap.GetPixelRef<Vec3f>(columnGroupIndex * NumColumnsPerTask, y);
+            const uint32 lineIndex = y - extendedRegion.minY;
+            Vec3f* pixels = &targetBitmap.GetPixelRef<Vec3f>(firstColumn, y);
             for (uint32 i = 0; i < numColumnsInTask; ++i)
             {
-                pixels[i] = srcLine[i][y].ToVec3f();
+                const Vec8f& value = srcLine[i / 2u][lineIndex];
+                pixels[i] = (i % 2u == 0 ? value.Low() : value.High()).ToVec3f();
             }
         }
     });
@@ -179,5 +246,49 @@ bool BitmapUtils::GaussianBlur(Bitmap& targetBitmap, const Bitmap& sourceBitmap,
     return true;
 }
 
+bool BitmapUtils::Downsample(Bitmap& targetBitmap, const Bitmap& sourceBitmap, const Region& region, Common::TaskBuilder& taskBuilder)
+{
+    if (targetBitmap.mFormat != Bitmap::Format::R32G32B32_Float || sourceBitmap.mFormat != Bitmap::Format::R32G32B32_Float)
+    {
+        NFE_LOG_ERROR("Downsample: Unsupported texture format");
+        return false;
+    }
+
+    const uint32 sourceWidth = sourceBitmap.GetWidth();
+    const uint32 sourceHeight = sourceBitmap.GetHeight();
+
+    if (targetBitmap.GetWidth() != (sourceWidth + 1u) / 2u || targetBitmap.GetHeight() != (sourceHeight + 1u) / 2u)
+    {
+        NFE_LOG_ERROR("Downsample: Invalid target bitmap size");
+        return false;
+    }
+
+    Region targetRegion = region;
+    if (targetRegion.maxX <= targetRegion.minX || targetRegion.maxY <= targetRegion.minY)
+    {
+        targetRegion = Region(0, targetBitmap.GetWidth(), 0, targetBitmap.GetHeight());
+    }
+    targetRegion.maxX = Min(targetRegion.maxX, targetBitmap.GetWidth());
+    targetRegion.maxY = Min(targetRegion.maxY, targetBitmap.GetHeight());
+
+    taskBuilder.ParallelFor("BitmapUtils::Downsample", targetRegion.Height(), [=, &sourceBitmap, &targetBitmap](const TaskContext&, const uint32 rowIndex)
+    {
+        const uint32 y = targetRegion.minY + rowIndex;
+        const Vec3f* sourceRowA = &sourceBitmap.GetPixelRef<Vec3f>(0, 2u * y);
+        const Vec3f* sourceRowB = &sourceBitmap.GetPixelRef<Vec3f>(0, Min(2u * y + 1u, sourceHeight - 1u));
+        Vec3f* targetRow = &targetBitmap.GetPixelRef<Vec3f>(0, y);
+
+        for (uint32 x = targetRegion.minX; x < targetRegion.maxX; ++x)
+        {
+            const uint32 x0 = 2u * x;
+            const uint32 x1 = Min(x0 + 1u, sourceWidth - 1u);
+            const Vec4f sum = (Vec4f(sourceRowA[x0]) + Vec4f(sourceRowA[x1])) + (Vec4f(sourceRowB[x0]) + Vec4f(sourceRowB[x1]));
+            targetRow[x] = (sum * 0.25f).ToVec3f();
+        }
+    });
+
+    return true;
+}
+
 } // namespace RT
 } // namespace NFE
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Bitmap.h"
+#include "../../Common/Math/Rectangle.hpp"
 
 namespace NFE {
 namespace RT {
@@ -11,13 +12,28 @@ namespace RT {
 class BitmapUtils
 {
 public:
+    using Region = Math::Rectangle<uint32>;
+
     struct GaussianBlurParams
     {
         float sigma;
         uint32 numPasses;
+
+        // region of the target bitmap to update (empty region means whole bitmap)
+        Region region;
     };
 
-    static bool GaussianBlur(Bitmap& targetBitmap, const Bitmap& sourceBitmap, const GaussianBlurParams params, Common::TaskBuilder& taskBuilder);
+    // Approximate Gaussian blur with successive box filters (constant cost per pixel, regardless of sigma)
+    // Supports R32G32B32_Float format only. Temporary bitmap must have the same size and format as the target.
+    // NOTE: horizontal and vertical passes are separated with a fence
+    static bool GaussianBlur(Bitmap& targetBitmap, const Bitmap& sourceBitmap, Bitmap& tempBitmap, const GaussianBlurParams& params, Common::TaskBuilder& taskBuilder);
+
+    // Get number of pixels that given blur spreads the pixel value to (in each direction)
+    static uint32 GetGaussianBlurRadius(const GaussianBlurParams& params);
+
+    // Downsample by factor of two in each dimension with 2x2 box filter (used for building image pyramids)
+    // Target bitmap must be of size: ceil(source size / 2). Supports R32G32B32_Float format only.
+    static bool Downsample(Bitmap& targetBitmap, const Bitmap& sourceBitmap, const Region& region, Common::TaskBuilder& taskBuilder);
 };
 
 
@@ -1,11 +1,92 @@
 #include "PCH.h"
+#include "BlockCompression.h"
+#include "Bitmap.h"
 #include "../Common/Math/Vec4i.hpp"
+#include "../Common/Math/Vec8f.hpp"
+#include "../Common/Math/ColorHelpers.hpp"
+#include "../Common/Logger/Logger.hpp"
+#include "../Common/System/Thread.hpp"
+#include "../Common/Utils/TaskBuilder.hpp"
+#include "../Common/Utils/Waitable.hpp"
+#include "../Common/Containers/SharedPtr.hpp"
+
+#include "libsquish/squish.h"
 
 namespace NFE {
 namespace RT {
 
 using namespace Math;
 
+namespace helper
+{
+
+// compute 4-color palette of BC1 block
+NFE_FORCE_INLINE void DecodeBC1Palette(const uint8* blockData, Vec4f* outPalette)
+{
+    const uint16 raw0 = *reinterpret_cast<const uint16*>(blockData + 0);
+    const uint16 raw1 = *reinterpret_cast<const uint16*>(blockData + 2);
+
+    // extract base colors + scale down from 5,6,5 bit ranges to 0...1 float range
+    const Vec4i mask = { 0x1F << 11, 0x3F << 5, 0x1F, 0 };
+    const Vec4f scale{ 1.0f / 2048.0f / 31.0f, 1.0f / 32.0f / 63.0f, 1.0f / 31.0f, 0.0f };
+    const Vec4f color0 = (Vec4i(static_cast<int32>(raw0)) & mask).ConvertToVec4f() * scale;
+    const Vec4f color1 = (Vec4i(static_cast<int32>(raw1)) & mask).ConvertToVec4f() * scale;
+    // TODO alpha support
+
+    outPalette[0] = color0;
+    outPalette[1] = color1;
+
+    if (raw0 > raw1)
+    {
+        outPalette[2] = Vec4f::Lerp(color0, color1, 1.0f / 3.0f);
+        outPalette[3] = Vec4f::Lerp(color0, color1, 2.0f / 3.0f);
+    }
+    else // 3-color block
+    {
+        outPalette[2] = Vec4f::Lerp(color0, color1, 0.5f);
+        outPalette[3] = Vec4f::Zero();
+    }
+}
+
+// compute 8-value palette of BC4 block (also used by both halves of BC5 block)
+NFE_FORCE_INLINE const Vec8f DecodeBC4Palette(const uint8* blockData)
+{
+    const Vec8f value0(static_cast<float>(blockData[0]) * (1.0f / 255.0f));
+    const Vec8f value1(static_cast<float>(blockData[1]) * (1.0f / 255.0f));
+
+    if (blockData[0] > blockData[1])
+    {
+        const Vec8f weights0(1.0f, 0.0f, 6.0f / 7.0f, 5.0f / 7.0f, 4.0f / 7.0f, 3.0f / 7.0f, 2.0f / 7.0f, 1.0f / 7.0f);
+        const Vec8f weights1(0.0f, 1.0f, 1.0f / 7.0f, 2.0f / 7.0f, 3.0f / 7.0f, 4.0f / 7.0f, 5.0f / 7.0f, 6.0f / 7.0f);
+        return Vec8f::MulAndAdd(value0, weights0, value1 * weights1);
+    }
+    else
+    {
+        const Vec8f weights0(1.0f, 0.0f, 4.0f / 5.0f, 3.0f / 5.0f, 2.0f / 5.0f, 1.0f / 5.0f, 0.0f, 0.0f);
+        const Vec8f weights1(0.0f, 1.0f, 1.0f / 5.0f, 2.0f / 5.0f, 3.0f / 5.0f, 4.0f / 5.0f, 0.0f, 0.0f);
+        const Vec8f bias(0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+        return Vec8f::MulAndAdd(value0, weights0, Vec8f::MulAndAdd(value1, weights1, bias));
+    }
+}
+
+// get 48-bit index code of BC4 block
+NFE_FORCE_INLINE uint64 GetBC4Code(const uint8* blockData)
+{
+    uint64 code = 0;
+    memcpy(&code, blockData + 2, 6);
+    return code;
+}
+
+static float DecodeBC_Grayscale(const uint8* blockData, const uint32 x, const uint32 y)
+{
+    const uint64 code = GetBC4Code(blockData);
+    const uint32 index = (code >> (uint64)(3 * (4 * y + x))) % 8;
+
+    return DecodeBC4Palette(blockData)[index];
+}
+
+} // helper
+
 NFE_FORCE_NOINLINE
 const Vec4f DecodeBC1(const uint8* data, uint32 x, uint32 y, const uint32 width)
 {
@@ -58,59 +139,17 @@ const Vec4f DecodeBC1(const uint8* data, uint32 x, uint32 y, const uint32 width)
 
     const uint8* blockData = data + 8u * (blocksInRow * blockY + blockX);
 
-    // extract base colors for given block
-    const Vec4i mask = { 0x1F << 11, 0x3F << 5, 0x1F, 0 };
-    const Vec4i raw0 = Vec4i(*reinterpret_cast<const int32*>(blockData + 0)) & mask;
-    const Vec4i raw1 = Vec4i(*reinterpret_cast<const int32*>(blockData + 2)) & mask;
-    const Vec4f color0 = raw0.ConvertToVec4f();
-    const Vec4f color1 = raw1.ConvertToVec4f();
-    // TODO alpha support
+    Vec4f palette[4];
+    helper::DecodeBC1Palette(blockData, palette);
 
     // extract color index for given pixel
     const uint32 code = *reinterpret_cast<const uint32*>(blockData + 4);
     const uint32 codeOffset = 2u * (4u * y + x);
     const uint32 index = (code >> codeOffset) % 4;
 
-    // calculate final color by blending base colors + scale down from 5,6,5 bit ranges to 0...1 float range
-    const float weights[] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
-    const Vec4f scale{ 1.0f / 2048.0f / 31.0f, 1.0f / 32.0f / 63.0f, 1.0f / 31.0f, 0.0f };
-    return Vec4f::Lerp(color0, color1, weights[index]) * scale;
-}
-
-namespace helper
-{
-
-static float DecodeBC_Grayscale(const uint8* blockData, const uint32 x, const uint32 y)
-{
-    const float intColor0 = blockData[0];
-    const float intColor1 = blockData[1];
-    const float color0 = static_cast<float>(intColor0) / 255.0f;
-    const float color1 = static_cast<float>(intColor1) / 255.0f;
-
-    const uint64 code = *reinterpret_cast<const uint64*>(blockData + 2);
-    const uint32 index = (code >> (uint64)(3 * (4 * y + x))) % 8;
-
-    // TODO SSE
-
-    if (index == 0)
-        return color0;
-    else if (index == 1)
-        return color1;
-    else if (intColor0 > intColor1)
-        return (color0 * (8 - index) + color1 * (index - 1)) / 7.0f;
-    else
-    {
-        if (index == 6)
-            return 0.0f;
-        else if (index == 7)
-            return 1.0f;
-        else
-            return (color0 * (6 - index) + color1 * (index - 1)) / 5.0f;
-    }
+    return palette[index];
 }
 
-} // helper
-
 const Vec4f DecodeBC4(const uint8* data, uint32 x, uint32 y, const uint32 width)
 {
     const size_t blocksInRow = width / 4; // TODO non-4-multiply width support
@@ -145,5 +184,436 @@ const Vec4f DecodeBC5(const uint8* data, uint32 x, uint32 y, const uint32 width)
     return Vec4f(green, red, 0.0f, 1.0f);
 }
 
+void DecodeBC1Quad(const uint8* data, const Vec4ui coords, const uint32 width, Vec4f* outColors)
+{
+    const size_t blocksInRow = width / 4u; // TODO non-4-multiply width support
+    const uint32 blockX = coords.x / 4u;
+    const uint32 blockY = coords.y / 4u;
+
+    if (blockX != coords.z / 4u || blockY != coords.w / 4u)
+    {
+        // footprint spans multiple blocks
+        outColors[0] = DecodeBC1(data, coords.x, coords.y, width);
+        outColors[1] = DecodeBC1(data, coords.z, coords.y, width);
+        outColors[2] = DecodeBC1(data, coords.x, coords.w, width);
+        outColors[3] = DecodeBC1(data, coords.z, coords.w, width);
+        return;
+    }
+
+    const uint8* blockData = data + 8u * (blocksInRow * blockY + blockX);
+
+    Vec4f palette[4];
+    helper::DecodeBC1Palette(blockData, palette);
+
+    const uint32 code = *reinterpret_cast<const uint32*>(blockData + 4);
+    const uint32 x0 = coords.x % 4u, y0 = coords.y % 4u;
+    const uint32 x1 = coords.z % 4u, y1 = coords.w % 4u;
+    outColors[0] = palette[(code >> (2u * (4u * y0 + x0))) % 4];
+    outColors[1] = palette[(code >> (2u * (4u * y0 + x1))) % 4];
+    outColors[2] = palette[(code >> (2u * (4u * y1 + x0))) % 4];
+    outColors[3] = palette[(code >> (2u * (4u * y1 + x1))) % 4];
+}
+
+void DecodeBC4Quad(const uint8* data, const Vec4ui coords, const uint32 width, Vec4f* outColors)
+{
+    const size_t blocksInRow = width / 4u; // TODO non-4-multiply width support
+    const uint32 blockX = coords.x / 4u;
+    const uint32 blockY = coords.y / 4u;
+
+    if (blockX != coords.z / 4u || blockY != coords.w / 4u)
+    {
+        // footprint spans multiple blocks
+        outColors[0] = DecodeBC4(data, coords.x, coords.y, width);
+        outColors[1] = DecodeBC4(data, coords.z, coords.y, width);
+        outColors[2] = DecodeBC4(data, coords.x, coords.w, width);
+        outColors[3] = DecodeBC4(data, coords.z, coords.w, width);
+        return;
+    }
+
+    const uint8* blockData = data + 8u * (blocksInRow * blockY + blockX);
+
+    const Vec8f palette = helper::DecodeBC4Palette(blockData);
+
+    const uint64 code = helper::GetBC4Code(blockData);
+    const uint32 x0 = coords.x % 4u, y0 = coords.y % 4u;
+    const uint32 x1 = coords.z % 4u, y1 = coords.w % 4u;
+    const float values[4] =
+    {
+        palette[(code >> (3u * (4u * y0 + x0))) % 8],
+        palette[(code >> (3u * (4u * y0 + x1))) % 8],
+        palette[(code >> (3u * (4u * y1 + x0))) % 8],
+        palette[(code >> (3u * (4u * y1 + x1))) % 8],
+    };
+
+    for (uint32 i = 0; i < 4; ++i)
+    {
+        outColors[i] = Vec4f(values[i], values[i], values[i], 1.0f);
+    }
+}
+
+void DecodeBC5Quad(const uint8* data, const Vec4ui coords, const uint32 width, Vec4f* outColors)
+{
+    const size_t blocksInRow = width / 4u; // TODO non-4-multiply width support
+    const uint32 blockX = coords.x / 4u;
+    const uint32 blockY = coords.y / 4u;
+
+    if (blockX != coords.z / 4u || blockY != coords.w / 4u)
+    {
+        // footprint spans multiple blocks
+        outColors[0] = DecodeBC5(data, coords.x, coords.y, width);
+        outColors[1] = DecodeBC5(data, coords.z, coords.y, width);
+        outColors[2] = DecodeBC5(data, coords.x, coords.w, width);
+        outColors[3] = DecodeBC5(data, coords.z, coords.w, width);
+        return;
+    }
+
+    const uint8* blockDataRed = data + 16u * (blocksInRow * blockY + blockX);
+    const uint8* blockDataGreen = blockDataRed + 8;
+
+    const Vec8f paletteRed = helper::DecodeBC4Palette(blockDataRed);
+    const Vec8f paletteGreen = helper::DecodeBC4Palette(blockDataGreen);
+
+    const uint64 codeRed = helper::GetBC4Code(blockDataRed);
+    const uint64 codeGreen = helper::GetBC4Code(blockDataGreen);
+    const uint32 x0 = coords.x % 4u, y0 = coords.y % 4u;
+    const uint32 x1 = coords.z % 4u, y1 = coords.w % 4u;
+    const uint32 shifts[4] =
+    {
+        3u * (4u * y0 + x0),
+        3u * (4u * y0 + x1),
+        3u * (4u * y1 + x0),
+        3u * (4u * y1 + x1),
+    };
+
+    for (uint32 i = 0; i < 4; ++i)
+    {
+        const float red = paletteRed[(codeRed >> shifts[i]) % 8];
+        const float green = paletteGreen[(codeGreen >> shifts[i]) % 8];
+        outColors[i] = Vec4f(green, red, 0.0f, 1.0f);
+    }
+}
+
+void DecodeBC1Block(const uint8* blockData, Vec4f* outColors)
+{
+    Vec4f palette[4];
+    helper::DecodeBC1Palette(blockData, palette);
+
+    // extract color indices of a whole row at once
+    const uint32 code = *reinterpret_cast<const uint32*>(blockData + 4);
+    const Vec4ui shifts(0u, 2u, 4u, 6u);
+    for (uint32 y = 0; y < 4; ++y)
+    {
+        const Vec4ui indices = (Vec4ui(code >> (8u * y)) >> shifts) & Vec4ui(3u);
+        outColors[4 * y + 0] = palette[indices.x];
+        outColors[4 * y + 1] = palette[indices.y];
+        outColors[4 * y + 2] = palette[indices.z];
+        outColors[4 * y + 3] = palette[indices.w];
+    }
+}
+
+void DecodeBC4Block(const uint8* blockData, Vec4f* outColors)
+{
+    const Vec8f palette = helper::DecodeBC4Palette(blockData);
+
+    const uint64 code = helper::GetBC4Code(blockData);
+    const Vec4ui shifts(0u, 3u, 6u, 9u);
+    for (uint32 y = 0; y < 4; ++y)
+    {
+        const Vec4ui indices = (Vec4ui(static_cast<uint32>(code >> (12u * y))) >> shifts) & Vec4ui(7u);
+        for (uint32 x = 0; x < 4; ++x)
+        {
+            const float value = palette[indices[x]];
+            outColors[4 * y + x] = Vec4f(value, value, value, 1.0f);
+        }
+    }
+}
+
+void DecodeBC5Block(const uint8* blockData, Vec4f* outColors)
+{
+    const uint8* blockDataRed = blockData;
+    const uint8* blockDataGreen = blockData + 8;
+
+    const Vec8f paletteRed = helper::DecodeBC4Palette(blockDataRed);
+    const Vec8f paletteGreen = helper::DecodeBC4Palette(blockDataGreen);
+
+    const uint64 codeRed = helper::GetBC4Code(blockDataRed);
+    const uint64 codeGreen = helper::GetBC4Code(blockDataGreen);
+    const Vec4ui shifts(0u, 3u, 6u, 9u);
+    for (uint32 y = 0; y < 4; ++y)
+    {
+        const Vec4ui indicesRed = (Vec4ui(static_cast<uint32>(codeRed >> (12u * y))) >> shifts) & Vec4ui(7u);
+        const Vec4ui indicesGreen = (Vec4ui(static_cast<uint32>(codeGreen >> (12u * y))) >> shifts) & Vec4ui(7u);
+        for (uint32 x = 0; x < 4; ++x)
+        {
+            outColors[4 * y + x] = Vec4f(paletteGreen[indicesGreen[x]], paletteRed[indicesRed[x]], 0.0f, 1.0f);
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+bool Bitmap::IsBlockCompressed(Format format)
+{
+    switch (format)
+    {
+    case Format::BC1:
+    case Format::BC1_sRGB:
+    case Format::BC4:
+    case Format::BC5:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void Bitmap::GetCompressedBlock(uint32 blockX, uint32 blockY, Vec4f* outColors) const
+{
+    NFE_ASSERT(blockX < GetWidth() / 4u && blockY < GetHeight() / 4u, "Block coordinates out of bounds");
+
+    const size_t blockIndex = static_cast<size_t>(GetWidth() / 4u) * blockY + blockX;
+
+    switch (mFormat)
+    {
+    case Format::BC1:
+        DecodeBC1Block(mData + 8u * blockIndex, outColors);
+        break;
+
+    case Format::BC1_sRGB:
+        DecodeBC1Block(mData + 8u * blockIndex, outColors);
+        for (uint32 i = 0; i < 16; ++i)
+        {
+            outColors[i] = Convert_sRGB_To_Linear(outColors[i]);
+        }
+        break;
+
+    case Format::BC4:
+        DecodeBC4Block(mData + 8u * blockIndex, outColors);
+        break;
+
+    case Format::BC5:
+        DecodeBC5Block(mData + 16u * blockIndex, outColors);
+        break;
+
+    default:
+        NFE_FATAL("Not a block compressed format");
+    }
+}
+
+Bitmap::Format Bitmap::GetBlockCompressedFormat(Format format)
+{
+    switch (format)
+    {
+    case Format::R8_UNorm:
+        return Format::BC4;
+    case Format::R8G8_UNorm:
+        return Format::BC5;
+    case Format::B8G8R8_UNorm:
+    case Format::B8G8R8A8_UNorm:
+    case Format::R8G8B8A8_UNorm:
+    case Format::B8G8R8A8_UNorm_Palette:
+        return Format::BC1;
+    case Format::B8G8R8_UNorm_sRGB:
+    case Format::B8G8R8A8_UNorm_sRGB:
+    case Format::R8G8B8A8_UNorm_sRGB:
+    case Format::B8G8R8A8_UNorm_Palette_sRGB:
+        return Format::BC1_sRGB;
+    }
+
+    return Format::Unknown;
+}
+
+bool Bitmap::BlockCompress()
+{
+    if (Common::Thread::IsMainThread())
+    {
+        bool result = false;
+        Common::Waitable waitable;
+        {
+            Common::TaskBuilder taskBuilder(waitable);
+            result = BlockCompress_Internal(&taskBuilder);
+        }
+        waitable.Wait();
+        return result;
+    }
+
+    // waiting for tasks on a worker thread could deadlock, so compress on the calling thread
+    // (use the task builder version with the task context to compress in parallel)
+    return BlockCompress_Internal(nullptr);
+}
+
+bool Bitmap::BlockCompress(Common::TaskBuilder& taskBuilder)
+{
+    return BlockCompress_Internal(&taskBuilder);
+}
+
+bool Bitmap::BlockCompress_Internal(Common::TaskBuilder* taskBuilder)
+{
+    const Format targetFormat = GetBlockCompressedFormat(mFormat);
+    if (targetFormat == Format::Unknown)
+    {
+        NFE_LOG_ERROR("Bitmap '%s': Block compression of %s format is not supported", mDebugName, FormatToString(mFormat));
+        return false;
+    }
+
+    if (GetDepth() > 1 || GetWidth() % 4 != 0 || GetHeight() % 4 != 0)
+    {
+        NFE_LOG_ERROR("Bitmap '%s': Block compression requires 2D bitmap with dimensions being multiply of 4", mDebugName);
+        return false;
+    }
+
+    const uint32 numBlocksX = GetWidth() / 4;
+    const uint32 numBlocksY = GetHeight() / 4;
+
+    int squishFlags = 0;
+    uint32 blockSize = 0;
+    if (targetFormat == Format::BC4)
+    {
+        squishFlags = squish::kBc4;
+        blockSize = 8;
+    }
+    else if (targetFormat == Format::BC5)
+    {
+        squishFlags = squish::kBc5;
+        blockSize = 16;
+    }
+    else
+    {
+        squishFlags = squish::kDxt1 | squish::kColourClusterFit;
+        blockSize = 8;
+    }
+
+    // BC1 has no alpha support
+    const bool hasAlpha = (targetFormat == Format::BC1 || targetFormat == Format::BC1_sRGB) &&
+        mFormat != Format::B8G8R8_UNorm && mFormat != Format::B8G8R8_UNorm_sRGB;
+    if (hasAlpha)
+    {
+        for (uint32 y = 0; y < GetHeight(); ++y)
+        {
+            for (uint32 x = 0; x < GetWidth(); ++x)
+            {
+                if (GetPixel(x, y).w < 1.0f)
+                {
+                    NFE_LOG_WARNING("Bitmap '%s': Skipping block compression, because bitmap is not opaque", mDebugName);
+                    return false;
+                }
+            }
+        }
+    }
+
+    InitData initData;
+    initData.width = GetWidth();
+    initData.height = GetHeight();
+    initData.format = targetFormat;
+
+    // compressed data is shared with the tasks, it replaces the source data when all the rows are compressed
+    const BitmapPtr compressed = Common::MakeSharedPtr<Bitmap>(mDebugName);
+    if (!compressed->Init(initData))
+    {
+        return false;
+    }
+
+    const auto compressRow = [this, compressed, numBlocksX, blockSize, squishFlags](uint32 blockY)
+    {
+        uint8* targetRow = compressed->GetData() + static_cast<size_t>(blockY) * numBlocksX * blockSize;
+
+        for (uint32 blockX = 0; blockX < numBlocksX; ++blockX)
+        {
+            // gather 4x4 block of RGBA pixels, as expected by squish
+            uint8 rgba[16 * 4];
+
+            for (uint32 j = 0; j < 4; ++j)
+            {
+                const uint32 y = 4 * blockY + j;
+                const uint8* rowData = mData + static_cast<size_t>(GetStride()) * y;
+
+                for (uint32 i = 0; i < 4; ++i)
+                {
+                    const uint32 x = 4 * blockX + i;
+                    uint8* target = rgba + 4 * (4 * j + i);
+
+                    switch (mFormat)
+                    {
+                    case Format::R8_UNorm:
+                        target[0] = rowData[x];
+                        target[1] = target[2] = 0;
+                        break;
+                    case Format::R8G8_UNorm:
+                        // BC5 decoder swaps the channels, so the order is swapped here too
+                        target[0] = rowData[2 * x + 1];
+                        target[1] = rowData[2 * x];
+                        target[2] = 0;
+                        break;
+                    case Format::B8G8R8_UNorm:
+                    case Format::B8G8R8_UNorm_sRGB:
+                        target[0] = rowData[3 * x + 2];
+                        target[1] = rowData[3 * x + 1];
+                        target[2] = rowData[3 * x];
+                        break;
+                    case Format::B8G8R8A8_UNorm:
+                    case Format::B8G8R8A8_UNorm_sRGB:
+                        target[0] = rowData[4 * x + 2];
+                        target[1] = rowData[4 * x + 1];
+                        target[2] = rowData[4 * x];
+                        break;
+                    case Format::R8G8B8A8_UNorm:
+                    case Format::R8G8B8A8_UNorm_sRGB:
+                        target[0] = rowData[4 * x];
+                        target[1] = rowData[4 * x + 1];
+                        target[2] = rowData[4 * x + 2];
+                        break;
+                    case Format::B8G8R8A8_UNorm_Palette:
+                    case Format::B8G8R8A8_UNorm_Palette_sRGB:
+                    {
+                        const uint8* paletteEntry = mPalette + 4u * rowData[x];
+                        target[0] = paletteEntry[2];
+                        target[1] = paletteEntry[1];
+                        target[2] = paletteEntry[0];
+                        break;
+                    }
+                    }
+
+                    target[3] = 0xFF;
+                }
+            }
+
+            squish::Compress(rgba, targetRow + blockX * blockSize, squishFlags);
+        }
+    };
+
+    const auto takeOverCompressed = [this, compressed]()
+    {
+        std::swap(mData, compressed->mData);
+        std::swap(mPalette, compressed->mPalette);
+        std::swap(mUsesSystemAllocator, compressed->mUsesSystemAllocator);
+        std::swap(mPaletteSize, compressed->mPaletteSize);
+        std::swap(mSize, compressed->mSize);
+        std::swap(mFloatSize, compressed->mFloatSize);
+        std::swap(mFormat, compressed->mFormat);
+    };
+
+    if (taskBuilder)
+    {
+        taskBuilder->ParallelFor("Bitmap/BlockCompress", numBlocksY, [compressRow](const Common::TaskContext&, uint32 blockY)
+        {
+            compressRow(blockY);
+        });
+        taskBuilder->Fence();
+        taskBuilder->Task("Bitmap/BlockCompressFinish", [takeOverCompressed](const Common::TaskContext&)
+        {
+            takeOverCompressed();
+        });
+    }
+    else
+    {
+        for (uint32 blockY = 0; blockY < numBlocksY; ++blockY)
+        {
+            compressRow(blockY);
+        }
+        takeOverCompressed();
+    }
+
+    return true;
+}
+
 } // namespace RT
 } // namespace NFE
@@ -2,6 +2,7 @@
 
 #include "../Raytracer.h"
 #include "../../Common/Math/Vec4f.hpp"
+#include "../../Common/Math/Vec4i.hpp"
 
 
 namespace NFE {
@@ -11,5 +12,16 @@ const Math::Vec4f DecodeBC1(const uint8* data, uint32 x, uint32 y, const uint32
 const Math::Vec4f DecodeBC4(const uint8* data, uint32 x, uint32 y, const uint32 width);
 const Math::Vec4f DecodeBC5(const uint8* data, uint32 x, uint32 y, const uint32 width);
 
+// decode 2x2 texel footprint (same layout as Bitmap::GetPixelBlock)
+// block palette is decoded only once if the footprint lies within a single block
+void DecodeBC1Quad(const uint8* data, const Math::Vec4ui coords, const uint32 width, Math::Vec4f* outColors);
+void DecodeBC4Quad(const uint8* data, const Math::Vec4ui coords, const uint32 width, Math::Vec4f* outColors);
+void DecodeBC5Quad(const uint8* data, const Math::Vec4ui coords, const uint32 width, Math::Vec4f* outColors);
+
+// decode all 16 texels of a single block (in row-major order)
+void DecodeBC1Block(const uint8* blockData, Math::Vec4f* outColors);
+void DecodeBC4Block(const uint8* blockData, Math::Vec4f* outColors);
+void DecodeBC5Block(const uint8* blockData, Math::Vec4f* outColors);
+
 } // namespace RT
 } // namespace NFE
@@ -0,0 +1,587 @@
+#include "PCH.h"
+#include "ExrWriter.h"
+#include "Bitmap.h"
+#include "../Common/Logger/Logger.hpp"
+#include "../Common/Math/Half.hpp"
+#include "../Common/Utils/TaskBuilder.hpp"
+#include "../Common/Utils/Waitable.hpp"
+#include "tinyexr/deps/miniz/miniz.h"
+
+namespace NFE {
+namespace RT {
+
+using namespace Common;
+using namespace Math;
+
+namespace {
+
+static const int32 ExrMagic = 20000630;
+static const int32 ExrVersion = 2;
+static const int32 ExrMultiPartFlag = 0x1000;
+
+// OpenEXR channel pixel types
+static const int32 ExrPixelTypeHalf = 1;
+static const int32 ExrPixelTypeFloat = 2;
+
+// OpenEXR compression methods
+static const uint8 ExrCompressionNone = 0;
+static const uint8 ExrCompressionZIPS = 2;
+static const uint8 ExrCompressionZIP = 3;
+
+struct ChannelLayout
+{
+    uint32 numChannels;
+    const char* names[4];       // must be sorted alphabetically
+    uint32 sourceComponent[4];  // source bitmap component for each channel
+};
+
+static bool GetChannelLayout(Bitmap::Format format, ChannelLayout& outLayout)
+{
+    switch (format)
+    {
+    case Bitmap::Format::R32_Float:
+        outLayout = { 1, { "Y" }, { 0 } };
+        return true;
+    case Bitmap::Format::R32G32B32_Float:
+        outLayout = { 3, { "B", "G", "R" }, { 2, 1, 0 } };
+        return true;
+    case Bitmap::Format::R32G32B32A32_Float:
+        outLayout = { 4, { "A", "B", "G", "R" }, { 3, 2, 1, 0 } };
+        return true;
+    default:
+        return false;
+    }
+}
+
+class HeaderBuilder
+{
+public:
+    template<typename T>
+    void Append(const T& value)
+    {
+        AppendBytes(&value, sizeof(T));
+    }
+
+    void AppendString(const char* str)
+    {
+        AppendBytes(str, static_cast<uint32>(strlen(str)) + 1u);
+    }
+
+    void AppendBytes(const void* data, uint32 size)
+    {
+        const uint8* bytes = static_cast<const uint8*>(data);
+        for (uint32 i = 0; i < size; ++i)
+        {
+            mData.PushBack(bytes[i]);
+        }
+    }
+
+    void BeginAttribute(const char* name, const char* type, uint32 size)
+    {
+        AppendString(name);
+        AppendString(type);
+        Append(static_cast<int32>(size));
+    }
+
+    const DynArray<uint8>& GetData() const { return mData; }
+
+private:
+    DynArray<uint8> mData;
+};
+
+static uint8 ToExrCompression(ExrWriter::Compression compression)
+{
+    switch (compression)
+    {
+    case ExrWriter::Compression::ZIPS:  return ExrCompressionZIPS;
+    case ExrWriter::Compression::ZIP:   return ExrCompressionZIP;
+    default:                            return ExrCompressionNone;
+    }
+}
+
+static uint32 GetLinesPerChunk(ExrWriter::Compression compression)
+{
+    return compression == ExrWriter::Compression::ZIP ? 16u : 1u;
+}
+
+// OpenEXR zlib compression: bytes are split into two halves and delta-encoded before deflating
+static bool CompressZip(const DynArray<uint8>& raw, DynArray<uint8>& outData)
+{
+    const uint32 size = raw.Size();
+
+    DynArray<uint8> tmp;
+    tmp.Resize_SkipConstructor(size);
+
+    // reorder
+    {
+        uint8* t1 = tmp.Data();
+        uint8* t2 = tmp.Data() + (size + 1) / 2;
+        for (uint32 i = 0; i < size; i += 2)
+        {
+            *(t1++) = raw[i];
+            if (i + 1 < size)
+            {
+                *(t2++) = raw[i + 1];
+            }
+        }
+    }
+
+    // predictor
+    {
+        int32 p = size > 0 ? tmp[0] : 0;
+        for (uint32 i = 1; i < size; ++i)
+        {
+            const int32 d = int32(tmp[i]) - p + (128 + 256);
+            p = tmp[i];
+            tmp[i] = static_cast<uint8>(d);
+        }
+    }
+
+    mz_ulong compressedSize = mz_compressBound(size);
+    outData.Resize_SkipConstructor(static_cast<uint32>(compressedSize));
+
+    if (mz_compress2(outData.Data(), &compressedSize, tmp.Data(), size, MZ_DEFAULT_LEVEL) != MZ_OK)
+    {
+        return false;
+    }
+
+    // incompressible data is stored raw (the reader detects it by the size)
+    if (compressedSize >= size)
+    {
+        return false;
+    }
+
+    outData.Resize(static_cast<uint32>(compressedSize));
+    return true;
+}
+
+// 64-bit seek, offset tables of big images can be placed beyond 2GB
+static bool SeekFile(FILE* file, uint64 position)
+{
+#if defined(NFE_PLATFORM_WINDOWS)
+    return _fseeki64(file, static_cast<int64>(position), SEEK_SET) == 0;
+#else
+    return fseeko(file, static_cast<off_t>(position), SEEK_SET) == 0;
+#endif // NFE_PLATFORM_WINDOWS
+}
+
+} // namespace
+
+ExrWriter::ExrWriter() = default;
+
+ExrWriter::~ExrWriter()
+{
+    if (mFile)
+    {
+        Close();
+    }
+}
+
+bool ExrWriter::Open(const char* path, const ArrayView<const PartDesc> parts)
+{
+    if (mFile)
+    {
+        NFE_LOG_ERROR("ExrWriter: File is already opened");
+        return false;
+    }
+
+    if (parts.Empty())
+    {
+        NFE_LOG_ERROR("ExrWriter: No parts");
+        return false;
+    }
+
+    mMultiPart = parts.Size() > 1;
+    mWidth = parts[0].source ? parts[0].source->GetWidth() : 0;
+    mHeight = parts[0].source ? parts[0].source->GetHeight() : 0;
+
+    mParts.Clear();
+    for (uint32 i = 0; i < parts.Size(); ++i)
+    {
+        const PartDesc& desc = parts[i];
+
+        ChannelLayout layout;
+        if (!desc.source || !GetChannelLayout(desc.source->GetFormat(), layout))
+        {
+            NFE_LOG_ERROR("ExrWriter: Part %u has invalid source image", i);
+            return false;
+        }
+
+        if (desc.source->GetWidth() != mWidth || desc.source->GetHeight() != mHeight || desc.source->GetDepth() > 1 || mWidth == 0 || mHeight == 0)
+        {
+            NFE_LOG_ERROR("ExrWriter: All parts must be non-empty 2D images of the same size");
+            return false;
+        }
+
+        if (mMultiPart && desc.name.Empty())
+        {
+            NFE_LOG_ERROR("ExrWriter: Parts of multi-part file must be named");
+            return false;
+        }
+
+        Part part;
+        part.desc = desc;
+        part.numChannels = layout.numChannels;
+        part.linesPerChunk = GetLinesPerChunk(desc.compression);
+        part.numChunks = (mHeight + part.linesPerChunk - 1) / part.linesPerChunk;
+        part.chunkOffsets.Resize(part.numChunks);
+        mParts.PushBack(std::move(part));
+    }
+
+    mFile = fopen(path, "wb");
+    if (!mFile)
+    {
+        NFE_LOG_ERROR("ExrWriter: Failed to open file '%s'", path);
+        return false;
+    }
+
+    mFilePosition = 0;
+    mError = false;
+    mHeadersWritten = false;
+    mFirstPendingBatch = 0;
+    mPendingBatches.Clear();
+
+    const int32 version = ExrVersion | (mMultiPart ? ExrMultiPartFlag : 0);
+    if (!WriteData(&ExrMagic, sizeof(ExrMagic)) || !WriteData(&version, sizeof(version)))
+    {
+        Close();
+        return false;
+    }
+
+    for (uint32 i = 0; i < mParts.Size(); ++i)
+    {
+        if (!WriteHeader(mParts[i], i))
+        {
+            Close();
+            return false;
+        }
+    }
+
+    // end of headers list
+    if (mMultiPart)
+    {
+        const uint8 terminator = 0;
+        if (!WriteData(&terminator, 1))
+        {
+            Close();
+            return false;
+        }
+    }
+
+    // reserve space for offset tables (filled when closing the file)
+    for (Part& part : mParts)
+    {
+        part.offsetTablePosition = mFilePosition;
+
+        if (!WriteData(part.chunkOffsets.Data(), sizeof(uint64) * part.numChunks))
+        {
+            Close();
+            return false;
+        }
+    }
+
+    mHeadersWritten = true;
+    return true;
+}
+
+bool ExrWriter::WriteHeader(const Part& part, uint32 partIndex)
+{
+    ChannelLayout layout;
+    GetChannelLayout(part.desc.source->GetFormat(), layout);
+
+    HeaderBuilder header;
+
+    // channels list
+    {
+        uint32 size = 1;
+        for (uint32 i = 0; i < layout.numChannels; ++i)
+        {
+            size += static_cast<uint32>(strlen(layout.names[i])) + 1u + 16u;
+        }
+
+        header.BeginAttribute("channels", "chlist", size);
+        for (uint32 i = 0; i < layout.numChannels; ++i)
+        {
+            header.AppendString(layout.names[i]);
+            header.Append(part.desc.pixelType == PixelType::Half ? ExrPixelTypeHalf : ExrPixelTypeFloat);
+            header.Append(uint32(0)); // pLinear + reserved
+            header.Append(int32(1)); // x sampling
+            header.Append(int32(1)); // y sampling
+        }
+        header.Append(uint8(0));
+    }
+
+    header.BeginAttribute("compression", "compression", 1);
+    header.Append(ToExrCompression(part.desc.compression));
+
+    const int32 window[4] = { 0, 0, static_cast<int32>(mWidth) - 1, static_cast<int32>(mHeight) - 1 };
+
+    header.BeginAttribute("dataWindow", "box2i", sizeof(window));
+    header.AppendBytes(window, sizeof(window));
+
+    header.BeginAttribute("displayWindow", "box2i", sizeof(window));
+    header.AppendBytes(window, sizeof(window));
+
+    header.BeginAttribute("lineOrder", "lineOrder", 1);
+    header.Append(uint8(0)); // increasing Y
+
+    header.BeginAttribute("pixelAspectRatio", "float", 4);
+    header.Append(1.0f);
+
+    const float screenWindowCenter[2] = { 0.0f, 0.0f };
+    header.BeginAttribute("screenWindowCenter", "v2f", sizeof(screenWindowCenter));
+    header.AppendBytes(screenWindowCenter, sizeof(screenWindowCenter));
+
+    header.BeginAttribute("screenWindowWidth", "float", 4);
+    header.Append(1.0f);
+
+    if (mMultiPart)
+    {
+        header.BeginAttribute("name", "string", part.desc.name.Length());
+        header.AppendBytes(part.desc.name.Str(), part.desc.name.Length());
+
+        const char* type = "scanlineimage";
+        header.BeginAttribute("type", "string", static_cast<uint32>(strlen(type)));
+        header.AppendBytes(type, static_cast<uint32>(strlen(type)));
+
+        header.BeginAttribute("chunkCount", "int", 4);
+        header.Append(static_cast<int32>(part.numChunks));
+    }
+
+    // end of header
+    header.Append(uint8(0));
+
+    if (!WriteData(header.GetData().Data(), header.GetData().Size()))
+    {
+        NFE_LOG_ERROR("ExrWriter: Failed to write header of part %u", partIndex);
+        return false;
+    }
+
+    return true;
+}
+
+bool ExrWriter::WriteRows(uint32 numRows)
+{
+    if (!mFile || !mHeadersWritten)
+    {
+        return false;
+    }
+
+    UniquePtr<Batch> batch = MakeUniquePtr<Batch>();
+
+    for (uint32 i = 0; i < mParts.Size(); ++i)
+    {
+        Part& part = mParts[i];
+
+        // only complete chunks can be encoded
+        const uint32 firstChunk = part.submittedRows / part.linesPerChunk;
+        const uint32 lastChunk = numRows >= mHeight ? part.numChunks : (numRows / part.linesPerChunk);
+
+        for (uint32 j = firstChunk; j < lastChunk; ++j)
+        {
+            Chunk chunk;
+            chunk.partIndex = i;
+            chunk.chunkIndex = j;
+            batch->chunks.PushBack(std::move(chunk));
+        }
+
+        part.submittedRows = Max(part.submittedRows, Min(lastChunk * part.linesPerChunk, mHeight));
+    }
+
+    if (!batch->chunks.Empty())
+    {
+        batch->waitable = MakeUniquePtr<Waitable>();
+        {
+            Batch* batchPtr = batch.Get();
+
+            TaskBuilder taskBuilder(*batch->waitable);
+            taskBuilder.ParallelFor("ExrWriter::EncodeChunk", batch->chunks.Size(), [this, batchPtr](const TaskContext&, uint32 index)
+            {
+                Chunk& chunk = batchPtr->chunks[index];
+                EncodeChunk(mParts[chunk.partIndex], chunk);
+            });
+        }
+
+        mPendingBatches.PushBack(std::move(batch));
+    }
+
+    return Flush();
+}
+
+void ExrWriter::EncodeChunk(const Part& part, Chunk& chunk) const
+{
+    ChannelLayout layout;
+    GetChannelLayout(part.desc.source->GetFormat(), layout);
+
+    const Bitmap& source = *part.desc.source;
+    const uint32 minY = chunk.chunkIndex * part.linesPerChunk;
+    const uint32 maxY = Min(minY + part.linesPerChunk, mHeight);
+    const bool isHalf = part.desc.pixelType == PixelType::Half;
+    const uint32 valueSize = isHalf ? sizeof(Half) : sizeof(float);
+    const float scale = part.desc.scale;
+
+    DynArray<uint8> raw;
+    raw.Resize_SkipConstructor((maxY - minY) * mWidth * layout.numChannels * valueSize);
+
+    // each scanline contains all values of the first channel, then all values of the second one, etc.
+    uint8* output = raw.Data();
+    for (uint32 y = minY; y < maxY; ++y)
+    {
+        const float* row = reinterpret_cast<const float*>(source.GetData() + static_cast<size_t>(source.GetStride()) * y);
+
+        for (uint32 c = 0; c < layout.numChannels; ++c)
+        {
+            const uint32 component = layout.sourceComponent[c];
+
+            if (isHalf)
+            {
+                Half* typedOutput = reinterpret_cast<Half*>(output);
+                for (uint32 x = 0; x < mWidth; ++x)
+                {
+                    typedOutput[x] = Half(scale * row[layout.numChannels * x + component]);
+                }
+            }
+            else
+            {
+                float* typedOutput = reinterpret_cast<float*>(output);
+                for (uint32 x = 0; x < mWidth; ++x)
+                {
+                    typedOutput[x] = scale * row[layout.numChannels * x + component];
+                }
+            }
+
+            output += mWidth * valueSize;
+        }
+    }
+
+    if (part.desc.compression == Compression::None || !CompressZip(raw, chunk.data))
+    {
+        chunk.data = std::move(raw);
+    }
+}
+
+bool ExrWriter::Flush()
+{
+    if (!mFile)
+    {
+        return false;
+    }
+
+    // batches are written in submission order, so the chunks are stored in increasing Y order
+    while (mFirstPendingBatch < mPendingBatches.Size())
+    {
+        Batch& batch = *mPendingBatches[mFirstPendingBatch];
+        if (!batch.waitable->IsFinished())
+        {
+            break;
+        }
+
+        if (!WriteBatch(batch))
+        {
+            mError = true;
+        }
+
+        mPendingBatches[mFirstPendingBatch].Reset();
+        mFirstPendingBatch++;
+    }
+
+    if (mFirstPendingBatch == mPendingBatches.Size())
+    {
+        mPendingBatches.Clear();
+        mFirstPendingBatch = 0;
+    }
+
+    return !mError;
+}
+
+bool ExrWriter::WriteBatch(Batch& batch)
+{
+    for (const Chunk& chunk : batch.chunks)
+    {
+        Part& part = mParts[chunk.partIndex];
+        part.chunkOffsets[chunk.chunkIndex] = mFilePosition;
+
+        const int32 partNumber = static_cast<int32>(chunk.partIndex);
+        const int32 y = static_cast<int32>(chunk.chunkIndex * part.linesPerChunk);
+        const int32 dataSize = static_cast<int32>(chunk.data.Size());
+
+        if (mMultiPart && !WriteData(&partNumber, sizeof(partNumber)))
+        {
+            return false;
+        }
+
+        if (!WriteData(&y, sizeof(y)) || !WriteData(&dataSize, sizeof(dataSize)) || !WriteData(chunk.data.Data(), chunk.data.Size()))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool ExrWriter::WriteData(const void* data, size_t size)
+{
+    if (size > 0 && fwrite(data, size, 1, mFile) != 1)
+    {
+        NFE_LOG_ERROR("ExrWriter: Failed to write data");
+        return false;
+    }
+
+    mFilePosition += size;
+    return true;
+}
+
+bool ExrWriter::Close()
+{
+    if (!mFile)
+    {
+        return false;
+    }
+
+    // if Open() failed, there is no image to finish
+    bool success = mHeadersWritten && !mError;
+
+    // make sure whole image is written
+    if (success)
+    {
+        success = WriteRows(mHeight);
+    }
+
+    for (uint32 i = mFirstPendingBatch; i < mPendingBatches.Size(); ++i)
+    {
+        Batch& batch = *mPendingBatches[i];
+        batch.waitable->Wait();
+        success = success && WriteBatch(batch);
+    }
+    mPendingBatches.Clear();
+    mFirstPendingBatch = 0;
+
+    // fill offset tables
+    if (success)
+    {
+        for (const Part& part : mParts)
+        {
+            if (!SeekFile(mFile, part.offsetTablePosition) ||
+                fwrite(part.chunkOffsets.Data(), sizeof(uint64) * part.numChunks, 1, mFile) != 1)
+            {
+                NFE_LOG_ERROR("ExrWriter: Failed to write offset table");
+                success = false;
+                break;
+            }
+        }
+    }
+
+    if (fclose(mFile) != 0)
+    {
+        success = false;
+    }
+
+    mFile = nullptr;
+    mHeadersWritten = false;
+    mParts.Clear();
+
+    return success;
+}
+
+} // namespace RT
+} // namespace NFE
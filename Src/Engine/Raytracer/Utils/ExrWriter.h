@@ -0,0 +1,125 @@
+#pragma once
+
+#include "../Raytracer.h"
+#include "../../Common/Containers/DynArray.hpp"
+#include "../../Common/Containers/ArrayView.hpp"
+#include "../../Common/Containers/String.hpp"
+#include "../../Common/Containers/UniquePtr.hpp"
+
+#include <stdio.h>
+
+namespace NFE {
+
+namespace Common {
+class Waitable;
+} // namespace Common
+
+namespace RT {
+
+class Bitmap;
+
+/**
+ * Streaming OpenEXR writer.
+ *
+ * Image is split into scanline chunks, which are converted and compressed in parallel on the thread pool.
+ * Rows can be submitted in batches (compression of a batch starts immediately), compressed chunks are written
+ * to the file in order when ready. Multiple images (e.g. AOVs) are stored as parts of a multi-part file.
+ */
+class ExrWriter
+{
+    NFE_MAKE_NONCOPYABLE(ExrWriter)
+    NFE_MAKE_NONMOVEABLE(ExrWriter)
+
+public:
+    enum class Compression : uint8
+    {
+        None,
+        ZIPS,   // zlib, single scanline per chunk
+        ZIP,    // zlib, 16 scanlines per chunk
+    };
+
+    enum class PixelType : uint8
+    {
+        Half,
+        Float,
+    };
+
+    struct PartDesc
+    {
+        Common::String name;                    // part name (required for multi-part files)
+        const Bitmap* source = nullptr;         // R32_Float, R32G32B32_Float or R32G32B32A32_Float image
+        PixelType pixelType = PixelType::Half;
+        Compression compression = Compression::ZIP;
+        float scale = 1.0f;                     // source values multiplier (e.g. exposure)
+    };
+
+    NFE_RAYTRACER_API ExrWriter();
+    NFE_RAYTRACER_API ~ExrWriter();
+
+    // create file and write headers
+    // NOTE: source bitmaps must stay alive until the file is closed
+    NFE_RAYTRACER_API bool Open(const char* path, const Common::ArrayView<const PartDesc> parts);
+
+    // Submit rows [0, numRows) of all the parts for compression.
+    // Rows must not be modified after submission, until the file is closed.
+    // Submitting rows which were already submitted has no effect.
+    NFE_RAYTRACER_API bool WriteRows(uint32 numRows);
+
+    // write compressed chunks that are ready (does not block)
+    NFE_RAYTRACER_API bool Flush();
+
+    // wait for pending chunks, write offset tables and close the file
+    // NOTE: returns false if the file was not opened successfully
+    NFE_RAYTRACER_API bool Close();
+
+    NFE_FORCE_INLINE bool IsOpened() const { return mFile != nullptr; }
+
+private:
+    struct Part
+    {
+        PartDesc desc;
+        uint32 linesPerChunk = 1;
+        uint32 numChunks = 0;
+        uint32 numChannels = 0;
+        uint32 submittedRows = 0;
+        uint64 offsetTablePosition = 0;         // position of the part's offset table in the file
+        Common::DynArray<uint64> chunkOffsets;
+    };
+
+    struct Chunk
+    {
+        uint32 partIndex;
+        uint32 chunkIndex;
+        Common::DynArray<uint8> data;           // compressed pixel data
+    };
+
+    // chunks submitted in a single WriteRows() call
+    struct Batch
+    {
+        Common::UniquePtr<Common::Waitable> waitable;
+        Common::DynArray<Chunk> chunks;
+    };
+
+    bool WriteHeader(const Part& part, uint32 partIndex);
+    bool WriteBatch(Batch& batch);
+    bool WriteData(const void* data, size_t size);
+
+    // convert and compress pixels of a single chunk
+    void EncodeChunk(const Part& part, Chunk& chunk) const;
+
+    FILE* mFile = nullptr;
+    uint64 mFilePosition = 0;
+    bool mMultiPart = false;
+    bool mError = false;
+    bool mHeadersWritten = false;   // Open() succeeded, so offset tables can be filled when closing
+
+    uint32 mWidth = 0;
+    uint32 mHeight = 0;
+
+    Common::DynArray<Part> mParts;
+    Common::DynArray<Common::UniquePtr<Batch>> mPendingBatches;
+    uint32 mFirstPendingBatch = 0;
+};
+
+} // namespace RT
+} // namespace NFE
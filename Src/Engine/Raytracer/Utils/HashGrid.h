@@ -17,7 +17,7 @@ public:
     NFE_FORCE_INLINE const Math::Box& GetBox() const { return mBox; }
 
     template<typename ParticleType>
-    NFE_FORCE_NOINLINE void Build(const Common::DynArray<ParticleType>& particles, float radius)
+    NFE_FORCE_NOINLINE void Build(const Common::ArrayView<ParticleType>& particles, float radius)
     {
         NFE_SCOPED_TIMER(HashGrid_Build);
 
@@ -74,7 +74,7 @@ public:
     }
 
     template<typename ParticleType, typename Query>
-    NFE_FORCE_NOINLINE void Process(const Math::Vec4f& queryPos, const Common::DynArray<ParticleType>& particles, Query& query) const
+    NFE_FORCE_NOINLINE void Process(const Math::Vec4f& queryPos, const Common::ArrayView<ParticleType>& particles, Query& query) const
     {
         if (mIndices.Empty())
         {
@@ -3,10 +3,10 @@
 #include "../Raytracer.h"
 
 #include "Memory.h"
-#include "../Common/System/Timer.hpp"
-#include "../Common/Logger/Logger.hpp"
-#include "../Common/Math/Box.hpp"
-#include "../Common/Containers/DynArray.hpp"
+#include "../../Common/System/Timer.hpp"
+#include "../../Common/Logger/Logger.hpp"
+#include "../../Common/Math/Box.hpp"
+#include "../../Common/Containers/DynArray.hpp"
 
 #include <numeric>
 
@@ -34,7 +34,7 @@ public:
     {}
 
     template<typename ParticleType>
-    NFE_FORCE_NOINLINE void Build(Common::DynArray<ParticleType>& particles)
+    NFE_FORCE_NOINLINE void Build(Common::ArrayView<ParticleType>& particles)
     {
         Common::Timer timer;
 
@@ -53,7 +53,7 @@ public:
     }
 
     template<typename ParticleType, typename Query>
-    void Find(const Math::Vec4f& queryPos, const float radius, const Common::DynArray<ParticleType>& particles, Query& query) const
+    void Find(const Math::Vec4f& queryPos, const float radius, const Common::ArrayView<ParticleType>& particles, Query& query) const
     {
         const Math::Box queryBox(queryPos, radius);
         const float sqrRadius = Math::Sqr(radius);
@@ -98,7 +98,7 @@ private:
     uint32 mNumGeneratedNodes = 0;
 
     template<typename ParticleType>
-    void BuildRecursive(Node& targetNode, Common::DynArray<ParticleType>& particles, uint32* indices, uint32 npoints, uint32 depth)
+    void BuildRecursive(Node& targetNode, Common::ArrayView<ParticleType>& particles, uint32* indices, uint32 npoints, uint32 depth)
     {
         const uint32 axis = depth % 3u; // TODO select longer axis?
         const uint32 mid = (npoints - 1) / 2;
@@ -0,0 +1,181 @@
+#include "PCH.h"
+#include "MajorantGrid.h"
+#include "Bitmap.h"
+#include "SparseBitmap3D.h"
+#include "../Common/Logger/Logger.hpp"
+#include "../Common/System/Timer.hpp"
+#include "../Common/Utils/TaskBuilder.hpp"
+#include "../Common/Utils/Waitable.hpp"
+
+namespace NFE {
+namespace RT {
+
+using namespace Common;
+using namespace Math;
+
+namespace {
+
+// compute range of texels influencing given cell
+// NOTE: the range is extended by one texel in each direction, as the texture is filtered
+// and neighbouring cells may be slightly mixed up due to floating point rounding
+void GetTexelRange(uint32 cell, uint32 numCells, uint32 numTexels, int32& outFirst, int32& outLast)
+{
+    outFirst = static_cast<int32>(cell * numTexels / numCells) - 1;
+    outLast = static_cast<int32>(((cell + 1) * numTexels + numCells - 1) / numCells);
+}
+
+uint32 WrapTexelCoord(int32 coord, uint32 size)
+{
+    return static_cast<uint32>(coord + static_cast<int32>(size)) % size;
+}
+
+} // namespace
+
+bool MajorantGrid::Init(const Vec4ui& size, const Vec4f& coordsScale, const Vec4f& coordsOffset, uint32 cellSize)
+{
+    NFE_ASSERT(cellSize > 0, "Invalid cell size");
+
+    if (size.x == 0 || size.y == 0 || size.z == 0)
+    {
+        NFE_LOG_ERROR("MajorantGrid: Empty bitmap");
+        return false;
+    }
+
+    mResolution = Vec4i(
+        static_cast<int32>((size.x + cellSize - 1) / cellSize),
+        static_cast<int32>((size.y + cellSize - 1) / cellSize),
+        static_cast<int32>((size.z + cellSize - 1) / cellSize),
+        0);
+
+    const Vec4f resolution = mResolution.ConvertToVec4f();
+    mScale = coordsScale * resolution;
+    mOffset = coordsOffset * resolution;
+
+    const uint32 numCells = static_cast<uint32>(mResolution.x * mResolution.y * mResolution.z);
+    if (!mValues.Resize(numCells))
+    {
+        NFE_LOG_ERROR("MajorantGrid: Failed to allocate %u cells", numCells);
+        return false;
+    }
+
+    return true;
+}
+
+bool MajorantGrid::Build(const Bitmap& bitmap, const Vec4f& coordsScale, const Vec4f& coordsOffset, uint32 cellSize)
+{
+    const Vec4ui size = bitmap.GetSize();
+    if (!Init(size, coordsScale, coordsOffset, cellSize))
+    {
+        return false;
+    }
+
+    Timer timer;
+
+    Waitable waitable;
+    {
+        TaskBuilder taskBuilder(waitable);
+        taskBuilder.ParallelFor("MajorantGrid/Build", static_cast<uint32>(mResolution.z), [&](const TaskContext&, uint32 cellZ)
+        {
+            int32 firstZ, lastZ;
+            GetTexelRange(cellZ, mResolution.z, size.z, firstZ, lastZ);
+
+            for (uint32 cellY = 0; cellY < static_cast<uint32>(mResolution.y); ++cellY)
+            {
+                int32 firstY, lastY;
+                GetTexelRange(cellY, mResolution.y, size.y, firstY, lastY);
+
+                for (uint32 cellX = 0; cellX < static_cast<uint32>(mResolution.x); ++cellX)
+                {
+                    int32 firstX, lastX;
+                    GetTexelRange(cellX, mResolution.x, size.x, firstX, lastX);
+
+                    float maxValue = 0.0f;
+                    for (int32 z = firstZ; z <= lastZ; ++z)
+                    {
+                        for (int32 y = firstY; y <= lastY; ++y)
+                        {
+                            for (int32 x = firstX; x <= lastX; ++x)
+                            {
+                                const Vec4f value = bitmap.GetPixel3D(WrapTexelCoord(x, size.x), WrapTexelCoord(y, size.y), WrapTexelCoord(z, size.z));
+                                maxValue = Max(maxValue, value.x, value.y, value.z);
+                            }
+                        }
+                    }
+
+                    mValues[cellX + mResolution.x * (cellY + mResolution.y * cellZ)] = maxValue;
+                }
+            }
+        });
+    }
+    waitable.Wait();
+
+    const float elapsedTime = static_cast<float>(1000.0 * timer.Stop());
+    NFE_LOG_INFO("Majorant grid for bitmap '%s' built in %.3fms: %ux%ux%u cells",
+        bitmap.GetDebugName(), elapsedTime, mResolution.x, mResolution.y, mResolution.z);
+
+    return true;
+}
+
+bool MajorantGrid::Build(const SparseBitmap3D& bitmap, const Vec4f& coordsScale, const Vec4f& coordsOffset, uint32 cellSize)
+{
+    const Vec4ui size = bitmap.GetSize();
+    if (!Init(size, coordsScale, coordsOffset, cellSize))
+    {
+        return false;
+    }
+
+    Timer timer;
+
+    // for each brick row/column/slice collect cells influenced by its texels (same texel ranges as for dense bitmaps)
+    DynArray<DynArray<uint32>> cellsPerBrick[3];
+    for (uint32 axis = 0; axis < 3; ++axis)
+    {
+        const uint32 numCells = static_cast<uint32>(mResolution[axis]);
+        cellsPerBrick[axis].Resize(bitmap.GetNumBricks()[axis]);
+
+        for (uint32 cell = 0; cell < numCells; ++cell)
+        {
+            int32 first, last;
+            GetTexelRange(cell, numCells, size[axis], first, last);
+
+            for (int32 texel = first; texel <= last; ++texel)
+            {
+                DynArray<uint32>& cells = cellsPerBrick[axis][WrapTexelCoord(texel, size[axis]) >> SparseBitmap3D::BrickSizeLog2];
+                if (cells.Empty() || cells.Back() != cell)
+                {
+                    cells.PushBack(cell);
+                }
+            }
+        }
+    }
+
+    // only allocated bricks contribute, the volume is zero elsewhere
+    for (float& value : mValues)
+    {
+        value = 0.0f;
+    }
+
+    bitmap.ForEachAllocatedBrick([&](uint32 brickX, uint32 brickY, uint32 brickZ, float maxValue)
+    {
+        for (const uint32 cellZ : cellsPerBrick[2][brickZ])
+        {
+            for (const uint32 cellY : cellsPerBrick[1][brickY])
+            {
+                for (const uint32 cellX : cellsPerBrick[0][brickX])
+                {
+                    float& cellValue = mValues[cellX + mResolution.x * (cellY + mResolution.y * cellZ)];
+                    cellValue = Max(cellValue, maxValue);
+                }
+            }
+        }
+    });
+
+    const float elapsedTime = static_cast<float>(1000.0 * timer.Stop());
+    NFE_LOG_INFO("Majorant grid for sparse bitmap '%s' built in %.3fms: %ux%ux%u cells, %u bricks",
+        bitmap.GetDebugName(), elapsedTime, mResolution.x, mResolution.y, mResolution.z, bitmap.GetNumAllocatedBricks());
+
+    return true;
+}
+
+} // namespace RT
+} // namespace NFE
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "../Raytracer.h"
+#include "../../Common/Math/Vec4f.hpp"
+#include "../../Common/Math/Vec4i.hpp"
+#include "../../Common/Containers/DynArray.hpp"
+
+namespace NFE {
+namespace RT {
+
+class Bitmap;
+class SparseBitmap3D;
+
+/**
+ * Coarse grid of local maximum values of a 3D density bitmap.
+ * Used to get tight majorants when tracking rays through heterogeneous media.
+ * The grid is periodic (wraps in all directions), just like the bitmap textures.
+ */
+class NFE_RAYTRACER_API NFE_ALIGN(16) MajorantGrid
+{
+public:
+    NFE_ALIGNED_CLASS(16)
+
+    static constexpr uint32 DefaultCellSize = 16; // in texels
+
+    // build grid from 3D bitmap
+    // texture coordinates are computed as: (point * coordsScale + coordsOffset), wrapped to 0..1 range
+    bool Build(const Bitmap& bitmap, const Math::Vec4f& coordsScale, const Math::Vec4f& coordsOffset, uint32 cellSize = DefaultCellSize);
+
+    // build grid from sparse 3D bitmap
+    // NOTE: only allocated bricks are visited and their maximum values are used,
+    // so the grid is a bit more conservative, but much faster to build
+    bool Build(const SparseBitmap3D& bitmap, const Math::Vec4f& coordsScale, const Math::Vec4f& coordsOffset, uint32 cellSize = DefaultCellSize);
+
+    NFE_FORCE_INLINE bool IsEmpty() const { return mValues.Empty(); }
+
+    // walk cells along a ray segment (3D DDA)
+    // callback is called for each visited cell with (segmentStart, segmentEnd, maxValue) and returns false to stop traversal
+    template<typename CallbackType>
+    void Traverse(const Math::Vec4f& origin, const Math::Vec4f& dir, float minDistance, float maxDistance, const CallbackType& callback) const;
+
+private:
+    // set up grid resolution and mapping for a bitmap of given size
+    bool Init(const Math::Vec4ui& size, const Math::Vec4f& coordsScale, const Math::Vec4f& coordsOffset, uint32 cellSize);
+
+    NFE_FORCE_INLINE float GetCellValue(int32 x, int32 y, int32 z) const
+    {
+        const uint32 wrappedX = static_cast<uint32>(x % mResolution.x + mResolution.x) % static_cast<uint32>(mResolution.x);
+        const uint32 wrappedY = static_cast<uint32>(y % mResolution.y + mResolution.y) % static_cast<uint32>(mResolution.y);
+        const uint32 wrappedZ = static_cast<uint32>(z % mResolution.z + mResolution.z) % static_cast<uint32>(mResolution.z);
+        return mValues[wrappedX + mResolution.x * (wrappedY + mResolution.y * wrappedZ)];
+    }
+
+    // maps point to grid space (one unit = one cell)
+    Math::Vec4f mScale = Math::Vec4f::Zero();
+    Math::Vec4f mOffset = Math::Vec4f::Zero();
+    Math::Vec4i mResolution = Math::Vec4i::Zero();
+    Common::DynArray<float> mValues;
+};
+
+template<typename CallbackType>
+void MajorantGrid::Traverse(const Math::Vec4f& origin, const Math::Vec4f& dir, float minDistance, float maxDistance, const CallbackType& callback) const
+{
+    NFE_ASSERT(!IsEmpty(), "Majorant grid is not built");
+
+    // transform the ray to grid space
+    // NOTE: the transformation is only a scale + offset, so distances along the ray are preserved
+    const Math::Vec4f gridDir = dir * mScale;
+    const Math::Vec4f startPoint = Math::Vec4f::MulAndAdd(origin, mScale, mOffset) + gridDir * minDistance;
+
+    int32 cell[3];
+    int32 step[3];
+    float nextCrossing[3];
+    float crossingDelta[3];
+
+    for (uint32 i = 0; i < 3; ++i)
+    {
+        const float cellCoord = floorf(startPoint[i]);
+        cell[i] = static_cast<int32>(cellCoord);
+
+        if (gridDir[i] > 0.0f)
+        {
+            step[i] = 1;
+            crossingDelta[i] = 1.0f / gridDir[i];
+            nextCrossing[i] = minDistance + (cellCoord + 1.0f - startPoint[i]) * crossingDelta[i];
+        }
+        else if (gridDir[i] < 0.0f)
+        {
+            step[i] = -1;
+            crossingDelta[i] = -1.0f / gridDir[i];
+            nextCrossing[i] = minDistance + (startPoint[i] - cellCoord) * crossingDelta[i];
+        }
+        else
+        {
+            step[i] = 0;
+            crossingDelta[i] = FLT_MAX;
+            nextCrossing[i] = FLT_MAX;
+        }
+    }
+
+    float t = minDistance;
+    while (t < maxDistance)
+    {
+        uint32 axis = nextCrossing[0] < nextCrossing[1] ? 0 : 1;
+        axis = nextCrossing[2] < nextCrossing[axis] ? 2 : axis;
+
+        const float segmentEnd = Math::Min(nextCrossing[axis], maxDistance);
+        if (!callback(t, segmentEnd, GetCellValue(cell[0], cell[1], cell[2])))
+        {
+            return;
+        }
+
+        t = segmentEnd;
+        cell[axis] += step[axis];
+        nextCrossing[axis] += crossingDelta[axis];
+    }
+}
+
+} // namespace RT
+} // namespace NFE
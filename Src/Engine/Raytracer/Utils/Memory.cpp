@@ -1,15 +1,57 @@
 #include "PCH.h"
 #include "Memory.h"
+#include "../Common/Logger/Logger.hpp"
+#include "../Common/Memory/DefaultAllocator.hpp"
+#include "../Common/Containers/HashMap.hpp"
+#include "../Common/System/Mutex.hpp"
+#include "../Common/Utils/ScopedLock.hpp"
+
+#if defined(NFE_PLATFORM_LINUX)
+#include <sys/mman.h>
+#endif // NFE_PLATFORM_LINUX
 
 
 namespace NFE {
 namespace RT {
 
-/*
+using namespace Common;
+
+namespace {
+
+// Regions mapped with large pages, indexed by the returned pointer.
+// NOTE: kept outside of the allocated memory, so a mapping does not need to grow by a page just to fit a header
+struct LargePageAllocations
+{
+    Mutex lock;
+    HashMap<void*, size_t> mappedSizes;
+};
+
+static bool gUseLargePages = false;
+static std::atomic<size_t> gLargePagesMemoryUsage = 0;
+
+// minimum alignment of large page mappings, so most of the pointers can be rejected without a lookup when freeing
+static constexpr size_t LargePageSize = 2u * 1024u * 1024u;
+
+#if defined(NFE_PLATFORM_LINUX)
+static constexpr size_t HugePageSize = 1024u * 1024u * 1024u;
+
+// 1GB pages are used only if at most 1/N of the mapped memory is wasted for rounding
+static constexpr size_t HugePageMaxWasteFraction = 8u;
+#endif // NFE_PLATFORM_LINUX
+
+// NOTE: intentionally never destroyed, so buffers can still be freed during static deinitialization
+static LargePageAllocations& GetLargePageAllocations()
+{
+    static LargePageAllocations* allocations = new LargePageAllocations;
+    return *allocations;
+}
+
+} // namespace
+
 
 #if defined(NFE_PLATFORM_WINDOWS)
 
-static bool TogglePrivilege(TCHAR* pszPrivilege, BOOL bEnable)
+static bool TogglePrivilege(const TCHAR* pszPrivilege, BOOL bEnable)
 {
     HANDLE hToken;
     TOKEN_PRIVILEGES tp;
@@ -25,6 +67,7 @@ static bool TogglePrivilege(TCHAR* pszPrivilege, BOOL bEnable)
     if (!LookupPrivilegeValue(NULL, pszPrivilege, &tp.Privileges[0].Luid))
     {
         NFE_LOG_ERROR("LookupPrivilegeValue failed, error code: %u", GetLastError());
+        CloseHandle(hToken);
         return false;
     }
 
@@ -42,11 +85,6 @@ static bool TogglePrivilege(TCHAR* pszPrivilege, BOOL bEnable)
     // It is possible for AdjustTokenPrivileges to return TRUE and still not succeed.
     // So always check for the last error value.
     DWORD error = GetLastError();
-    if (!status || (error != ERROR_SUCCESS))
-    {
-        NFE_LOG_WARNING("AdjustTokenPrivileges failed, error code: %u", error);
-        return false;
-    }
 
     // close the handle
     if (!CloseHandle(hToken))
@@ -55,68 +93,140 @@ static bool TogglePrivilege(TCHAR* pszPrivilege, BOOL bEnable)
         return false;
     }
 
+    if (!status || (error != ERROR_SUCCESS))
+    {
+        NFE_LOG_WARNING("AdjustTokenPrivileges failed, error code: %u", error);
+        return false;
+    }
+
     return true;
 }
 
-static void EnableLargePagesSupport()
+static bool EnableLargePagesSupport()
 {
     if (TogglePrivilege(TEXT("SeLockMemoryPrivilege"), TRUE))
     {
         NFE_LOG_INFO("Large page support enabled. Minimum large page size: %zu bytes", GetLargePageMinimum());
+        return true;
     }
-    else
+
+    NFE_LOG_WARNING("Failed to enable large page support");
+    return false;
+}
+
+static void* AllocateLargePages(size_t size, size_t& outMappedSize)
+{
+    const size_t largePageSize = ::GetLargePageMinimum();
+    if (largePageSize == 0 || size < largePageSize)
     {
-        NFE_LOG_WARNING("Failed to enable large page support");
+        return nullptr;
     }
-}
 
-#else
+    const size_t mappedSize = Math::RoundUp(size, largePageSize);
+    void* ptr = ::VirtualAlloc(NULL, mappedSize, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+    if (ptr)
+    {
+        outMappedSize = mappedSize;
+    }
+    return ptr;
+}
 
-static void EnableLargePagesSupport()
+static void FreeLargePages(void* ptr, size_t mappedSize)
 {
-    // TODO
+    NFE_UNUSED(mappedSize);
+    ::VirtualFree(ptr, 0, MEM_RELEASE);
 }
 
-#endif // NFE_PLATFORM_WINDOWS
+#elif defined(NFE_PLATFORM_LINUX)
 
-void InitMemory(const MemoryInitOptions& options)
+static bool EnableLargePagesSupport()
+{
+    // explicit huge pages must be reserved by the administrator (vm.nr_hugepages),
+    // otherwise transparent huge pages are requested with madvise()
+    NFE_LOG_INFO("Large page support enabled");
+    return true;
+}
+
+static void* MapExplicitLargePages(size_t size, size_t pageSize, int pageSizeFlags, size_t& outMappedSize)
 {
-    if (options.useLargePages)
+    const size_t mappedSize = Math::RoundUp(size, pageSize);
+    void* ptr = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | pageSizeFlags, -1, 0);
+    if (ptr == MAP_FAILED)
     {
-        EnableLargePagesSupport();
+        return nullptr;
     }
+
+    outMappedSize = mappedSize;
+    return ptr;
 }
 
-void* DefaultAllocator::Allocate(size_t size, size_t alignment)
+static void* AllocateLargePages(size_t size, size_t& outMappedSize)
 {
+    if (size < LargePageSize)
+    {
+        return nullptr;
+    }
+
     void* ptr = nullptr;
-#if defined(NFE_PLATFORM_WINDOWS)
-    ptr = _aligned_malloc(size, alignment);
-#elif defined(NFE_PLATFORM_LINUX)
-    alignment = std::max(alignment, sizeof(void*));
-    int ret = posix_memalign(&ptr, alignment, size);
-    if (ret != 0)
+
+#ifdef MAP_HUGE_1GB
+    // e.g. buffer slightly bigger than 1GB would take two 1GB pages
+    const size_t hugePagesWaste = Math::RoundUp(size, HugePageSize) - size;
+    if (size >= HugePageSize && hugePagesWaste <= size / HugePageMaxWasteFraction)
     {
-        NFE_ASSERT("posix_memalign() returned %i", ret);
-        ptr = nullptr;
+        ptr = MapExplicitLargePages(size, HugePageSize, MAP_HUGE_1GB, outMappedSize);
     }
-#else
-#error Invalid platform
-#endif
-    return ptr;
+#endif // MAP_HUGE_1GB
+
+    if (!ptr)
+    {
+        ptr = MapExplicitLargePages(size, LargePageSize, 0, outMappedSize);
+    }
+
+    if (ptr)
+    {
+        return ptr;
+    }
+
+    // fallback to transparent huge pages
+    // the region must be aligned to large page size, so map more and trim the excess
+    const size_t mappedSize = Math::RoundUp(size, LargePageSize);
+    uint8* region = static_cast<uint8*>(mmap(nullptr, mappedSize + LargePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (region == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    uint8* alignedRegion = reinterpret_cast<uint8*>(Math::RoundUp(reinterpret_cast<size_t>(region), LargePageSize));
+    const size_t headSize = alignedRegion - region;
+    if (headSize > 0)
+    {
+        munmap(region, headSize);
+    }
+    munmap(alignedRegion + mappedSize, LargePageSize - headSize);
+
+    if (madvise(alignedRegion, mappedSize, MADV_HUGEPAGE) != 0)
+    {
+        NFE_LOG_DEBUG("SystemAllocator: madvise(MADV_HUGEPAGE) failed, errno=%i", errno);
+    }
+
+    outMappedSize = mappedSize;
+    return alignedRegion;
 }
 
-void DefaultAllocator::Free(void* ptr)
+static void FreeLargePages(void* ptr, size_t mappedSize)
 {
-#if defined(NFE_PLATFORM_WINDOWS)
-    _aligned_free(ptr);
-#elif defined(NFE_PLATFORM_LINUX)
-    free(ptr);
+    munmap(ptr, mappedSize);
+}
+
 #else
 #error Invalid platform
-#endif
-}
+#endif // NFE_PLATFORM_WINDOWS
 
+void InitMemory(const MemoryInitOptions& options)
+{
+    gUseLargePages = options.useLargePages && EnableLargePagesSupport();
+}
 
 void* SystemAllocator::Allocate(size_t size, size_t alignment)
 {
@@ -125,68 +235,68 @@ void* SystemAllocator::Allocate(size_t size, size_t alignment)
         return nullptr;
     }
 
-    void* ptr = nullptr;
-
-#if defined(NFE_PLATFORM_WINDOWS)
+    NFE_ASSERT(Math::IsPowerOfTwo(alignment), "Invalid alignment");
 
-    if (size < 64u * 1024u)
+    // large page mappings are aligned to the page size
+    if (gUseLargePages && alignment <= LargePageSize)
     {
-        NFE_LOG_WARNING("SystemAllocator: Allocating less than 64KB is not optimal (requested %zu bytes)", size);
-    }
+        size_t mappedSize = 0;
+        if (void* ptr = AllocateLargePages(size, mappedSize))
+        {
+            NFE_ASSERT(reinterpret_cast<size_t>(ptr) % LargePageSize == 0, "Large page mapping is not aligned");
 
-    NFE_UNUSED(alignment);
+            LargePageAllocations& allocations = GetLargePageAllocations();
+            {
+                NFE_SCOPED_LOCK(allocations.lock);
+                allocations.mappedSizes.Insert(ptr, mappedSize);
+            }
 
-    // try large pages first
-    const size_t largePageMinNumpages = 4;
-    const size_t minLargePageSize = largePageMinNumpages * ::GetLargePageMinimum();
-    if (size >= minLargePageSize)
-    {
-        const size_t roundedSize = Math::RoundUp(size, minLargePageSize);
-        ptr = ::VirtualAlloc(NULL, roundedSize, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
-        if (ptr)
-        {
-            NFE_LOG_DEBUG("SystemAllocator: Allocated %.2f KB using (via large pages)", size / 1024.0);
+            gLargePagesMemoryUsage += mappedSize;
+            NFE_LOG_DEBUG("SystemAllocator: Allocated %.2f KB using large pages (%.2f KB mapped)", size / 1024.0, mappedSize / 1024.0);
+            return ptr;
         }
     }
 
+    return NFE_MALLOC(size, alignment);
+}
+
+void SystemAllocator::Free(void* ptr)
+{
     if (!ptr)
     {
-        ptr = ::VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
-        if (ptr)
+        return;
+    }
+
+    if (reinterpret_cast<size_t>(ptr) % LargePageSize == 0)
+    {
+        size_t mappedSize = 0;
+
+        LargePageAllocations& allocations = GetLargePageAllocations();
         {
-            NFE_LOG_DEBUG("SystemAllocator: Allocated %.2f KB", size / 1024.0);
+            NFE_SCOPED_LOCK(allocations.lock);
+            const auto iter = allocations.mappedSizes.Find(ptr);
+            if (iter != allocations.mappedSizes.End())
+            {
+                mappedSize = iter->second;
+                allocations.mappedSizes.Erase(iter);
+            }
         }
-        else
+
+        if (mappedSize > 0)
         {
-            NFE_LOG_ERROR("SystemAllocator: Failed to allocate %.2f KB, error code: %u", size / 1024.0, GetLastError());
+            gLargePagesMemoryUsage -= mappedSize;
+            FreeLargePages(ptr, mappedSize);
+            return;
         }
     }
 
-#elif defined(NFE_PLATFORM_LINUX)
-
-    // TODO
-    DefaultAllocator::Allocate(size, alignment);
-
-#else
-#error Invalid platform
-#endif
-    
-    return ptr;
+    NFE_FREE(ptr);
 }
 
-void SystemAllocator::Free(void* ptr)
+size_t SystemAllocator::GetLargePagesMemoryUsage()
 {
-#if defined(NFE_PLATFORM_WINDOWS)
-    ::VirtualFree(ptr, 0, MEM_RELEASE);
-#elif defined(NFE_PLATFORM_LINUX)
-    // TODO
-    DefaultAllocator::Free(ptr);
-#else
-#error Invalid platform
-#endif
+    return gLargePagesMemoryUsage;
 }
 
-*/
-
 } // namespace RT
 } // namespace NFE
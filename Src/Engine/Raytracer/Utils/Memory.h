@@ -1,6 +1,8 @@
 #pragma once
 
 #include "../Raytracer.h"
+#include "../../Common/Containers/ArrayView.hpp"
+#include "../../Common/Math/Math.hpp"
 
 #include <stdlib.h>
 #include <malloc.h>
@@ -8,147 +10,128 @@
 namespace NFE {
 namespace RT {
 
-/*
-
 struct MemoryInitOptions
 {
+    // allocate big buffers (BVH nodes, vertex buffers, bitmaps, photons) using large pages (2MB or 1GB) to reduce TLB misses
     bool useLargePages = false;
 };
 
 NFE_RAYTRACER_API void InitMemory(const MemoryInitOptions& options = MemoryInitOptions());
 
-class DefaultAllocator
-{
-public:
-    NFE_RAYTRACER_API static void* Allocate(size_t size, size_t alignment = 1);
-    NFE_RAYTRACER_API static void Free(void* ptr);
-};
-
+// Allocator for big, long-living buffers.
+// Memory is allocated directly from the system, using large pages if enabled (see MemoryInitOptions).
+// Falls back to the default allocator if large pages are disabled, not available or the buffer is small.
 class SystemAllocator
 {
 public:
-    NFE_RAYTRACER_API static void* Allocate(size_t size, size_t alignment = 1);
+    NFE_RAYTRACER_API static void* Allocate(size_t size, size_t alignment = NFE_CACHE_LINE_SIZE);
     NFE_RAYTRACER_API static void Free(void* ptr);
-};
-
-// Override this class to align children objects.
-template <size_t Alignment, typename Allocator = DefaultAllocator>
-class Aligned
-{
-public:
-    NFE_FORCE_INLINE void* operator new(size_t size)
-    {
-        return Allocator::Allocate(size, Alignment);
-    }
-
-    NFE_FORCE_INLINE void operator delete(void* ptr)
-    {
-        Allocator::Free(ptr);
-    }
-
-    NFE_FORCE_INLINE void* operator new[](size_t size)
-    {
-        return Allocator::Allocate(size, Alignment);
-    }
-
-    NFE_FORCE_INLINE void operator delete[](void* ptr)
-    {
-        Allocator::Free(ptr);
-    }
 
-        NFE_FORCE_INLINE void* operator new(size_t size, void* ptr)
-    {
-        NFE_UNUSED(size);
-        return ptr;
-    }
-
-    NFE_FORCE_INLINE void* operator new[](size_t size, void* ptr)
-    {
-        NFE_UNUSED(size);
-        return ptr;
-    }
+    // get number of bytes currently allocated using large pages
+    NFE_RAYTRACER_API static size_t GetLargePagesMemoryUsage();
 };
 
-template <typename T, std::size_t N = alignof(T), typename Allocator = DefaultAllocator>
-class AlignedAllocator
+// Array of trivial elements allocated with SystemAllocator.
+// NOTE: elements are not initialized on resize
+template<typename ElementType>
+class LargeArray : public Common::ArrayView<ElementType>
 {
-public:
-    typedef T value_type;
-    typedef std::size_t size_type;
-    typedef std::ptrdiff_t difference_type;
+    NFE_MAKE_NONCOPYABLE(LargeArray)
 
-    typedef T * pointer;
-    typedef const T * const_pointer;
-
-    typedef T & reference;
-    typedef const T & const_reference;
+    static_assert(std::is_trivially_copyable_v<ElementType>, "Large array element must be trivially copyable");
+    static_assert(std::is_trivially_destructible_v<ElementType>, "Large array element must be trivially destructible");
 
 public:
-    AlignedAllocator() throw () { }
-
-    template <typename T2>
-    AlignedAllocator(const AlignedAllocator<T2, N> &) throw () { }
-
-    ~AlignedAllocator() throw () { }
+    LargeArray() = default;
 
-    pointer adress(reference r)
+    LargeArray(LargeArray&& other)
+        : Common::ArrayView<ElementType>(other.mElements, other.mSize)
+        , mCapacity(other.mCapacity)
     {
-        return &r;
+        other.mElements = nullptr;
+        other.mSize = 0;
+        other.mCapacity = 0;
     }
 
-    const_pointer adress(const_reference r) const
+    LargeArray& operator = (LargeArray&& other)
     {
-        return &r;
+        if (this != &other)
+        {
+            Clear();
+            std::swap(this->mElements, other.mElements);
+            std::swap(this->mSize, other.mSize);
+            std::swap(mCapacity, other.mCapacity);
+        }
+        return *this;
     }
 
-    pointer allocate(size_type n)
+    ~LargeArray()
     {
-        return (pointer)Allocator::Allocate(n * sizeof(value_type), N);
+        Clear();
     }
 
-    void deallocate(pointer p, size_type)
-    {
-        Allocator::Free(p);
-    }
+    NFE_FORCE_INLINE uint32 Capacity() const { return mCapacity; }
 
-    void construct(pointer p, const value_type & wert)
+    // change size of the array, memory is reallocated only if the capacity is not sufficient
+    bool Resize(uint32 newSize)
     {
-        new (p) value_type(wert);
-    }
+        if (newSize > mCapacity && !Reallocate(newSize))
+        {
+            return false;
+        }
 
-    void construct(pointer p, value_type&& wert)
-    {
-        new (p) value_type(std::move(wert));
+        this->mSize = newSize;
+        return true;
     }
 
-    void destroy(pointer p)
+    // release unused memory
+    bool ShrinkToFit()
     {
-        p->~value_type();
+        if (this->mSize == mCapacity)
+        {
+            return true;
+        }
+
+        if (this->mSize == 0)
+        {
+            Clear();
+            return true;
+        }
+
+        return Reallocate(this->mSize);
     }
 
-    size_type max_size() const throw ()
+    void Clear()
     {
-        return size_type(-1) / sizeof(value_type);
+        SystemAllocator::Free(this->mElements);
+        this->mElements = nullptr;
+        this->mSize = 0;
+        mCapacity = 0;
     }
 
-    template <typename T2>
-    struct rebind
+private:
+    bool Reallocate(uint32 newCapacity)
     {
-        typedef AlignedAllocator<T2, N> other;
-    };
+        ElementType* newElements = static_cast<ElementType*>(SystemAllocator::Allocate(
+            sizeof(ElementType) * (size_t)newCapacity, Math::Max<size_t>(alignof(ElementType), NFE_CACHE_LINE_SIZE)));
+        if (!newElements)
+        {
+            return false;
+        }
 
-    bool operator!=(const AlignedAllocator<T, N>& other) const
-    {
-        return !(*this == other);
-    }
+        if (this->mElements)
+        {
+            memcpy(newElements, this->mElements, sizeof(ElementType) * (size_t)Math::Min(this->mSize, newCapacity));
+            SystemAllocator::Free(this->mElements);
+        }
 
-    bool operator==(const AlignedAllocator<T, N>&) const
-    {
+        this->mElements = newElements;
+        mCapacity = newCapacity;
         return true;
     }
-};
 
-*/
+    uint32 mCapacity = 0;
+};
 
 } // namespace RT
 } // namespace NFE
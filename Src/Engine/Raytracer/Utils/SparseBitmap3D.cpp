@@ -0,0 +1,348 @@
+#include "PCH.h"
+#include "SparseBitmap3D.h"
+#include "../Common/Logger/Logger.hpp"
+#include "../Common/System/Timer.hpp"
+
+#ifdef USE_OPENVDB
+#include <openvdb/openvdb.h>
+#endif // USE_OPENVDB
+
+namespace NFE {
+namespace RT {
+
+using namespace Common;
+using namespace Math;
+
+SparseBitmap3D::SparseBitmap3D(const char* debugName)
+    : mNumAllocatedBricks(0)
+    , mBytesPerTexel(0)
+    , mBrickDataSize(0)
+    , mFormat(Bitmap::Format::Unknown)
+{
+    mDebugName = strdup(debugName);
+}
+
+SparseBitmap3D::~SparseBitmap3D()
+{
+    Release();
+    free(mDebugName);
+}
+
+void SparseBitmap3D::Release()
+{
+    mBrickIndices.Clear(true);
+    mBrickPages.Clear(true);
+    mBrickMaxValues.Clear(true);
+    mNumAllocatedBricks = 0;
+    mSize = Vec4ui::Zero();
+    mFloatSize = Vec4f::Zero();
+    mNumBricks = Vec4ui::Zero();
+}
+
+size_t SparseBitmap3D::GetMemorySize() const
+{
+    return static_cast<size_t>(mBrickPages.Size()) * BricksPerPage * mBrickDataSize +
+        static_cast<size_t>(mBrickIndices.Size()) * sizeof(uint32) +
+        static_cast<size_t>(mBrickMaxValues.Size()) * sizeof(float);
+}
+
+bool SparseBitmap3D::Init(uint32 width, uint32 height, uint32 depth, Bitmap::Format format)
+{
+    Release();
+
+    if (format != Bitmap::Format::R8_UNorm && format != Bitmap::Format::R16_UNorm && format != Bitmap::Format::R32_Float)
+    {
+        NFE_LOG_ERROR("SparseBitmap3D: Unsupported format: %s", Bitmap::FormatToString(format));
+        return false;
+    }
+
+    if (width == 0 || height == 0 || depth == 0)
+    {
+        NFE_LOG_ERROR("SparseBitmap3D: Invalid size (%ux%ux%u)", width, height, depth);
+        return false;
+    }
+
+    const uint64 numBricksX = (width + BrickSize - 1) >> BrickSizeLog2;
+    const uint64 numBricksY = (height + BrickSize - 1) >> BrickSizeLog2;
+    const uint64 numBricksZ = (depth + BrickSize - 1) >> BrickSizeLog2;
+    const uint64 numBricks = numBricksX * numBricksY * numBricksZ;
+    if (numBricks >= static_cast<uint64>(InvalidBrick))
+    {
+        NFE_LOG_ERROR("SparseBitmap3D: Volume is too big (%ux%ux%u)", width, height, depth);
+        return false;
+    }
+
+    if (!mBrickIndices.Resize(static_cast<uint32>(numBricks), InvalidBrick))
+    {
+        NFE_LOG_ERROR("SparseBitmap3D: Failed to allocate brick index (%llu bricks)", numBricks);
+        return false;
+    }
+
+    mSize = Vec4ui(width, height, depth, 0);
+    mFloatSize = Vec4f(static_cast<float>(width), static_cast<float>(height), static_cast<float>(depth), 0.0f);
+    mNumBricks = Vec4ui(static_cast<uint32>(numBricksX), static_cast<uint32>(numBricksY), static_cast<uint32>(numBricksZ), 0);
+    mFormat = format;
+    mBytesPerTexel = Bitmap::BitsPerPixel(format) / 8;
+    mBrickDataSize = TexelsPerBrick * mBytesPerTexel;
+
+    return true;
+}
+
+uint32 SparseBitmap3D::AllocateBrick()
+{
+    const uint32 brickIndex = mNumAllocatedBricks++;
+
+    if ((brickIndex >> BricksPerPageLog2) >= mBrickPages.Size())
+    {
+        const size_t pageSize = static_cast<size_t>(BricksPerPage) * mBrickDataSize;
+        UniquePtr<uint8[]> page = MakeUniquePtr<uint8[]>(pageSize);
+        NFE_ASSERT(page, "Failed to allocate brick page");
+        memset(page.Get(), 0, pageSize);
+        mBrickPages.PushBack(std::move(page));
+    }
+
+    return brickIndex;
+}
+
+float SparseBitmap3D::DecodeTexel(const uint8* data) const
+{
+    switch (mFormat)
+    {
+    case Bitmap::Format::R8_UNorm:
+        return static_cast<float>(*data) * (1.0f / 255.0f);
+    case Bitmap::Format::R16_UNorm:
+        return static_cast<float>(*reinterpret_cast<const uint16*>(data)) * (1.0f / 65535.0f);
+    case Bitmap::Format::R32_Float:
+        return *reinterpret_cast<const float*>(data);
+    default:
+        NFE_FATAL("Unsupported bitmap format");
+    }
+
+    return 0.0f;
+}
+
+void SparseBitmap3D::Finalize()
+{
+    mBrickMaxValues.Resize(mNumAllocatedBricks);
+
+    for (uint32 brickIndex = 0; brickIndex < mNumAllocatedBricks; ++brickIndex)
+    {
+        const uint8* brickData = GetBrickData(brickIndex);
+
+        float maxValue = 0.0f;
+        for (uint32 i = 0; i < TexelsPerBrick; ++i)
+        {
+            maxValue = Max(maxValue, DecodeTexel(brickData + i * mBytesPerTexel));
+        }
+        mBrickMaxValues[brickIndex] = maxValue;
+    }
+}
+
+bool SparseBitmap3D::FromBitmap(const Bitmap& bitmap)
+{
+    const Vec4ui size = bitmap.GetSize();
+
+    if (!Init(size.x, size.y, size.z, bitmap.GetFormat()))
+    {
+        return false;
+    }
+
+    Timer timer;
+
+    const uint8* data = bitmap.GetData();
+    const size_t stride = bitmap.GetStride();
+
+    for (uint32 brickZ = 0; brickZ < mNumBricks.z; ++brickZ)
+    {
+        for (uint32 brickY = 0; brickY < mNumBricks.y; ++brickY)
+        {
+            for (uint32 brickX = 0; brickX < mNumBricks.x; ++brickX)
+            {
+                const uint32 firstX = brickX << BrickSizeLog2;
+                const uint32 firstY = brickY << BrickSizeLog2;
+                const uint32 firstZ = brickZ << BrickSizeLog2;
+                const uint32 lastX = Min(firstX + BrickSize, size.x);
+                const uint32 lastY = Min(firstY + BrickSize, size.y);
+                const uint32 lastZ = Min(firstZ + BrickSize, size.z);
+                const size_t rowSize = (lastX - firstX) * mBytesPerTexel;
+
+                // check if the brick contains any non-zero texel
+                bool isEmpty = true;
+                for (uint32 z = firstZ; z < lastZ && isEmpty; ++z)
+                {
+                    for (uint32 y = firstY; y < lastY && isEmpty; ++y)
+                    {
+                        const uint8* row = data + stride * (y + static_cast<size_t>(size.y) * z) + firstX * mBytesPerTexel;
+                        for (size_t i = 0; i < rowSize; ++i)
+                        {
+                            if (row[i] != 0)
+                            {
+                                isEmpty = false;
+                                break;
+                            }
+                        }
+                    }
+                }
+
+                if (isEmpty)
+                {
+                    continue;
+                }
+
+                const uint32 brickIndex = AllocateBrick();
+                mBrickIndices[brickX + mNumBricks.x * (brickY + mNumBricks.y * brickZ)] = brickIndex;
+
+                uint8* brickData = GetBrickData(brickIndex);
+                for (uint32 z = firstZ; z < lastZ; ++z)
+                {
+                    for (uint32 y = firstY; y < lastY; ++y)
+                    {
+                        const uint8* row = data + stride * (y + static_cast<size_t>(size.y) * z) + firstX * mBytesPerTexel;
+                        memcpy(brickData + GetTexelIndexInBrick(firstX, y, z) * mBytesPerTexel, row, rowSize);
+                    }
+                }
+            }
+        }
+    }
+
+    Finalize();
+
+    const float elapsedTime = static_cast<float>(1000.0 * timer.Stop());
+    NFE_LOG_INFO("SparseBitmap3D: Converted bitmap '%s' in %.3fms: %u of %u bricks allocated, %.2f MB",
+        bitmap.GetDebugName(), elapsedTime, mNumAllocatedBricks, mBrickIndices.Size(),
+        static_cast<float>(GetMemorySize()) / (1024.0f * 1024.0f));
+
+    return true;
+}
+
+bool SparseBitmap3D::LoadVDB(const char* path)
+{
+#ifdef USE_OPENVDB
+    Timer timer;
+
+    openvdb::io::File file(path);
+    if (!file.open())
+    {
+        NFE_LOG_ERROR("SparseBitmap3D: Failed to open VDB file '%s'", path);
+        return false;
+    }
+
+    openvdb::GridBase::Ptr baseGrid;
+    for (openvdb::io::File::NameIterator nameIter = file.beginName(); nameIter != file.endName(); ++nameIter)
+    {
+        baseGrid = file.readGrid(nameIter.gridName());
+        NFE_LOG_INFO("SparseBitmap3D: Found grid: %s", nameIter.gridName().c_str());
+    }
+
+    file.close();
+
+    if (!baseGrid)
+    {
+        NFE_LOG_ERROR("SparseBitmap3D: No grids found in VDB file '%s'", path);
+        return false;
+    }
+
+    if (baseGrid->valueType() != "float")
+    {
+        NFE_LOG_ERROR("SparseBitmap3D: Unsupported VDB format in file '%s': %s", path, baseGrid->valueType().c_str());
+        return false;
+    }
+
+    const openvdb::CoordBBox box = baseGrid->evalActiveVoxelBoundingBox();
+    const int64 width = static_cast<int64>(box.max().x()) - box.min().x() + 1;
+    const int64 height = static_cast<int64>(box.max().y()) - box.min().y() + 1;
+    const int64 depth = static_cast<int64>(box.max().z()) - box.min().z() + 1;
+    if (width < 1 || height < 1 || depth < 1 ||
+        width > UINT32_MAX || height > UINT32_MAX || depth > UINT32_MAX)
+    {
+        NFE_LOG_ERROR("SparseBitmap3D: Unsupported VDB file '%s': dimensions are out of bounds", path);
+        return false;
+    }
+
+    if (!Init(static_cast<uint32>(width), static_cast<uint32>(height), static_cast<uint32>(depth), Bitmap::Format::R8_UNorm))
+    {
+        return false;
+    }
+
+    openvdb::FloatGrid::Ptr grid = openvdb::gridPtrCast<openvdb::FloatGrid>(baseGrid);
+    for (openvdb::FloatGrid::ValueOnCIter iter = grid->cbeginValueOn(); iter; ++iter)
+    {
+        const uint8 value = static_cast<uint8>(Clamp(iter.getValue(), 0.0f, 1.0f) * 255.0f + 0.5f);
+        if (value == 0)
+        {
+            continue;
+        }
+
+        const openvdb::Coord coord = iter.getCoord() - box.min();
+        GetTexelRef<uint8>(coord.x(), coord.y(), coord.z()) = value;
+    }
+
+    Finalize();
+
+    const float elapsedTime = static_cast<float>(1000.0 * timer.Stop());
+    NFE_LOG_INFO("SparseBitmap3D: Loaded '%s' in %.3fms: %ux%ux%u, %u of %u bricks allocated, %.2f MB",
+        path, elapsedTime, mSize.x, mSize.y, mSize.z, mNumAllocatedBricks, mBrickIndices.Size(),
+        static_cast<float>(GetMemorySize()) / (1024.0f * 1024.0f));
+
+    return true;
+
+#else
+
+    NFE_LOG_ERROR("SparseBitmap3D: Can't load '%s', OpenVDB support is disabled", path);
+
+    return false;
+
+#endif // USE_OPENVDB
+}
+
+const Vec4f SparseBitmap3D::GetPixel3D(uint32 x, uint32 y, uint32 z) const
+{
+    NFE_ASSERT(x < GetWidth(), "");
+    NFE_ASSERT(y < GetHeight(), "");
+    NFE_ASSERT(z < GetDepth(), "");
+
+    const uint8* data = GetTexelData(x, y, z);
+    return data ? Vec4f(DecodeTexel(data)) : Vec4f::Zero();
+}
+
+void SparseBitmap3D::GetPixelBlock3D(const Vec4ui coordsA, const Vec4ui coordsB, Vec4f* outColors) const
+{
+    NFE_ASSERT((coordsA < mSize).All3(), "");
+    NFE_ASSERT((coordsB < mSize).All3(), "");
+
+    // fast path: whole block lies inside a single brick
+    if (GetBrickIndex(coordsA.x, coordsA.y, coordsA.z) == GetBrickIndex(coordsB.x, coordsB.y, coordsB.z))
+    {
+        const uint32 brickIndex = mBrickIndices[GetBrickIndex(coordsA.x, coordsA.y, coordsA.z)];
+        if (brickIndex == InvalidBrick)
+        {
+            for (uint32 i = 0; i < 8u; ++i)
+            {
+                outColors[i] = Vec4f::Zero();
+            }
+            return;
+        }
+
+        const uint8* brickData = GetBrickData(brickIndex);
+        for (uint32 i = 0; i < 8u; ++i)
+        {
+            const uint32 x = (i & 1) ? coordsB.x : coordsA.x;
+            const uint32 y = (i & 2) ? coordsB.y : coordsA.y;
+            const uint32 z = (i & 4) ? coordsB.z : coordsA.z;
+            outColors[i] = Vec4f(DecodeTexel(brickData + GetTexelIndexInBrick(x, y, z) * mBytesPerTexel));
+        }
+        return;
+    }
+
+    for (uint32 i = 0; i < 8u; ++i)
+    {
+        const uint32 x = (i & 1) ? coordsB.x : coordsA.x;
+        const uint32 y = (i & 2) ? coordsB.y : coordsA.y;
+        const uint32 z = (i & 4) ? coordsB.z : coordsA.z;
+        const uint8* data = GetTexelData(x, y, z);
+        outColors[i] = data ? Vec4f(DecodeTexel(data)) : Vec4f::Zero();
+    }
+}
+
+} // namespace RT
+} // namespace NFE
@@ -0,0 +1,158 @@
+#pragma once
+
+#include "Bitmap.h"
+#include "../../Common/Containers/DynArray.hpp"
+#include "../../Common/Containers/UniquePtr.hpp"
+#include "../../Common/Containers/SharedPtr.hpp"
+
+namespace NFE {
+namespace RT {
+
+/**
+ * Sparse 3D bitmap.
+ * The volume is split into small bricks and only bricks containing non-zero texels are stored.
+ * Texels of missing bricks are implicitly zero.
+ * Supported formats: R8_UNorm, R16_UNorm, R32_Float.
+ */
+class NFE_RAYTRACER_API NFE_ALIGN(16) SparseBitmap3D
+{
+    NFE_MAKE_NONCOPYABLE(SparseBitmap3D)
+    NFE_MAKE_NONMOVEABLE(SparseBitmap3D)
+
+public:
+    NFE_ALIGNED_CLASS(16)
+
+    static constexpr uint32 BrickSizeLog2 = 3;
+    static constexpr uint32 BrickSize = 1u << BrickSizeLog2; // in texels
+    static constexpr uint32 TexelsPerBrick = BrickSize * BrickSize * BrickSize;
+    static constexpr uint32 InvalidBrick = UINT32_MAX;
+
+    SparseBitmap3D(const char* debugName = "<unnamed>");
+    ~SparseBitmap3D();
+
+    NFE_FORCE_INLINE const char* GetDebugName() const { return mDebugName; }
+    NFE_FORCE_INLINE const Math::Vec4ui& GetSize() const { return mSize; }
+    NFE_FORCE_INLINE const Math::Vec4f& GetFloatSize() const { return mFloatSize; }
+    NFE_FORCE_INLINE uint32 GetWidth() const { return mSize.x; }
+    NFE_FORCE_INLINE uint32 GetHeight() const { return mSize.y; }
+    NFE_FORCE_INLINE uint32 GetDepth() const { return mSize.z; }
+    NFE_FORCE_INLINE Bitmap::Format GetFormat() const { return mFormat; }
+    NFE_FORCE_INLINE const Math::Vec4ui& GetNumBricks() const { return mNumBricks; }
+    NFE_FORCE_INLINE uint32 GetNumAllocatedBricks() const { return mNumAllocatedBricks; }
+
+    // amount of memory used by bricks and the brick index
+    size_t GetMemorySize() const;
+
+    // initialize empty volume
+    bool Init(uint32 width, uint32 height, uint32 depth, Bitmap::Format format);
+
+    // convert dense 3D bitmap, bricks containing only zeros are dropped
+    bool FromBitmap(const Bitmap& bitmap);
+
+    // load density grid from OpenVDB file
+    bool LoadVDB(const char* path);
+
+    // get texel for writing, allocates the brick if necessary
+    // NOTE: Finalize() must be called after all the texels are written
+    template<typename T>
+    NFE_FORCE_INLINE T& GetTexelRef(uint32 x, uint32 y, uint32 z)
+    {
+        NFE_ASSERT(Bitmap::BitsPerPixel(mFormat) / 8 == sizeof(T), "");
+        uint32& brickIndex = mBrickIndices[GetBrickIndex(x, y, z)];
+        if (brickIndex == InvalidBrick)
+        {
+            brickIndex = AllocateBrick();
+        }
+        return reinterpret_cast<T*>(GetBrickData(brickIndex))[GetTexelIndexInBrick(x, y, z)];
+    }
+
+    // update per-brick maximum values
+    void Finalize();
+
+    // get single pixel
+    const Math::Vec4f GetPixel3D(uint32 x, uint32 y, uint32 z) const;
+
+    // get 2x2x2 pixel block (same ordering as Bitmap::GetPixelBlock3D)
+    void GetPixelBlock3D(const Math::Vec4ui coordsA, const Math::Vec4ui coordsB, Math::Vec4f* outColors) const;
+
+    // maximum value stored in a brick (zero for missing bricks)
+    NFE_FORCE_INLINE float GetBrickMaxValue(uint32 brickX, uint32 brickY, uint32 brickZ) const
+    {
+        const uint32 brickIndex = mBrickIndices[brickX + mNumBricks.x * (brickY + mNumBricks.y * brickZ)];
+        return brickIndex == InvalidBrick ? 0.0f : mBrickMaxValues[brickIndex];
+    }
+
+    // call func(brickX, brickY, brickZ, maxValue) for each allocated brick
+    template<typename FuncType>
+    void ForEachAllocatedBrick(const FuncType& func) const
+    {
+        uint32 index = 0;
+        for (uint32 brickZ = 0; brickZ < mNumBricks.z; ++brickZ)
+        {
+            for (uint32 brickY = 0; brickY < mNumBricks.y; ++brickY)
+            {
+                for (uint32 brickX = 0; brickX < mNumBricks.x; ++brickX, ++index)
+                {
+                    const uint32 brickIndex = mBrickIndices[index];
+                    if (brickIndex != InvalidBrick)
+                    {
+                        func(brickX, brickY, brickZ, mBrickMaxValues[brickIndex]);
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr uint32 BricksPerPageLog2 = 8;
+    static constexpr uint32 BricksPerPage = 1u << BricksPerPageLog2;
+
+    NFE_FORCE_INLINE uint32 GetBrickIndex(uint32 x, uint32 y, uint32 z) const
+    {
+        return (x >> BrickSizeLog2) + mNumBricks.x * ((y >> BrickSizeLog2) + mNumBricks.y * (z >> BrickSizeLog2));
+    }
+
+    NFE_FORCE_INLINE static uint32 GetTexelIndexInBrick(uint32 x, uint32 y, uint32 z)
+    {
+        constexpr uint32 mask = BrickSize - 1;
+        return (x & mask) | ((y & mask) << BrickSizeLog2) | ((z & mask) << (2 * BrickSizeLog2));
+    }
+
+    NFE_FORCE_INLINE uint8* GetBrickData(uint32 brickIndex) const
+    {
+        return mBrickPages[brickIndex >> BricksPerPageLog2].Get() + (brickIndex & (BricksPerPage - 1)) * mBrickDataSize;
+    }
+
+    // returns texel data pointer or nullptr if the texel lies in a missing brick
+    NFE_FORCE_INLINE const uint8* GetTexelData(uint32 x, uint32 y, uint32 z) const
+    {
+        const uint32 brickIndex = mBrickIndices[GetBrickIndex(x, y, z)];
+        if (brickIndex == InvalidBrick)
+        {
+            return nullptr;
+        }
+        return GetBrickData(brickIndex) + GetTexelIndexInBrick(x, y, z) * mBytesPerTexel;
+    }
+
+    float DecodeTexel(const uint8* data) const;
+
+    uint32 AllocateBrick();
+    void Release();
+
+    Math::Vec4ui mSize = Math::Vec4ui::Zero();
+    Math::Vec4f mFloatSize = Math::Vec4f::Zero();
+    Math::Vec4ui mNumBricks = Math::Vec4ui::Zero();
+    char* mDebugName;
+    Common::DynArray<uint32> mBrickIndices;
+    Common::DynArray<Common::UniquePtr<uint8[]>> mBrickPages;
+    Common::DynArray<float> mBrickMaxValues;
+    uint32 mNumAllocatedBricks;
+    uint32 mBytesPerTexel;
+    uint32 mBrickDataSize;
+    Bitmap::Format mFormat;
+};
+
+using SparseBitmap3DPtr = Common::SharedPtr<SparseBitmap3D>;
+
+} // namespace RT
+} // namespace NFE
@@ -0,0 +1,755 @@
+#include "PCH.h"
+#include "TextureCache.h"
+#include "../Common/Logger/Logger.hpp"
+#include "../Common/FileSystem/FileSystem.hpp"
+#include "../Common/System/Timer.hpp"
+#include "../Common/Utils/ScopedLock.hpp"
+
+namespace NFE {
+namespace RT {
+
+using namespace Common;
+using namespace Math;
+
+namespace {
+
+static constexpr uint32 TileFileMagic = 'NFTC';
+static constexpr uint32 TileFileVersion = 1;
+
+struct TileFileHeader
+{
+    uint32 magic;
+    uint32 version;
+    uint64 sourceSize;
+    uint64 sourceTime;
+    uint32 width;
+    uint32 height;
+    uint32 tileSize;
+    uint32 paletteSize;
+    uint32 format;
+    uint32 padding;
+};
+
+NFE_FORCE_INLINE uint32 GetBlockDimension(Bitmap::Format format)
+{
+    switch (format)
+    {
+    case Bitmap::Format::BC1:
+    case Bitmap::Format::BC1_sRGB:
+    case Bitmap::Format::BC4:
+    case Bitmap::Format::BC5:
+        return 4;
+    }
+    return 1;
+}
+
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////
+
+struct TextureCache::ThreadState
+{
+    static constexpr uint32 NumEntries = 64;
+
+    struct Entry
+    {
+        const TiledBitmap* owner = nullptr;
+        const TextureCache::Tile* tile = nullptr;
+        uint32 tileIndex = 0;
+        uint32 epoch = 0;
+    };
+
+    // direct-mapped cache of recently used tiles
+    // NOTE: this way the hot path does not touch any shared cache lines
+    Entry entries[NumEntries];
+
+    // epoch observed by the thread while sampling textures, zero if the thread is not sampling
+    std::atomic<uint32> activeEpoch = 0;
+
+    // number of nested access scopes and the epoch announced by the outermost one
+    uint32 scopeDepth = 0;
+    uint32 scopeEpoch = 0;
+
+    bool registered = false;
+
+    ~ThreadState()
+    {
+        if (registered)
+        {
+            TextureCache::GetInstance().UnregisterThread(*this);
+        }
+    }
+};
+
+TextureCache& TextureCache::GetInstance()
+{
+    static TextureCache textureCache;
+    return textureCache;
+}
+
+TextureCache::TextureCache()
+    : mMemoryBudget(size_t(2) << 30)
+    , mMemoryUsage(0)
+    , mRetiredMemoryUsage(0)
+    , mNumTileLoads(0)
+    , mNumTileEvictions(0)
+    , mClock(0)
+    , mEpoch(1)
+{}
+
+TextureCache::~TextureCache()
+{
+    // worker threads may outlive the cache (e.g. when the thread pool is destroyed later at exit)
+    for (ThreadState* state : mThreadStates)
+    {
+        state->registered = false;
+    }
+    mThreadStates.Clear();
+
+    for (Tile* tile : mResidentTiles)
+    {
+        delete tile;
+    }
+
+    for (Tile* tile : mRetiredTiles)
+    {
+        delete tile;
+    }
+}
+
+void TextureCache::SetMemoryBudget(size_t budget)
+{
+    NFE_SCOPED_LOCK(mLock);
+
+    mMemoryBudget = budget;
+
+    if (mMemoryUsage > mMemoryBudget)
+    {
+        EvictTiles();
+    }
+}
+
+const TextureCache::Stats TextureCache::GetStats() const
+{
+    NFE_SCOPED_LOCK(mLock);
+
+    Stats stats;
+    stats.numTileLoads = mNumTileLoads;
+    stats.numTileEvictions = mNumTileEvictions;
+    stats.memoryUsage = mMemoryUsage + mRetiredMemoryUsage;
+    stats.memoryBudget = mMemoryBudget;
+    return stats;
+}
+
+void TextureCache::CollectGarbage()
+{
+    NFE_SCOPED_LOCK(mLock);
+
+    for (Tile* tile : mRetiredTiles)
+    {
+        delete tile;
+    }
+    mRetiredTiles.Clear();
+    mRetiredMemoryUsage = 0;
+
+    // invalidate per-thread caches, as they may point to freed tiles
+    mEpoch++;
+}
+
+TextureCache::ThreadState& TextureCache::GetThreadState()
+{
+    static thread_local ThreadState threadState;
+    return threadState;
+}
+
+void TextureCache::RegisterThread(ThreadState& state)
+{
+    NFE_SCOPED_LOCK(mLock);
+
+    mThreadStates.PushBack(&state);
+    state.registered = true;
+}
+
+void TextureCache::UnregisterThread(ThreadState& state)
+{
+    NFE_SCOPED_LOCK(mLock);
+
+    const auto iter = mThreadStates.Find(&state);
+    if (iter != mThreadStates.End())
+    {
+        mThreadStates.Erase(iter);
+    }
+    state.registered = false;
+}
+
+uint32 TextureCache::BeginAccess(ThreadState& state)
+{
+    if (!state.registered)
+    {
+        RegisterThread(state);
+    }
+
+    state.activeEpoch.store(mEpoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+    // the announced epoch must be visible before any tile pointer is read (pairs with the fence in FreeRetiredTiles)
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    // NOTE: epoch may have been advanced in the meantime, the announced one is more conservative
+    return mEpoch.load(std::memory_order_relaxed);
+}
+
+void TextureCache::EndAccess(ThreadState& state)
+{
+    state.activeEpoch.store(0, std::memory_order_release);
+}
+
+TextureCache::AccessScope::AccessScope()
+    : mState(GetThreadState())
+{
+    if (mState.scopeDepth++ == 0)
+    {
+        mState.scopeEpoch = GetInstance().BeginAccess(mState);
+    }
+}
+
+TextureCache::AccessScope::~AccessScope()
+{
+    NFE_ASSERT(mState.scopeDepth > 0, "Unbalanced texture access scope");
+
+    if (--mState.scopeDepth == 0)
+    {
+        GetInstance().EndAccess(mState);
+    }
+}
+
+const TextureCache::Tile* TextureCache::GetTile(const TiledBitmap& bitmap, uint32 tileIndex)
+{
+    Tile* tile = bitmap.mTiles[tileIndex].load(std::memory_order_acquire);
+
+    if (!tile)
+    {
+        // load outside of the cache lock, so multiple tiles can be streamed in parallel
+        tile = new Tile;
+        tile->owner = &bitmap;
+        tile->index = tileIndex;
+
+        if (!bitmap.LoadTile(tileIndex, tile->bitmap))
+        {
+            delete tile;
+            return nullptr;
+        }
+
+        tile->memorySize = tile->bitmap.GetDataSize() + bitmap.mPalette.Size();
+
+        // clock is advanced only when a tile is loaded, so hits don't write to a shared cache line
+        tile->lastUsed.store(mClock.fetch_add(1, std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+        return InsertTile(tile);
+    }
+
+    MarkUsed(*tile);
+
+    return tile;
+}
+
+const TextureCache::Tile* TextureCache::InsertTile(Tile* tile)
+{
+    NFE_SCOPED_LOCK(mLock);
+
+    std::atomic<Tile*>& slot = tile->owner->mTiles[tile->index];
+
+    // other thread was faster
+    if (Tile* existingTile = slot.load(std::memory_order_acquire))
+    {
+        delete tile;
+        return existingTile;
+    }
+
+    slot.store(tile, std::memory_order_release);
+    mResidentTiles.PushBack(tile);
+    mMemoryUsage += tile->memorySize;
+    mNumTileLoads++;
+
+    if (mMemoryUsage > mMemoryBudget)
+    {
+        EvictTiles();
+    }
+    else
+    {
+        FreeRetiredTiles();
+    }
+
+    return tile;
+}
+
+void TextureCache::EvictTiles()
+{
+    // evict more than needed, so the sorting cost is amortized over many tile loads
+    const size_t lowWatermark = mMemoryBudget - mMemoryBudget / 8u;
+
+    std::sort(mResidentTiles.begin(), mResidentTiles.end(), [] (const Tile* a, const Tile* b)
+    {
+        return a->lastUsed.load(std::memory_order_relaxed) < b->lastUsed.load(std::memory_order_relaxed);
+    });
+
+    const uint32 epoch = mEpoch.load(std::memory_order_relaxed);
+
+    uint32 numEvicted = 0;
+    while (numEvicted < mResidentTiles.Size() && mMemoryUsage > lowWatermark)
+    {
+        Tile* tile = mResidentTiles[numEvicted++];
+        tile->owner->mTiles[tile->index].store(nullptr, std::memory_order_release);
+        mMemoryUsage -= tile->memorySize;
+
+        // other threads may still hold a pointer to the tile, so it's freed when they are done
+        tile->retireEpoch = epoch;
+        mRetiredTiles.PushBack(tile);
+        mRetiredMemoryUsage += tile->memorySize;
+    }
+
+    const uint32 numRemaining = mResidentTiles.Size() - numEvicted;
+    for (uint32 i = 0; i < numRemaining; ++i)
+    {
+        mResidentTiles[i] = mResidentTiles[numEvicted + i];
+    }
+    mResidentTiles.Resize(numRemaining);
+
+    mNumTileEvictions += numEvicted;
+
+    // invalidate per-thread caches, so the retired tiles are not reachable in the new epoch
+    mEpoch++;
+
+    FreeRetiredTiles();
+}
+
+void TextureCache::FreeRetiredTiles()
+{
+    if (mRetiredTiles.Empty())
+    {
+        return;
+    }
+
+    // pairs with the fence in BeginAccess
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    uint32 minActiveEpoch = UINT32_MAX;
+    for (const ThreadState* state : mThreadStates)
+    {
+        const uint32 activeEpoch = state->activeEpoch.load(std::memory_order_relaxed);
+        if (activeEpoch != 0)
+        {
+            minActiveEpoch = Min(minActiveEpoch, activeEpoch);
+        }
+    }
+
+    uint32 numRemaining = 0;
+    for (Tile* tile : mRetiredTiles)
+    {
+        // threads which started sampling after the tile was retired can't reach it
+        if (tile->retireEpoch < minActiveEpoch)
+        {
+            mRetiredMemoryUsage -= tile->memorySize;
+            delete tile;
+        }
+        else
+        {
+            mRetiredTiles[numRemaining++] = tile;
+        }
+    }
+    mRetiredTiles.Resize(numRemaining);
+}
+
+void TextureCache::ReleaseTiles(const TiledBitmap& bitmap)
+{
+    NFE_SCOPED_LOCK(mLock);
+
+    uint32 numRemaining = 0;
+    for (Tile* tile : mResidentTiles)
+    {
+        if (tile->owner == &bitmap)
+        {
+            mMemoryUsage -= tile->memorySize;
+            delete tile;
+        }
+        else
+        {
+            mResidentTiles[numRemaining++] = tile;
+        }
+    }
+    mResidentTiles.Resize(numRemaining);
+
+    // the same address may be reused by other bitmap
+    mEpoch++;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+TiledBitmap::TiledBitmap(const char* debugName)
+    : mTileDataOffset(0)
+    , mTileDataSize(0)
+    , mNumTilesX(0)
+    , mNumTilesY(0)
+    , mFormat(Bitmap::Format::Unknown)
+{
+    NFE_ASSERT(debugName, "Invalid debug name");
+    mDebugName = strdup(debugName);
+}
+
+TiledBitmap::~TiledBitmap()
+{
+    Close();
+
+    free(mDebugName);
+}
+
+void TiledBitmap::Close()
+{
+    if (mTiles)
+    {
+        TextureCache::GetInstance().ReleaseTiles(*this);
+        mTiles.Reset();
+    }
+
+    mFile.Close();
+    mPalette.Clear();
+    mSize = Vec4ui::Zero();
+    mFloatSize = Vec4f::Zero();
+    mNumTilesX = 0;
+    mNumTilesY = 0;
+    mFormat = Bitmap::Format::Unknown;
+}
+
+bool TiledBitmap::Open(const char* path)
+{
+    Close();
+
+    uint64 sourceTime = 0;
+    int64 sourceSize = -1;
+    if (FileSystem::GetModificationTime(StringView(path), sourceTime))
+    {
+        const File sourceFile(StringView(path), AccessMode::Read);
+        sourceSize = sourceFile.GetSize();
+    }
+
+    if (sourceSize < 0)
+    {
+        NFE_LOG_ERROR("TiledBitmap: Failed to access source image '%hs'", path);
+        return false;
+    }
+
+    String cachePath(path);
+    cachePath += ".tiles";
+
+    if (!OpenCacheFile(cachePath, static_cast<uint64>(sourceSize), sourceTime))
+    {
+        if (!BuildCacheFile(path, cachePath, static_cast<uint64>(sourceSize), sourceTime))
+        {
+            return false;
+        }
+
+        if (!OpenCacheFile(cachePath, static_cast<uint64>(sourceSize), sourceTime))
+        {
+            NFE_LOG_ERROR("TiledBitmap: Failed to open tile cache file '%s'", cachePath.Str());
+            return false;
+        }
+    }
+
+    NFE_LOG_INFO("TiledBitmap '%hs' opened: width=%u, height=%u, format=%s, tiles=%ux%u",
+        path, GetWidth(), GetHeight(), Bitmap::FormatToString(mFormat), mNumTilesX, mNumTilesY);
+    return true;
+}
+
+bool TiledBitmap::OpenCacheFile(const String& cachePath, uint64 sourceSize, uint64 sourceTime)
+{
+    if (FileSystem::GetPathType(cachePath) != PathType::File)
+    {
+        return false;
+    }
+
+    if (!mFile.Open(cachePath, AccessMode::Read))
+    {
+        return false;
+    }
+
+    TileFileHeader header;
+    if (mFile.Read(&header, sizeof(header)) != sizeof(header))
+    {
+        mFile.Close();
+        return false;
+    }
+
+    // cache file is corrupted, was not fully written or is out of date
+    if (header.magic != TileFileMagic || header.version != TileFileVersion ||
+        header.sourceSize != sourceSize || header.sourceTime != sourceTime ||
+        header.tileSize != TileSize || header.width == 0 || header.height == 0)
+    {
+        mFile.Close();
+        return false;
+    }
+
+    mFormat = static_cast<Bitmap::Format>(header.format);
+    mSize = Vec4ui(header.width, header.height, 1, 0);
+    mFloatSize = Vec4f::FromIntegers(header.width, header.height, 1, 0);
+    mNumTilesX = (header.width + TileSize - 1) / TileSize;
+    mNumTilesY = (header.height + TileSize - 1) / TileSize;
+    mTileDataSize = Bitmap::ComputeDataStride(TileSize, mFormat) * TileSize;
+
+    const size_t paletteBytes = sizeof(uint32) * static_cast<size_t>(header.paletteSize);
+    mPalette.Resize(static_cast<uint32>(paletteBytes));
+    if (paletteBytes > 0 && mFile.Read(mPalette.Data(), paletteBytes) != paletteBytes)
+    {
+        Close();
+        return false;
+    }
+
+    mTileDataOffset = sizeof(TileFileHeader) + paletteBytes;
+
+    const int64 expectedSize = static_cast<int64>(mTileDataOffset) + static_cast<int64>(mTileDataSize) * mNumTilesX * mNumTilesY;
+    if (mFile.GetSize() < expectedSize)
+    {
+        Close();
+        return false;
+    }
+
+    mTiles = MakeUniquePtr<std::atomic<TextureCache::Tile*>[]>(mNumTilesX * mNumTilesY);
+
+    return true;
+}
+
+bool TiledBitmap::BuildCacheFile(const char* sourcePath, const String& cachePath, uint64 sourceSize, uint64 sourceTime)
+{
+    Timer timer;
+
+    Bitmap source(sourcePath);
+    if (!source.Load(sourcePath))
+    {
+        return false;
+    }
+
+    if (source.GetDepth() > 1)
+    {
+        NFE_LOG_ERROR("TiledBitmap: 3D bitmaps are not supported: '%hs'", sourcePath);
+        return false;
+    }
+
+    const Bitmap::Format format = source.GetFormat();
+    const uint32 width = source.GetWidth();
+    const uint32 height = source.GetHeight();
+    const uint32 numTilesX = (width + TileSize - 1) / TileSize;
+    const uint32 numTilesY = (height + TileSize - 1) / TileSize;
+
+    // compressed formats are copied in whole rows of blocks
+    const uint32 blockDim = GetBlockDimension(format);
+    const size_t sourceRowSize = static_cast<size_t>(source.GetStride()) * blockDim;
+    const size_t tileRowSize = static_cast<size_t>(Bitmap::ComputeDataStride(TileSize, format)) * blockDim;
+    const uint32 tileDataSize = Bitmap::ComputeDataStride(TileSize, format) * TileSize;
+
+    File file;
+    if (!file.Open(cachePath, AccessMode::Write, true))
+    {
+        NFE_LOG_ERROR("TiledBitmap: Failed to create tile cache file '%s'", cachePath.Str());
+        return false;
+    }
+
+    TileFileHeader header;
+    header.magic = 0; // written when the file is complete
+    header.version = TileFileVersion;
+    header.sourceSize = sourceSize;
+    header.sourceTime = sourceTime;
+    header.width = width;
+    header.height = height;
+    header.tileSize = TileSize;
+    header.paletteSize = source.mPaletteSize;
+    header.format = static_cast<uint32>(format);
+    header.padding = 0;
+
+    bool success = file.Write(&header, sizeof(header)) == sizeof(header);
+
+    const size_t paletteBytes = sizeof(uint32) * static_cast<size_t>(source.mPaletteSize);
+    if (success && paletteBytes > 0)
+    {
+        success = file.Write(source.mPalette, paletteBytes) == paletteBytes;
+    }
+
+    DynArray<uint8> tileData;
+    tileData.Resize(tileDataSize);
+
+    for (uint32 tileY = 0; success && tileY < numTilesY; ++tileY)
+    {
+        for (uint32 tileX = 0; success && tileX < numTilesX; ++tileX)
+        {
+            const uint32 x0 = tileX * TileSize;
+            const uint32 y0 = tileY * TileSize;
+            const uint32 numRows = (Min(TileSize, height - y0) + blockDim - 1) / blockDim;
+            const size_t rowOffset = static_cast<size_t>(Bitmap::ComputeDataStride(x0, format)) * blockDim;
+            const size_t rowSize = static_cast<size_t>(Bitmap::ComputeDataStride(Min(TileSize, width - x0), format)) * blockDim;
+
+            memset(tileData.Data(), 0, tileDataSize);
+
+            for (uint32 row = 0; row < numRows; ++row)
+            {
+                const uint8* sourceRow = source.GetData() + sourceRowSize * (y0 / blockDim + row) + rowOffset;
+                memcpy(tileData.Data() + tileRowSize * row, sourceRow, rowSize);
+            }
+
+            success = file.Write(tileData.Data(), tileDataSize) == tileDataSize;
+        }
+    }
+
+    if (success)
+    {
+        header.magic = TileFileMagic;
+        success = file.Seek(0, SeekMode::Begin) && file.Write(&header, sizeof(header)) == sizeof(header);
+    }
+
+    file.Close();
+
+    if (!success)
+    {
+        NFE_LOG_ERROR("TiledBitmap: Failed to write tile cache file '%s'", cachePath.Str());
+        FileSystem::Remove(cachePath);
+        return false;
+    }
+
+    const float elapsedTime = static_cast<float>(1000.0 * timer.Stop());
+    NFE_LOG_INFO("TiledBitmap: Tile cache file '%s' built in %.3fms", cachePath.Str(), elapsedTime);
+    return true;
+}
+
+bool TiledBitmap::LoadTile(uint32 tileIndex, Bitmap& outBitmap) const
+{
+    NFE_ASSERT(tileIndex < mNumTilesX * mNumTilesY, "Invalid tile index");
+
+    Bitmap::InitData initData;
+    initData.width = TileSize;
+    initData.height = TileSize;
+    initData.format = mFormat;
+    initData.paletteSize = mPalette.Size() / sizeof(uint32);
+
+    if (!outBitmap.Init(initData))
+    {
+        return false;
+    }
+
+    if (!mPalette.Empty())
+    {
+        memcpy(outBitmap.mPalette, mPalette.Data(), mPalette.Size());
+    }
+
+    const int64 offset = static_cast<int64>(mTileDataOffset) + static_cast<int64>(mTileDataSize) * tileIndex;
+
+    {
+        NFE_SCOPED_LOCK(mFileLock);
+
+        if (!mFile.Seek(offset, SeekMode::Begin) || mFile.Read(outBitmap.GetData(), mTileDataSize) != mTileDataSize)
+        {
+            NFE_LOG_ERROR("TiledBitmap: Failed to read tile %u of bitmap '%s'", tileIndex, mDebugName);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+const TextureCache::Tile* TiledBitmap::GetTile(TextureCache::ThreadState& state, uint32 epoch, uint32 tileIndex) const
+{
+    TextureCache& cache = TextureCache::GetInstance();
+
+    const uint32 hash = static_cast<uint32>(reinterpret_cast<size_t>(this) >> 4) * 0x9E3779B1u + tileIndex;
+    TextureCache::ThreadState::Entry& entry = state.entries[hash % TextureCache::ThreadState::NumEntries];
+
+    if (entry.owner == this && entry.tileIndex == tileIndex && entry.epoch == epoch)
+    {
+        if (entry.tile)
+        {
+            cache.MarkUsed(*entry.tile);
+        }
+        return entry.tile;
+    }
+
+    const TextureCache::Tile* tile = cache.GetTile(*this, tileIndex);
+
+    entry.owner = this;
+    entry.tile = tile;
+    entry.tileIndex = tileIndex;
+    entry.epoch = epoch;
+
+    return tile;
+}
+
+const Vec4f TiledBitmap::GetPixel_Internal(TextureCache::ThreadState& state, uint32 epoch, uint32 x, uint32 y) const
+{
+    NFE_ASSERT((x < GetWidth()) && (y < GetHeight()), "");
+
+    const TextureCache::Tile* tile = GetTile(state, epoch, GetTileIndex(x, y));
+    if (!tile)
+    {
+        return Vec4f::Zero();
+    }
+
+    return tile->bitmap.GetPixel(x % TileSize, y % TileSize);
+}
+
+void TiledBitmap::GetPixelBlock_Internal(TextureCache::ThreadState& state, uint32 epoch, const Vec4ui coords, Vec4f* outColors) const
+{
+    const uint32 tileIndex = GetTileIndex(coords.x, coords.y);
+
+    // fast path - whole block lies in a single tile
+    if (tileIndex == GetTileIndex(coords.z, coords.w))
+    {
+        const TextureCache::Tile* tile = GetTile(state, epoch, tileIndex);
+        if (tile)
+        {
+            tile->bitmap.GetPixelBlock(coords & Vec4ui(TileSize - 1), outColors);
+        }
+        else
+        {
+            outColors[0] = outColors[1] = outColors[2] = outColors[3] = Vec4f::Zero();
+        }
+    }
+    else
+    {
+        outColors[0] = GetPixel_Internal(state, epoch, coords.x, coords.y);
+        outColors[1] = GetPixel_Internal(state, epoch, coords.z, coords.y);
+        outColors[2] = GetPixel_Internal(state, epoch, coords.x, coords.w);
+        outColors[3] = GetPixel_Internal(state, epoch, coords.z, coords.w);
+    }
+}
+
+const Vec4f TiledBitmap::GetPixel(uint32 x, uint32 y) const
+{
+    TextureCache::ThreadState& state = TextureCache::GetThreadState();
+
+    // epoch was already announced by TextureCache::AccessScope
+    if (state.scopeDepth > 0)
+    {
+        return GetPixel_Internal(state, state.scopeEpoch, x, y);
+    }
+
+    TextureCache& cache = TextureCache::GetInstance();
+    const uint32 epoch = cache.BeginAccess(state);
+    const Vec4f result = GetPixel_Internal(state, epoch, x, y);
+    cache.EndAccess(state);
+
+    return result;
+}
+
+void TiledBitmap::GetPixelBlock(const Vec4ui coords, Vec4f* outColors) const
+{
+    TextureCache::ThreadState& state = TextureCache::GetThreadState();
+
+    // epoch was already announced by TextureCache::AccessScope
+    if (state.scopeDepth > 0)
+    {
+        GetPixelBlock_Internal(state, state.scopeEpoch, coords, outColors);
+        return;
+    }
+
+    TextureCache& cache = TextureCache::GetInstance();
+    const uint32 epoch = cache.BeginAccess(state);
+    GetPixelBlock_Internal(state, epoch, coords, outColors);
+    cache.EndAccess(state);
+}
+
+} // namespace RT
+} // namespace NFE
@@ -0,0 +1,209 @@
+#pragma once
+
+#include "Bitmap.h"
+#include "../../Common/Containers/DynArray.hpp"
+#include "../../Common/Containers/UniquePtr.hpp"
+#include "../../Common/Containers/SharedPtr.hpp"
+#include "../../Common/Containers/String.hpp"
+#include "../../Common/System/Mutex.hpp"
+#include "../../Common/FileSystem/File.hpp"
+
+namespace NFE {
+namespace RT {
+
+class TiledBitmap;
+
+/**
+ * Global cache of bitmap tiles.
+ * Keeps resident tiles under a memory budget and evicts least recently used ones when it is exceeded.
+ * Lookups on the rendering hot path go through small per-thread caches and are lock-free.
+ * Evicted tiles are freed as soon as all threads sampling textures at the time of eviction are done
+ * (epoch based reclamation), so the budget is respected also in the middle of rendering.
+ */
+class NFE_RAYTRACER_API TextureCache
+{
+    NFE_MAKE_NONCOPYABLE(TextureCache)
+    NFE_MAKE_NONMOVEABLE(TextureCache)
+
+    // per-thread data, defined in the source file
+    struct ThreadState;
+
+public:
+    /**
+     * Marks the calling thread as sampling textures until the scope ends (scopes can be nested).
+     * The epoch is announced once, so texel lookups inside the scope don't need any memory fence.
+     * NOTE: keep the scope short (e.g. single rendering tile), tiles evicted in the meantime are not freed until it ends.
+     */
+    class NFE_RAYTRACER_API AccessScope
+    {
+        NFE_MAKE_NONCOPYABLE(AccessScope)
+        NFE_MAKE_NONMOVEABLE(AccessScope)
+
+    public:
+        AccessScope();
+        ~AccessScope();
+
+    private:
+        ThreadState& mState;
+    };
+
+    struct Tile
+    {
+        Bitmap bitmap;
+        const TiledBitmap* owner = nullptr;
+        uint32 index = 0;
+        size_t memorySize = 0;
+        uint32 retireEpoch = 0;
+        mutable std::atomic<uint64> lastUsed;
+    };
+
+    struct Stats
+    {
+        uint64 numTileLoads = 0;
+        uint64 numTileEvictions = 0;
+        size_t memoryUsage = 0;
+        size_t memoryBudget = 0;
+    };
+
+    static TextureCache& GetInstance();
+
+    // set maximum amount of memory used by resident tiles (in bytes)
+    void SetMemoryBudget(size_t budget);
+
+    const Stats GetStats() const;
+
+    // free evicted tiles and invalidate per-thread caches
+    // NOTE: must be called when no texture sampling is in progress (e.g. after a frame is finished)
+    void CollectGarbage();
+
+private:
+    friend class TiledBitmap;
+
+    TextureCache();
+    ~TextureCache();
+
+    static ThreadState& GetThreadState();
+
+    void RegisterThread(ThreadState& state);
+    void UnregisterThread(ThreadState& state);
+
+    // mark the thread as sampling textures, returns current epoch
+    uint32 BeginAccess(ThreadState& state);
+    void EndAccess(ThreadState& state);
+
+    // update LRU timestamp of a tile (cheap, doesn't advance the clock)
+    NFE_FORCE_INLINE void MarkUsed(const Tile& tile) const
+    {
+        const uint64 now = mClock.load(std::memory_order_relaxed);
+
+        // avoid writing to a shared cache line if the tile was already marked
+        if (tile.lastUsed.load(std::memory_order_relaxed) != now)
+        {
+            tile.lastUsed.store(now, std::memory_order_relaxed);
+        }
+    }
+
+    // get a tile, loading it if not resident
+    const Tile* GetTile(const TiledBitmap& bitmap, uint32 tileIndex);
+
+    // insert freshly loaded tile, returns tile that ended up resident
+    const Tile* InsertTile(Tile* tile);
+
+    // remove all tiles owned by a bitmap (called when the bitmap is destroyed)
+    void ReleaseTiles(const TiledBitmap& bitmap);
+
+    // evict least recently used tiles until memory usage drops below low watermark
+    void EvictTiles();
+
+    // free retired tiles that can't be accessed by any thread anymore
+    void FreeRetiredTiles();
+
+    mutable Common::Mutex mLock;
+    Common::DynArray<Tile*> mResidentTiles;
+    Common::DynArray<Tile*> mRetiredTiles;
+    Common::DynArray<ThreadState*> mThreadStates;
+    size_t mMemoryBudget;
+    size_t mMemoryUsage;
+    size_t mRetiredMemoryUsage;
+    uint64 mNumTileLoads;
+    uint64 mNumTileEvictions;
+
+    NFE_ALIGN(64) std::atomic<uint64> mClock;
+    NFE_ALIGN(64) std::atomic<uint32> mEpoch;
+};
+
+/**
+ * Bitmap with out-of-core storage.
+ * The source image is converted once into a tiled cache file (stored next to the source, with ".tiles" suffix).
+ * Tiles are loaded from that file on first access and kept in the global TextureCache.
+ */
+class NFE_RAYTRACER_API NFE_ALIGN(16) TiledBitmap
+{
+    NFE_MAKE_NONCOPYABLE(TiledBitmap)
+    NFE_MAKE_NONMOVEABLE(TiledBitmap)
+
+public:
+    NFE_ALIGNED_CLASS(16)
+
+    static constexpr uint32 TileSizeLog2 = 6;
+    static constexpr uint32 TileSize = 1u << TileSizeLog2; // in texels
+
+    TiledBitmap(const char* debugName = "<unnamed>");
+    ~TiledBitmap();
+
+    NFE_FORCE_INLINE const char* GetDebugName() const { return mDebugName; }
+    NFE_FORCE_INLINE const Math::Vec4ui& GetSize() const { return mSize; }
+    NFE_FORCE_INLINE const Math::Vec4f& GetFloatSize() const { return mFloatSize; }
+    NFE_FORCE_INLINE uint32 GetWidth() const { return mSize.x; }
+    NFE_FORCE_INLINE uint32 GetHeight() const { return mSize.y; }
+    NFE_FORCE_INLINE Bitmap::Format GetFormat() const { return mFormat; }
+
+    // open bitmap file for streaming
+    // builds the tiled cache file if it's missing or out of date
+    bool Open(const char* path);
+
+    // get single pixel
+    const Math::Vec4f GetPixel(uint32 x, uint32 y) const;
+
+    // get 2x2 pixel block
+    void GetPixelBlock(const Math::Vec4ui coords, Math::Vec4f* outColors) const;
+
+private:
+    friend class TextureCache;
+
+    NFE_FORCE_INLINE uint32 GetTileIndex(uint32 x, uint32 y) const
+    {
+        return (x >> TileSizeLog2) + (y >> TileSizeLog2) * mNumTilesX;
+    }
+
+    // NOTE: must be called between TextureCache::BeginAccess() and TextureCache::EndAccess()
+    const TextureCache::Tile* GetTile(TextureCache::ThreadState& state, uint32 epoch, uint32 tileIndex) const;
+
+    const Math::Vec4f GetPixel_Internal(TextureCache::ThreadState& state, uint32 epoch, uint32 x, uint32 y) const;
+    void GetPixelBlock_Internal(TextureCache::ThreadState& state, uint32 epoch, const Math::Vec4ui coords, Math::Vec4f* outColors) const;
+
+    // read tile data from the cache file
+    bool LoadTile(uint32 tileIndex, Bitmap& outBitmap) const;
+
+    bool OpenCacheFile(const Common::String& cachePath, uint64 sourceSize, uint64 sourceTime);
+    bool BuildCacheFile(const char* sourcePath, const Common::String& cachePath, uint64 sourceSize, uint64 sourceTime);
+    void Close();
+
+    Math::Vec4ui mSize = Math::Vec4ui::Zero();
+    Math::Vec4f mFloatSize = Math::Vec4f::Zero();
+    char* mDebugName;
+    mutable Common::File mFile;
+    mutable Common::Mutex mFileLock;
+    Common::DynArray<uint8> mPalette;
+    Common::UniquePtr<std::atomic<TextureCache::Tile*>[]> mTiles;
+    uint64 mTileDataOffset;
+    uint32 mTileDataSize;
+    uint32 mNumTilesX;
+    uint32 mNumTilesY;
+    Bitmap::Format mFormat;
+};
+
+using TiledBitmapPtr = Common::SharedPtr<TiledBitmap>;
+
+} // namespace RT
+} // namespace NFE
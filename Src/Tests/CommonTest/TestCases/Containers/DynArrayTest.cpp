@@ -719,4 +719,17 @@ TEST(DynArray, Erase_Range_Empty)
 
     EXPECT_FALSE(array.Erase(array.End(), array.End()));
     ASSERT_EQ(5u, array.Size());
-}
\ No newline at end of file
+}
+
+TEST(DynArray, Swap)
+{
+    DynArray<int> arrayA({ 10, 20, 30 });
+    DynArray<int> arrayB({ 40, 50 });
+
+    arrayA.Swap(arrayB);
+
+    int expectedElementsA[] = { 40, 50 };
+    int expectedElementsB[] = { 10, 20, 30 };
+    EXPECT_EQ(ArrayView<int>(expectedElementsA, 2), arrayA);
+    EXPECT_EQ(ArrayView<int>(expectedElementsB, 3), arrayB);
+}
@@ -56,3 +56,110 @@ TEST(MathTest, Distribution_MultipleValues)
         EXPECT_LT(Abs(expected - counters[i]), 200);
     }
 }
+
+TEST(MathTest, Distribution_Alias_SingleValue)
+{
+    const float p = 1.0f;
+    Distribution distr;
+    ASSERT_TRUE(distr.Initialize(&p, 1));
+
+    Random random;
+
+    const uint32 numIterations = 1000;
+    for (uint32 i = 0; i < numIterations; ++i)
+    {
+        float pdf = 0.0f;
+        uint32 sample = distr.SampleDiscreteAlias(random.GetFloat(), pdf);
+
+        EXPECT_EQ(1.0f, pdf);
+        EXPECT_EQ(0u, sample);
+    }
+}
+
+TEST(MathTest, Distribution_Alias_MultipleValues)
+{
+    const uint32 pdfSize = 6;
+    const uint32 numIterations = 10000;
+
+    const float p[] = { 0.1f, 0.0f, 0.3f, 0.1f, 0.5f, 0.0f };
+    Distribution distr;
+    ASSERT_TRUE(distr.Initialize(p, pdfSize));
+
+    Random random;
+
+    int32 counters[pdfSize] = { 0,0,0,0 };
+
+    for (uint32 i = 0; i < numIterations; ++i)
+    {
+        float pdf = 0.0f;
+        float remappedU = -1.0f;
+        uint32 sample = distr.SampleDiscreteAlias(random.GetFloat(), pdf, &remappedU);
+        ASSERT_LT(sample, pdfSize);
+        EXPECT_EQ(distr.Pdf(sample), pdf);
+        EXPECT_GE(remappedU, 0.0f);
+        EXPECT_LT(remappedU, 1.0f);
+
+        counters[sample]++;
+    }
+
+    for (uint32 i = 0; i < pdfSize; ++i)
+    {
+        int32 expected = (int32)(numIterations * p[i]);
+
+        EXPECT_LT(Abs(expected - counters[i]), 200);
+    }
+}
+
+TEST(MathTest, Distribution2D_MultipleValues)
+{
+    const uint32 width = 3;
+    const uint32 height = 2;
+    const uint32 numIterations = 10000;
+
+    const float p[] =
+    {
+        0.1f, 0.0f, 0.3f,
+        0.0f, 0.0f, 0.0f,
+    };
+    const float q[] =
+    {
+        0.2f, 0.3f, 0.0f,
+        0.1f, 0.0f, 0.4f,
+    };
+
+    for (const float* values : { p, q })
+    {
+        Distribution2D distr;
+        ASSERT_TRUE(distr.Initialize(values, width, height));
+
+        float sum = 0.0f;
+        for (uint32 i = 0; i < width * height; ++i)
+        {
+            sum += values[i];
+        }
+
+        Random random;
+
+        int32 counters[width * height] = { 0 };
+
+        for (uint32 i = 0; i < numIterations; ++i)
+        {
+            uint32 x = UINT32_MAX, y = UINT32_MAX;
+            float pdf = 0.0f;
+            distr.SampleDiscrete(random.GetVec2f(), x, y, pdf);
+            ASSERT_LT(x, width);
+            ASSERT_LT(y, height);
+            EXPECT_NEAR(values[width * y + x] * (float)(width * height) / sum, pdf, 1.0e-5f);
+            EXPECT_NEAR(distr.Pdf(x, y), pdf, 1.0e-5f);
+
+            counters[width * y + x]++;
+        }
+
+        for (uint32 i = 0; i < width * height; ++i)
+        {
+            int32 expected = (int32)(numIterations * values[i] / sum);
+
+            EXPECT_LT(Abs(expected - counters[i]), 200);
+        }
+    }
+}
@@ -22,3 +22,23 @@ TEST(RandomTest, Entropy)
     EXPECT_GE(sum, 4900ull * (uint64)UINT32_MAX);
     EXPECT_LE(sum, 5100ull * (uint64)UINT32_MAX);
 }
+
+TEST(RandomTest, Seed)
+{
+    Random randomA(1234);
+    Random randomB(1234);
+    Random randomC(1235);
+
+    bool anyDifferent = false;
+    for (uint32 i = 0; i < 100; ++i)
+    {
+        const uint64 valueA = randomA.GetLong();
+        EXPECT_EQ(valueA, randomB.GetLong());
+        anyDifferent |= valueA != randomC.GetLong();
+    }
+    EXPECT_TRUE(anyDifferent);
+
+    randomA.Reset(1234);
+    randomB.Reset(1234);
+    EXPECT_EQ(randomA.GetLong(), randomB.GetLong());
+}
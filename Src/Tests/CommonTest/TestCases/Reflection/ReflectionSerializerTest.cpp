@@ -124,4 +124,73 @@ TEST(ReflectionTest, Serialize_Complex_SingleRootObject)
         EXPECT_EQ(456, readChildObj->i32);
         EXPECT_EQ(TestEnum::OptionC, readChildObj->e);
     }
-}
\ No newline at end of file
+}
+
+TEST(ReflectionTest, Serialize_Complex_AllObjects)
+{
+    Buffer buffer;
+    DynArray<ObjectPtr> writtenObjects;
+
+    {
+        const SharedPtr<SerializationTestClass> obj = MakeSharedPtr<SerializationTestClass>();
+        const SharedPtr<SerializationTestClass> childObj = MakeSharedPtr<SerializationTestClass>();
+        obj->sharedPtrA = childObj;
+        obj->sharedPtrB = childObj;
+        obj->i32 = 123;
+        childObj->i32 = 456;
+
+        BufferOutputStream stream(buffer);
+        const ObjectPtr rootObject = obj;
+        ASSERT_TRUE(Serialize(ArrayView<const ObjectPtr>(&rootObject, 1), stream, &writtenObjects));
+        ASSERT_EQ(2u, writtenObjects.Size());
+    }
+
+    {
+        BufferInputStream stream(buffer);
+        DynArray<ObjectPtr> readObjects;
+        DynArray<ObjectPtr> allReadObjects;
+
+        ASSERT_TRUE(Deserialize(readObjects, stream, &allReadObjects));
+        ASSERT_EQ(1u, readObjects.Size());
+        ASSERT_EQ(2u, allReadObjects.Size());
+
+        // objects are returned in the same order as they were serialized
+        for (uint32 i = 0; i < allReadObjects.Size(); ++i)
+        {
+            const SharedPtr<SerializationTestClass> writtenObj = Cast<SerializationTestClass>(writtenObjects[i]);
+            const SharedPtr<SerializationTestClass> readObj = Cast<SerializationTestClass>(allReadObjects[i]);
+            ASSERT_TRUE(writtenObj != nullptr);
+            ASSERT_TRUE(readObj != nullptr);
+            EXPECT_EQ(writtenObj->i32, readObj->i32);
+        }
+
+        EXPECT_TRUE(allReadObjects.Find(readObjects[0]) != allReadObjects.End());
+    }
+}
+
+TEST(ReflectionTest, Serialize_DeserializedNotification)
+{
+    Buffer buffer;
+
+    {
+        const SharedPtr<SerializationTestClassWithDerivedState> obj = MakeSharedPtr<SerializationTestClassWithDerivedState>();
+        obj->value = 4.0f;
+
+        BufferOutputStream stream(buffer);
+        ASSERT_TRUE(Serialize(obj, stream));
+    }
+
+    {
+        BufferInputStream stream(buffer);
+        DynArray<ObjectPtr> readObjects;
+
+        ASSERT_TRUE(Deserialize(readObjects, stream));
+        ASSERT_EQ(1u, readObjects.Size());
+
+        const SharedPtr<SerializationTestClassWithDerivedState> readObj = Cast<SerializationTestClassWithDerivedState>(readObjects[0]);
+        ASSERT_TRUE(readObj != nullptr);
+        EXPECT_EQ(4.0f, readObj->value);
+        EXPECT_EQ(0.25f, readObj->valueInv);
+        EXPECT_EQ(1u, readObj->numDeserializedCalls);
+    }
+}
@@ -108,6 +108,20 @@ NFE_DEFINE_POLYMORPHIC_CLASS(SerializationTestClass)
 }
 NFE_END_DEFINE_CLASS()
 
+NFE_DEFINE_POLYMORPHIC_CLASS(SerializationTestClassWithDerivedState)
+{
+    NFE_CLASS_MEMBER(value);
+}
+NFE_END_DEFINE_CLASS()
+
+void SerializationTestClassWithDerivedState::OnDeserialized()
+{
+    IObject::OnDeserialized();
+
+    numDeserializedCalls++;
+    valueInv = 1.0f / value;
+}
+
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -161,6 +161,19 @@ public:
     NFE::Common::SharedPtr<NFE::IObject> sharedPtrB;
 };
 
+// class with non-reflected state derived from a reflected member
+class SerializationTestClassWithDerivedState : public NFE::IObject
+{
+    NFE_DECLARE_POLYMORPHIC_CLASS(SerializationTestClassWithDerivedState)
+
+public:
+    float value = 1.0f;
+    float valueInv = 1.0f; // not reflected
+    NFE::uint32 numDeserializedCalls = 0; // not reflected
+
+    virtual void OnDeserialized() override;
+};
+
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -2,6 +2,7 @@
 #include "Engine/Common/System/SystemInfo.hpp"
 #include "Engine/Common/Containers/String.hpp"
 
+using namespace NFE;
 using namespace NFE::Common;
 
 TEST(SystemInfoTest, CpuInfoTest)
@@ -25,6 +26,28 @@ TEST(SystemInfoTest, MemoryInfoTest)
     EXPECT_GT(sysInfoPtr.GetFreeMemoryKb(), 0);
 }
 
+TEST(SystemInfoTest, NumaInfoTest)
+{
+    SystemInfo& sysInfoPtr = SystemInfo::Instance();
+    const uint32 numNodes = sysInfoPtr.GetNumNumaNodes();
+    ASSERT_GE(numNodes, 1u);
+
+    uint32 numCpus = 0;
+    for (uint32 i = 0; i < numNodes; ++i)
+    {
+        const DynArray<uint32>& nodeCpus = sysInfoPtr.GetNumaNodeCpus(i);
+        EXPECT_FALSE(nodeCpus.Empty());
+        numCpus += nodeCpus.Size();
+
+        for (const uint32 cpu : nodeCpus)
+        {
+            EXPECT_EQ(i, sysInfoPtr.GetCpuNumaNode(cpu));
+        }
+    }
+
+    EXPECT_GE(numCpus, 1u);
+}
+
 TEST(SystemInfoTest, InfoStringTest)
 {
     SystemInfo& sysInfoPtr = SystemInfo::Instance();
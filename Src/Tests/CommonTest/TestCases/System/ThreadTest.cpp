@@ -6,6 +6,7 @@
 
 #include "PCH.hpp"
 #include "Engine/Common/System/Thread.hpp"
+#include "Engine/Common/System/SystemInfo.hpp"
 
 using namespace NFE;
 using namespace NFE::Common;
@@ -91,6 +92,25 @@ TEST(ThreadTest, SetPriority)
     threadTestLambda(ThreadPriority::RealTime);
 }
 
+TEST(ThreadTest, SetAffinity)
+{
+    const DynArray<uint32>& nodeCpus = SystemInfo::Instance().GetNumaNodeCpus(0);
+    std::atomic<bool> finish = false;
+
+    Thread thread;
+    ASSERT_TRUE(thread.Run([&]()
+    {
+        while (!finish)
+        {
+            Thread::SleepCurrentThread(0.001);
+        }
+    }));
+
+    EXPECT_TRUE(thread.SetAffinity(nodeCpus));
+    EXPECT_FALSE(thread.SetAffinity(ArrayView<const uint32>()));
+    finish = true;
+}
+
 TEST(ThreadTest, ThreadId)
 {
     const uint32 TestThreadNumber = 10;
@@ -0,0 +1,175 @@
+#include "PCH.h"
+#include "Engine/Raytracer/BVH/BVHBuilder.h"
+#include "Engine/Raytracer/BVH/BVHOptimizer.h"
+#include "Engine/Common/Math/Random.hpp"
+
+using namespace NFE;
+using namespace NFE::RT;
+using namespace NFE::Math;
+
+namespace {
+
+struct BVHChecker
+{
+    const BVH& bvh;
+    const Box* leafBoxes;               // leaf boxes in BVH order
+    std::vector<uint32> leafVisits;
+    uint32 maxDepth = 0;
+
+    BVHChecker(const BVH& bvh, const Box* leafBoxes, uint32 numLeaves)
+        : bvh(bvh)
+        , leafBoxes(leafBoxes)
+        , leafVisits(numLeaves, 0)
+    { }
+
+    static bool Contains(const Box& outer, const Box& inner)
+    {
+        return (inner.min >= outer.min).All3() && (inner.max <= outer.max).All3();
+    }
+
+    void Check(uint32 nodeIndex, uint32 depth)
+    {
+        const BVH::Node& node = bvh.GetNodes()[nodeIndex];
+        const Box box = node.GetBox();
+        maxDepth = Max(maxDepth, depth);
+
+        if (node.IsLeaf())
+        {
+            for (uint32 i = 0; i < node.numLeaves; ++i)
+            {
+                ASSERT_LT(node.childIndex + i, leafVisits.size());
+                leafVisits[node.childIndex + i]++;
+                EXPECT_TRUE(Contains(box, leafBoxes[node.childIndex + i])) << "node " << nodeIndex;
+            }
+            return;
+        }
+
+        ASSERT_LT(node.childIndex + 1, bvh.GetNumNodes());
+        for (uint32 i = 0; i < 2; ++i)
+        {
+            EXPECT_TRUE(Contains(box, bvh.GetNodes()[node.childIndex + i].GetBox())) << "node " << nodeIndex;
+            Check(node.childIndex + i, depth + 1);
+        }
+    }
+};
+
+double CalculateSAHCost(const BVH& bvh, uint32 nodeIndex = 0)
+{
+    const BVH::Node& node = bvh.GetNodes()[nodeIndex];
+    const double area = node.GetBox().SurfaceArea();
+
+    if (node.IsLeaf())
+    {
+        return area * node.numLeaves;
+    }
+
+    return 1.2 * area + CalculateSAHCost(bvh, node.childIndex) + CalculateSAHCost(bvh, node.childIndex + 1);
+}
+
+} // namespace
+
+
+class BVHOptimizerTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        Random random;
+        for (uint32 i = 0; i < NumLeaves; ++i)
+        {
+            const Vec4f center = random.GetVec4f() * 100.0f;
+            const Vec4f extent = random.GetVec4f() * Vec4f(2.0f, 0.2f, 0.5f, 0.0f) + Vec4f(0.01f);
+            mBoxes.push_back(Box(center - extent, center + extent));
+        }
+    }
+
+    void Build(BVH& bvh, const BvhBuildingParams& params)
+    {
+        BVHBuilder::Indices leavesOrder;
+        BVHBuilder builder(bvh);
+        ASSERT_TRUE(builder.Build(mBoxes.data(), NumLeaves, params, leavesOrder));
+        ASSERT_EQ(NumLeaves, leavesOrder.Size());
+
+        mOrderedBoxes.clear();
+        for (const uint32 index : leavesOrder)
+        {
+            mOrderedBoxes.push_back(mBoxes[index]);
+        }
+    }
+
+    void Validate(const BVH& bvh)
+    {
+        BVHChecker checker(bvh, mOrderedBoxes.data(), NumLeaves);
+        checker.Check(0, 0);
+
+        for (uint32 i = 0; i < NumLeaves; ++i)
+        {
+            ASSERT_EQ(1u, checker.leafVisits[i]) << "leaf " << i;
+        }
+
+        EXPECT_LE(checker.maxDepth, BVH::MaxDepth);
+    }
+
+    static constexpr uint32 NumLeaves = 20000;
+
+    std::vector<Box> mBoxes;
+    std::vector<Box> mOrderedBoxes;
+};
+
+TEST_F(BVHOptimizerTest, Restructure)
+{
+    BvhBuildingParams params;
+    params.reorderNodes = false;
+
+    BVH bvh;
+    Build(bvh, params);
+    Validate(bvh);
+
+    const double initialCost = CalculateSAHCost(bvh);
+
+    BVHOptimizer optimizer(bvh);
+    optimizer.Restructure(100.0f, 3);
+
+    Validate(bvh);
+    EXPECT_LE(CalculateSAHCost(bvh), initialCost * (1.0 + 1.0e-6));
+}
+
+TEST_F(BVHOptimizerTest, ReorderNodes)
+{
+    BvhBuildingParams params;
+    params.reorderNodes = false;
+
+    BVH bvh;
+    Build(bvh, params);
+
+    const double initialCost = CalculateSAHCost(bvh);
+
+    BVHOptimizer optimizer(bvh);
+    optimizer.Restructure(100.0f, 3);
+    const double restructuredCost = CalculateSAHCost(bvh);
+    ASSERT_TRUE(optimizer.ReorderNodes());
+
+    Validate(bvh);
+    EXPECT_LE(CalculateSAHCost(bvh), initialCost * (1.0 + 1.0e-6));
+    EXPECT_NEAR(restructuredCost, CalculateSAHCost(bvh), restructuredCost * 1.0e-6);
+
+    // child pairs of sibling nodes must be adjacent
+    const BVH::Node* nodes = bvh.GetNodes();
+    for (uint32 i = 0; i < bvh.GetNumNodes(); ++i)
+    {
+        // skip padding node
+        if (i == 1 || nodes[i].IsLeaf())
+        {
+            continue;
+        }
+
+        EXPECT_EQ(0u, nodes[i].childIndex % 2) << "node " << i;
+
+        const BVH::Node& childA = nodes[nodes[i].childIndex];
+        const BVH::Node& childB = nodes[nodes[i].childIndex + 1];
+        if (!childA.IsLeaf() && !childB.IsLeaf())
+        {
+            EXPECT_EQ(childA.childIndex + 2, childB.childIndex) << "node " << i;
+        }
+    }
+}
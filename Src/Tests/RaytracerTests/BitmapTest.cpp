@@ -1,10 +1,11 @@
 #include "PCH.h"
-#include "../Core/Utils/Bitmap.h"
-#include "../Core/Math/Half.h"
-#include "../Core/Math/Packed.h"
+#include "Engine/Raytracer/Utils/Bitmap.h"
+#include "Engine/Common/Math/Half.hpp"
+#include "Engine/Common/Math/Packed.hpp"
 
-using namespace rt;
-using namespace rt::math;
+using namespace NFE;
+using namespace NFE::RT;
+using namespace NFE::Math;
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -18,16 +19,17 @@ TEST(BitmapTest, Empty)
     EXPECT_EQ(nullptr, bitmap.GetData());
 }
 
-void CompareVector(const Vector4& ref, const Vector4& val, float maxError = 0.0f)
+static bool InitBitmap(Bitmap& bitmap, Bitmap::Format format, const void* data)
 {
-    const Vector4 diff = Vector4::Abs(ref - val);
-    EXPECT_LE(diff.x, maxError);
-    EXPECT_LE(diff.y, maxError);
-    EXPECT_LE(diff.z, maxError);
-    EXPECT_LE(diff.w, maxError);
+    Bitmap::InitData initData;
+    initData.width = 2;
+    initData.height = 2;
+    initData.format = format;
+    initData.data = data;
+    return bitmap.Init(initData);
 }
 
-static void Validate_GetPixel(const Bitmap& bitmap, const Vector4* expectedValues, float maxError = 0.0f, uint32 width = 2, uint32 height = 2)
+static void Validate_GetPixel(const Bitmap& bitmap, const Vec4f* expectedValues, float maxError = 0.0f, uint32 width = 2, uint32 height = 2)
 {
     for (uint32 y = 0; y < height; ++y)
     {
@@ -37,8 +39,8 @@ static void Validate_GetPixel(const Bitmap& bitmap, const Vector4* expectedValue
         {
             SCOPED_TRACE("x=" + std::to_string(x));
 
-            const Vector4& expected = expectedValues[y * width + x];
-            const Vector4 actual = bitmap.GetPixel(x, y);
+            const Vec4f& expected = expectedValues[y * width + x];
+            const Vec4f actual = bitmap.GetPixel(x, y);
 
             EXPECT_NEAR(expected.x, actual.x, maxError);
             EXPECT_NEAR(expected.y, actual.y, maxError);
@@ -48,17 +50,17 @@ static void Validate_GetPixel(const Bitmap& bitmap, const Vector4* expectedValue
     }
 }
 
-static void Validate_GetPixelBlock(const Bitmap& bitmap, const Vector4* expectedValues, float maxError = 0.0f, uint32 x = 0, uint32 y = 0)
+static void Validate_GetPixelBlock(const Bitmap& bitmap, const Vec4f* expectedValues, float maxError = 0.0f, uint32 x = 0, uint32 y = 0)
 {
-    Vector4 actual[4];
+    Vec4f actual[4];
 
-    bitmap.GetPixelBlock(VectorInt4(x, y, x + 1, y + 1), actual);
+    bitmap.GetPixelBlock(Vec4ui(x, y, x + 1, y + 1), actual);
 
     for (uint32 i = 0; i < 4; ++i)
     {
         SCOPED_TRACE("i=" + std::to_string(i));
 
-        const Vector4& expected = expectedValues[i];
+        const Vec4f& expected = expectedValues[i];
 
         EXPECT_NEAR(expected.x, actual[i].x, maxError);
         EXPECT_NEAR(expected.y, actual[i].y, maxError);
@@ -80,16 +82,16 @@ TEST(BitmapTest, Format_R8_UNorm)
             128,
             255,
         };
-        ASSERT_TRUE(bitmap.Init({ 2, 2, Bitmap::Format::R8_UNorm, data }));
+        ASSERT_TRUE(InitBitmap(bitmap, Bitmap::Format::R8_UNorm, data));
         ASSERT_EQ(2u, bitmap.GetStride());
     }
 
-    const Vector4 expected[] =
+    const Vec4f expected[] =
     {
-        Vector4(0.0f),
-        Vector4(13.0f / 255.0f),
-        Vector4(128.0f / 255.0f),
-        Vector4(1.0f),
+        Vec4f(0.0f),
+        Vec4f(13.0f / 255.0f),
+        Vec4f(128.0f / 255.0f),
+        Vec4f(1.0f),
     };
     Validate_GetPixel(bitmap, expected, 0.00001f);
     Validate_GetPixelBlock(bitmap, expected, 0.00001f);
@@ -106,16 +108,16 @@ TEST(BitmapTest, Format_R8G8_UNorm)
             128,    255,
             255,    13
         };
-        ASSERT_TRUE(bitmap.Init({ 2, 2, Bitmap::Format::R8G8_UNorm, data }));
+        ASSERT_TRUE(InitBitmap(bitmap, Bitmap::Format::R8G8_UNorm, data));
         ASSERT_EQ(4u, bitmap.GetStride());
     }
 
-    const Vector4 expected[] =
+    const Vec4f expected[] =
     {
-        Vector4(0.0f, 123.0f / 255.0f),
-        Vector4(13.0f / 255.0f, 0.0f),
-        Vector4(128.0f / 255.0f, 1.0f),
-        Vector4(1.0f, 13.0f / 255.0f),
+        Vec4f(0.0f, 123.0f / 255.0f),
+        Vec4f(13.0f / 255.0f, 0.0f),
+        Vec4f(128.0f / 255.0f, 1.0f),
+        Vec4f(1.0f, 13.0f / 255.0f),
     };
     Validate_GetPixel(bitmap, expected, 0.00001f);
     Validate_GetPixelBlock(bitmap, expected, 0.00001f);
@@ -132,16 +134,16 @@ TEST(BitmapTest, Format_B8G8R8_UNorm)
             128,    255,    201,
             255,    13,     0,
         };
-        ASSERT_TRUE(bitmap.Init({ 2, 2, Bitmap::Format::B8G8R8_UNorm, data }));
+        ASSERT_TRUE(InitBitmap(bitmap, Bitmap::Format::B8G8R8_UNorm, data));
         ASSERT_EQ(6u, bitmap.GetStride());
     }
 
-    const Vector4 expected[] =
+    const Vec4f expected[] =
     {
-        Vector4(17.0f / 255.0f, 123.0f / 255.0f, 0.0f),
-        Vector4(1.0f, 0.0f, 13.0f / 255.0f),
-        Vector4(201.0f / 255.0f, 1.0f, 128.0f / 255.0f),
-        Vector4(0.0f, 13.0f / 255.0f, 1.0f),
+        Vec4f(17.0f / 255.0f, 123.0f / 255.0f, 0.0f),
+        Vec4f(1.0f, 0.0f, 13.0f / 255.0f),
+        Vec4f(201.0f / 255.0f, 1.0f, 128.0f / 255.0f),
+        Vec4f(0.0f, 13.0f / 255.0f, 1.0f),
     };
     Validate_GetPixel(bitmap, expected, 0.00001f);
     Validate_GetPixelBlock(bitmap, expected, 0.00001f);
@@ -158,16 +160,16 @@ TEST(BitmapTest, Format_B8G8R8A8_UNorm)
             128,    255,    201,    0,
             255,    13,     0,      190,
         };
-        ASSERT_TRUE(bitmap.Init({ 2, 2, Bitmap::Format::B8G8R8A8_UNorm, data }));
+        ASSERT_TRUE(InitBitmap(bitmap, Bitmap::Format::B8G8R8A8_UNorm, data));
         ASSERT_EQ(8u, bitmap.GetStride());
     }
 
-    const Vector4 expected[] =
+    const Vec4f expected[] =
     {
-        Vector4(17.0f / 255.0f, 123.0f / 255.0f, 0.0f, 1.0f),
-        Vector4(1.0f, 0.0f, 13.0f / 255.0f, 30.0f / 255.0f),
-        Vector4(201.0f / 255.0f, 1.0f, 128.0f / 255.0f, 0.0f),
-        Vector4(0.0f, 13.0f / 255.0f, 1.0f, 190.0f / 255.0f),
+        Vec4f(17.0f / 255.0f, 123.0f / 255.0f, 0.0f, 1.0f),
+        Vec4f(1.0f, 0.0f, 13.0f / 255.0f, 30.0f / 255.0f),
+        Vec4f(201.0f / 255.0f, 1.0f, 128.0f / 255.0f, 0.0f),
+        Vec4f(0.0f, 13.0f / 255.0f, 1.0f, 190.0f / 255.0f),
     };
     Validate_GetPixel(bitmap, expected, 0.00001f);
     Validate_GetPixelBlock(bitmap, expected, 0.00001f);
@@ -179,23 +181,23 @@ TEST(BitmapTest, Format_B5G6R5_UNorm)
 {
     Bitmap bitmap;
     {
-        const Packed565 data[] =
+        const Packed_5_6_5 data[] =
         {
-            Packed565( 0, 59, 29),
-            Packed565( 2,  0, 31),
-            Packed565(29, 63,  2),
-            Packed565(31,  7,  0),
+            Packed_5_6_5( 0, 59, 29),
+            Packed_5_6_5( 2,  0, 31),
+            Packed_5_6_5(29, 63,  2),
+            Packed_5_6_5(31,  7,  0),
         };
-        ASSERT_TRUE(bitmap.Init({ 2, 2, Bitmap::Format::B5G6R5_UNorm, data }));
+        ASSERT_TRUE(InitBitmap(bitmap, Bitmap::Format::B5G6R5_UNorm, data));
         ASSERT_EQ(4u, bitmap.GetStride());
     }
 
-    const Vector4 expected[] =
+    const Vec4f expected[] =
     {
-        Vector4(29.0f / 31.0f, 59.0f / 63.0f, 0.0f / 31.0f),
-        Vector4(31.0f / 31.0f, 0.0f / 63.0f, 2.0f / 31.0f),
-        Vector4(2.0f / 31.0f, 63.0f / 63.0f, 29.0f / 31.0f),
-        Vector4(0.0f / 31.0f, 7.0f / 63.0f, 31.0f / 31.0f),
+        Vec4f(29.0f / 31.0f, 59.0f / 63.0f, 0.0f / 31.0f),
+        Vec4f(31.0f / 31.0f, 0.0f / 63.0f, 2.0f / 31.0f),
+        Vec4f(2.0f / 31.0f, 63.0f / 63.0f, 29.0f / 31.0f),
+        Vec4f(0.0f / 31.0f, 7.0f / 63.0f, 31.0f / 31.0f),
     };
     Validate_GetPixel(bitmap, expected, 0.001f);
     Validate_GetPixelBlock(bitmap, expected, 0.001f);
@@ -214,16 +216,16 @@ TEST(BitmapTest, Format_R16_UNorm)
             47813,
             65535,
         };
-        ASSERT_TRUE(bitmap.Init({ 2, 2, Bitmap::Format::R16_UNorm, data }));
+        ASSERT_TRUE(InitBitmap(bitmap, Bitmap::Format::R16_UNorm, data));
         ASSERT_EQ(4u, bitmap.GetStride());
     }
 
-    const Vector4 expected[] =
+    const Vec4f expected[] =
     {
-        Vector4(0.0f),
-        Vector4(120.0f / 65535.0f),
-        Vector4(47813.0f / 65535.0f),
-        Vector4(1.0f),
+        Vec4f(0.0f),
+        Vec4f(120.0f / 65535.0f),
+        Vec4f(47813.0f / 65535.0f),
+        Vec4f(1.0f),
     };
     Validate_GetPixel(bitmap, expected, 0.00001f);
     Validate_GetPixelBlock(bitmap, expected, 0.00001f);
@@ -240,16 +242,16 @@ TEST(BitmapTest, Format_R16G16_UNorm)
             47813,  65535,
             65535,  47813,
         };
-        ASSERT_TRUE(bitmap.Init({ 2, 2, Bitmap::Format::R16G16_UNorm, data }));
+        ASSERT_TRUE(InitBitmap(bitmap, Bitmap::Format::R16G16_UNorm, data));
         ASSERT_EQ(8u, bitmap.GetStride());
     }
 
-    const Vector4 expected[] =
+    const Vec4f expected[] =
     {
-        Vector4(0.0f, 120.0f) / 65535.0f,
-        Vector4(120.0f, 0.0f) / 65535.0f,
-        Vector4(47813.0f, 65535.0f) / 65535.0f,
-        Vector4(65535.0f, 47813.0f) / 65535.0f,
+        Vec4f(0.0f, 120.0f) / 65535.0f,
+        Vec4f(120.0f, 0.0f) / 65535.0f,
+        Vec4f(47813.0f, 65535.0f) / 65535.0f,
+        Vec4f(65535.0f, 47813.0f) / 65535.0f,
     };
     Validate_GetPixel(bitmap, expected, 0.00001f);
     Validate_GetPixelBlock(bitmap, expected, 0.00001f);
@@ -266,16 +268,16 @@ TEST(BitmapTest, Format_R16G16B16A16_UNorm)
             47813,  65535,  120,    0,
             65535,  47813,  0,      120,
         };
-        ASSERT_TRUE(bitmap.Init({ 2, 2, Bitmap::Format::R16G16B16A16_UNorm, data }));
+        ASSERT_TRUE(InitBitmap(bitmap, Bitmap::Format::R16G16B16A16_UNorm, data));
         ASSERT_EQ(16u, bitmap.GetStride());
     }
 
-    const Vector4 expected[] =
+    const Vec4f expected[] =
     {
-        Vector4(0.0f, 120.0f, 47813.0f, 65535.0f) / 65535.0f,
-        Vector4(120.0f, 0.0f, 65535.0f, 47813.0f) / 65535.0f,
-        Vector4(47813.0f, 65535.0f, 120.0f, 0.0f) / 65535.0f,
-        Vector4(65535.0f, 47813.0f, 0.0f, 120.0f) / 65535.0f,
+        Vec4f(0.0f, 120.0f, 47813.0f, 65535.0f) / 65535.0f,
+        Vec4f(120.0f, 0.0f, 65535.0f, 47813.0f) / 65535.0f,
+        Vec4f(47813.0f, 65535.0f, 120.0f, 0.0f) / 65535.0f,
+        Vec4f(65535.0f, 47813.0f, 0.0f, 120.0f) / 65535.0f,
     };
     Validate_GetPixel(bitmap, expected, 0.00001f);
     Validate_GetPixelBlock(bitmap, expected, 0.00001f);
@@ -294,16 +296,16 @@ TEST(BitmapTest, Format_R32_Float)
             0.2f,
             10000.0f
         };
-        ASSERT_TRUE(bitmap.Init({ 2, 2, Bitmap::Format::R32_Float, data }));
+        ASSERT_TRUE(InitBitmap(bitmap, Bitmap::Format::R32_Float, data));
         ASSERT_EQ(8u, bitmap.GetStride());
     }
 
-    const Vector4 expected[] =
+    const Vec4f expected[] =
     {
-        Vector4(0.0f),
-        Vector4(-123.0f),
-        Vector4(0.2f),
-        Vector4(10000.0f),
+        Vec4f(0.0f),
+        Vec4f(-123.0f),
+        Vec4f(0.2f),
+        Vec4f(10000.0f),
     };
     Validate_GetPixel(bitmap, expected, 0.00001f);
     Validate_GetPixelBlock(bitmap, expected, 0.00001f);
@@ -320,16 +322,16 @@ TEST(BitmapTest, Format_R32G32_Float)
             0.2f,       1000.0f,
             10000.0f,   0.25f,
         };
-        ASSERT_TRUE(bitmap.Init({ 2, 2, Bitmap::Format::R32G32_Float, data }));
+        ASSERT_TRUE(InitBitmap(bitmap, Bitmap::Format::R32G32_Float, data));
         ASSERT_EQ(16u, bitmap.GetStride());
     }
 
-    const Vector4 expected[] =
+    const Vec4f expected[] =
     {
-        Vector4(0.0f, 123.0f),
-        Vector4(-123.0f, 0.0f),
-        Vector4(0.2f, 1000.0f),
-        Vector4(10000.0f, 0.25f),
+        Vec4f(0.0f, 123.0f),
+        Vec4f(-123.0f, 0.0f),
+        Vec4f(0.2f, 1000.0f),
+        Vec4f(10000.0f, 0.25f),
     };
     Validate_GetPixel(bitmap, expected, 0.00001f);
     Validate_GetPixelBlock(bitmap, expected, 0.00001f);
@@ -346,16 +348,16 @@ TEST(BitmapTest, Format_R32G32B32_Float)
             0.2f,       1000.0f,    0.0f,
             10000.0f,   0.25f,      -10.0f,
         };
-        ASSERT_TRUE(bitmap.Init({ 2, 2, Bitmap::Format::R32G32B32_Float, data }));
+        ASSERT_TRUE(InitBitmap(bitmap, Bitmap::Format::R32G32B32_Float, data));
         ASSERT_EQ(24u, bitmap.GetStride());
     }
 
-    const Vector4 expected[] =
+    const Vec4f expected[] =
     {
-        Vector4(0.0f, 123.0f, 100.0f),
-        Vector4(-123.0f, 0.0f, 0.1f),
-        Vector4(0.2f, 1000.0f, 0.0f),
-        Vector4(10000.0f, 0.25f, -10.0f),
+        Vec4f(0.0f, 123.0f, 100.0f),
+        Vec4f(-123.0f, 0.0f, 0.1f),
+        Vec4f(0.2f, 1000.0f, 0.0f),
+        Vec4f(10000.0f, 0.25f, -10.0f),
     };
     Validate_GetPixel(bitmap, expected, 0.00001f);
     Validate_GetPixelBlock(bitmap, expected, 0.00001f);
@@ -372,16 +374,16 @@ TEST(BitmapTest, Format_R32G32B32A32_Float)
             0.2f,       1000.0f,    0.0f,       0.8f,
             10000.0f,   0.25f,      -10.0f,     0.0f,
         };
-        ASSERT_TRUE(bitmap.Init({ 2, 2, Bitmap::Format::R32G32B32A32_Float, data }));
+        ASSERT_TRUE(InitBitmap(bitmap, Bitmap::Format::R32G32B32A32_Float, data));
         ASSERT_EQ(32u, bitmap.GetStride());
     }
 
-    const Vector4 expected[] =
+    const Vec4f expected[] =
     {
-        Vector4(0.0f, 123.0f, 100.0f, -0.1f),
-        Vector4(-123.0f, 0.0f, 0.1f, 200.0f),
-        Vector4(0.2f, 1000.0f, 0.0f, 0.8f),
-        Vector4(10000.0f, 0.25f, -10.0f, 0.0f),
+        Vec4f(0.0f, 123.0f, 100.0f, -0.1f),
+        Vec4f(-123.0f, 0.0f, 0.1f, 200.0f),
+        Vec4f(0.2f, 1000.0f, 0.0f, 0.8f),
+        Vec4f(10000.0f, 0.25f, -10.0f, 0.0f),
     };
     Validate_GetPixel(bitmap, expected, 0.00001f);
     Validate_GetPixelBlock(bitmap, expected, 0.00001f);
@@ -400,16 +402,16 @@ TEST(BitmapTest, Format_R16_Half)
             0.2f,
             1000.0f
         };
-        ASSERT_TRUE(bitmap.Init({ 2, 2, Bitmap::Format::R16_Half, data }));
+        ASSERT_TRUE(InitBitmap(bitmap, Bitmap::Format::R16_Half, data));
         ASSERT_EQ(4u, bitmap.GetStride());
     }
 
-    const Vector4 expected[] =
+    const Vec4f expected[] =
     {
-        Vector4(0.0f),
-        Vector4(-123.0f),
-        Vector4(0.2f),
-        Vector4(1000.0f),
+        Vec4f(0.0f),
+        Vec4f(-123.0f),
+        Vec4f(0.2f),
+        Vec4f(1000.0f),
     };
     Validate_GetPixel(bitmap, expected, 0.001f);
     Validate_GetPixelBlock(bitmap, expected, 0.001f);
@@ -426,16 +428,16 @@ TEST(BitmapTest, Format_R16G16_Half)
             0.2f,       1000.0f,
             1000.0f,    0.25f,
         };
-        ASSERT_TRUE(bitmap.Init({ 2, 2, Bitmap::Format::R16G16_Half, data }));
+        ASSERT_TRUE(InitBitmap(bitmap, Bitmap::Format::R16G16_Half, data));
         ASSERT_EQ(8u, bitmap.GetStride());
     }
 
-    const Vector4 expected[] =
+    const Vec4f expected[] =
     {
-        Vector4(0.0f, 123.0f),
-        Vector4(-123.0f, 0.0f),
-        Vector4(0.2f, 1000.0f),
-        Vector4(1000.0f, 0.25f),
+        Vec4f(0.0f, 123.0f),
+        Vec4f(-123.0f, 0.0f),
+        Vec4f(0.2f, 1000.0f),
+        Vec4f(1000.0f, 0.25f),
     };
     Validate_GetPixel(bitmap, expected, 0.001f);
     Validate_GetPixelBlock(bitmap, expected, 0.001f);
@@ -452,16 +454,16 @@ TEST(BitmapTest, Format_R16G16B16_Half)
             0.2f,       1000.0f,    0.0f,
             1000.0f,    0.25f,      -10.0f,
         };
-        ASSERT_TRUE(bitmap.Init({ 2, 2, Bitmap::Format::R16G16B16_Half, data }));
+        ASSERT_TRUE(InitBitmap(bitmap, Bitmap::Format::R16G16B16_Half, data));
         ASSERT_EQ(12u, bitmap.GetStride());
     }
 
-    const Vector4 expected[] =
+    const Vec4f expected[] =
     {
-        Vector4(0.0f, 123.0f, 100.0f),
-        Vector4(-123.0f, 0.0f, 0.1f),
-        Vector4(0.2f, 1000.0f, 0.0f),
-        Vector4(1000.0f, 0.25f, -10.0f),
+        Vec4f(0.0f, 123.0f, 100.0f),
+        Vec4f(-123.0f, 0.0f, 0.1f),
+        Vec4f(0.2f, 1000.0f, 0.0f),
+        Vec4f(1000.0f, 0.25f, -10.0f),
     };
     Validate_GetPixel(bitmap, expected, 0.001f);
     Validate_GetPixelBlock(bitmap, expected, 0.001f);
@@ -478,16 +480,16 @@ TEST(BitmapTest, Format_R16G16B16A16_Half)
             0.2f,       1000.0f,    0.0f,       0.8f,
             1000.0f,    0.25f,      -10.0f,     0.0f,
         };
-        ASSERT_TRUE(bitmap.Init({ 2, 2, Bitmap::Format::R16G16B16A16_Half, data }));
+        ASSERT_TRUE(InitBitmap(bitmap, Bitmap::Format::R16G16B16A16_Half, data));
         ASSERT_EQ(16u, bitmap.GetStride());
     }
 
-    const Vector4 expected[] =
+    const Vec4f expected[] =
     {
-        Vector4(0.0f, 123.0f, 100.0f, -0.1f),
-        Vector4(-123.0f, 0.0f, 0.1f, 200.0f),
-        Vector4(0.2f, 1000.0f, 0.0f, 0.8f),
-        Vector4(1000.0f, 0.25f, -10.0f, 0.0f),
+        Vec4f(0.0f, 123.0f, 100.0f, -0.1f),
+        Vec4f(-123.0f, 0.0f, 0.1f, 200.0f),
+        Vec4f(0.2f, 1000.0f, 0.0f, 0.8f),
+        Vec4f(1000.0f, 0.25f, -10.0f, 0.0f),
     };
     Validate_GetPixel(bitmap, expected, 0.001f);
     Validate_GetPixelBlock(bitmap, expected, 0.001f);
@@ -0,0 +1,132 @@
+#include "PCH.h"
+#include "Engine/Raytracer/Utils/Bitmap.h"
+#include "Engine/Common/Containers/DynArray.hpp"
+#include "Engine/Common/Math/Random.hpp"
+#include "Engine/Common/Utils/TaskBuilder.hpp"
+#include "Engine/Common/Utils/Waitable.hpp"
+
+using namespace NFE;
+using namespace NFE::RT;
+using namespace NFE::Math;
+using namespace NFE::Common;
+
+
+class BlockCompressionTest : public ::testing::Test
+{
+protected:
+    static constexpr uint32 Width = 16;
+    static constexpr uint32 Height = 12;
+
+    // fill bitmap with random blocks and compare whole block decoding with per-pixel decoding
+    void VerifyBlockDecode(Bitmap::Format format, uint32 bytesPerBlock)
+    {
+        ASSERT_TRUE(Bitmap::IsBlockCompressed(format));
+
+        // random block data covers all palette modes (e.g. BC1 with and without alpha)
+        Random random(1234);
+        DynArray<uint8> data;
+        data.Resize(bytesPerBlock * (Width / 4u) * (Height / 4u));
+        for (uint8& value : data)
+        {
+            value = random.Get<uint8>();
+        }
+
+        Bitmap::InitData initData;
+        initData.width = Width;
+        initData.height = Height;
+        initData.format = format;
+        initData.data = data.Data();
+
+        Bitmap bitmap;
+        ASSERT_TRUE(bitmap.Init(initData));
+
+        for (uint32 blockY = 0; blockY < Height / 4u; ++blockY)
+        {
+            for (uint32 blockX = 0; blockX < Width / 4u; ++blockX)
+            {
+                Vec4f colors[16];
+                bitmap.GetCompressedBlock(blockX, blockY, colors);
+
+                for (uint32 i = 0; i < 16; ++i)
+                {
+                    const uint32 x = 4u * blockX + i % 4u;
+                    const uint32 y = 4u * blockY + i / 4u;
+                    const Vec4f expected = bitmap.GetPixel(x, y);
+                    EXPECT_EQ(expected.x, colors[i].x) << "x=" << x << " y=" << y;
+                    EXPECT_EQ(expected.y, colors[i].y) << "x=" << x << " y=" << y;
+                    EXPECT_EQ(expected.z, colors[i].z) << "x=" << x << " y=" << y;
+                    EXPECT_EQ(expected.w, colors[i].w) << "x=" << x << " y=" << y;
+                }
+            }
+        }
+    }
+};
+
+TEST_F(BlockCompressionTest, BC1)
+{
+    VerifyBlockDecode(Bitmap::Format::BC1, 8);
+}
+
+TEST_F(BlockCompressionTest, BC1_sRGB)
+{
+    VerifyBlockDecode(Bitmap::Format::BC1_sRGB, 8);
+}
+
+TEST_F(BlockCompressionTest, BC4)
+{
+    VerifyBlockDecode(Bitmap::Format::BC4, 8);
+}
+
+TEST_F(BlockCompressionTest, BC5)
+{
+    VerifyBlockDecode(Bitmap::Format::BC5, 16);
+}
+
+TEST_F(BlockCompressionTest, IsBlockCompressed)
+{
+    EXPECT_FALSE(Bitmap::IsBlockCompressed(Bitmap::Format::Unknown));
+    EXPECT_FALSE(Bitmap::IsBlockCompressed(Bitmap::Format::R8G8B8A8_UNorm));
+    EXPECT_FALSE(Bitmap::IsBlockCompressed(Bitmap::Format::R32G32B32_Float));
+}
+
+TEST_F(BlockCompressionTest, CompressInSubtasks)
+{
+    Random random(1234);
+    DynArray<uint8> data;
+    data.Resize(Width * Height);
+    for (uint8& value : data)
+    {
+        value = random.Get<uint8>();
+    }
+
+    Bitmap::InitData initData;
+    initData.width = Width;
+    initData.height = Height;
+    initData.format = Bitmap::Format::R8_UNorm;
+    initData.data = data.Data();
+
+    Bitmap expected;
+    ASSERT_TRUE(expected.Init(initData));
+    ASSERT_TRUE(expected.BlockCompress());
+
+    // compressed from a worker task, the bitmap is ready when the parent task finishes
+    Bitmap bitmap;
+    ASSERT_TRUE(bitmap.Init(initData));
+
+    bool result = false;
+    Waitable waitable;
+    {
+        TaskBuilder builder(waitable);
+        builder.Task("CompressInSubtasks", [&](const TaskContext& context)
+        {
+            TaskBuilder compressionBuilder(context);
+            result = bitmap.BlockCompress(compressionBuilder);
+        });
+    }
+    waitable.Wait();
+
+    ASSERT_TRUE(result);
+    ASSERT_EQ(Bitmap::Format::BC4, bitmap.GetFormat());
+    ASSERT_EQ(expected.GetDataSize(), bitmap.GetDataSize());
+    EXPECT_EQ(0, memcmp(expected.GetData(), bitmap.GetData(), expected.GetDataSize()));
+}
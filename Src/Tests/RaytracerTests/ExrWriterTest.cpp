@@ -0,0 +1,329 @@
+#include "PCH.h"
+#include "Engine/Raytracer/Utils/ExrWriter.h"
+#include "Engine/Raytracer/Utils/Bitmap.h"
+#include "Engine/Common/Containers/String.hpp"
+#include "Engine/Common/FileSystem/FileSystem.hpp"
+#include "Engine/Common/Math/Half.hpp"
+#include "Engine/Common/Math/Random.hpp"
+#include "Engine/Common/Math/Vec3f.hpp"
+#include "tinyexr/tinyexr.h"
+
+using namespace NFE;
+using namespace NFE::RT;
+using namespace NFE::Math;
+using namespace NFE::Common;
+
+namespace {
+
+const String TEST_FILE{ "exr_writer_test.exr" };
+
+} // namespace
+
+class ExrWriterTest : public ::testing::Test
+{
+protected:
+    // height is not a multiple of ZIP chunk height (16 scanlines)
+    static constexpr uint32 Width = 37;
+    static constexpr uint32 Height = 45;
+
+    void SetUp() override
+    {
+        FileSystem::Remove(TEST_FILE);
+
+        Bitmap::InitData initData;
+        initData.width = Width;
+        initData.height = Height;
+        initData.format = Bitmap::Format::R32G32B32_Float;
+        ASSERT_TRUE(mSource.Init(initData));
+
+        // only non-negative values, the loader clamps negative ones
+        Random random(1234);
+        for (uint32 y = 0; y < Height; ++y)
+        {
+            for (uint32 x = 0; x < Width; ++x)
+            {
+                mSource.GetPixelRef<Vec3f>(x, y) = random.GetVec3f() * 10.0f;
+            }
+        }
+    }
+
+    void TearDown() override
+    {
+        FileSystem::Remove(TEST_FILE);
+    }
+
+    Bitmap mSource;
+};
+
+TEST_F(ExrWriterTest, ZipFloat)
+{
+    ExrWriter::PartDesc part;
+    part.source = &mSource;
+    part.pixelType = ExrWriter::PixelType::Float;
+    part.compression = ExrWriter::Compression::ZIP;
+
+    {
+        ExrWriter writer;
+        ASSERT_TRUE(writer.Open(TEST_FILE.Str(), ArrayView<const ExrWriter::PartDesc>(&part, 1)));
+
+        // rows are submitted in batches, the rest is submitted when closing
+        EXPECT_TRUE(writer.WriteRows(10));
+        EXPECT_TRUE(writer.WriteRows(33));
+        EXPECT_TRUE(writer.Close());
+        EXPECT_FALSE(writer.IsOpened());
+    }
+
+    Bitmap loaded;
+    ASSERT_TRUE(loaded.Load(TEST_FILE.Str()));
+    ASSERT_EQ(Bitmap::Format::R32G32B32_Float, loaded.GetFormat());
+    ASSERT_EQ(Width, loaded.GetWidth());
+    ASSERT_EQ(Height, loaded.GetHeight());
+
+    for (uint32 y = 0; y < Height; ++y)
+    {
+        for (uint32 x = 0; x < Width; ++x)
+        {
+            const Vec3f& expected = mSource.GetPixelRef<Vec3f>(x, y);
+            const Vec3f& actual = loaded.GetPixelRef<Vec3f>(x, y);
+            EXPECT_EQ(expected.x, actual.x) << "x=" << x << " y=" << y;
+            EXPECT_EQ(expected.y, actual.y) << "x=" << x << " y=" << y;
+            EXPECT_EQ(expected.z, actual.z) << "x=" << x << " y=" << y;
+        }
+    }
+}
+
+TEST_F(ExrWriterTest, ZipHalfScaled)
+{
+    const float scale = 0.5f;
+
+    ExrWriter::PartDesc part;
+    part.source = &mSource;
+    part.pixelType = ExrWriter::PixelType::Half;
+    part.compression = ExrWriter::Compression::ZIP;
+    part.scale = scale;
+
+    {
+        ExrWriter writer;
+        ASSERT_TRUE(writer.Open(TEST_FILE.Str(), ArrayView<const ExrWriter::PartDesc>(&part, 1)));
+        EXPECT_TRUE(writer.Close());
+    }
+
+    Bitmap loaded;
+    ASSERT_TRUE(loaded.Load(TEST_FILE.Str()));
+    ASSERT_EQ(Bitmap::Format::R16G16B16_Half, loaded.GetFormat());
+    ASSERT_EQ(Width, loaded.GetWidth());
+    ASSERT_EQ(Height, loaded.GetHeight());
+
+    for (uint32 y = 0; y < Height; ++y)
+    {
+        const Half* row = reinterpret_cast<const Half*>(loaded.GetData() + static_cast<size_t>(loaded.GetStride()) * y);
+        for (uint32 x = 0; x < Width; ++x)
+        {
+            const Vec3f& expected = mSource.GetPixelRef<Vec3f>(x, y);
+            EXPECT_EQ(Half(scale * expected.x).value, row[3 * x].value) << "x=" << x << " y=" << y;
+            EXPECT_EQ(Half(scale * expected.y).value, row[3 * x + 1].value) << "x=" << x << " y=" << y;
+            EXPECT_EQ(Half(scale * expected.z).value, row[3 * x + 2].value) << "x=" << x << " y=" << y;
+        }
+    }
+}
+
+TEST_F(ExrWriterTest, MultiPart)
+{
+    // second part is a single channel image, so the parts differ in channels, pixel types and chunk sizes
+    Bitmap::InitData initData;
+    initData.width = Width;
+    initData.height = Height;
+    initData.format = Bitmap::Format::R32_Float;
+    Bitmap depth;
+    ASSERT_TRUE(depth.Init(initData));
+
+    Random random(5678);
+    for (uint32 y = 0; y < Height; ++y)
+    {
+        for (uint32 x = 0; x < Width; ++x)
+        {
+            depth.GetPixelRef<float>(x, y) = random.GetFloat() * 100.0f;
+        }
+    }
+
+    ExrWriter::PartDesc parts[2];
+    parts[0].name = "color";
+    parts[0].source = &mSource;
+    parts[0].pixelType = ExrWriter::PixelType::Float;
+    parts[0].compression = ExrWriter::Compression::ZIP;
+    parts[1].name = "depth";
+    parts[1].source = &depth;
+    parts[1].pixelType = ExrWriter::PixelType::Float;
+    parts[1].compression = ExrWriter::Compression::ZIPS;
+
+    const char* expectedNames[] = { "color", "depth" };
+    const int expectedChunkCounts[] = { (Height + 15) / 16, Height };
+    const uint32 expectedNumChannels[] = { 3, 1 };
+    const Bitmap* expectedSources[] = { &mSource, &depth };
+
+    {
+        ExrWriter writer;
+        ASSERT_TRUE(writer.Open(TEST_FILE.Str(), ArrayView<const ExrWriter::PartDesc>(parts, 2)));
+        EXPECT_TRUE(writer.WriteRows(20));
+        EXPECT_TRUE(writer.Close());
+    }
+
+    // load with tinyexr
+    {
+        EXRVersion exrVersion;
+        ASSERT_EQ(TINYEXR_SUCCESS, ParseEXRVersionFromFile(&exrVersion, TEST_FILE.Str()));
+        ASSERT_TRUE(exrVersion.multipart);
+
+        EXRHeader** exrHeaders = nullptr;
+        int numHeaders = 0;
+        const char* err = nullptr;
+        ASSERT_EQ(TINYEXR_SUCCESS, ParseEXRMultipartHeaderFromFile(&exrHeaders, &numHeaders, &exrVersion, TEST_FILE.Str(), &err));
+        ASSERT_EQ(2, numHeaders);
+
+        for (int i = 0; i < numHeaders; ++i)
+        {
+            EXPECT_STREQ(expectedNames[i], exrHeaders[i]->name);
+            EXPECT_EQ(0, exrHeaders[i]->tiled);
+            EXPECT_EQ(expectedChunkCounts[i], exrHeaders[i]->chunk_count);
+            ASSERT_EQ(static_cast<int>(expectedNumChannels[i]), exrHeaders[i]->num_channels);
+
+            for (int c = 0; c < exrHeaders[i]->num_channels; ++c)
+            {
+                exrHeaders[i]->requested_pixel_types[c] = TINYEXR_PIXELTYPE_FLOAT;
+            }
+        }
+
+        EXRImage exrImages[2];
+        InitEXRImage(&exrImages[0]);
+        InitEXRImage(&exrImages[1]);
+        ASSERT_EQ(TINYEXR_SUCCESS, LoadEXRMultipartImageFromFile(exrImages, const_cast<const EXRHeader**>(exrHeaders), 2, TEST_FILE.Str(), &err));
+
+        for (uint32 i = 0; i < 2; ++i)
+        {
+            ASSERT_EQ(static_cast<int>(Width), exrImages[i].width);
+            ASSERT_EQ(static_cast<int>(Height), exrImages[i].height);
+
+            // channels are sorted alphabetically (B, G, R)
+            const uint32 numChannels = expectedNumChannels[i];
+            for (uint32 c = 0; c < numChannels; ++c)
+            {
+                const float* channel = reinterpret_cast<const float*>(exrImages[i].images[c]);
+                const uint32 component = numChannels - 1 - c;
+
+                for (uint32 y = 0; y < Height; ++y)
+                {
+                    const float* sourceRow = reinterpret_cast<const float*>(expectedSources[i]->GetData() + static_cast<size_t>(expectedSources[i]->GetStride()) * y);
+                    for (uint32 x = 0; x < Width; ++x)
+                    {
+                        EXPECT_EQ(sourceRow[numChannels * x + component], channel[Width * y + x]) << "part=" << i << " x=" << x << " y=" << y;
+                    }
+                }
+            }
+
+            FreeEXRImage(&exrImages[i]);
+        }
+
+        for (int i = 0; i < numHeaders; ++i)
+        {
+            FreeEXRHeader(exrHeaders[i]);
+            free(exrHeaders[i]);
+        }
+        free(exrHeaders);
+    }
+
+    // check raw file structure: part type attributes and part numbers of the chunks
+    {
+        FILE* file = fopen(TEST_FILE.Str(), "rb");
+        ASSERT_NE(nullptr, file);
+        fseek(file, 0, SEEK_END);
+        const long fileSize = ftell(file);
+        fseek(file, 0, SEEK_SET);
+        DynArray<uint8> data;
+        data.Resize(static_cast<uint32>(fileSize));
+        ASSERT_EQ(1u, fread(data.Data(), data.Size(), 1, file));
+        fclose(file);
+
+        const auto readString = [&](uint32& offset) -> String
+        {
+            const String str(reinterpret_cast<const char*>(data.Data() + offset));
+            offset += str.Length() + 1;
+            return str;
+        };
+
+        const auto readInt = [&](uint32& offset) -> int32
+        {
+            int32 value;
+            memcpy(&value, data.Data() + offset, sizeof(value));
+            offset += sizeof(value);
+            return value;
+        };
+
+        // magic + version
+        uint32 offset = 8;
+
+        for (uint32 i = 0; i < 2; ++i)
+        {
+            String type;
+            int32 chunkCount = 0;
+            while (data[offset] != 0)
+            {
+                const String attributeName = readString(offset);
+                readString(offset); // attribute type
+                const int32 attributeSize = readInt(offset);
+
+                if (attributeName == StringView("type"))
+                {
+                    type = String(reinterpret_cast<const char*>(data.Data() + offset), attributeSize);
+                }
+                else if (attributeName == StringView("chunkCount"))
+                {
+                    memcpy(&chunkCount, data.Data() + offset, sizeof(chunkCount));
+                }
+
+                offset += attributeSize;
+            }
+            offset++;
+
+            EXPECT_STREQ("scanlineimage", type.Str()) << "part=" << i;
+            EXPECT_EQ(expectedChunkCounts[i], chunkCount) << "part=" << i;
+        }
+
+        // end of headers list
+        ASSERT_EQ(0u, data[offset]);
+        offset++;
+
+        for (uint32 i = 0; i < 2; ++i)
+        {
+            for (int32 j = 0; j < expectedChunkCounts[i]; ++j)
+            {
+                uint64 chunkOffset;
+                memcpy(&chunkOffset, data.Data() + offset, sizeof(chunkOffset));
+                offset += sizeof(chunkOffset);
+                ASSERT_LT(chunkOffset, data.Size());
+
+                uint32 chunkPosition = static_cast<uint32>(chunkOffset);
+                EXPECT_EQ(static_cast<int32>(i), readInt(chunkPosition)) << "part=" << i << " chunk=" << j;
+                EXPECT_EQ(j * (i == 0 ? 16 : 1), readInt(chunkPosition)) << "part=" << i << " chunk=" << j;
+            }
+        }
+    }
+}
+
+TEST_F(ExrWriterTest, FailedOpen)
+{
+    Bitmap::InitData initData;
+    initData.width = Width;
+    initData.height = Height;
+    initData.format = Bitmap::Format::B8G8R8A8_UNorm;
+    Bitmap unsupportedSource;
+    ASSERT_TRUE(unsupportedSource.Init(initData));
+
+    ExrWriter::PartDesc part;
+    part.source = &unsupportedSource;
+
+    ExrWriter writer;
+    EXPECT_FALSE(writer.Open(TEST_FILE.Str(), ArrayView<const ExrWriter::PartDesc>(&part, 1)));
+    EXPECT_FALSE(writer.IsOpened());
+    EXPECT_FALSE(writer.WriteRows(Height));
+    EXPECT_FALSE(writer.Close());
+}
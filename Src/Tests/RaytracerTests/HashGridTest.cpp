@@ -1,72 +1,74 @@
 #include "PCH.h"
-#include "../Core/Utils/HashGrid.h"
+#include "Engine/Raytracer/Utils/HashGrid.h"
+#include "Engine/Common/Math/Random.hpp"
+#include "Engine/Common/Containers/DynArray.hpp"
 
-using namespace rt;
-using namespace rt::math;
+using namespace NFE;
+using namespace NFE::RT;
+using namespace NFE::Math;
+using namespace NFE::Common;
 
 
 TEST(UtilsTest, HashGrid_RandomPoints)
 {
     const uint32 numPoints = 50000;
-    const uint32 numQueries = 10000;
+    const uint32 numQueries = 1000;
     const float particleRadius = 1.0f;
     const float boxSize = 100.0f;
-    const float queryBoxMarigin = 2.0f;
+    const float queryBoxMargin = 2.0f;
 
-    Random random;
+    Random random(1234);
 
     struct Particle
     {
-        Vector4 pos;
-        RT_FORCE_INLINE const Vector4& GetPosition() const { return pos; }
+        Vec4f pos;
+        NFE_FORCE_INLINE const Vec4f& GetPosition() const { return pos; }
     };
 
     DynArray<Particle> particles;
     for (uint32 i = 0; i < numPoints; ++i)
     {
-        particles.PushBack({ random.GetVector4Bipolar() * boxSize });
+        particles.PushBack({ random.GetVec4fBipolar() * boxSize });
     }
 
     HashGrid grid;
     grid.Build(particles, particleRadius);
 
-    std::vector<uint32> referenceIndices;
-
     struct Query
     {
-        void operator()(uint32 index)
+        void operator()(uint32 index, float)
         {
-            collectedIndices.push_back(index);
+            collectedIndices.PushBack(index);
         }
 
-        std::vector<uint32> collectedIndices;
+        DynArray<uint32> collectedIndices;
     };
 
     Query query;
+    DynArray<uint32> referenceIndices;
 
     for (uint32 i = 0; i < numQueries; ++i)
     {
-        const Vector4 queryPoint = random.GetVector4Bipolar() * (boxSize + queryBoxMarigin);
+        const Vec4f queryPoint = random.GetVec4fBipolar() * (boxSize + queryBoxMargin);
         SCOPED_TRACE("Query point: [" + std::to_string(queryPoint.x) + ',' + std::to_string(queryPoint.y) + ',' + std::to_string(queryPoint.z) + "]");
 
         // collect using hash grid
-        query.collectedIndices.clear();
+        query.collectedIndices.Clear();
         grid.Process(queryPoint, particles, query);
         std::sort(query.collectedIndices.begin(), query.collectedIndices.end());
 
         // collect via brute force check
-        referenceIndices.clear();
+        referenceIndices.Clear();
         for (uint32 j = 0; j < numPoints; ++j)
         {
             if ((queryPoint - particles[j].pos).SqrLength3() <= particleRadius * particleRadius)
             {
-                referenceIndices.push_back(j);
+                referenceIndices.PushBack(j);
             }
         }
 
-        ASSERT_EQ(referenceIndices.size(), query.collectedIndices.size());
-
-        for (size_t j = 0; j < referenceIndices.size(); ++j)
+        ASSERT_EQ(referenceIndices.Size(), query.collectedIndices.Size());
+        for (uint32 j = 0; j < referenceIndices.Size(); ++j)
         {
             ASSERT_EQ(referenceIndices[j], query.collectedIndices[j]) << j;
         }
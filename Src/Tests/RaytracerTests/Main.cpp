@@ -1,14 +1,24 @@
 #include "PCH.h"
-#include "../Core/Math/Math.h"
+#include "Engine/Common/Math/Math.hpp"
 
-int main(int argc, char **argv)
+
+int main(int argc, char* argv[])
 {
-    rt::math::SetFlushDenormalsToZero();
+    if (!NFE::Common::InitSubsystems())
+    {
+        NFE::Common::ShutdownSubsystems();
+        return -1;
+    }
 
     testing::InitGoogleTest(&argc, argv);
-    const int result = RUN_ALL_TESTS();
 
-    RT_ASSERT(rt::math::GetFlushDenormalsToZero(), "Something disabled flushing denormal float to zero");
+    NFE::Math::SetFlushDenormalsToZero();
+
+    int result = RUN_ALL_TESTS();
+
+    NFE::Common::ShutdownSubsystems();
+
+    NFE_ASSERT(NFE::Math::GetFlushDenormalsToZero(), "Something disabled flushing denormal float to zero");
 
     return result;
 }
@@ -1,17 +1,48 @@
 #pragma once
 
-#if defined(_DEBUG) && defined(WIN32)
+// enable memory allocation tracking (Windows only)
+#if defined(NFE_PLATFORM_WINDOWS) && defined(NFE_CONFIGURATION_DEBUG)
 #define _CRTDBG_MAP_ALLOC
 #include <stdlib.h>
 #include <crtdbg.h>
-#endif // _DEBUG
+#endif // defined(NFE_PLATFORM_WINDOWS) && defined(NFE_CONFIGURATION_DEBUG)
+
+#ifdef NFE_PLATFORM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#endif // NFE_PLATFORM_WINDOWS
+
+#ifdef NFE_USE_SSE
+#include <xmmintrin.h>
+#endif // NFE_USE_SSE
+
+#if defined(NFE_USE_AVX2) | defined(NFE_USE_AVX) | defined(NFE_USE_FMA)
+#include <immintrin.h>
+#endif // defined(NFE_USE_AVX2) | defined(NFE_USE_AVX) | defined(NFE_USE_FMA)
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
 
-#include <sstream>
-#include <array>
-#include <string>
 #include <vector>
+#include <algorithm>
 #include <memory>
+#include <atomic>
+#include <string>
 #include <limits>
 #include <functional>
+#include <type_traits>
+#include <sstream>
 
 #include "gtest/gtest.h"
+
+#include "Engine/Common/nfCommon.hpp"
+#include "Engine/Raytracer/Raytracer.h"
+
+// disable some Visual Studio specific warnings
+#ifdef _MSC_VER
+#pragma warning(disable: 4324) // "structure was padded due to alignment specifier"
+#endif
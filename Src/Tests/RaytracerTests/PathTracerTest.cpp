@@ -0,0 +1,170 @@
+#include "PCH.h"
+#include "Engine/Raytracer/Rendering/Viewport.h"
+#include "Engine/Raytracer/Scene/Scene.h"
+#include "Engine/Raytracer/Scene/Object/SceneObject_Light.h"
+#include "Engine/Raytracer/Scene/Object/SceneObject_Shape.h"
+#include "Engine/Raytracer/Scene/Light/BackgroundLight.h"
+#include "Engine/Raytracer/Shapes/MeshShape.h"
+#include "Engine/Raytracer/Material/Material.h"
+#include "Engine/Raytracer/Textures/CheckerboardTexture.h"
+#include "Engine/Common/Containers/DynArray.hpp"
+
+using namespace NFE;
+using namespace NFE::RT;
+using namespace NFE::Math;
+using namespace NFE::Common;
+
+
+class PathTracerTest : public ::testing::Test
+{
+protected:
+    static constexpr uint32 Width = 32;
+    static constexpr uint32 Height = 24;
+
+    void SetUp() override
+    {
+        mScene.AddObject(MakeUniquePtr<LightSceneObject>(MakeUniquePtr<BackgroundLight>(HdrColorRGB(BackgroundColor))));
+
+        // two emissive quads with textured and constant emission
+        // NOTE: only meshes support packet traversal
+        {
+            MaterialPtr texturedMaterial = Material::Create();
+            texturedMaterial->emission = HdrColorRGB(1.0f, 1.0f, 1.0f);
+            texturedMaterial->emission.SetTexture(MakeSharedPtr<CheckerboardTexture>(Vec4f(1.0f, 0.5f, 0.25f), Vec4f(0.1f, 0.2f, 0.3f)));
+            texturedMaterial->Compile();
+
+            MaterialPtr constMaterial = Material::Create();
+            constMaterial->emission = HdrColorRGB(2.0f, 3.0f, 4.0f);
+            constMaterial->Compile();
+
+            const MaterialPtr materials[] = { texturedMaterial, constMaterial };
+
+            DynArray<Vec3f> positions;
+            DynArray<Vec3f> normals;
+            DynArray<Vec3f> tangents;
+            DynArray<Vec2f> texCoords;
+            DynArray<uint32> vertexIndices;
+            DynArray<uint32> materialIndices;
+
+            for (uint32 i = 0; i < 2; ++i)
+            {
+                const uint32 firstVertex = positions.Size();
+                const float minX = i == 0 ? -1.3f : 0.1f;
+                const float maxX = minX + 1.2f;
+
+                positions.PushBack(Vec3f(minX, -0.8f, 0.0f));
+                positions.PushBack(Vec3f(maxX, -0.8f, 0.0f));
+                positions.PushBack(Vec3f(maxX, 0.8f, 0.0f));
+                positions.PushBack(Vec3f(minX, 0.8f, 0.0f));
+                texCoords.PushBack(Vec2f(0.0f, 0.0f));
+                texCoords.PushBack(Vec2f(1.0f, 0.0f));
+                texCoords.PushBack(Vec2f(1.0f, 1.0f));
+                texCoords.PushBack(Vec2f(0.0f, 1.0f));
+
+                for (uint32 j = 0; j < 4; ++j)
+                {
+                    normals.PushBack(Vec3f(0.0f, 0.0f, -1.0f));
+                    tangents.PushBack(Vec3f(1.0f, 0.0f, 0.0f));
+                }
+
+                for (const uint32 index : { 0u, 1u, 2u, 0u, 2u, 3u })
+                {
+                    vertexIndices.PushBack(firstVertex + index);
+                }
+
+                materialIndices.PushBack(i);
+                materialIndices.PushBack(i);
+            }
+
+            MeshDesc meshDesc;
+            meshDesc.vertexBufferDesc.numVertices = positions.Size();
+            meshDesc.vertexBufferDesc.numTriangles = materialIndices.Size();
+            meshDesc.vertexBufferDesc.numMaterials = 2;
+            meshDesc.vertexBufferDesc.materials = materials;
+            meshDesc.vertexBufferDesc.vertexIndexBuffer = vertexIndices.Data();
+            meshDesc.vertexBufferDesc.positions = positions.Data();
+            meshDesc.vertexBufferDesc.normals = normals.Data();
+            meshDesc.vertexBufferDesc.tangents = tangents.Data();
+            meshDesc.vertexBufferDesc.texCoords = texCoords.Data();
+            meshDesc.vertexBufferDesc.materialIndexBuffer = materialIndices.Data();
+
+            MeshShapePtr mesh = MakeSharedPtr<MeshShape>();
+            ASSERT_TRUE(mesh->Initialize(meshDesc));
+            // objects without material are treated as media boundaries
+            ShapeSceneObjectPtr object = MakeUniquePtr<ShapeSceneObject>(mesh);
+            object->BindMaterial(texturedMaterial);
+            mScene.AddObject(std::move(object));
+        }
+
+        ASSERT_TRUE(mScene.BuildBVH());
+
+        mCamera.SetTransform(Transform(Vec4f(0.0f, 0.0f, -3.0f)));
+        mCamera.SetPerspective(static_cast<float>(Width) / static_cast<float>(Height), DegToRad(60.0f));
+
+        mRenderer = CreateRenderer("NFE::RT::PathTracer", mScene);
+        ASSERT_TRUE(mRenderer);
+    }
+
+    void Render(TraversalMode traversalMode, Viewport& viewport)
+    {
+        // primary hits only, no jittering, so the result is deterministic
+        RenderingParams params;
+        params.traversalMode = traversalMode;
+        params.maxRayDepth = 0;
+        params.antiAliasingSpread = 0.0f;
+        params.motionBlurStrength = 0.0f;
+
+        ASSERT_TRUE(viewport.SetRenderingParams(params));
+        ASSERT_TRUE(viewport.SetRenderer(mRenderer.Get()));
+        ASSERT_TRUE(viewport.Resize(Width, Height));
+        ASSERT_TRUE(viewport.Render(mScene, mCamera));
+    }
+
+    static constexpr float BackgroundColor = 0.25f;
+
+    Scene mScene;
+    Camera mCamera;
+    RendererPtr mRenderer;
+};
+
+TEST_F(PathTracerTest, PacketMatchesSingle)
+{
+    Viewport singleViewport;
+    Render(TraversalMode::Single, singleViewport);
+
+    Viewport packetViewport;
+    Render(TraversalMode::Packet, packetViewport);
+
+    uint32 numBackgroundPixels = 0;
+    uint32 numMismatchedPixels = 0;
+    for (uint32 y = 0; y < Height; ++y)
+    {
+        for (uint32 x = 0; x < Width; ++x)
+        {
+            const Vec3f& expected = singleViewport.GetSumBuffer().GetPixelRef<Vec3f>(x, y);
+            const Vec3f& actual = packetViewport.GetSumBuffer().GetPixelRef<Vec3f>(x, y);
+
+            // all pixels must be rendered
+            EXPECT_LT(0.0f, actual.x) << "x=" << x << " y=" << y;
+
+            const Vec3f diff = Vec3f::Abs(expected - actual);
+            if (Max(diff.x, Max(diff.y, diff.z)) > 1.0e-4f)
+            {
+                numMismatchedPixels++;
+            }
+
+            const Vec3f backgroundDiff = Vec3f::Abs(expected - Vec3f(BackgroundColor));
+            if (Max(backgroundDiff.x, Max(backgroundDiff.y, backgroundDiff.z)) < 1.0e-4f)
+            {
+                numBackgroundPixels++;
+            }
+        }
+    }
+
+    // both objects and background are visible
+    EXPECT_LT(0u, numBackgroundPixels);
+    EXPECT_GT(Width * Height, numBackgroundPixels);
+
+    // single and packet rays differ slightly, allow a few mismatches on edges (of objects and checkerboard cells)
+    EXPECT_GE(Width * Height / 100u, numMismatchedPixels);
+}
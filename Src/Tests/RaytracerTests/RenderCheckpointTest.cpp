@@ -0,0 +1,284 @@
+#include "PCH.h"
+#include "Engine/Raytracer/Rendering/RenderCheckpoint.h"
+#include "Engine/Raytracer/Rendering/RenderingParams.h"
+#include "Engine/Raytracer/Scene/Camera.h"
+#include "Engine/Raytracer/Textures/Texture.h"
+#include "Engine/Raytracer/Utils/Bitmap.h"
+#include "Engine/Common/Containers/String.hpp"
+#include "Engine/Common/FileSystem/FileSystem.hpp"
+#include "Engine/Common/FileSystem/MemoryMappedFile.hpp"
+#include "Engine/Common/Math/Random.hpp"
+#include "Engine/Common/Math/Vec3f.hpp"
+
+using namespace NFE;
+using namespace NFE::RT;
+using namespace NFE::Math;
+using namespace NFE::Common;
+
+namespace {
+
+const String TEST_FILE{ "render_checkpoint_test.bin" };
+
+} // namespace
+
+class RenderCheckpointTest : public ::testing::Test
+{
+protected:
+    static constexpr uint32 Width = 33;
+    static constexpr uint32 Height = 17;
+    static constexpr uint32 MaxBlocks = 8;
+    static constexpr uint64 IdentityHash = 0x1234;
+
+    // image data of a single checkpoint
+    struct Image
+    {
+        Bitmap sum;
+        Bitmap secondarySum;
+        DynArray<uint32> extraSamples;
+        DynArray<RenderCheckpoint::Block> blocks;
+        RenderCheckpoint::State state;
+    };
+
+    void SetUp() override
+    {
+        FileSystem::Remove(TEST_FILE);
+    }
+
+    void TearDown() override
+    {
+        EXPECT_TRUE(FileSystem::Remove(TEST_FILE));
+    }
+
+    void InitImage(Image& image, uint32 seed)
+    {
+        Random random(seed);
+
+        Bitmap::InitData initData;
+        initData.width = Width;
+        initData.height = Height;
+        initData.format = Bitmap::Format::R32G32B32_Float;
+        ASSERT_TRUE(image.sum.Init(initData));
+        ASSERT_TRUE(image.secondarySum.Init(initData));
+
+        image.extraSamples.Resize(Width * Height);
+
+        for (uint32 y = 0; y < Height; ++y)
+        {
+            for (uint32 x = 0; x < Width; ++x)
+            {
+                image.sum.GetPixelRef<Vec3f>(x, y) = Vec3f(random.GetFloat(), random.GetFloat(), random.GetFloat());
+                image.secondarySum.GetPixelRef<Vec3f>(x, y) = Vec3f(random.GetFloat(), random.GetFloat(), random.GetFloat());
+                image.extraSamples[y * Width + x] = random.GetInt();
+            }
+        }
+
+        image.blocks.Clear();
+        for (uint32 i = 0; i < seed % MaxBlocks; ++i)
+        {
+            image.blocks.PushBack(RenderCheckpoint::Block(i, i + 2, 0, Height));
+        }
+
+        image.state.passesFinished = seed;
+        image.state.firstPassIndex = seed * 2;
+        image.state.haltonSeed = seed * 3;
+        image.state.activeBlocks = image.blocks.Size();
+    }
+
+    void ExpectEqual(const Image& expected, const Image& actual)
+    {
+        EXPECT_EQ(expected.state.passesFinished, actual.state.passesFinished);
+        EXPECT_EQ(expected.state.firstPassIndex, actual.state.firstPassIndex);
+        EXPECT_EQ(expected.state.haltonSeed, actual.state.haltonSeed);
+        EXPECT_EQ(expected.state.activeBlocks, actual.state.activeBlocks);
+
+        ASSERT_EQ(expected.blocks.Size(), actual.blocks.Size());
+        for (uint32 i = 0; i < expected.blocks.Size(); ++i)
+        {
+            EXPECT_EQ(expected.blocks[i].minX, actual.blocks[i].minX);
+            EXPECT_EQ(expected.blocks[i].maxX, actual.blocks[i].maxX);
+            EXPECT_EQ(expected.blocks[i].minY, actual.blocks[i].minY);
+            EXPECT_EQ(expected.blocks[i].maxY, actual.blocks[i].maxY);
+        }
+
+        EXPECT_EQ(0, memcmp(expected.extraSamples.Data(), actual.extraSamples.Data(), Width * Height * sizeof(uint32)));
+
+        for (uint32 y = 0; y < Height; ++y)
+        {
+            EXPECT_EQ(0, memcmp(&expected.sum.GetPixelRef<Vec3f>(0, y), &actual.sum.GetPixelRef<Vec3f>(0, y), Width * sizeof(Vec3f)));
+            EXPECT_EQ(0, memcmp(&expected.secondarySum.GetPixelRef<Vec3f>(0, y), &actual.secondarySum.GetPixelRef<Vec3f>(0, y), Width * sizeof(Vec3f)));
+        }
+    }
+
+    bool Write(RenderCheckpoint& checkpoint, const Image& image, bool sync)
+    {
+        return checkpoint.Write(image.state, image.sum, image.secondarySum, image.extraSamples.Data(), image.blocks, sync);
+    }
+
+    bool Read(RenderCheckpoint& checkpoint, Image& image)
+    {
+        InitImage(image, 0);
+        return checkpoint.Read(image.state, image.sum, image.secondarySum, image.extraSamples.Data(), image.blocks);
+    }
+};
+
+TEST_F(RenderCheckpointTest, Empty)
+{
+    RenderCheckpoint checkpoint;
+    ASSERT_TRUE(checkpoint.Open(TEST_FILE, Width, Height, MaxBlocks, IdentityHash));
+    EXPECT_FALSE(checkpoint.HasValidState());
+
+    Image image;
+    EXPECT_FALSE(Read(checkpoint, image));
+}
+
+TEST_F(RenderCheckpointTest, WriteRead)
+{
+    Image imageA, imageB, readImage;
+    InitImage(imageA, 5);
+    InitImage(imageB, 6);
+
+    {
+        RenderCheckpoint checkpoint;
+        ASSERT_TRUE(checkpoint.Open(TEST_FILE, Width, Height, MaxBlocks, IdentityHash));
+        ASSERT_TRUE(Write(checkpoint, imageA, true));
+        ASSERT_TRUE(checkpoint.HasValidState());
+        ASSERT_TRUE(Read(checkpoint, readImage));
+        ExpectEqual(imageA, readImage);
+
+        ASSERT_TRUE(Write(checkpoint, imageB, false));
+        ASSERT_TRUE(Read(checkpoint, readImage));
+        ExpectEqual(imageB, readImage);
+    }
+
+    // reopen
+    {
+        RenderCheckpoint checkpoint;
+        ASSERT_TRUE(checkpoint.Open(TEST_FILE, Width, Height, MaxBlocks, IdentityHash));
+        ASSERT_TRUE(Read(checkpoint, readImage));
+        ExpectEqual(imageB, readImage);
+    }
+
+    // different resolution discards the checkpoint
+    {
+        RenderCheckpoint checkpoint;
+        ASSERT_TRUE(checkpoint.Open(TEST_FILE, Width + 1, Height, MaxBlocks, IdentityHash));
+        EXPECT_FALSE(checkpoint.HasValidState());
+    }
+}
+
+TEST_F(RenderCheckpointTest, IdentityHash)
+{
+    Camera camera;
+    camera.SetPerspective(1.5f, 1.0f);
+    RenderingParams params;
+
+    const uint64 hash = RenderCheckpoint::ComputeIdentityHash("scene.nfs", camera, params);
+    EXPECT_EQ(hash, RenderCheckpoint::ComputeIdentityHash("scene.nfs", camera, params));
+    EXPECT_NE(hash, RenderCheckpoint::ComputeIdentityHash("other_scene.nfs", camera, params));
+
+    {
+        Camera movedCamera = camera;
+        movedCamera.SetTransform(Transform(Vec4f(1.0f, 0.0f, 0.0f)));
+        EXPECT_NE(hash, RenderCheckpoint::ComputeIdentityHash("scene.nfs", movedCamera, params));
+    }
+
+    {
+        RenderingParams otherParams = params;
+        otherParams.maxRayDepth++;
+        EXPECT_NE(hash, RenderCheckpoint::ComputeIdentityHash("scene.nfs", camera, otherParams));
+    }
+
+    {
+        RenderingParams otherParams = params;
+        otherParams.samplingParams.sequence = SampleSequence::Halton;
+        EXPECT_NE(hash, RenderCheckpoint::ComputeIdentityHash("scene.nfs", camera, otherParams));
+    }
+
+    Image image, readImage;
+    InitImage(image, 5);
+
+    {
+        RenderCheckpoint checkpoint;
+        ASSERT_TRUE(checkpoint.Open(TEST_FILE, Width, Height, MaxBlocks, hash));
+        ASSERT_TRUE(Write(checkpoint, image, true));
+    }
+
+    // the same image resumes
+    {
+        RenderCheckpoint checkpoint;
+        ASSERT_TRUE(checkpoint.Open(TEST_FILE, Width, Height, MaxBlocks, hash));
+        ASSERT_TRUE(Read(checkpoint, readImage));
+        ExpectEqual(image, readImage);
+    }
+
+    // different scene, camera or settings discards the checkpoint
+    {
+        RenderCheckpoint checkpoint;
+        ASSERT_TRUE(checkpoint.Open(TEST_FILE, Width, Height, MaxBlocks, hash + 1));
+        EXPECT_FALSE(checkpoint.HasValidState());
+        EXPECT_FALSE(Read(checkpoint, readImage));
+    }
+
+    // ...permanently
+    {
+        RenderCheckpoint checkpoint;
+        ASSERT_TRUE(checkpoint.Open(TEST_FILE, Width, Height, MaxBlocks, hash));
+        EXPECT_FALSE(checkpoint.HasValidState());
+    }
+}
+
+TEST_F(RenderCheckpointTest, TornSlot)
+{
+    Image imageA, imageB, readImage;
+    InitImage(imageA, 5);
+    InitImage(imageB, 6);
+
+    {
+        RenderCheckpoint checkpoint;
+        ASSERT_TRUE(checkpoint.Open(TEST_FILE, Width, Height, MaxBlocks, IdentityHash));
+        ASSERT_TRUE(Write(checkpoint, imageA, true));
+        ASSERT_TRUE(Write(checkpoint, imageB, true));
+    }
+
+    // simulate a page of the latest slot that did not reach the disk (header is activated, but slot data is stale)
+    {
+        MemoryMappedFile file;
+        ASSERT_TRUE(file.Open(TEST_FILE));
+
+        // file layout: header page, slot 0 (generation 2), slot 1 (generation 1)
+        uint8* latestSlotData = static_cast<uint8*>(file.GetData()) + 4096;
+        latestSlotData[4096 + 123] ^= 0xFF;
+        ASSERT_TRUE(file.Flush());
+    }
+
+    // previous checkpoint is restored
+    {
+        RenderCheckpoint checkpoint;
+        ASSERT_TRUE(checkpoint.Open(TEST_FILE, Width, Height, MaxBlocks, IdentityHash));
+        ASSERT_TRUE(checkpoint.HasValidState());
+        ASSERT_TRUE(Read(checkpoint, readImage));
+        ExpectEqual(imageA, readImage);
+
+        // next write overwrites the torn slot
+        ASSERT_TRUE(Write(checkpoint, imageB, true));
+        ASSERT_TRUE(Read(checkpoint, readImage));
+        ExpectEqual(imageB, readImage);
+    }
+
+    // corrupt both slots
+    {
+        MemoryMappedFile file;
+        ASSERT_TRUE(file.Open(TEST_FILE));
+        const size_t slotSize = (file.GetSize() - 4096) / 2;
+        uint8* slotsData = static_cast<uint8*>(file.GetData()) + 4096;
+        slotsData[300] ^= 0xFF;
+        slotsData[slotSize + 300] ^= 0xFF;
+    }
+
+    {
+        RenderCheckpoint checkpoint;
+        ASSERT_TRUE(checkpoint.Open(TEST_FILE, Width, Height, MaxBlocks, IdentityHash));
+        EXPECT_FALSE(checkpoint.HasValidState());
+        EXPECT_FALSE(Read(checkpoint, readImage));
+    }
+}
@@ -0,0 +1,145 @@
+#include "PCH.h"
+#include "Engine/Raytracer/Scene/Scene.h"
+#include "Engine/Raytracer/Scene/Object/SceneObject_Shape.h"
+#include "Engine/Raytracer/Shapes/SphereShape.h"
+#include "Engine/Raytracer/Medium/Medium.h"
+#include "Engine/Raytracer/Medium/MediumStack.h"
+#include "Engine/Raytracer/Rendering/RenderingContext.h"
+
+using namespace NFE;
+using namespace NFE::RT;
+using namespace NFE::Math;
+using namespace NFE::Common;
+
+
+class SceneMediaTest : public ::testing::Test
+{
+protected:
+    static constexpr float Tolerance = 1.0e-4f;
+
+    // all the media are placed along an axis
+    // NOTE: the axis is not aligned with the world axes, as ray-box tests don't handle zero direction components
+    const Vec4f mAxis = Vec4f(1.0f, 1.0f, 1.0f).Normalized3();
+
+    void SetUp() override
+    {
+        // "outer" contains "inner" and "side", "inner" and "side" overlap
+        mOuterMedium = AddMedium(Vec4f::Zero(), 10.0f);
+        mInnerMedium = AddMedium(Vec4f::Zero(), 2.0f);
+        mSideMedium = AddMedium(mAxis * 3.0f, 2.0f);
+
+        ASSERT_TRUE(mScene.BuildBVH());
+    }
+
+    const IMedium* AddMedium(const Vec4f& center, float radius)
+    {
+        MediumPtr medium = MakeSharedPtr<HomogenousAbsorptiveMedium>();
+
+        ShapeSceneObjectPtr object = MakeUniquePtr<ShapeSceneObject>(MakeSharedPtr<SphereShape>(radius));
+        object->SetTransform(Matrix4::MakeTranslation(center));
+        object->BindMedium(medium);
+        mScene.AddObject(std::move(object));
+
+        return medium.Get();
+    }
+
+    void ExpectInterval(const MediumInterval& interval, const IMedium* medium, float minDistance, float maxDistance)
+    {
+        EXPECT_EQ(medium, interval.medium);
+        EXPECT_NEAR(minDistance, interval.minDistance, Tolerance);
+        EXPECT_NEAR(maxDistance, interval.maxDistance, Tolerance);
+    }
+
+    Scene mScene;
+    RenderingContext mContext;
+
+    const IMedium* mOuterMedium = nullptr;
+    const IMedium* mInnerMedium = nullptr;
+    const IMedium* mSideMedium = nullptr;
+};
+
+TEST_F(SceneMediaTest, IntervalsAlongRay)
+{
+    const Ray ray(mAxis * -20.0f, mAxis);
+
+    MediumInterval intervals[MediumStack::MaxSize];
+    ASSERT_EQ(3u, mScene.GetMediaAlongRay(mContext, ray, 40.0f, intervals, MediumStack::MaxSize));
+    ExpectInterval(intervals[0], mOuterMedium, 10.0f, 30.0f);
+    ExpectInterval(intervals[1], mInnerMedium, 18.0f, 22.0f);
+    ExpectInterval(intervals[2], mSideMedium, 21.0f, 25.0f);
+
+    // clamped to the segment end
+    ASSERT_EQ(2u, mScene.GetMediaAlongRay(mContext, ray, 20.0f, intervals, MediumStack::MaxSize));
+    ExpectInterval(intervals[0], mOuterMedium, 10.0f, 20.0f);
+    ExpectInterval(intervals[1], mInnerMedium, 18.0f, 20.0f);
+
+    // the nearest intervals are kept
+    ASSERT_EQ(1u, mScene.GetMediaAlongRay(mContext, ray, 40.0f, intervals, 1));
+    ExpectInterval(intervals[0], mOuterMedium, 10.0f, 30.0f);
+}
+
+TEST_F(SceneMediaTest, IntervalsFromInside)
+{
+    // clamped to the ray origin
+    const Ray ray(mAxis * 0.5f, mAxis);
+
+    MediumInterval intervals[MediumStack::MaxSize];
+    ASSERT_EQ(3u, mScene.GetMediaAlongRay(mContext, ray, 40.0f, intervals, MediumStack::MaxSize));
+
+    // outer and inner media both start at the origin
+    const uint32 innerIndex = intervals[0].medium == mInnerMedium ? 0 : 1;
+    ExpectInterval(intervals[innerIndex], mInnerMedium, 0.0f, 1.5f);
+    ExpectInterval(intervals[1 - innerIndex], mOuterMedium, 0.0f, 9.5f);
+    ExpectInterval(intervals[2], mSideMedium, 0.5f, 4.5f);
+}
+
+TEST_F(SceneMediaTest, MediaAtPoint)
+{
+    MediumStack stack;
+
+    mScene.GetMediaAtPoint(mContext, Ray(Vec4f::Zero(), mAxis), stack);
+    ASSERT_EQ(2u, stack.Size());
+    EXPECT_EQ(mInnerMedium, stack.Top());
+
+    // overlapping media are ordered as if they were entered along the ray
+    mScene.GetMediaAtPoint(mContext, Ray(mAxis * 1.5f, mAxis), stack);
+    ASSERT_EQ(3u, stack.Size());
+    EXPECT_EQ(mSideMedium, stack.Top());
+    stack.Pop(mSideMedium);
+    EXPECT_EQ(mInnerMedium, stack.Top());
+
+    mScene.GetMediaAtPoint(mContext, Ray(mAxis * 1.5f, -mAxis), stack);
+    ASSERT_EQ(3u, stack.Size());
+    EXPECT_EQ(mInnerMedium, stack.Top());
+    stack.Pop(mInnerMedium);
+    EXPECT_EQ(mSideMedium, stack.Top());
+
+    mScene.GetMediaAtPoint(mContext, Ray(mAxis * 20.0f, mAxis), stack);
+    EXPECT_TRUE(stack.Empty());
+}
+
+TEST_F(SceneMediaTest, StackCrossing)
+{
+    // boundaries along the ray and the innermost medium after crossing them
+    const float boundaries[] = { 10.0f, 18.0f, 21.0f, 22.0f, 25.0f, 30.0f };
+    const IMedium* expectedMedia[] = { mOuterMedium, mInnerMedium, mSideMedium, mSideMedium, mOuterMedium, nullptr };
+
+    const Vec4f start = mAxis * -20.0f;
+    float distance = 0.0f;
+
+    MediumStack stack;
+    for (uint32 i = 0; i < 6; ++i)
+    {
+        const Ray ray(start + mAxis * distance, mAxis);
+        const float crossedDistance = boundaries[i] - distance + 0.001f;
+
+        MediumInterval intervals[MediumStack::MaxSize];
+        const uint32 numIntervals = mScene.GetMediaAlongRay(mContext, ray, crossedDistance, intervals, MediumStack::MaxSize);
+        stack.Cross(intervals, numIntervals, crossedDistance);
+
+        EXPECT_EQ(expectedMedia[i], stack.Top()) << "boundary " << i;
+        distance += crossedDistance;
+    }
+
+    EXPECT_TRUE(stack.Empty());
+}
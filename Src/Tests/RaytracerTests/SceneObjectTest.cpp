@@ -0,0 +1,111 @@
+#include "PCH.h"
+#include "Engine/Raytracer/Scene/Object/SceneObject_Shape.h"
+#include "Engine/Raytracer/Shapes/BoxShape.h"
+#include "Engine/Common/Math/Quaternion.hpp"
+
+using namespace NFE;
+using namespace NFE::RT;
+using namespace NFE::Math;
+using namespace NFE::Common;
+
+
+class SceneObjectTest : public ::testing::Test
+{
+protected:
+    static constexpr float Epsilon = 1.0e-4f;
+
+    void SetUp() override
+    {
+        mObject = MakeUniquePtr<ShapeSceneObject>(MakeSharedPtr<BoxShape>(mBoxSize));
+    }
+
+    static void ExpectMatrixNear(const Matrix4& expected, const Matrix4& actual)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            EXPECT_TRUE(Vec4f::AlmostEqual(expected.GetRow(i), actual.GetRow(i), Epsilon)) << "row " << i;
+        }
+    }
+
+    // check if all corners of a box transformed with given matrix are inside the bounds
+    static void ExpectBoxInside(const Box& bounds, const Matrix4& matrix, const Box& box)
+    {
+        for (uint32 i = 0; i < 8; ++i)
+        {
+            const Vec4f corner((i & 1) ? box.max.x : box.min.x, (i & 2) ? box.max.y : box.min.y, (i & 4) ? box.max.z : box.min.z);
+            const Vec4f point = matrix.TransformPoint(corner);
+            EXPECT_TRUE((point >= bounds.min - Vec4f(Epsilon)).All3()) << "corner " << i;
+            EXPECT_TRUE((point <= bounds.max + Vec4f(Epsilon)).All3()) << "corner " << i;
+        }
+    }
+
+    const Vec4f mBoxSize = Vec4f(1.0f, 2.0f, 0.5f);
+    SceneObjectPtr mObject;
+};
+
+TEST_F(SceneObjectTest, ScaledMatrix)
+{
+    const Matrix4 matrix =
+        Matrix4::MakeScaling(Vec4f(2.0f, 3.0f, 0.5f)) *
+        Quaternion::FromEulerAngles(0.3f, -1.2f, 0.7f).ToMatrix() *
+        Matrix4::MakeTranslation(Vec4f(1.0f, -2.0f, 5.0f));
+
+    mObject->SetTransform(matrix);
+    ExpectMatrixNear(matrix, mObject->GetBaseTransform());
+    ExpectMatrixNear(Matrix4::Identity(), mObject->GetBaseInverseTransform() * matrix);
+
+    // motion with the same start and end transform must not change anything
+    mObject->SetEndTransform(matrix);
+    ASSERT_TRUE(mObject->HasMotion());
+    for (const float t : { 0.0f, 0.5f, 1.0f })
+    {
+        ExpectMatrixNear(matrix, mObject->GetTransform(t));
+        ExpectMatrixNear(Matrix4::Identity(), mObject->GetInverseTransform(t) * matrix);
+    }
+}
+
+TEST_F(SceneObjectTest, MirroredMatrix)
+{
+    const Matrix4 matrix =
+        Matrix4::MakeScaling(Vec4f(1.0f, -2.0f, 1.0f)) *
+        Quaternion::FromEulerAngles(1.0f, 0.5f, 0.0f).ToMatrix();
+
+    mObject->SetTransform(matrix);
+    ExpectMatrixNear(matrix, mObject->GetBaseTransform());
+}
+
+TEST_F(SceneObjectTest, MotionBounds)
+{
+    const Transform startTransform(Vec4f(1.0f, 2.0f, 3.0f), Quaternion::FromEulerAngles(0.1f, 0.2f, 0.3f));
+    const Transform endTransform(Vec4f(-2.0f, 2.5f, 0.0f), Quaternion::FromEulerAngles(1.5f, -0.8f, 2.0f));
+    const Vec4f startScale(1.0f, 2.0f, 3.0f);
+    const Vec4f endScale(0.5f, 1.0f, 4.0f);
+
+    mObject->SetTransform(startTransform, startScale);
+    mObject->SetEndTransform(endTransform, endScale);
+
+    const Matrix4 startMatrix = Matrix4::MakeScaling(startScale) * startTransform.ToMatrix();
+    const Matrix4 endMatrix = Matrix4::MakeScaling(endScale) * endTransform.ToMatrix();
+    ExpectMatrixNear(startMatrix, mObject->GetBaseTransform());
+    ExpectMatrixNear(startMatrix, mObject->GetTransform(0.0f));
+    ExpectMatrixNear(endMatrix, mObject->GetTransform(1.0f));
+
+    Box startBox, endBox;
+    mObject->GetMotionBounds(startBox, endBox);
+
+    const Box localBox(-mBoxSize, mBoxSize);
+    const Box boundingBox = mObject->GetBoundingBox();
+
+    // sample much denser than motion bounds computation does
+    const uint32 numSamples = 256;
+    for (uint32 i = 0; i <= numSamples; ++i)
+    {
+        const float t = static_cast<float>(i) / static_cast<float>(numSamples);
+        const Matrix4 transform = mObject->GetTransform(t);
+        ExpectMatrixNear(Matrix4::Identity(), mObject->GetInverseTransform(t) * transform);
+
+        const Box interpolatedBox(Vec4f::Lerp(startBox.min, endBox.min, t), Vec4f::Lerp(startBox.max, endBox.max, t));
+        ExpectBoxInside(interpolatedBox, transform, localBox);
+        ExpectBoxInside(boundingBox, transform, localBox);
+    }
+}
@@ -0,0 +1,205 @@
+#include "PCH.h"
+#include "Engine/Raytracer/Scene/Scene.h"
+#include "Engine/Raytracer/Scene/Object/SceneObject_Shape.h"
+#include "Engine/Raytracer/Shapes/MeshShape.h"
+#include "Engine/Raytracer/Shapes/SphereShape.h"
+#include "Engine/Raytracer/Rendering/RenderingContext.h"
+#include "Engine/Raytracer/Traversal/TraversalContext.h"
+#include "Engine/Common/Containers/DynArray.hpp"
+#include "Engine/Common/Math/Random.hpp"
+
+using namespace NFE;
+using namespace NFE::RT;
+using namespace NFE::Math;
+using namespace NFE::Common;
+
+
+class ShadowOccluderCacheTest : public ::testing::Test
+{
+protected:
+    static constexpr uint32 NumTriangles = 200;
+    static constexpr uint32 NumSpheres = 10;
+    static constexpr uint32 NumRays = 2000;
+
+    void SetUp() override
+    {
+        Random random(1234);
+
+        // triangle soup
+        {
+            DynArray<Vec3f> positions;
+            DynArray<Vec3f> normals;
+            DynArray<Vec3f> tangents;
+            DynArray<uint32> vertexIndices;
+            DynArray<uint32> materialIndices;
+
+            for (uint32 i = 0; i < NumTriangles; ++i)
+            {
+                const Vec3f v0 = random.GetVec3f() * 10.0f;
+                const Vec3f v1 = v0 + random.GetVec4fBipolar().ToVec3f();
+                const Vec3f v2 = v0 + random.GetVec4fBipolar().ToVec3f();
+                const Vec3f normal = Vec3f::Cross(v1 - v0, v2 - v0).Normalized();
+                const Vec3f tangent = (v1 - v0).Normalized();
+
+                for (const Vec3f& v : { v0, v1, v2 })
+                {
+                    vertexIndices.PushBack(positions.Size());
+                    positions.PushBack(v);
+                    normals.PushBack(normal);
+                    tangents.PushBack(tangent);
+                }
+
+                materialIndices.PushBack(UINT32_MAX);
+            }
+
+            MeshDesc meshDesc;
+            meshDesc.vertexBufferDesc.numVertices = positions.Size();
+            meshDesc.vertexBufferDesc.numTriangles = NumTriangles;
+            meshDesc.vertexBufferDesc.vertexIndexBuffer = vertexIndices.Data();
+            meshDesc.vertexBufferDesc.positions = positions.Data();
+            meshDesc.vertexBufferDesc.normals = normals.Data();
+            meshDesc.vertexBufferDesc.tangents = tangents.Data();
+            meshDesc.vertexBufferDesc.materialIndexBuffer = materialIndices.Data();
+
+            MeshShapePtr mesh = MakeSharedPtr<MeshShape>();
+            ASSERT_TRUE(mesh->Initialize(meshDesc));
+            mScene.AddObject(MakeUniquePtr<ShapeSceneObject>(mesh));
+        }
+
+        // non-mesh objects are tested as a whole
+        for (uint32 i = 0; i < NumSpheres; ++i)
+        {
+            SceneObjectPtr sphere = MakeUniquePtr<ShapeSceneObject>(MakeSharedPtr<SphereShape>(0.5f));
+            sphere->SetTransform(Matrix4::MakeTranslation(random.GetVec4f() * 10.0f));
+            mScene.AddObject(std::move(sphere));
+        }
+
+        ASSERT_TRUE(mScene.BuildBVH());
+
+        for (uint32 i = 0; i < NumRays; ++i)
+        {
+            mRayOrigins.PushBack(random.GetVec4f() * 10.0f);
+        }
+    }
+
+    // cast shadow rays from all the origins towards a target point
+    void CastShadowRays(RenderingContext& context, const Vec4f& target, const void* occluderCacheKey, DynArray<bool>& outOccluded) const
+    {
+        outOccluded.Clear();
+        for (const Vec4f& origin : mRayOrigins)
+        {
+            const Ray shadowRay(origin, target - origin);
+
+            HitPoint hitPoint;
+            hitPoint.distance = (target - origin).Length3();
+
+            outOccluded.PushBack(mScene.Traverse_Shadow({ shadowRay, hitPoint, context }, occluderCacheKey));
+        }
+    }
+
+    Scene mScene;
+    DynArray<Vec4f> mRayOrigins;
+};
+
+TEST_F(ShadowOccluderCacheTest, MatchesFullTraversal)
+{
+    // keys are not dereferenced, any address identifying shadow rays target will do
+    const Vec4f targets[] = { Vec4f(5.0f, 5.0f, 20.0f), Vec4f(-10.0f, 5.0f, 5.0f) };
+    const void* keys[] = { &targets[0], &targets[1] };
+
+    RenderingContext referenceContext;
+    RenderingContext cachedContext;
+
+    DynArray<bool> expected;
+    DynArray<bool> occluded;
+
+    uint32 numOccluded = 0;
+    for (uint32 pass = 0; pass < 2; ++pass)
+    {
+        for (uint32 i = 0; i < 2; ++i)
+        {
+            CastShadowRays(referenceContext, targets[i], nullptr, expected);
+            CastShadowRays(cachedContext, targets[i], keys[i], occluded);
+
+            ASSERT_EQ(expected.Size(), occluded.Size());
+            for (uint32 j = 0; j < expected.Size(); ++j)
+            {
+                EXPECT_EQ(expected[j], occluded[j]) << "pass " << pass << " target " << i << " ray " << j;
+                numOccluded += expected[j] ? 1 : 0;
+            }
+        }
+    }
+
+    // the scene is dense enough to occlude some rays (but not all of them)
+    ASSERT_LT(0u, numOccluded);
+    ASSERT_GT(4u * NumRays, numOccluded);
+
+    EXPECT_EQ(0u, referenceContext.counters.numOccluderCacheTests);
+    EXPECT_EQ(0u, referenceContext.counters.numOccluderCacheHits);
+
+    const RayTracingCounters& counters = cachedContext.counters;
+    EXPECT_LT(0u, counters.numOccluderCacheHits);
+    EXPECT_LE(counters.numOccluderCacheHits, counters.numOccluderCacheTests);
+    EXPECT_GE(numOccluded, counters.numOccluderCacheHits);
+}
+
+TEST_F(ShadowOccluderCacheTest, MissClearsEntry)
+{
+    int key = 0;
+    RenderingContext context;
+
+    // find a ray that is occluded
+    const Vec4f target(5.0f, 5.0f, 20.0f);
+    DynArray<bool> occluded;
+    CastShadowRays(context, target, &key, occluded);
+
+    uint32 occludedRayIndex = UINT32_MAX;
+    for (uint32 i = 0; i < occluded.Size() && occludedRayIndex == UINT32_MAX; ++i)
+    {
+        if (occluded[i])
+        {
+            occludedRayIndex = i;
+        }
+    }
+    ASSERT_NE(UINT32_MAX, occludedRayIndex);
+
+    const Vec4f origin = mRayOrigins[occludedRayIndex];
+    const Ray shadowRay(origin, target - origin);
+    const float distance = (target - origin).Length3();
+
+    // other rays have overwritten the cache entry, find the occluder again
+    {
+        HitPoint hitPoint;
+        hitPoint.distance = distance;
+        ASSERT_TRUE(mScene.Traverse_Shadow({ shadowRay, hitPoint, context }, &key));
+    }
+
+    // same ray again - must hit the cached occluder
+    {
+        context.counters.Reset();
+        HitPoint hitPoint;
+        hitPoint.distance = distance;
+        EXPECT_TRUE(mScene.Traverse_Shadow({ shadowRay, hitPoint, context }, &key));
+        EXPECT_EQ(1u, context.counters.numOccluderCacheTests);
+        EXPECT_EQ(1u, context.counters.numOccluderCacheHits);
+    }
+
+    // very short ray is not occluded, stale occluder must be dropped
+    {
+        context.counters.Reset();
+        HitPoint hitPoint;
+        hitPoint.distance = 1.0e-6f;
+        EXPECT_FALSE(mScene.Traverse_Shadow({ shadowRay, hitPoint, context }, &key));
+        EXPECT_EQ(1u, context.counters.numOccluderCacheTests);
+        EXPECT_EQ(0u, context.counters.numOccluderCacheHits);
+    }
+
+    // nothing to test against anymore
+    {
+        context.counters.Reset();
+        HitPoint hitPoint;
+        hitPoint.distance = 1.0e-6f;
+        EXPECT_FALSE(mScene.Traverse_Shadow({ shadowRay, hitPoint, context }, &key));
+        EXPECT_EQ(0u, context.counters.numOccluderCacheTests);
+    }
+}
@@ -0,0 +1,279 @@
+#include "PCH.h"
+#include "Engine/Raytracer/Rendering/TileFarm.h"
+#include "Engine/Raytracer/Rendering/Viewport.h"
+#include "Engine/Raytracer/Scene/Scene.h"
+#include "Engine/Raytracer/Scene/Object/SceneObject_Light.h"
+#include "Engine/Raytracer/Scene/Light/BackgroundLight.h"
+#include "Engine/Raytracer/Textures/Texture.h"
+#include "Engine/Common/Memory/Buffer.hpp"
+#include "Engine/Common/Utils/Stream/BufferInputStream.hpp"
+#include "Engine/Common/Utils/Stream/BufferOutputStream.hpp"
+#include "Engine/Common/Utils/Stream/SocketInputStream.hpp"
+#include "Engine/Common/Utils/Stream/SocketOutputStream.hpp"
+#include "Engine/Common/System/Socket.hpp"
+#include "Engine/Common/System/Thread.hpp"
+
+using namespace NFE;
+using namespace NFE::RT;
+using namespace NFE::Math;
+using namespace NFE::Common;
+
+
+class TileFarmTest : public ::testing::Test
+{
+protected:
+    static constexpr uint32 Width = 24;
+    static constexpr uint32 Height = 16;
+
+    void SetUp() override
+    {
+        mScene.AddObject(MakeUniquePtr<LightSceneObject>(MakeUniquePtr<BackgroundLight>(HdrColorRGB(BackgroundColor))));
+        ASSERT_TRUE(mScene.BuildBVH());
+
+        mCamera.SetPerspective(static_cast<float>(Width) / static_cast<float>(Height), DegToRad(60.0f));
+
+        mRenderer = CreateRenderer("NFE::RT::PathTracer", mScene);
+        ASSERT_TRUE(mRenderer);
+    }
+
+    void InitViewport(Viewport& viewport, uint32 numPreviewPasses = 0, bool adaptive = false)
+    {
+        RenderingParams params;
+        params.numPreviewPasses = numPreviewPasses;
+        params.adaptiveSettings.enable = adaptive;
+        params.adaptiveSettings.numInitialPasses = 2;
+
+        ASSERT_TRUE(viewport.SetRenderingParams(params));
+        ASSERT_TRUE(viewport.SetRenderer(mRenderer.Get()));
+        ASSERT_TRUE(viewport.Resize(Width, Height));
+    }
+
+    static constexpr float BackgroundColor = 0.5f;
+
+    Scene mScene;
+    Camera mCamera;
+    RendererPtr mRenderer;
+};
+
+TEST_F(TileFarmTest, WriteMergeSamples)
+{
+    Viewport source;
+    InitViewport(source);
+    source.SetRenderRegion(Rectangle<uint32>(4, 20, 2, 10));
+    source.Reset();
+
+    for (uint32 i = 0; i < 3; ++i)
+    {
+        ASSERT_TRUE(source.Render(mScene, mCamera));
+    }
+
+    Buffer samplesBuffer;
+    {
+        BufferOutputStream stream(samplesBuffer);
+        ASSERT_TRUE(source.WriteSamples(stream));
+    }
+
+    Viewport target;
+    InitViewport(target);
+    target.SetRenderRegion(Rectangle<uint32>(4, 20, 2, 10));
+    target.Reset();
+    {
+        BufferInputStream stream(samplesBuffer);
+        ASSERT_TRUE(target.MergeSamples(stream));
+    }
+
+    // merged viewport must serialize exactly the same samples (including per-pixel sample counts)
+    Buffer mergedSamplesBuffer;
+    {
+        BufferOutputStream stream(mergedSamplesBuffer);
+        ASSERT_TRUE(target.WriteSamples(stream));
+    }
+
+    ASSERT_EQ(samplesBuffer.Size(), mergedSamplesBuffer.Size());
+    EXPECT_EQ(0, memcmp(samplesBuffer.Data(), mergedSamplesBuffer.Data(), samplesBuffer.Size()));
+
+    // pixels outside of the region are untouched
+    EXPECT_EQ(0.0f, target.GetSumBuffer().GetPixelRef<Vec3f>(0, 0).x);
+    EXPECT_LT(0.0f, target.GetSumBuffer().GetPixelRef<Vec3f>(4, 2).x);
+
+    // merging samples of a different resolution must fail
+    Viewport otherViewport;
+    ASSERT_TRUE(otherViewport.Resize(Width / 2, Height));
+    {
+        BufferInputStream stream(samplesBuffer);
+        EXPECT_FALSE(otherViewport.MergeSamples(stream));
+    }
+}
+
+TEST_F(TileFarmTest, CoordinatorWithWorkers)
+{
+    // preview passes are enabled on purpose, they must not affect the coordinator's viewport
+    Viewport coordinatorViewport;
+    InitViewport(coordinatorViewport, 2);
+
+    TileFarmCoordinator::Settings settings;
+    settings.totalPasses = 4;
+    settings.passesPerJob = 2;
+    settings.blockSize = 8;
+
+    TileFarmCoordinator coordinator;
+    ASSERT_TRUE(coordinator.Init(coordinatorViewport, settings));
+    EXPECT_EQ(3u * 2u * 2u, coordinator.GetNumJobs());
+
+    Viewport workerViewport;
+    InitViewport(workerViewport, 2);
+
+    // return first job, as if a worker disconnected
+    {
+        TileFarmJob job;
+        ASSERT_TRUE(coordinator.GetNextJob(job));
+        coordinator.ReturnJob(job);
+    }
+
+    TileFarmJob job;
+    while (coordinator.GetNextJob(job))
+    {
+        // pass job through a stream, as it would be sent to a remote worker
+        Buffer jobBuffer;
+        {
+            BufferOutputStream stream(jobBuffer);
+            ASSERT_TRUE(job.Write(stream));
+        }
+        TileFarmJob receivedJob;
+        {
+            BufferInputStream stream(jobBuffer);
+            ASSERT_TRUE(receivedJob.Read(stream));
+        }
+
+        Buffer resultBuffer;
+        {
+            BufferOutputStream stream(resultBuffer);
+            ASSERT_TRUE(TileFarmWorker::ProcessJob(workerViewport, mScene, mCamera, receivedJob, stream));
+        }
+        {
+            BufferInputStream stream(resultBuffer);
+            ASSERT_TRUE(coordinator.MergeResult(stream));
+        }
+
+        coordinator.PostProcess();
+    }
+
+    EXPECT_TRUE(coordinator.IsFinished());
+    EXPECT_EQ(coordinator.GetNumJobs(), coordinator.GetNumMergedJobs());
+
+    // every pixel got all the passes (camera rays hit background only)
+    const Bitmap& sum = coordinatorViewport.GetSumBuffer();
+    for (uint32 y = 0; y < Height; ++y)
+    {
+        for (uint32 x = 0; x < Width; ++x)
+        {
+            const Vec3f& color = sum.GetPixelRef<Vec3f>(x, y);
+            EXPECT_NEAR(BackgroundColor * settings.totalPasses, color.x, 1.0e-3f) << "x=" << x << " y=" << y;
+        }
+    }
+}
+
+TEST_F(TileFarmTest, WorkerOverSocket)
+{
+    Viewport coordinatorViewport;
+    InitViewport(coordinatorViewport);
+
+    TileFarmCoordinator::Settings settings;
+    settings.totalPasses = 4;
+    settings.passesPerJob = 2;
+    settings.blockSize = 8;
+
+    TileFarmCoordinator coordinator;
+    ASSERT_TRUE(coordinator.Init(coordinatorViewport, settings));
+
+    Socket listener;
+    ASSERT_TRUE(listener.Listen(0, true));
+    const uint16 port = listener.GetPort();
+    ASSERT_NE(0u, port);
+
+    // coordinator serves the worker on a separate thread, worker renders on the main thread
+    bool serveResult = false;
+    Thread coordinatorThread;
+    ASSERT_TRUE(coordinatorThread.Run([&]()
+    {
+        Socket connection;
+        if (listener.Accept(connection))
+        {
+            SocketInputStream input(connection);
+            SocketOutputStream output(connection);
+            serveResult = coordinator.ServeWorker(input, output);
+        }
+    }));
+
+    {
+        Viewport workerViewport;
+        InitViewport(workerViewport, 2);
+
+        Socket connection;
+        EXPECT_TRUE(connection.Connect("127.0.0.1", port));
+
+        SocketInputStream input(connection);
+        SocketOutputStream output(connection);
+        EXPECT_TRUE(TileFarmWorker::Run(workerViewport, mScene, mCamera, input, output));
+    }
+
+    coordinatorThread.Wait();
+
+    EXPECT_TRUE(serveResult);
+    EXPECT_TRUE(coordinator.IsFinished());
+    EXPECT_EQ(coordinator.GetNumJobs(), coordinator.GetNumMergedJobs());
+
+    const Bitmap& sum = coordinatorViewport.GetSumBuffer();
+    for (uint32 y = 0; y < Height; ++y)
+    {
+        for (uint32 x = 0; x < Width; ++x)
+        {
+            EXPECT_EQ(settings.totalPasses, coordinatorViewport.GetNumPixelSamples(x, y)) << "x=" << x << " y=" << y;
+            EXPECT_NEAR(BackgroundColor * settings.totalPasses, sum.GetPixelRef<Vec3f>(x, y).x, 1.0e-3f) << "x=" << x << " y=" << y;
+        }
+    }
+}
+
+TEST_F(TileFarmTest, AdaptiveWorkerSampleCounts)
+{
+    Viewport coordinatorViewport;
+    InitViewport(coordinatorViewport);
+
+    TileFarmCoordinator::Settings settings;
+    settings.totalPasses = 8;
+    settings.passesPerJob = 8;
+
+    TileFarmCoordinator coordinator;
+    ASSERT_TRUE(coordinator.Init(coordinatorViewport, settings));
+
+    // constant background converges right after the initial passes, further passes don't render anything
+    Viewport workerViewport;
+    InitViewport(workerViewport, 0, true);
+
+    TileFarmJob job;
+    ASSERT_TRUE(coordinator.GetNextJob(job));
+
+    Buffer resultBuffer;
+    {
+        BufferOutputStream stream(resultBuffer);
+        ASSERT_TRUE(TileFarmWorker::ProcessJob(workerViewport, mScene, mCamera, job, stream));
+    }
+    {
+        BufferInputStream stream(resultBuffer);
+        ASSERT_TRUE(coordinator.MergeResult(stream));
+    }
+
+    EXPECT_EQ(1.0f, workerViewport.GetProgress().converged);
+
+    // sample counts must match the samples actually accumulated
+    const Bitmap& sum = coordinatorViewport.GetSumBuffer();
+    for (uint32 y = 0; y < Height; ++y)
+    {
+        for (uint32 x = 0; x < Width; ++x)
+        {
+            const uint32 numSamples = coordinatorViewport.GetNumPixelSamples(x, y);
+            ASSERT_EQ(2u, numSamples) << "x=" << x << " y=" << y;
+            EXPECT_NEAR(BackgroundColor, sum.GetPixelRef<Vec3f>(x, y).x / static_cast<float>(numSamples), 1.0e-3f) << "x=" << x << " y=" << y;
+        }
+    }
+}
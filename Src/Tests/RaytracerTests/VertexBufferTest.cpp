@@ -0,0 +1,183 @@
+#include "PCH.h"
+#include "Engine/Raytracer/Shapes/Mesh/VertexBuffer.h"
+#include "Engine/Raytracer/Shapes/Mesh/VertexBufferDesc.h"
+#include "Engine/Common/Containers/DynArray.hpp"
+#include "Engine/Common/Memory/Buffer.hpp"
+#include "Engine/Common/Math/Random.hpp"
+#include "Engine/Common/Utils/Stream/BufferInputStream.hpp"
+#include "Engine/Common/Utils/Stream/BufferOutputStream.hpp"
+
+using namespace NFE;
+using namespace NFE::RT;
+using namespace NFE::Math;
+using namespace NFE::Common;
+
+
+class VertexBufferTest : public ::testing::Test
+{
+protected:
+    static constexpr uint32 NumTriangles = 500;
+    static constexpr uint32 NumVertices = 3 * NumTriangles;
+
+    // tiled texture coordinates (outside of [0,1] range)
+    static constexpr float MinTexCoord = -3.0f;
+    static constexpr float MaxTexCoord = 5.0f;
+
+    void SetUp() override
+    {
+        Random random(1234);
+
+        mPositions.Resize(NumVertices);
+        mNormals.Resize(NumVertices);
+        mTangents.Resize(NumVertices);
+        mTexCoords.Resize(NumVertices);
+        mVertexIndices.Resize(NumVertices);
+        mMaterialIndices.Resize(NumTriangles);
+
+        for (uint32 i = 0; i < NumVertices; ++i)
+        {
+            const Vec3f normal = random.GetVec4fBipolar().ToVec3f().Normalized();
+            mPositions[i] = random.GetVec3f();
+            mNormals[i] = normal;
+            mTangents[i] = Vec3f::Cross(normal, random.GetVec4fBipolar().ToVec3f()).Normalized();
+            mTexCoords[i] = Vec2f(MinTexCoord) + random.GetVec2f() * (MaxTexCoord - MinTexCoord);
+            mVertexIndices[i] = NumVertices - 1 - i;
+        }
+
+        // axis aligned vectors and texture coordinates range bounds must be preserved exactly
+        mNormals[0] = Vec3f(0.0f, 0.0f, -1.0f);
+        mTangents[0] = Vec3f(1.0f, 0.0f, 0.0f);
+        mTexCoords[0] = Vec2f(MinTexCoord, MaxTexCoord);
+        mTexCoords[1] = Vec2f(MaxTexCoord, MinTexCoord);
+
+        for (uint32 i = 0; i < NumTriangles; ++i)
+        {
+            mMaterialIndices[i] = UINT32_MAX;
+        }
+
+        mDesc.numVertices = NumVertices;
+        mDesc.numTriangles = NumTriangles;
+        mDesc.vertexIndexBuffer = mVertexIndices.Data();
+        mDesc.positions = mPositions.Data();
+        mDesc.normals = mNormals.Data();
+        mDesc.tangents = mTangents.Data();
+        mDesc.texCoords = mTexCoords.Data();
+        mDesc.materialIndexBuffer = mMaterialIndices.Data();
+    }
+
+    void VerifyVertexBuffer(const VertexBuffer& vertexBuffer, float vectorTolerance, float texCoordTolerance)
+    {
+        ASSERT_EQ(NumVertices, vertexBuffer.GetNumVertices());
+        ASSERT_EQ(NumTriangles, vertexBuffer.GetNumTriangles());
+
+        for (uint32 i = 0; i < NumTriangles; ++i)
+        {
+            VertexIndices indices;
+            vertexBuffer.GetVertexIndices(i, indices);
+            ASSERT_EQ(mVertexIndices[3 * i], indices.i0);
+            ASSERT_EQ(mVertexIndices[3 * i + 1], indices.i1);
+            ASSERT_EQ(mVertexIndices[3 * i + 2], indices.i2);
+            ASSERT_EQ(UINT32_MAX, indices.materialIndex);
+
+            VertexShadingData data[3];
+            vertexBuffer.GetShadingData(indices, data[0], data[1], data[2]);
+
+            const uint32 vertexIndices[3] = { indices.i0, indices.i1, indices.i2 };
+            for (uint32 j = 0; j < 3; ++j)
+            {
+                const uint32 v = vertexIndices[j];
+                EXPECT_NEAR(1.0f, data[j].normal.Length(), 1.0e-5f) << "vertex " << v;
+                EXPECT_NEAR(1.0f, data[j].tangent.Length(), 1.0e-5f) << "vertex " << v;
+                EXPECT_NEAR(mNormals[v].x, data[j].normal.x, vectorTolerance) << "vertex " << v;
+                EXPECT_NEAR(mNormals[v].y, data[j].normal.y, vectorTolerance) << "vertex " << v;
+                EXPECT_NEAR(mNormals[v].z, data[j].normal.z, vectorTolerance) << "vertex " << v;
+                EXPECT_NEAR(mTangents[v].x, data[j].tangent.x, vectorTolerance) << "vertex " << v;
+                EXPECT_NEAR(mTangents[v].y, data[j].tangent.y, vectorTolerance) << "vertex " << v;
+                EXPECT_NEAR(mTangents[v].z, data[j].tangent.z, vectorTolerance) << "vertex " << v;
+                EXPECT_NEAR(mTexCoords[v].x, data[j].texCoord.x, texCoordTolerance) << "vertex " << v;
+                EXPECT_NEAR(mTexCoords[v].y, data[j].texCoord.y, texCoordTolerance) << "vertex " << v;
+            }
+        }
+    }
+
+    DynArray<Vec3f> mPositions;
+    DynArray<Vec3f> mNormals;
+    DynArray<Vec3f> mTangents;
+    DynArray<Vec2f> mTexCoords;
+    DynArray<uint32> mVertexIndices;
+    DynArray<uint32> mMaterialIndices;
+    VertexBufferDesc mDesc;
+};
+
+TEST_F(VertexBufferTest, Uncompressed)
+{
+    VertexBuffer vertexBuffer;
+    ASSERT_TRUE(vertexBuffer.Initialize(mDesc));
+    VerifyVertexBuffer(vertexBuffer, 0.0f, 0.0f);
+}
+
+TEST_F(VertexBufferTest, PackedShadingData)
+{
+    mDesc.packShadingData = true;
+    mDesc.compactIndices = true;
+
+    VertexBuffer vertexBuffer;
+    ASSERT_TRUE(vertexBuffer.Initialize(mDesc));
+
+    // 16-bit octahedral encoding, unorm16 quantization within texture coordinates bounds
+    const float vectorTolerance = 2.0e-4f;
+    const float texCoordTolerance = 0.5f * (MaxTexCoord - MinTexCoord) / 65535.0f + 1.0e-5f;
+    VerifyVertexBuffer(vertexBuffer, vectorTolerance, texCoordTolerance);
+
+    VertexIndices indices;
+    VertexShadingData a, b, c;
+    vertexBuffer.GetVertexIndices(NumTriangles - 1, indices);
+    vertexBuffer.GetShadingData(indices, a, b, c);
+    EXPECT_EQ(Vec3f(0.0f, 0.0f, -1.0f), c.normal);
+    EXPECT_EQ(Vec3f(1.0f, 0.0f, 0.0f), c.tangent);
+    EXPECT_FLOAT_EQ(MaxTexCoord, b.texCoord.x);
+    EXPECT_FLOAT_EQ(MinTexCoord, b.texCoord.y);
+    EXPECT_FLOAT_EQ(MinTexCoord, c.texCoord.x);
+    EXPECT_FLOAT_EQ(MaxTexCoord, c.texCoord.y);
+
+    // packed data survives serialization
+    Buffer buffer;
+    {
+        BufferOutputStream stream(buffer);
+        ASSERT_TRUE(vertexBuffer.Write(stream));
+    }
+
+    VertexBuffer loadedVertexBuffer;
+    {
+        BufferInputStream stream(buffer);
+        ASSERT_TRUE(loadedVertexBuffer.Read(stream));
+    }
+    VerifyVertexBuffer(loadedVertexBuffer, vectorTolerance, texCoordTolerance);
+    EXPECT_EQ(vertexBuffer.GetMemorySize(), loadedVertexBuffer.GetMemorySize());
+}
+
+TEST_F(VertexBufferTest, LargeTexCoordRange)
+{
+    mDesc.packShadingData = true;
+    mDesc.compactIndices = true;
+
+    VertexBuffer packedVertexBuffer;
+    ASSERT_TRUE(packedVertexBuffer.Initialize(mDesc));
+
+    // quantization step would be bigger than allowed, so full precision data is stored
+    mTexCoords[0] = Vec2f(-1000.0f, 0.0f);
+    mTexCoords[1] = Vec2f(0.0f, 1000.0f);
+
+    VertexBuffer vertexBuffer;
+    ASSERT_TRUE(vertexBuffer.Initialize(mDesc));
+    VerifyVertexBuffer(vertexBuffer, 0.0f, 0.0f);
+    EXPECT_LT(packedVertexBuffer.GetMemorySize(), vertexBuffer.GetMemorySize());
+
+    // range fits if bigger error is allowed
+    mDesc.maxTexCoordError = 0.01f;
+
+    VertexBuffer lowPrecisionVertexBuffer;
+    ASSERT_TRUE(lowPrecisionVertexBuffer.Initialize(mDesc));
+    VerifyVertexBuffer(lowPrecisionVertexBuffer, 2.0e-4f, 0.01f);
+    EXPECT_EQ(packedVertexBuffer.GetMemorySize(), lowPrecisionVertexBuffer.GetMemorySize());
+}